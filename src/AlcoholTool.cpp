@@ -32,6 +32,7 @@
 
 #include "Algorithms.h"
 #include "BtLineEdit.h"
+#include "Logging.h"
 #include "PersistentSettings.h"
 #include "measurement/SystemOfMeasurement.h"
 #include "widgets/ToggleSwitch.h"
@@ -216,7 +217,7 @@ public:
       this->label_calibration_temperature->setText(tr("Hydrometer Calibration Temperature"));
 
 #ifndef QT_NO_TOOLTIP
-      qDebug() << Q_FUNC_INFO << "Setting tooltips and What's This help texts";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Setting tooltips and What's This help texts";
       this->input_og->setToolTip(tr("Initial Reading"));
       this->input_fg->setToolTip(tr("Final Reading"));
       this->output_result->setToolTip(tr("Result"));
@@ -224,7 +225,7 @@ public:
          tr("Calculated according to the formula set by the UK Laboratory of the Government Chemist")
       );
 #else
-      qDebug() << Q_FUNC_INFO << "Tooltips not enabled in this build";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Tooltips not enabled in this build";
 #endif
       return;
    }
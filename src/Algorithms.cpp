@@ -25,6 +25,7 @@
 #include <QDebug>
 #include <QVector>
 
+#include "Logging.h"
 #include "PhysicalConstants.h"
 #include "measurement/Unit.h"
 
@@ -326,7 +327,7 @@ double Algorithms::abvFromOgAndFg(double og, double fg) {
    //
    int excessGravityDiffx10 = round(10.0 * (specificGravityToExcessGravity(og) - specificGravityToExcessGravity(fg)));
    double excessGravityDiff = excessGravityDiffx10 / 10.0;
-   qDebug() <<
+   qCDebug(Logging::calc) <<
       Q_FUNC_INFO << "OG (as SG) =" << og << ", FG (as SG) =" << fg << ", excess gravity diff =" << excessGravityDiff <<
       "(×10 =" << excessGravityDiffx10 << ")";
 
@@ -366,7 +367,7 @@ double Algorithms::abvFromOgAndFg(double og, double fg) {
 
    double abvByNewMethod = excessGravityDiff * matchingGravityDifferenceRec->factorToUse;
 
-   qDebug() <<
+   qCDebug(Logging::calc) <<
       Q_FUNC_INFO << "ABV old method:" << abvByOldMethod << "% , new method:" << abvByNewMethod << "% (used factor" <<
       matchingGravityDifferenceRec->factorToUse << "and should be in range" <<
       matchingGravityDifferenceRec->pctAbv_Min << "% -" << matchingGravityDifferenceRec->pctAbv_Max << "%)";
@@ -411,7 +412,7 @@ double Algorithms::correctSgForTemperature(double measuredSg, double readingTemp
       (1.00130346 - 0.000134722124 * tc + 0.00000204052596 * intPow(tc,2) - 0.00000000232820948 * intPow(tc,3))
    );
 
-   qDebug() <<
+   qCDebug(Logging::calc) <<
      Q_FUNC_INFO << measuredSg << "SG measured @" << readingTempInC << "°C (" << tr << "°F) "
      "on hydrometer calibrated at" << calibrationTempInC << "°C (" << tc << "°F) is corrected to" << correctedSg <<
      "SG";
@@ -28,6 +28,7 @@
 #include "database/ObjectStoreWrapper.h"
 #include "Html.h"
 #include "InstructionWidget.h"
+#include "Logging.h"
 #include "measurement/Measurement.h"
 #include "measurement/UnitSystem.h"
 #include "model/Equipment.h"
@@ -258,7 +259,7 @@ void BrewDayScrollWidget::insertInstruction() {
       lineEdit_step->clear();
    }
 
-   qDebug() << Q_FUNC_INFO << "Inserting instruction '" << lineEdit_name->text() << "' at posistion" << pos;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Inserting instruction '" << lineEdit_name->text() << "' at posistion" << pos;
    auto ins = std::make_shared<Instruction>();
    ins->setName(lineEdit_name->text());
    ObjectStoreWrapper::insert(ins);
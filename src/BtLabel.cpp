@@ -24,6 +24,7 @@
 #include <QDebug>
 #include <QMouseEvent>
 
+#include "Logging.h"
 #include "measurement/Measurement.h"
 #include "model/Style.h"
 #include "model/Recipe.h"
@@ -130,7 +131,7 @@ void BtLabel::initializeMenu() {
       Measurement::getForcedSystemOfMeasurementForField(this->propertyName, this->configSection);
    std::optional<Measurement::UnitSystem::RelativeScale> forcedRelativeScale =
       Measurement::getForcedRelativeScaleForField(this->propertyName, this->configSection);
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "forcedSystemOfMeasurement=" << forcedSystemOfMeasurement << ", forcedRelativeScale=" <<
       forcedRelativeScale;
 
@@ -204,7 +205,7 @@ void BtLabel::popContextMenu(const QPoint& point) {
       // It's the menu, so SystemOfMeasurement
       std::optional<Measurement::SystemOfMeasurement> whatSelected =
          UnitAndScalePopUpMenu::dataFromQAction<Measurement::SystemOfMeasurement>(*invoked);
-      qDebug() << Q_FUNC_INFO << "Selected SystemOfMeasurement" << whatSelected;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Selected SystemOfMeasurement" << whatSelected;
       if (!whatSelected) {
          // Null means "Default", which means don't set a forced SystemOfMeasurement for this field
          for (auto field : fieldsToSet) {
@@ -238,7 +239,7 @@ void BtLabel::popContextMenu(const QPoint& point) {
       // It's the sub-menu, so UnitSystem::RelativeScale
       std::optional<Measurement::UnitSystem::RelativeScale> whatSelected =
          UnitAndScalePopUpMenu::dataFromQAction<Measurement::UnitSystem::RelativeScale>(*invoked);
-      qDebug() << Q_FUNC_INFO << "Selected RelativeScale" << whatSelected;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Selected RelativeScale" << whatSelected;
       if (!whatSelected) {
          // Null means "Default", which means don't set a forced RelativeScale for this field
          for (auto field : fieldsToSet) {
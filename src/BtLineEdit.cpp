@@ -28,6 +28,7 @@
 
 #include "Algorithms.h"
 #include "Localization.h"
+#include "Logging.h"
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
 #include "measurement/UnitSystem.h"
@@ -113,13 +114,13 @@ template double BtLineEdit::getValueAs<double>() const;
 
 void BtLineEdit::onLineChanged() {
    auto const myFieldType = this->getFieldType();
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "this->fieldType=" << myFieldType << ", this->units=" << this->units <<
       ", forcedSystemOfMeasurement=" << this->getForcedSystemOfMeasurement() << ", forcedRelativeScale=" <<
       this->getForcedRelativeScale() << ", value=" << this->getWidgetText();
 
    if (!std::holds_alternative<Measurement::PhysicalQuantity>(myFieldType)) {
-      qDebug() << Q_FUNC_INFO << "Not physical quantity";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Not physical quantity";
       if (sender() == this) {
          emit textModified();
       }
@@ -136,7 +137,7 @@ void BtLineEdit::onLineChanged() {
       oldForcedRelativeScale
    };
 
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "oldUnitSystem=" << oldUnitSystem << ", oldForcedRelativeScale=" << oldForcedRelativeScale;
 
    this->lineChanged(previousScaleInfo);
@@ -148,7 +149,7 @@ void BtLineEdit::lineChanged(PreviousScaleInfo previousScaleInfo) {
    // being changed. I am hoping this short circuits properly and we do
    // nothing if nothing changed.
    if (this->sender() == this && !isModified()) {
-      qDebug() << Q_FUNC_INFO << "Nothing changed; field holds" << this->getWidgetText();
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Nothing changed; field holds" << this->getWidgetText();
       return;
    }
 
@@ -182,7 +183,7 @@ void BtLineEdit::setText(NamedEntity * element, int precision) {
 
    char const * const propertyName = this->editField.toLatin1().constData();
    QVariant const propertyValue = element->property(propertyName);
-   qDebug() << Q_FUNC_INFO << "Read property" << propertyName << "of" << *element << "as" << propertyValue;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Read property" << propertyName << "of" << *element << "as" << propertyValue;
    bool force = false;
    auto const myFieldType = this->getFieldType();
    if (std::holds_alternative<NonPhysicalQuantity>(myFieldType) &&
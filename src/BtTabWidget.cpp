@@ -26,6 +26,7 @@
 #include "BtTreeView.h"
 //#include "database/Database.h"
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
 #include "model/Hop.h"
@@ -46,7 +47,7 @@ BtTabWidget::BtTabWidget(QWidget* parent) :
 void BtTabWidget::dragEnterEvent(QDragEnterEvent *event) {
    if (this->acceptMime.size() == 0) {
       this->acceptMime = property("mimeAccepted").toString();
-      qDebug() << Q_FUNC_INFO << "this->acceptMime:" << this->acceptMime;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "this->acceptMime:" << this->acceptMime;
    }
 
    if (event->mimeData()->hasFormat(this->acceptMime) ) {
@@ -61,11 +62,11 @@ void BtTabWidget::dragEnterEvent(QDragEnterEvent *event) {
  * started.
  */
 void BtTabWidget::dropEvent(QDropEvent *event) {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::ui) << Q_FUNC_INFO;
 
    if (this->acceptMime.size() == 0) {
       this->acceptMime = property("mimeAccepted").toString();
-      qDebug() << Q_FUNC_INFO << "this->acceptMime:" << this->acceptMime;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "this->acceptMime:" << this->acceptMime;
    }
 
    if (!event->mimeData()->hasFormat(this->acceptMime)) {
@@ -85,7 +86,7 @@ void BtTabWidget::dropEvent(QDropEvent *event) {
       int id;
       QString name;
       dStream >> itemTypeRaw >> id >> name;
-      qDebug() << Q_FUNC_INFO << "Item type #" << itemTypeRaw;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Item type #" << itemTypeRaw;
       BtTreeItem::Type itemType{itemTypeRaw};
       switch (itemType) {
          case BtTreeItem::Type::RECIPE:
@@ -28,6 +28,7 @@
 #include <QModelIndex>
 #include <QObject>
 #include <QStringBuilder>
+#include <QTextStream>
 #include <Qt>
 #include <QVariant>
 
@@ -35,6 +36,7 @@
 #include "BtFolder.h"
 #include "BtTreeItem.h"
 #include "BtTreeView.h"
+#include "Logging.h"
 #include "RecipeFormatter.h"
 #include "database/ObjectStoreWrapper.h"
 #include "model/Equipment.h"
@@ -48,6 +50,8 @@
 #include "model/Water.h"
 #include "utils/BtStringConst.h"
 #include "PersistentSettings.h"
+#include "utils/StartupProfiler.h"
+#include "utils/Tracing.h"
 
 namespace {
    NamedEntity * getElement(BtTreeItem::Type oType, int id) {
@@ -77,6 +81,23 @@ namespace {
 
       return nullptr;
    }
+
+   /**
+    * \brief Add the approximate size of \c item and all its descendants to \c usage.  We only count the items
+    *        themselves: the recipes, hops, etc they point to are counted in the object stores.
+    */
+   void addTreeItemMemoryUsage(BtTreeItem & item, MemoryAccounting::Usage & usage) {
+      int const numChildren = item.childCount();
+      ++usage.numObjects;
+      usage.approxBytes += sizeof(BtTreeItem);
+      if (numChildren > 0) {
+         usage.approxBytes += MemoryAccounting::containerNodeOverhead + numChildren * sizeof(BtTreeItem *);
+      }
+      for (int ii = 0; ii < numChildren; ++ii) {
+         addTreeItemMemoryUsage(*item.child(ii), usage);
+      }
+      return;
+   }
 }
 
 // =========================================================================
@@ -84,7 +105,13 @@ namespace {
 // =========================================================================
 
 BtTreeModel::BtTreeModel(BtTreeView * parent, TypeMasks type) :
-   QAbstractItemModel(parent) {
+   QAbstractItemModel(parent),
+   memoryRegistration{[this](QMap<QString, MemoryAccounting::Usage> & usage) {
+      QString name{"treeModel/"};
+      QTextStream{&name} << this->itemType;
+      usage[name] += this->getMemoryUsage();
+      return;
+   }} {
    // Initialize the tree structure
    int items = 0;
    this->rootItem = new BtTreeItem();
@@ -175,6 +202,14 @@ BtTreeModel::~BtTreeModel() {
    rootItem = nullptr;
 }
 
+MemoryAccounting::Usage BtTreeModel::getMemoryUsage() const {
+   MemoryAccounting::Usage usage;
+   if (this->rootItem) {
+      addTreeItemMemoryUsage(*this->rootItem, usage);
+   }
+   return usage;
+}
+
 // =========================================================================
 // =================== AbstractItemModel STUFF =============================
 // =========================================================================
@@ -620,13 +655,15 @@ QList<NamedEntity *> BtTreeModel::elements() {
 }
 
 void BtTreeModel::loadTreeModel() {
+   TRACE_SPAN("ui", "BtTreeModel::loadTreeModel");
+   StartupProfiler::Phase startupPhase{"Build tree model for type mask", QString::number(this->treeMask)};
    int i;
 
    QModelIndex ndxLocal;
    BtTreeItem * local = nullptr;
    QList<NamedEntity *> elems = this->elements();
 
-   qDebug() << Q_FUNC_INFO << "Got " << elems.length() << "elements matching type mask" << this->treeMask;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Got " << elems.length() << "elements matching type mask" << this->treeMask;
 
    for (NamedEntity * elem : elems) {
 
@@ -805,7 +842,7 @@ void BtTreeModel::copySelected(QList< QPair<QModelIndex, QString>> toBeCopied) {
                break;
             case BtTreeItem::Type::RECIPE: {
                   auto copy = ObjectStoreWrapper::copy(*this->getItem<Recipe>(ndx)); // Create a deep copy.
-                  qDebug() <<
+                  qCDebug(Logging::ui) <<
                      Q_FUNC_INFO << "display:" <<  copy->display() << "isLocked:" << copy->locked() <<
                      "hasDescendants:" << copy->hasDescendants();
                   copy->setName(name);
@@ -924,7 +961,7 @@ void BtTreeModel::deleteSelected(QModelIndexList victims) {
 // index after we have removed the recipe. BAD THINGS happen otherwise.
 //
 void BtTreeModel::folderChanged(QString name) {
-   qDebug() << Q_FUNC_INFO << name;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << name;
 
    NamedEntity * test = qobject_cast<NamedEntity *>(sender());
    if (test) {
@@ -935,7 +972,7 @@ void BtTreeModel::folderChanged(QString name) {
 }
 
 void BtTreeModel::folderChanged(NamedEntity * test) {
-   qDebug() << Q_FUNC_INFO << test;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << test;
 
    // Find it.
    QModelIndex ndx = findElement(test);
@@ -1373,7 +1410,7 @@ void BtTreeModel::recipePropertyChanged(int recipeId, BtStringConst const & prop
    // .:TBD:. We could probably get away with propertyName == PropertyNames::Recipe::ancestorId here because
    // we always use the same constants for property names.
    if (propertyName != PropertyNames::Recipe::ancestorId) {
-      qDebug() << Q_FUNC_INFO << "Ignoring change to" << propertyName << "on Recipe" << recipeId;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Ignoring change to" << propertyName << "on Recipe" << recipeId;
       return;
    }
 
@@ -1386,7 +1423,7 @@ void BtTreeModel::recipePropertyChanged(int recipeId, BtStringConst const & prop
    int ancestorId = descendant->getAncestorId();
 
    if (ancestorId <= 0 || ancestorId == descendant->key()) {
-      qDebug() << Q_FUNC_INFO << "No ancestor (" << ancestorId << ") on Recipe" << recipeId;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "No ancestor (" << ancestorId << ") on Recipe" << recipeId;
       return;
    }
 
@@ -1424,7 +1461,7 @@ bool BtTreeModel::dropMimeData(QMimeData const * data,
                                int row,
                                int column,
                                QModelIndex const & parent) {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::ui) << Q_FUNC_INFO;
 
    QByteArray encodedData;
 
@@ -1472,7 +1509,8 @@ bool BtTreeModel::dropMimeData(QMimeData const * data,
 
       // this is the work.
       if (oType != BtTreeItem::Type::FOLDER) {
-         qDebug() << Q_FUNC_INFO << "Moving" << elem << "from folder" << elem->folder() << "to folder" << target;
+         qCDebug(Logging::ui) << Q_FUNC_INFO << "Moving" << elem << "from folder" << elem->folder() << "to folder"
+            << target;
          // Dropping an item in a folder just means setting the folder name on that item
          elem->setFolder(target);
          // Now we have to update our own model (ie that of BtTreeModel) so that the display will update!
@@ -1583,7 +1621,7 @@ void BtTreeModel::spawnRecipe(QModelIndex ndx) {
    ObjectStoreWrapper::insert<Recipe>(descendant);
    // ...then we can connect it to the one it was copied from
    descendant->setAncestor(*ancestor);
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "Created descendant Recipe" << descendant->key() << "of Recipe" << ancestor->key() <<
       "(at position" << ndx.row() << ")";
 
@@ -1610,7 +1648,8 @@ void BtTreeModel::spawnRecipe(QModelIndex ndx) {
 }
 
 void BtTreeModel::versionedRecipe(Recipe * ancestor, Recipe * descendant) {
-   qDebug() << Q_FUNC_INFO << "Updating tree now that Recipe" << descendant->key() << "has ancestor Recipe" << ancestor->key();
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Updating tree now that Recipe" << descendant->key() << "has ancestor Recipe"
+      << ancestor->key();
 
    // like before, remove the ancestor
    QModelIndex ndx = findElement(ancestor);
@@ -33,6 +33,7 @@
 #include <QVariant>
 
 #include "BtTreeItem.h"
+#include "utils/MemoryAccounting.h"
 
 // Forward declarations
 class BrewNote;
@@ -281,6 +282,10 @@ private:
    int m_maxColumns;
    QString _mimeType;
 
+   //! \brief Approximate number and size of the tree items we hold.  See \c MemoryAccounting.
+   MemoryAccounting::Usage getMemoryUsage() const;
+   MemoryAccounting::Registration memoryRegistration;
+
 };
 
 #endif
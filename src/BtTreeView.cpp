@@ -35,6 +35,7 @@
 #include "EquipmentEditor.h"
 #include "FermentableDialog.h"
 #include "HopDialog.h"
+#include "Logging.h"
 #include "MiscDialog.h"
 #include "model/BrewNote.h"
 #include "model/Equipment.h"
@@ -52,7 +53,7 @@
 BtTreeView::BtTreeView(QWidget * parent, BtTreeModel::TypeMasks type) :
    QTreeView{parent},
    m_type{type} {
-   qDebug() << Q_FUNC_INFO << "type=" << type;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "type=" << type;
    // Set some global properties that all the kids will use.
    setAllColumnsShowFocus(true);
    setContextMenuPolicy(Qt::CustomContextMenu);
@@ -0,0 +1,245 @@
+/*
+ * DiagnosticsDialog.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "DiagnosticsDialog.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QStringList>
+#include <QTableWidgetItem>
+#include <QVBoxLayout>
+
+#include "database/Database.h"
+#include "utils/MemoryAccounting.h"
+#include "utils/Metrics.h"
+#include "utils/StartupProfiler.h"
+
+namespace {
+   enum {
+      NAME_COL,
+      COUNT_COL,
+      MEAN_COL,
+      P50_COL,
+      P90_COL,
+      P99_COL,
+      MAX_COL,
+      NUM_COLS /*This one MUST be last*/
+   };
+
+   enum {
+      MEMORY_NAME_COL,
+      MEMORY_OBJECTS_COL,
+      MEMORY_KIB_COL,
+      MEMORY_BYTES_PER_OBJECT_COL,
+      MEMORY_NUM_COLS /*This one MUST be last*/
+   };
+
+   //! Append the contents of \c tableWidget to \c lines as tab-separated text
+   void appendAsText(QTableWidget const & tableWidget, QStringList & lines) {
+      for (int row = 0; row < tableWidget.rowCount(); ++row) {
+         QStringList cells;
+         for (int col = 0; col < tableWidget.columnCount(); ++col) {
+            QTableWidgetItem const * item = tableWidget.item(row, col);
+            cells.append(item ? item->text() : QString{});
+         }
+         lines.append(cells.join('\t'));
+      }
+      return;
+   }
+
+   QTableWidgetItem * newNumberItem(QString const & text) {
+      QTableWidgetItem * item = new QTableWidgetItem(text);
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      return item;
+   }
+}
+
+DiagnosticsDialog::DiagnosticsDialog(QWidget * parent) :
+   QDialog{parent},
+   tableWidget_metrics{nullptr},
+   tableWidget_memory{nullptr},
+   label_help{nullptr},
+   plainTextEdit_startup{nullptr},
+   pushButton_refresh{nullptr},
+   pushButton_reset{nullptr},
+   pushButton_copy{nullptr} {
+   this->setObjectName("diagnosticsDialog");
+   this->doLayout();
+
+   connect(this->pushButton_refresh, &QAbstractButton::clicked, this, &DiagnosticsDialog::refresh);
+   connect(this->pushButton_reset,   &QAbstractButton::clicked, this, &DiagnosticsDialog::resetMetrics);
+   connect(this->pushButton_copy,    &QAbstractButton::clicked, this, &DiagnosticsDialog::copyToClipboard);
+   return;
+}
+
+DiagnosticsDialog::~DiagnosticsDialog() = default;
+
+void DiagnosticsDialog::changeEvent(QEvent * event) {
+   if (event->type() == QEvent::LanguageChange) {
+      this->retranslateUi();
+   }
+   QDialog::changeEvent(event);
+   return;
+}
+
+void DiagnosticsDialog::showEvent(QShowEvent * event) {
+   this->refresh();
+   QDialog::showEvent(event);
+   return;
+}
+
+void DiagnosticsDialog::doLayout() {
+   QVBoxLayout * verticalLayout = new QVBoxLayout(this);
+      this->label_help = new QLabel(this);
+      this->label_help->setWordWrap(true);
+      this->tableWidget_metrics = new QTableWidget(0, NUM_COLS, this);
+         this->tableWidget_metrics->setEditTriggers(QAbstractItemView::NoEditTriggers);
+         this->tableWidget_metrics->setSelectionBehavior(QAbstractItemView::SelectRows);
+         this->tableWidget_metrics->verticalHeader()->setVisible(false);
+         this->tableWidget_metrics->setWordWrap(false);
+      this->tableWidget_memory = new QTableWidget(0, MEMORY_NUM_COLS, this);
+         this->tableWidget_memory->setEditTriggers(QAbstractItemView::NoEditTriggers);
+         this->tableWidget_memory->setSelectionBehavior(QAbstractItemView::SelectRows);
+         this->tableWidget_memory->verticalHeader()->setVisible(false);
+         this->tableWidget_memory->setWordWrap(false);
+         this->tableWidget_memory->setVisible(MemoryAccounting::isEnabled());
+      this->plainTextEdit_startup = new QPlainTextEdit(this);
+         this->plainTextEdit_startup->setReadOnly(true);
+         this->plainTextEdit_startup->setLineWrapMode(QPlainTextEdit::NoWrap);
+         // The report is laid out in columns, so it needs a fixed-width font
+         this->plainTextEdit_startup->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+      QHBoxLayout * horizontalLayout = new QHBoxLayout;
+         this->pushButton_refresh = new QPushButton(this);
+         this->pushButton_reset = new QPushButton(this);
+         this->pushButton_copy = new QPushButton(this);
+         this->pushButton_refresh->setAutoDefault(false);
+         this->pushButton_reset->setAutoDefault(false);
+         this->pushButton_copy->setAutoDefault(false);
+         horizontalLayout->addWidget(this->pushButton_refresh);
+         horizontalLayout->addWidget(this->pushButton_reset);
+         horizontalLayout->addStretch();
+         horizontalLayout->addWidget(this->pushButton_copy);
+      verticalLayout->addWidget(this->label_help);
+      verticalLayout->addWidget(this->tableWidget_metrics, 2);
+      verticalLayout->addWidget(this->tableWidget_memory, 1);
+      verticalLayout->addWidget(this->plainTextEdit_startup, 1);
+      verticalLayout->addLayout(horizontalLayout);
+   this->resize(800, 700);
+   this->retranslateUi();
+   return;
+}
+
+void DiagnosticsDialog::retranslateUi() {
+   this->setWindowTitle(tr("Diagnostics"));
+   this->label_help->setText(
+      tr("Counts and timings of what Brewtarget has done since it started (or since the metrics were last reset).  "
+         "Names ending in \"Ns\" are timings in nanoseconds.  Percentiles are accurate to within 12.5%.")
+   );
+   this->pushButton_refresh->setText(tr("Refresh"));
+   this->pushButton_reset->setText(tr("Reset"));
+   this->pushButton_copy->setText(tr("Copy to Clipboard"));
+   this->tableWidget_metrics->setHorizontalHeaderLabels(
+      {tr("Metric"), tr("Count"), tr("Mean"), tr("50%"), tr("90%"), tr("99%"), tr("Max")}
+   );
+   this->tableWidget_memory->setHorizontalHeaderLabels(
+      {tr("Memory use"), tr("Objects"), tr("Approx. KiB"), tr("Approx. bytes per object")}
+   );
+   return;
+}
+
+void DiagnosticsDialog::refresh() {
+   QMap<QString, qint64> const counterValues = Metrics::getCounterValues();
+   QMap<QString, Metrics::HistogramSummary> const histogramSummaries = Metrics::getHistogramSummaries();
+
+   this->tableWidget_metrics->setRowCount(0);
+
+   // Counters just have a count
+   for (auto ii = counterValues.constBegin(); ii != counterValues.constEnd(); ++ii) {
+      int const row = this->tableWidget_metrics->rowCount();
+      this->tableWidget_metrics->insertRow(row);
+      this->tableWidget_metrics->setItem(row, NAME_COL,  new QTableWidgetItem(ii.key()));
+      this->tableWidget_metrics->setItem(row, COUNT_COL, newNumberItem(QString::number(ii.value())));
+   }
+
+   for (auto ii = histogramSummaries.constBegin(); ii != histogramSummaries.constEnd(); ++ii) {
+      Metrics::HistogramSummary const & summary = ii.value();
+      int const row = this->tableWidget_metrics->rowCount();
+      this->tableWidget_metrics->insertRow(row);
+      this->tableWidget_metrics->setItem(row, NAME_COL,  new QTableWidgetItem(ii.key()));
+      this->tableWidget_metrics->setItem(row, COUNT_COL, newNumberItem(QString::number(summary.count)));
+      this->tableWidget_metrics->setItem(row, MEAN_COL,  newNumberItem(QString::number(summary.mean, 'f', 0)));
+      this->tableWidget_metrics->setItem(row, P50_COL,   newNumberItem(QString::number(summary.p50)));
+      this->tableWidget_metrics->setItem(row, P90_COL,   newNumberItem(QString::number(summary.p90)));
+      this->tableWidget_metrics->setItem(row, P99_COL,   newNumberItem(QString::number(summary.p99)));
+      this->tableWidget_metrics->setItem(row, MAX_COL,   newNumberItem(QString::number(summary.max)));
+   }
+
+   this->tableWidget_metrics->resizeColumnsToContents();
+
+   // This is empty if memory accounting is not turned on
+   QMap<QString, MemoryAccounting::Usage> const memoryUsage = MemoryAccounting::getUsage();
+   this->tableWidget_memory->setRowCount(0);
+   for (auto ii = memoryUsage.constBegin(); ii != memoryUsage.constEnd(); ++ii) {
+      MemoryAccounting::Usage const & usage = ii.value();
+      int const row = this->tableWidget_memory->rowCount();
+      this->tableWidget_memory->insertRow(row);
+      qint64 const kib = usage.approxBytes / 1024;
+      this->tableWidget_memory->setItem(row, MEMORY_NAME_COL,    new QTableWidgetItem(ii.key()));
+      this->tableWidget_memory->setItem(row, MEMORY_OBJECTS_COL, newNumberItem(QString::number(usage.numObjects)));
+      this->tableWidget_memory->setItem(row, MEMORY_KIB_COL,     newNumberItem(QString::number(kib)));
+      this->tableWidget_memory->setItem(
+         row,
+         MEMORY_BYTES_PER_OBJECT_COL,
+         newNumberItem(usage.numObjects > 0 ? QString::number(usage.approxBytes / usage.numObjects) : QString{})
+      );
+   }
+   this->tableWidget_memory->resizeColumnsToContents();
+
+   // The compaction report is empty if it hasn't run in this session
+   QString const compactionReport = Database::instance().compactionReport();
+   this->plainTextEdit_startup->setPlainText(
+      compactionReport.isEmpty() ? StartupProfiler::getReport() : StartupProfiler::getReport() + "\n" + compactionReport
+   );
+   return;
+}
+
+void DiagnosticsDialog::resetMetrics() {
+   Metrics::resetAll();
+   this->refresh();
+   return;
+}
+
+void DiagnosticsDialog::copyToClipboard() {
+   QStringList lines;
+   appendAsText(*this->tableWidget_metrics, lines);
+   lines.append(QString{});
+   if (MemoryAccounting::isEnabled()) {
+      appendAsText(*this->tableWidget_memory, lines);
+      lines.append(QString{});
+   }
+   lines.append(StartupProfiler::getReport());
+   QString const compactionReport = Database::instance().compactionReport();
+   if (!compactionReport.isEmpty()) {
+      lines.append(compactionReport);
+   }
+   QApplication::clipboard()->setText(lines.join('\n'));
+   return;
+}
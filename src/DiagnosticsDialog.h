@@ -0,0 +1,74 @@
+/*
+ * DiagnosticsDialog.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+#pragma once
+
+#include <QDialog>
+#include <QEvent>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QShowEvent>
+#include <QTableWidget>
+
+/*!
+ * \class DiagnosticsDialog
+ *
+ * \brief Shows the current values of the runtime counters and latency histograms in \c Metrics, the start-up
+ *        timings from \c StartupProfiler (and what \c Database::automaticCompaction reclaimed, if it ran) and, if it
+ *        is turned on, the memory use per subsystem from \c MemoryAccounting, so that users can tell us what the
+ *        program has been doing (and how long it took) when reporting performance problems.
+ */
+class DiagnosticsDialog : public QDialog {
+   Q_OBJECT
+
+public:
+   DiagnosticsDialog(QWidget * parent = nullptr);
+   virtual ~DiagnosticsDialog();
+
+   void changeEvent(QEvent * event);
+
+public slots:
+   //! \brief Re-read all the metrics and redisplay them
+   void refresh();
+   //! \brief Set all the metrics back to zero, eg before doing something whose cost you want to measure
+   void resetMetrics();
+   //! \brief Copy the metrics and memory use, as tab-separated text, and the start-up timings to the clipboard so
+   //!        they can be pasted into a bug report
+   void copyToClipboard();
+
+protected:
+   virtual void showEvent(QShowEvent * event) override;
+
+private:
+   void doLayout();
+   void retranslateUi();
+
+   QTableWidget *   tableWidget_metrics;
+   //! Only shown if memory accounting is turned on
+   QTableWidget *   tableWidget_memory;
+   QLabel *         label_help;
+   QPlainTextEdit * plainTextEdit_startup;
+   QPushButton *    pushButton_refresh;
+   QPushButton *    pushButton_reset;
+   QPushButton *    pushButton_copy;
+};
+
+#endif
@@ -21,9 +21,9 @@
 
 #include <QDate>
 #include <QDialog>
+#include <QSet>
 
 #include "brewtarget.h"
-#include "database/ObjectStoreWrapper.h"
 #include "Html.h"
 #include "Localization.h"
 #include "MainWindow.h"
@@ -42,24 +42,63 @@ namespace {
     *
     * @return QString
     */
-   QString createInventoryHeader() {
+   QString createInventoryHeader(InventoryFormatter::Snapshot const & snapshot) {
       return Html::createHeader(QObject::tr("Inventory"), ":css/inventory.css") +
             QString("<h1>%1 &mdash; %2</h1>")
                   .arg(QObject::tr("Inventory"))
-                  .arg(Localization::displayDateUserFormated(QDate::currentDate()));
+                  .arg(snapshot.date);
+   }
+
+   /**
+    * \brief Capture one table's worth of ingredients (on the main thread)
+    */
+   template<class NE>
+   InventoryFormatter::Snapshot::Table takeTableSnapshot(BtStringConst const & section) {
+      return InventoryFormatter::Snapshot::Table{
+         ObjectStoreSnapshot::capture<NE>(),
+         Measurement::getForcedSystemOfMeasurementForField(*PropertyNames::NamedEntityWithInventory::inventory,
+                                                           *section),
+         Measurement::getForcedRelativeScaleForField(*PropertyNames::NamedEntityWithInventory::inventory, *section)
+      };
+   }
+
+   /**
+    * \brief Find all the parent ingredients whose inventory is > 0
+    *
+    *        (We don't want children because they are just usages of the parents in recipes.  As with
+    *        \c NamedEntity::getParent(), something whose parent is no longer in the store counts as a parent.)
+    */
+   QVector<ObjectStoreSnapshot::Record> parentsWithInventory(InventoryFormatter::Snapshot::Table const & table) {
+      QSet<int> keys;
+      for (auto const & record : table.records.records()) {
+         keys.insert(record.get<int>(PropertyNames::NamedEntity::key));
+      }
+      return table.records.findAllMatching(
+         [&keys](ObjectStoreSnapshot::Record const & record) {
+            return !keys.contains(record.get<int>(PropertyNames::NamedEntity::parentKey)) &&
+                   record.get<double>(PropertyNames::NamedEntityWithInventory::inventory) > 0.0;
+         }
+      );
+   }
+
+   QString displayInventory(InventoryFormatter::Snapshot::Table const & table,
+                            ObjectStoreSnapshot::Record const & record,
+                            Measurement::Unit const & unit) {
+      return Measurement::displayAmount(
+         Measurement::Amount{record.get<double>(PropertyNames::NamedEntityWithInventory::inventory), unit},
+         3,
+         table.forcedSystemOfMeasurement,
+         table.forcedScale
+      );
    }
 
    /**
     * Create Inventory HTML Table of Fermentables
     */
-   QString createInventoryTableFermentable() {
+   QString createInventoryTableFermentable(InventoryFormatter::Snapshot::Table const & table) {
       QString result;
 
-      // Find all the parent Fermentables whose inventory is > 0
-      // (We don't want children because they are just usages of the parents in recipes.)
-      auto inventory = ObjectStoreWrapper::findAllMatching<Fermentable>(
-         [](std::shared_ptr<Fermentable> ff) { return (ff->getParent() == nullptr && ff->inventory() > 0.0); }
-      );
+      auto inventory = parentsWithInventory(table);
       if (!inventory.empty()) {
 
          result += QString("<h2>%1</h2>").arg(QObject::tr("Fermentables"));
@@ -71,15 +110,13 @@ namespace {
                         .arg(QObject::tr("Name"))
                         .arg(QObject::tr("Amount"));
 
-         for (auto fermentable : inventory) {
+         for (auto const & fermentable : inventory) {
             result += QString("<tr>"
                               "<td>%1</td>"
                               "<td>%2</td>"
                               "</tr>")
-                           .arg(fermentable->name())
-                           .arg(Measurement::displayAmount(Measurement::Amount{fermentable->inventory(), Measurement::Units::kilograms},
-                                                           PersistentSettings::Sections::fermentableTable,
-                                                           PropertyNames::NamedEntityWithInventory::inventory));
+                           .arg(fermentable.get<QString>(PropertyNames::NamedEntity::name))
+                           .arg(displayInventory(table, fermentable, Measurement::Units::kilograms));
          }
          result += "</table>";
       }
@@ -89,12 +126,10 @@ namespace {
    /**
     * Create Inventory HTML Table of Hops
     */
-   QString createInventoryTableHop() {
+   QString createInventoryTableHop(InventoryFormatter::Snapshot::Table const & table) {
       QString result;
 
-      auto inventory = ObjectStoreWrapper::findAllMatching<Hop>(
-         [](std::shared_ptr<Hop> hh) { return (hh->getParent() == nullptr && hh->inventory() > 0.0); }
-      );
+      auto inventory = parentsWithInventory(table);
       if (!inventory.empty()) {
 
          result += QString("<h2>%1</h2>").arg(QObject::tr("Hops"));
@@ -108,17 +143,15 @@ namespace {
                         .arg(QObject::tr("Alpha %"))
                         .arg(QObject::tr("Amount"));
 
-         for (auto hop : inventory) {
+         for (auto const & hop : inventory) {
             result += QString("<tr>"
                               "<td>%1</td>"
                               "<td>%2</td>"
                               "<td>%3</td>"
                               "</tr>")
-                           .arg(hop->name())
-                           .arg(hop->alpha_pct())
-                           .arg(Measurement::displayAmount(Measurement::Amount{hop->inventory(), Measurement::Units::kilograms},
-                                                           PersistentSettings::Sections::hopTable,
-                                                           PropertyNames::NamedEntityWithInventory::inventory));
+                           .arg(hop.get<QString>(PropertyNames::NamedEntity::name))
+                           .arg(hop.get<double>(PropertyNames::Hop::alpha_pct))
+                           .arg(displayInventory(table, hop, Measurement::Units::kilograms));
          }
          result += "</table>";
       }
@@ -128,12 +161,10 @@ namespace {
    /**
     * Create Inventory HTML Table of Misc
     */
-   QString createInventoryTableMiscellaneous() {
+   QString createInventoryTableMiscellaneous(InventoryFormatter::Snapshot::Table const & table) {
       QString result;
 
-      auto inventory = ObjectStoreWrapper::findAllMatching<Misc>(
-         [](std::shared_ptr<Misc> mm) { return (mm->getParent() == nullptr && mm->inventory() > 0.0); }
-      );
+      auto inventory = parentsWithInventory(table);
       if (!inventory.empty()) {
 
          result += QString("<h2>%1</h2>").arg(QObject::tr("Miscellaneous"));
@@ -145,20 +176,18 @@ namespace {
                         .arg(QObject::tr("Name"))
                         .arg(QObject::tr("Amount"));
 
-         for (auto miscellaneous : inventory) {
-            QString const displayAmount = Measurement::displayAmount(
-               Measurement::Amount{
-                  miscellaneous->inventory(),
-                  miscellaneous->amountIsWeight() ? Measurement::Units::kilograms : Measurement::Units::liters
-               },
-               PersistentSettings::Sections::miscTable,
-               PropertyNames::NamedEntityWithInventory::inventory
+         for (auto const & miscellaneous : inventory) {
+            QString const displayAmount = displayInventory(
+               table,
+               miscellaneous,
+               miscellaneous.get<bool>(PropertyNames::Misc::amountIsWeight) ? Measurement::Units::kilograms :
+                                                                              Measurement::Units::liters
             );
             result += QString("<tr>"
                               "<td>%1</td>"
                               "<td>%2</td>"
                               "</tr>")
-                           .arg(miscellaneous->name())
+                           .arg(miscellaneous.get<QString>(PropertyNames::NamedEntity::name))
                            .arg(displayAmount);
          }
          result += "</table>";
@@ -169,11 +198,9 @@ namespace {
    /**
     * Create Inventory HTML Table of Yeast
     */
-   QString createInventoryTableYeast() {
+   QString createInventoryTableYeast(InventoryFormatter::Snapshot::Table const & table) {
       QString result;
-      auto inventory = ObjectStoreWrapper::findAllMatching<Yeast>(
-         [](std::shared_ptr<Yeast> yy) { return (yy->getParent() == nullptr && yy->inventory() > 0.0); }
-      );
+      auto inventory = parentsWithInventory(table);
       if (!inventory.empty()) {
          result += QString("<h2>%1</h2>").arg(QObject::tr("Yeast"));
          result += "<table id=\"yeast\">";
@@ -184,21 +211,19 @@ namespace {
                         .arg(QObject::tr("Name"))
                         .arg(QObject::tr("Amount"));
 
-         for (auto yeast : inventory) {
-            QString const displayAmount = Measurement::displayAmount(
-               Measurement::Amount{
-                  yeast->inventory(),
-                  yeast->amountIsWeight() ? Measurement::Units::kilograms : Measurement::Units::liters
-               },
-               PersistentSettings::Sections::yeastTable,
-               PropertyNames::NamedEntityWithInventory::inventory
+         for (auto const & yeast : inventory) {
+            QString const displayAmount = displayInventory(
+               table,
+               yeast,
+               yeast.get<bool>(PropertyNames::Yeast::amountIsWeight) ? Measurement::Units::kilograms :
+                                                                       Measurement::Units::liters
             );
 
             result += QString("<tr>"
                               "<td>%1</td>"
                               "<td>%2</td>"
                               "</tr>")
-                           .arg(yeast->name())
+                           .arg(yeast.get<QString>(PropertyNames::NamedEntity::name))
                            .arg(displayAmount);
          }
          result += "</table>";
@@ -209,13 +234,13 @@ namespace {
    /**
     * Create Inventory HTML Body
     */
-   QString createInventoryBody(InventoryFormatter::HtmlGenerationFlags flags) {
-      // Only generate users selection of Ingredient inventory.
-      QString result =
-         ((InventoryFormatter::FERMENTABLES  & flags) ? createInventoryTableFermentable() : "") +
-         ((InventoryFormatter::HOPS          & flags) ? createInventoryTableHop() : "") +
-         ((InventoryFormatter::MISCELLANEOUS & flags) ? createInventoryTableMiscellaneous() : "") +
-         ((InventoryFormatter::YEAST         & flags) ? createInventoryTableYeast() : "");
+   QString createInventoryBody(InventoryFormatter::Snapshot const & snapshot) {
+      // Only generate users selection of Ingredient inventory.  (The snapshot only has records for the tables the user
+      // selected, so the others will come out empty.)
+      QString result = createInventoryTableFermentable(snapshot.fermentables) +
+                       createInventoryTableHop(snapshot.hops) +
+                       createInventoryTableMiscellaneous(snapshot.miscellaneous) +
+                       createInventoryTableYeast(snapshot.yeast);
 
          // If user selects no printout or if there are no inventory for the selected ingredients.
       if (result.size() == 0) {
@@ -246,8 +271,30 @@ bool InventoryFormatter::operator&(InventoryFormatter::HtmlGenerationFlags a,
 }
 
 
-QString InventoryFormatter::createInventoryHtml(HtmlGenerationFlags flags) {
-   return createInventoryHeader() +
-          createInventoryBody(flags) +
+InventoryFormatter::Snapshot InventoryFormatter::takeSnapshot(HtmlGenerationFlags flags) {
+   Snapshot snapshot;
+   snapshot.date = Localization::displayDateUserFormated(QDate::currentDate());
+   if (FERMENTABLES & flags) {
+      snapshot.fermentables = takeTableSnapshot<Fermentable>(PersistentSettings::Sections::fermentableTable);
+   }
+   if (HOPS & flags) {
+      snapshot.hops = takeTableSnapshot<Hop>(PersistentSettings::Sections::hopTable);
+   }
+   if (MISCELLANEOUS & flags) {
+      snapshot.miscellaneous = takeTableSnapshot<Misc>(PersistentSettings::Sections::miscTable);
+   }
+   if (YEAST & flags) {
+      snapshot.yeast = takeTableSnapshot<Yeast>(PersistentSettings::Sections::yeastTable);
+   }
+   return snapshot;
+}
+
+QString InventoryFormatter::createInventoryHtml(Snapshot const & snapshot) {
+   return createInventoryHeader(snapshot) +
+          createInventoryBody(snapshot) +
           createInventoryFooter();
 }
+
+QString InventoryFormatter::createInventoryHtml(HtmlGenerationFlags flags) {
+   return createInventoryHtml(takeSnapshot(flags));
+}
@@ -22,7 +22,13 @@
 #define INVENTORY_FORMATTER_H
 #pragma once
 
-class QString;
+#include <optional>
+
+#include <QString>
+
+#include "database/ObjectStoreSnapshot.h"
+#include "measurement/SystemOfMeasurement.h"
+#include "measurement/UnitSystem.h"
 
 namespace InventoryFormatter {
    enum HtmlGenerationFlags {
@@ -52,6 +58,39 @@ namespace InventoryFormatter {
     */
    bool operator&(HtmlGenerationFlags a, HtmlGenerationFlags b);
 
+   /**
+    * \brief Everything needed to generate the inventory HTML.  Made on the main thread by \c takeSnapshot(), after
+    *        which \c createInventoryHtml(Snapshot const &) can be called on any thread, as it does not touch any live
+    *        objects or settings.
+    */
+   struct Snapshot {
+      struct Table {
+         //! Empty if the table was not selected
+         ObjectStoreSnapshot records;
+         //! The user's choice of units for amounts in this table (from \c PersistentSettings)
+         std::optional<Measurement::SystemOfMeasurement> forcedSystemOfMeasurement;
+         std::optional<Measurement::UnitSystem::RelativeScale> forcedScale;
+      };
+      QString date;
+      Table fermentables;
+      Table hops;
+      Table miscellaneous;
+      Table yeast;
+   };
+
+   /**
+    * \brief Capture what's currently in the inventory for the tables selected by \c flags.  MUST be called on the main
+    *        thread.
+    */
+   Snapshot takeSnapshot(HtmlGenerationFlags flags);
+
+   /**
+    * \brief Create the inventory HTML from a snapshot.  Safe to call on any thread.
+    *
+    * \return QString containing the HTML code for the inventory tables.
+    */
+   QString createInventoryHtml(Snapshot const & snapshot);
+
    /**
     * @brief Create a Inventory HTML for export
     *
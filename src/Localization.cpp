@@ -31,6 +31,7 @@
 #include <QTranslator>
 
 #include "brewtarget.h"
+#include "Logging.h"
 #include "model/NamedEntity.h"
 #include "PersistentSettings.h"
 #include "utils/BtStringConst.h"
@@ -115,7 +116,7 @@ bool Localization::hasUnits(QString qstr) {
 
    bool result = amtUnit.cap(2).size() > 0;
 
-   qDebug() << Q_FUNC_INFO << qstr << (result ? "has" : "does not have") << "units";
+   qCDebug(Logging::ui) << Q_FUNC_INFO << qstr << (result ? "has" : "does not have") << "units";
 
    return result;
 }
@@ -20,16 +20,25 @@
  */
 #include "Logging.h"
 
+#include <atomic>
+#include <cstdio>       // For std::fwrite, std::fflush
+#include <exception>    // For std::set_terminate
+#include <limits>
+#include <memory>
 #include <sstream>      // For std::ostringstream
 
 #include <boost/stacktrace.hpp>
 
 #include <QApplication>
+#include <QByteArray>
 #include <QDebug>
+#include <QHash>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QObject>
+#include <QSemaphore>
 #include <QStandardPaths>
+#include <QStringList>
 #include <QTextStream>
 #include <QThread>
 #include <QTime>
@@ -62,6 +71,15 @@ namespace {
    QString const timeFormat{"hh:mm:ss.zzz"};
 
    QFile logFile;
+   // Size of the current log file, which we keep track of ourselves so we don't have to ask the file system every time
+   // we write something
+   qint64 logFileBytesWritten{0};
+
+   //
+   // Protects logFile and logFileBytesWritten, and serialises writing to stderr.  Note that, with the exception of
+   // writing directly to errStream, nothing that is done while holding this mutex should do any logging -- otherwise
+   // we could end up trying to acquire the mutex when we already hold it.
+   //
    QMutex mutex;
 
    // This global flag controls whether, in general, we are logging to stderr or not.  Usually it's turned off for at
@@ -69,7 +87,6 @@ namespace {
    bool isLoggingToStderr{true};
 
    QTextStream errStream{stderr};
-   QTextStream * stream;
 
    //
    // It's useful to include the thread ID in log messages.  We don't care what the actual ID is, we just need to be
@@ -105,6 +122,132 @@ namespace {
       bool savedState;
    };
 
+   //
+   // Our logging categories all have names starting with this, which is how we tell them apart from Qt's own categories
+   // (eg "qt.network.ssl") and the "default" category that qDebug() etc log to.
+   //
+   char const * const categoryNamePrefix = "brewtarget.";
+   int const categoryNamePrefixLength = static_cast<int>(qstrlen(categoryNamePrefix));
+
+   //
+   // Logging levels for the categories that have their own (indexed by short name, eg "db").  Categories not in here
+   // use currentLoggingLevel.  This is only read when Qt calls categoryFilter(), which is not very often, so a mutex
+   // is fine.
+   //
+   QHash<QString, Logging::Level> categoryLogLevels;
+   //
+   // Levels set just for this run of the program (eg on the command line), which take precedence over the ones above
+   // and are never saved.  Protected by the same mutex.
+   //
+   QHash<QString, Logging::Level> categoryLogLevelOverrides;
+   QMutex categoryLogLevelsMutex;
+
+   QLoggingCategory::CategoryFilter previousCategoryFilter = nullptr;
+
+   /**
+    * \brief Qt calls this for each logging category when it is created and whenever we call applyCategoryFilter().
+    *        This is where we decide which message types are enabled for each category, so that qCDebug() etc can skip
+    *        disabled messages before doing any work.
+    */
+   void categoryFilter(QLoggingCategory * category) {
+      // Let Qt's default filter (which knows about QT_LOGGING_RULES etc) do its thing first
+      if (previousCategoryFilter) {
+         previousCategoryFilter(category);
+      }
+
+      Logging::Level level = currentLoggingLevel;
+      if (qstrncmp(category->categoryName(), categoryNamePrefix, categoryNamePrefixLength) == 0) {
+         QString const shortName = QString::fromLatin1(category->categoryName() + categoryNamePrefixLength);
+         QMutexLocker locker(&categoryLogLevelsMutex);
+         level = categoryLogLevelOverrides.value(shortName, categoryLogLevels.value(shortName, currentLoggingLevel));
+      } else if (qstrcmp(category->categoryName(), "default") != 0) {
+         // Qt's own categories are left however Qt's filter set them
+         return;
+      }
+
+      category->setEnabled(QtDebugMsg,   level <= Logging::LogLevel_DEBUG);
+      category->setEnabled(QtInfoMsg,    level <= Logging::LogLevel_INFO);
+      category->setEnabled(QtWarningMsg, level <= Logging::LogLevel_WARNING);
+      // We always log errors
+      category->setEnabled(QtCriticalMsg, true);
+      return;
+   }
+
+   /**
+    * \brief (Re)apply categoryFilter() to all logging categories.  Needs to be called whenever any logging level
+    *        changes.
+    */
+   void applyCategoryFilter() {
+      // Installing a filter makes Qt call it for every existing category
+      QLoggingCategory::CategoryFilter oldFilter = QLoggingCategory::installFilter(categoryFilter);
+      if (oldFilter != categoryFilter) {
+         previousCategoryFilter = oldFilter;
+      }
+      return;
+   }
+
+   /**
+    * \brief Case-insensitive lookup of a logging level from its name
+    */
+   std::optional<Logging::Level> logLevelFromName(QString const & name) {
+      for (auto const & levelDetail : Logging::levelDetails) {
+         if (name.compare(QLatin1String{levelDetail.name}, Qt::CaseInsensitive) == 0) {
+            return levelDetail.level;
+         }
+      }
+      return std::nullopt;
+   }
+
+   /**
+    * \brief Parse \c rules, in the format that Logging::setCategoryLogLevels() accepts, into \c levels.  Caller must
+    *        hold categoryLogLevelsMutex (so mustn't log).
+    *
+    * \return \c false if any of the rules could not be understood (in which case the others are still applied)
+    */
+   bool parseCategoryLogLevels(QString const & rules, QHash<QString, Logging::Level> & levels) {
+      bool allRulesOk = true;
+#if QT_VERSION < QT_VERSION_CHECK(5,15,0)
+      QString::SplitBehavior skip = QString::SkipEmptyParts;
+#else
+      Qt::SplitBehaviorFlags skip = Qt::SkipEmptyParts;
+#endif
+      for (QString const & rule : rules.split(',', skip)) {
+         QStringList const parts = rule.split('=');
+         std::optional<Logging::Level> const level = parts.size() == 2 ? logLevelFromName(parts.at(1).trimmed()) :
+                                                                         std::nullopt;
+         auto const match = std::find_if(
+            Logging::categoryDetails.begin(),
+            Logging::categoryDetails.end(),
+            [&parts](Logging::CategoryDetail const & cd) {
+               return parts.at(0).trimmed().compare(QLatin1String{cd.name}, Qt::CaseInsensitive) == 0;
+            }
+         );
+         if (!level || match == Logging::categoryDetails.end()) {
+            allRulesOk = false;
+            continue;
+         }
+         levels.insert(match->name, *level);
+      }
+      return allRulesOk;
+   }
+
+   /**
+    * \brief Turn categoryLogLevels (but not categoryLogLevelOverrides, as they are not to be saved) into the same
+    *        format that Logging::setCategoryLogLevels() accepts.  Caller must hold categoryLogLevelsMutex.
+    */
+   QString categoryLogLevelsToString() {
+      QStringList rules;
+      for (auto const & categoryDetail : Logging::categoryDetails) {
+         if (categoryLogLevels.contains(categoryDetail.name)) {
+            Logging::Level const level = categoryLogLevels.value(categoryDetail.name);
+            rules.append(
+               QString{"%1=%2"}.arg(QLatin1String{categoryDetail.name}, Logging::getStringFromLogLevel(level))
+            );
+         }
+      }
+      return rules.join(',');
+   }
+
    //
    // We use the Qt functions (qDebug(), qInfo(), etc) do our logging but we need to convert from QtMsgType to our own
    // logging level for two reasons:
@@ -122,18 +265,297 @@ namespace {
       }
    }
 
+   /**
+    * \brief A log message that has been formatted and is waiting to be written
+    */
+   struct LogRecord {
+      //! The full line, including the terminating newline, in the encoding in which it will be written out
+      QByteArray text;
+      //! Whether this line should also go to stderr.  We have to capture this when the message is logged, because
+      //  TemporarilyForceStderrLogging is per-thread.
+      bool toStderr;
+   };
+
+   /**
+    * \brief A fixed-size queue of \c LogRecord that any number of threads can add to, without blocking one another,
+    *        and that any number of threads can take from.  (In practice, only the log writer thread takes from it,
+    *        except when we need to flush in a hurry.)  If the queue is full, \c tryPush() fails rather than waiting.
+    *
+    *        This is Dmitry Vyukov's well-known bounded MPMC queue: each slot has a sequence number that tells producers
+    *        and consumers whether it is theirs to use on the current lap around the buffer, so the only contention
+    *        between threads is the compare-and-swap on the enqueue (or dequeue) position.
+    */
+   class LogRingBuffer {
+   public:
+      //! \param capacity Must be a power of two
+      LogRingBuffer(std::size_t const capacity) :
+         slots{std::make_unique<Slot[]>(capacity)},
+         mask{capacity - 1},
+         enqueuePosition{0},
+         dequeuePosition{0} {
+         Q_ASSERT((capacity & this->mask) == 0);
+         for (std::size_t ii = 0; ii < capacity; ++ii) {
+            this->slots[ii].sequence.store(ii, std::memory_order_relaxed);
+         }
+         return;
+      }
+
+      /**
+       * \return \c false if the buffer is full (in which case \c record is unchanged)
+       */
+      bool tryPush(LogRecord & record) {
+         std::size_t position = this->enqueuePosition.load(std::memory_order_relaxed);
+         for (;;) {
+            Slot & slot = this->slots[position & this->mask];
+            std::size_t const sequence = slot.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t const diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (diff == 0) {
+               // Slot is free on this lap, so try to claim it.  If we fail, position is updated for us to try again.
+               if (this->enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                  slot.record = std::move(record);
+                  slot.sequence.store(position + 1, std::memory_order_release);
+                  return true;
+               }
+            } else if (diff < 0) {
+               // Slot still holds a record from the previous lap, ie the buffer is full
+               return false;
+            } else {
+               // Another producer got here first
+               position = this->enqueuePosition.load(std::memory_order_relaxed);
+            }
+         }
+      }
+
+      /**
+       * \return \c false if the buffer is empty
+       */
+      bool tryPop(LogRecord & record) {
+         std::size_t position = this->dequeuePosition.load(std::memory_order_relaxed);
+         for (;;) {
+            Slot & slot = this->slots[position & this->mask];
+            std::size_t const sequence = slot.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t const diff =
+               static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+            if (diff == 0) {
+               if (this->dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                  record = std::move(slot.record);
+                  // Mark the slot as free for the next lap
+                  slot.sequence.store(position + this->mask + 1, std::memory_order_release);
+                  return true;
+               }
+            } else if (diff < 0) {
+               return false;
+            } else {
+               position = this->dequeuePosition.load(std::memory_order_relaxed);
+            }
+         }
+      }
+
+   private:
+      struct Slot {
+         std::atomic<std::size_t> sequence;
+         LogRecord record;
+      };
+      std::unique_ptr<Slot[]> const slots;
+      std::size_t const mask;
+      // Keep the producers' and consumers' positions on separate cache lines so they don't slow each other down
+      alignas(64) std::atomic<std::size_t> enqueuePosition;
+      alignas(64) std::atomic<std::size_t> dequeuePosition;
+   };
+
+   //
+   // 8192 records of typically 100-200 bytes is a couple of MB at most, which is plenty to absorb a burst of debug
+   // logging.
+   //
+   std::size_t constexpr logRingBufferCapacity = 8192;
+   LogRingBuffer logRingBuffer{logRingBufferCapacity};
+
+   // The writer thread will write out at most this many records before giving other threads a chance to get the mutex
+   int constexpr maxRecordsPerBatch = 1024;
+
+   // Number of times a thread logging a message found the ring buffer full and had to write out what was in it itself
+   std::atomic<quint64> numBufferOverflows{0};
+
+   // Used to wake the writer thread when there is something to write
+   QSemaphore writerWakeUp;
+   std::atomic<bool> writerWakeUpPending{false};
+
+   // Set when the writer thread should stop (once it has written everything in the ring buffer)
+   std::atomic<bool> writerStopRequested{false};
+
+   // Set while the writer thread is running.  When it isn't, we write log messages out synchronously.
+   std::atomic<bool> asyncLoggingRunning{false};
+
+   void pruneLogFiles();
+   bool openLogFile();
+
+   /**
+    * \brief Write one record to stderr and/or the log file, rotating the log file if it gets too big.  Caller must hold
+    *        the mutex.
+    */
+   void writeRecord(LogRecord const & record) {
+      if (record.toStderr) {
+         std::fwrite(record.text.constData(), 1, record.text.size(), stderr);
+      }
+      if (logFile.isOpen()) {
+         logFile.write(record.text);
+         logFileBytesWritten += record.text.size();
+         if (logFileBytesWritten >= Logging::logFileSize) {
+            // If the user has configured a different log file location, we might not be able to write there anymore,
+            // in which case openLogFile() will fall back to the temporary directory.
+            pruneLogFiles();
+            openLogFile();
+         }
+      }
+      return;
+   }
+
+   /**
+    * \brief Take whatever is in the ring buffer (up to \c maxRecords records) and write it out.  Caller must hold the
+    *        mutex.
+    *
+    * \return Number of records written
+    */
+   int writeBufferedRecords(int const maxRecords = std::numeric_limits<int>::max()) {
+      int numRecordsWritten = 0;
+      LogRecord record;
+      while (numRecordsWritten < maxRecords && logRingBuffer.tryPop(record)) {
+         writeRecord(record);
+         ++numRecordsWritten;
+      }
+      if (numRecordsWritten > 0) {
+         std::fflush(stderr);
+         if (logFile.isOpen()) {
+            logFile.flush();
+         }
+      }
+      return numRecordsWritten;
+   }
+
+   /**
+    * \brief Ask the writer thread to look at the ring buffer.  We make sure we don't keep poking it if it's already got
+    *        a wake-up call waiting.
+    */
+   void wakeWriterThread() {
+      if (!writerWakeUpPending.exchange(true)) {
+         writerWakeUp.release();
+      }
+      return;
+   }
+
+   /**
+    * \brief Writes out everything that gets put in the ring buffer.  This means that the thread that logs a message
+    *        only has to format it and put it in the buffer, and never has to wait for disk I/O (unless the buffer
+    *        fills up).  Rotating log files also happens on this thread.
+    */
+   class LogWriterThread : public QThread {
+   public:
+      LogWriterThread() : QThread{} {
+         return;
+      }
+      virtual ~LogWriterThread() = default;
+
+   protected:
+      virtual void run() {
+         for (;;) {
+            // Any wake-up call that arrives after this point will be for something we haven't yet seen
+            writerWakeUpPending = false;
+            int numRecordsWritten;
+            {
+               QMutexLocker locker(&mutex);
+               numRecordsWritten = writeBufferedRecords(maxRecordsPerBatch);
+            }
+            if (numRecordsWritten > 0) {
+               continue;
+            }
+            if (writerStopRequested) {
+               break;
+            }
+            // The timeout is just belt-and-braces.  Normally we'll be woken as soon as there is something to write.
+            writerWakeUp.tryAcquire(1, 250);
+         }
+         return;
+      }
+   };
+
+   LogWriterThread * logWriterThread = nullptr;
+
+   /**
+    * \brief Write out everything in the ring buffer on the current thread.  This is for when we can't wait for the
+    *        writer thread -- eg because we're about to crash or exit.
+    *
+    *        If, for some reason, another thread has the mutex and isn't giving it back (eg because it's the thread
+    *        that's crashing), we give up after a second rather than hang.
+    */
+   void flushOnCurrentThread() {
+      if (mutex.tryLock(1000)) {
+         writeBufferedRecords();
+         mutex.unlock();
+      }
+      return;
+   }
+
+   /**
+    * \brief If the program is about to be terminated because of an uncaught exception (or some other error that
+    *        causes std::terminate() to be called), make sure we write out the log messages explaining why before we go.
+    */
+   std::terminate_handler previousTerminateHandler = nullptr;
+   bool terminateHandlerInstalled = false;
+   [[noreturn]] void terminateHandler() {
+      flushOnCurrentThread();
+      if (previousTerminateHandler) {
+         previousTerminateHandler();
+      }
+      std::abort();
+   }
+
    //
    // This is what actually outputs a message to the log file and/or std::cerr
    //
-   void doLog(const Logging::Level level, const QString message) {
-      QString logEntry = QString{"[%1] (%2) %3 : %4"}.arg(QTime::currentTime().toString(timeFormat))
-                                                     .arg(threadId)
-                                                     .arg(Logging::getStringFromLogLevel(level))
-                                                     .arg(message);
+   // NB: We use the multi-argument version of QString::arg() to do all the substitution in one pass.  As well as being
+   //     faster than chained calls, it means that, if the message itself contains something like "%1", it doesn't get
+   //     substituted.
+   //
+   void doLog(Logging::Level const level, QString const & message, QString const & sourceFile, int const line) {
+      QString const logEntry = QString{"[%1] (%2) %3 : %4  [%5:%6]\n"}.arg(
+         QTime::currentTime().toString(timeFormat),
+         threadId,
+         QLatin1String{Logging::levelDetails.at(level).name},
+         message,
+         sourceFile,
+         QString::number(line)
+      );
+      LogRecord record{logEntry.toUtf8(), isLoggingToStderr || forceStderrLogging};
+
+      if (asyncLoggingRunning) {
+         if (logRingBuffer.tryPush(record)) {
+            wakeWriterThread();
+            return;
+         }
+         //
+         // The buffer is full, ie messages are being logged faster than we can write them out.  Rather than lose
+         // messages (which might be the very ones needed to diagnose a problem) or let the buffer grow without limit,
+         // we help out by writing out what's in the buffer ourselves (which also keeps the messages in order).
+         //
+         ++numBufferOverflows;
+         QMutexLocker locker(&mutex);
+         writeBufferedRecords();
+         writeRecord(record);
+         std::fflush(stderr);
+         if (logFile.isOpen()) {
+            logFile.flush();
+         }
+         return;
+      }
+
+      // If there is no writer thread (because we are not yet initialised or we have terminated) then we just write the
+      // message out ourselves
       QMutexLocker locker(&mutex);
-      if (isLoggingToStderr ||
-          forceStderrLogging) { errStream << logEntry << END_OF_LINE; }
-      if (stream)             {   *stream << logEntry << END_OF_LINE; }
+      writeRecord(record);
+      std::fflush(stderr);
+      if (logFile.isOpen()) {
+         logFile.flush();
+      }
       return;
    }
 
@@ -145,15 +567,9 @@ namespace {
    }
 
    /**
-    * \brief Closes the log file stream and the file handle.
+    * \brief Closes the log file handle.
     */
    void closeLogFile() {
-      // Close and reset the stream if it is set.
-      if (stream) {
-         delete stream;
-         stream = nullptr;
-      }
-
       // Close the file if it's open.
       if (logFile.isOpen()) {
          logFile.close();
@@ -184,20 +600,16 @@ namespace {
    }
 
    /**
-    * \brief initializes the log file and opens the stream for writing.
+    * \brief initializes the log file and opens it for writing.
     *        This was moved to its own function as this has to be called every time logs are being pruned.
+    *
+    *        NB it is the caller's responsibility to hold the mutex.  Since that means we can't use Qt logging here, any
+    *        problems go to stderr.
     */
    bool openLogFile() {
-      // We _really_ need to see problems with opening the log file on stderr!
-      TemporarilyForceStderrLogging temporarilyForceStderrLogging;
-
       // First check if it's time to rotate the log file
       if (logFile.size() > Logging::logFileSize) {
-         // Acquire lock due to the file mangling below.  NB: This means we do not want to use Qt logging in this
-         // block, as we'd end up attempting to acquire the same mutex in the doLog() function above!  So, any errors
-         // between here and the closing brace need to go to stderr
-         QMutexLocker locker(&mutex);
-         // Double check that the stream is not initiated, if so, kill it.
+         // Double check that the file is not open, if so, close it.
          closeLogFile();
          if (!renameLogFileWithTimestamp(logDirectory)) {
             errStream <<
@@ -210,26 +622,24 @@ namespace {
       // Test default location
       logFile.setFileName(logDirectory.filePath(logFileFullName()));
       if (logFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
-         stream = new QTextStream(&logFile);
-         qInfo() << Q_FUNC_INFO << "Logging to file" << QFileInfo(logFile).canonicalFilePath();
+         logFileBytesWritten = logFile.size();
          return true;
       }
 
-      qInfo() <<
-         Q_FUNC_INFO << "Could not open log file" << QFileInfo(logFile).canonicalFilePath() <<
-         "for writing.  Will try using temporary directory";
+      errStream <<
+         "Could not open log file " << QFileInfo(logFile).canonicalFilePath() <<
+         " for writing.  Will try using temporary directory" << END_OF_LINE;
 
       // Defaults to temporary
       logFile.setFileName(QDir::temp().filePath(logFileFullName()));
       if (logFile.open(QFile::WriteOnly | QFile::Truncate)) {
          logFile.setPermissions(QFileDevice::WriteUser | QFileDevice::ReadUser | QFileDevice::ExeUser);
-         stream = new QTextStream(&logFile);
-         qWarning() <<
-            Q_FUNC_INFO << "Log file is in a temporary directory: " << QFileInfo(logFile).canonicalFilePath();
+         logFileBytesWritten = 0;
+         errStream << "Log file is in a temporary directory: " << QFileInfo(logFile).canonicalFilePath() << END_OF_LINE;
          return true;
       }
 
-      qCritical() << Q_FUNC_INFO << "Unable to open" << QFileInfo(logFile).canonicalFilePath();
+      errStream << "Unable to open " << QFileInfo(logFile).canonicalFilePath() << END_OF_LINE;
 
       return false;
    }
@@ -238,16 +648,13 @@ namespace {
     * \brief Prunes old log files from the directory, keeping only the specified number of files in logFileCount,
     *        Purpose is to keep log files to a mininum while keeping the logs up-to-date and also not require manual
     *        pruning of files.
+    *
+    *        NB it is the caller's responsibility to hold the mutex.
     */
    void pruneLogFiles() {
-      QMutexLocker locker(&mutex);
-      // Need to close and reset the stream before deleting any files.
+      // Need to close the file before deleting any files.
       closeLogFile();
 
-      // If the logfile is closed and we're in testing mode where stderr is disabled, we need to enable it temporarily.
-      // saving old value to reset to after pruning.
-      TemporarilyForceStderrLogging temporarilyForceStderrLogging;
-
       //Get the list of log files.
       QFileInfoList fileList = Logging::getLogFileList();
       if (fileList.size() > Logging::logFileCount)
@@ -269,25 +676,18 @@ namespace {
       Logging::Level logLevelOfMessage = levelFromQtMsgType(qtMsgType);
       //
       // First things first!  What logging level has the user chosen.
-      // then, if the file-stream is open and the log file size is to big, we need to prune the old logs and initiate a new logfile.
-      // after that we're all set, Log away!
+      // After that we're all set, Log away!
       //
 
-      // Check that we're set to log this level, this is set by the user options.
-      if (logLevelOfMessage < currentLoggingLevel) {
+      // Check that we're set to log this level, this is set by the user options.  (For our own logging categories,
+      // this has already been checked, by categoryFilter(), before the message was even constructed, and the category
+      // might have a different level from the overall one.)
+      if (logLevelOfMessage < currentLoggingLevel &&
+          (!context.category ||
+           qstrncmp(context.category, categoryNamePrefix, categoryNamePrefixLength) != 0)) {
          return;
       }
 
-      // Check if there is a file actually set yet.  In a rare case if the logfile was not created at initialization,
-      // then we won't be logging to a file, the location may not yet have been loaded from the settings, thus only logging to the stderr.
-      // In this case we cannot do any of the pruning or filename generation.
-      if (stream) {
-         if (logFile.size() >= Logging::logFileSize) {
-            pruneLogFiles();
-            openLogFile();
-         }
-      }
-
       // Writing the actual log
       //
       // QMessageLogContext members are a bit hard to find in Qt documentation so noted here:
@@ -303,8 +703,15 @@ namespace {
       // But we'd like to show the relative path under the src directory (eg database/Database.cpp rather than just
       // Database.cpp).  (The code here assumes there will not be any subdirectory of src that is also called src,
       // which seems pretty reasonable.)
+      //
+      // Rotating the log file when it gets too big is taken care of when the message is written out.
       QString sourceFile = QString{context.file}.split("/src/").last();
-      doLog(logLevelOfMessage, QString("%1  [%2:%3]").arg(message).arg(sourceFile).arg(context.line));
+      doLog(logLevelOfMessage, message, sourceFile, context.line);
+
+      // A fatal message is going to abort the program as soon as we return, so we need to get everything out now
+      if (qtMsgType == QtFatalMsg) {
+         flushOnCurrentThread();
+      }
       return;
    }
 
@@ -318,6 +725,22 @@ QVector<Logging::LevelDetail> const Logging::levelDetails{
    { Logging::LogLevel_ERROR,   "ERROR",   QObject::tr("Errors only")}
 };
 
+namespace Logging {
+   Q_LOGGING_CATEGORY(db,    "brewtarget.db")
+   Q_LOGGING_CATEGORY(xml,   "brewtarget.xml")
+   Q_LOGGING_CATEGORY(model, "brewtarget.model")
+   Q_LOGGING_CATEGORY(ui,    "brewtarget.ui")
+   Q_LOGGING_CATEGORY(calc,  "brewtarget.calc")
+}
+
+QVector<Logging::CategoryDetail> const Logging::categoryDetails{
+   { &Logging::db,    "db",    QObject::tr("Database")},
+   { &Logging::xml,   "xml",   QObject::tr("BeerXML import and export")},
+   { &Logging::model, "model", QObject::tr("Recipes and ingredients")},
+   { &Logging::ui,    "ui",    QObject::tr("User interface")},
+   { &Logging::calc,  "calc",  QObject::tr("Units and calculations")}
+};
+
 QString Logging::getStringFromLogLevel(const Logging::Level level) {
    auto match = std::find_if(Logging::levelDetails.begin(),
                               Logging::levelDetails.end(),
@@ -345,9 +768,50 @@ Logging::Level Logging::getLogLevel() {
 void Logging::setLogLevel(Level newLevel) {
    currentLoggingLevel = newLevel;
    PersistentSettings::insert(PersistentSettings::Names::LoggingLevel, Logging::getStringFromLogLevel(currentLoggingLevel));
+   applyCategoryFilter();
+   return;
+}
+
+std::optional<Logging::Level> Logging::getCategoryLogLevel(QString const & categoryName) {
+   QMutexLocker locker(&categoryLogLevelsMutex);
+   if (categoryLogLevelOverrides.contains(categoryName)) {
+      return categoryLogLevelOverrides.value(categoryName);
+   }
+   if (categoryLogLevels.contains(categoryName)) {
+      return categoryLogLevels.value(categoryName);
+   }
+   return std::nullopt;
+}
+
+void Logging::setCategoryLogLevel(QString const & categoryName, std::optional<Level> newLevel) {
+   {
+      QMutexLocker locker(&categoryLogLevelsMutex);
+      // An explicit choice replaces any level that was only set for this run
+      categoryLogLevelOverrides.remove(categoryName);
+      if (newLevel) {
+         categoryLogLevels.insert(categoryName, *newLevel);
+      } else {
+         categoryLogLevels.remove(categoryName);
+      }
+      PersistentSettings::insert(PersistentSettings::Names::LoggingCategoryLevels, categoryLogLevelsToString());
+   }
+   applyCategoryFilter();
    return;
 }
 
+bool Logging::setCategoryLogLevels(QString const & rules) {
+   bool allRulesOk = true;
+   {
+      QMutexLocker locker(&categoryLogLevelsMutex);
+      allRulesOk = parseCategoryLogLevels(rules, categoryLogLevelOverrides);
+   }
+   if (!allRulesOk) {
+      qWarning() << Q_FUNC_INFO << "Could not understand all of logging category rules" << rules;
+   }
+   applyCategoryFilter();
+   return allRulesOk;
+}
+
 bool Logging::getLogInConfigDir() {
    return PersistentSettings::getConfigDir().canonicalPath() == logDirectory.canonicalPath();
 }
@@ -373,6 +837,36 @@ bool Logging::initializeLogging() {
    );
 
    qInstallMessageHandler(logMessageHandler);
+
+   // Now set up the saved logging levels for our logging categories
+   QString const savedCategoryLogLevels =
+      PersistentSettings::value(PersistentSettings::Names::LoggingCategoryLevels, "").toString();
+   bool savedCategoryLogLevelsOk = true;
+   {
+      QMutexLocker locker(&categoryLogLevelsMutex);
+      savedCategoryLogLevelsOk = parseCategoryLogLevels(savedCategoryLogLevels, categoryLogLevels);
+   }
+   if (!savedCategoryLogLevelsOk) {
+      qWarning() <<
+         Q_FUNC_INFO << "Could not understand all of saved logging category levels" << savedCategoryLogLevels;
+   }
+   applyCategoryFilter();
+
+   //
+   // From here on, writing log messages out happens on a separate thread.  (We check for an existing writer thread
+   // because, in testing, we can get called more than once.)
+   //
+   if (!logWriterThread) {
+      writerStopRequested = false;
+      logWriterThread = new LogWriterThread{};
+      logWriterThread->start();
+      asyncLoggingRunning = true;
+   }
+   // Make sure we don't lose the messages explaining why the program is terminating
+   if (!terminateHandlerInstalled) {
+      previousTerminateHandler = std::set_terminate(terminateHandler);
+      terminateHandlerInstalled = true;
+   }
    qDebug() << Q_FUNC_INFO << "Logging initialized.  Logs will be written to" << logDirectory.canonicalPath();
 
    // It's quite useful on debug builds to check that stack trace logging is working, rather than to find out it's not
@@ -435,62 +929,71 @@ bool Logging::setDirectory(std::optional<QDir> newDirectory, Logging::PersistNew
       PersistentSettings::insert(PersistentSettings::Names::LogDirectory, logDirectory.absolutePath());
    }
 
-   //
-   // If we are already writing to a log file in the old directory, it needs to be closed and moved to the new one
-   //
-   // NB: This only moves the current Logfile, the older ones will be left behind.
-   //
-   if (stream && logDirectory.canonicalPath() != oldDirectory.canonicalPath()) {
-
-      // NB Don't try to log inside this if statement.  We are moving the log file!  Errors need to go to stderr.
+   QString logFilePath;
+   {
+      // NB Don't try to log inside this block.  We are moving the log file!  Errors need to go to stderr.
       QMutexLocker locker(&mutex);
 
-      // Close the file if open and reset the stream.
-      closeLogFile();
-
       //
-      // Attempt to move existing log file to the new directory, making some attempt to avoid overwriting any existing
-      // file of the same name (by moving/renaming it to have a .bak extension).
+      // If we are already writing to a log file in the old directory, it needs to be closed and moved to the new one
       //
-      // Note however that some of this file moving/renaming could still fail for a couple of reasons:
-      //    - If we try to move/rename a file to overwrite a file that already exists (eg if the .bak file also already
-      //      exists) then, on some operating systems (eg Windows), the move will fail and, on others (eg Linux), it
-      //      will succeed (with the clashing file getting overwritten).
-      //    - On some operating systems, you can't move from one file system to another (eg on Windows from C: drive to
-      //      D: drive)
+      // NB: This only moves the current Logfile, the older ones will be left behind.
       //
-      // If things go wrong we can't really write a message to the log file(!) but we can emit something to stderr
-      //
-      // The first check is whether there's anything to move!
-      //
-      QString fileName = logFileFullName();
-      if (oldDirectory.exists(fileName)) {
+      if (logFile.isOpen() && logDirectory.canonicalPath() != oldDirectory.canonicalPath()) {
+
+         // Close the file if open.
+         closeLogFile();
+
+         //
+         // Attempt to move existing log file to the new directory, making some attempt to avoid overwriting any
+         // existing file of the same name (by moving/renaming it to have a .bak extension).
+         //
+         // Note however that some of this file moving/renaming could still fail for a couple of reasons:
+         //    - If we try to move/rename a file to overwrite a file that already exists (eg if the .bak file also
+         //      already exists) then, on some operating systems (eg Windows), the move will fail and, on others (eg
+         //      Linux), it will succeed (with the clashing file getting overwritten).
+         //    - On some operating systems, you can't move from one file system to another (eg on Windows from C:
+         //      drive to D: drive)
          //
-         // Make a reasonable effort to move out the way anything we might otherwise be about to stomp on
+         // If things go wrong we can't really write a message to the log file(!) but we can emit something to stderr
          //
-         if (logDirectory.exists(fileName)) {
-            if (!renameLogFileWithTimestamp(logDirectory)) {
+         // The first check is whether there's anything to move!
+         //
+         QString fileName = logFileFullName();
+         if (oldDirectory.exists(fileName)) {
+            //
+            // Make a reasonable effort to move out the way anything we might otherwise be about to stomp on
+            //
+            if (logDirectory.exists(fileName)) {
+               if (!renameLogFileWithTimestamp(logDirectory)) {
+                  errStream <<
+                     Q_FUNC_INFO << "Unable to rename " << fileName << " in directory " <<
+                     logDirectory.canonicalPath() << END_OF_LINE;
+                  return false;
+               }
+            }
+            if (!logFile.rename(logDirectory.filePath(fileName))) {
                errStream <<
-                  Q_FUNC_INFO << "Unable to rename " << fileName << " in directory " << logDirectory.canonicalPath() <<
-                  END_OF_LINE;
+                  Q_FUNC_INFO << "Unable to move " << fileName << " from " << oldDirectory.canonicalPath() << " to " <<
+                  logDirectory.canonicalPath() << END_OF_LINE;
                return false;
             }
          }
-         if (!logFile.rename(logDirectory.filePath(fileName))) {
-            errStream <<
-               Q_FUNC_INFO << "Unable to move " << fileName << " from " << oldDirectory.canonicalPath() << " to " <<
-               logDirectory.canonicalPath() << END_OF_LINE;
-            return false;
-         }
+      }
+
+      // Now make sure the log file in the new directory is open for writing
+      closeLogFile();
+      if (openLogFile()) {
+         logFilePath = QFileInfo(logFile).canonicalFilePath();
       }
    }
 
-   // Now make sure the log file in the new directory is open for writing
-   if (!openLogFile()) {
+   if (logFilePath.isEmpty()) {
       qWarning() << Q_FUNC_INFO << QString("Could not open/create a log file");
       return false;
    }
 
+   qInfo() << Q_FUNC_INFO << "Logging to file" << logFilePath;
    return true;
 }
 
@@ -513,9 +1016,40 @@ QFileInfoList Logging::getLogFileList() {
 }
 
 
+void Logging::flush() {
+   if (asyncLoggingRunning) {
+      QMutexLocker locker(&mutex);
+      writeBufferedRecords();
+   }
+   return;
+}
+
+quint64 Logging::getNumBufferOverflows() {
+   return numBufferOverflows;
+}
+
 void Logging::terminateLogging() {
+   //
+   // Stop the writer thread.  It will write out anything left in the ring buffer before it finishes.  After that, any
+   // further logging is written out synchronously.
+   //
+   if (logWriterThread) {
+      writerStopRequested = true;
+      wakeWriterThread();
+      logWriterThread->wait();
+      asyncLoggingRunning = false;
+      delete logWriterThread;
+      logWriterThread = nullptr;
+   }
+
    QMutexLocker locker(&mutex);
+   // In case anything got into the ring buffer between the writer thread finishing and us noticing
+   writeBufferedRecords();
    closeLogFile();
+   if (numBufferOverflows > 0) {
+      errStream <<
+         "Logging: ring buffer was full " << numBufferOverflows << " time(s); consider logging less" << END_OF_LINE;
+   }
    return;
 }
 
@@ -26,11 +26,16 @@
 
 #include <QDir>
 #include <QFileInfoList>
+#include <QLoggingCategory>
 #include <QString>
 #include <QVector>
 
 /*!
  * \brief Provides a proxy to an OS agnostic log file.
+ *
+ *        Log messages are formatted on the thread that logs them and put in a fixed-size lock-free ring buffer.  A
+ *        dedicated thread takes them out of the buffer and writes them to stderr and the log file (and takes care of
+ *        log file rotation), so logging a message doesn't have to wait for disk I/O.
  */
 namespace Logging {
    /**
@@ -89,6 +94,62 @@ namespace Logging {
     */
    extern void setLogLevel(Level newLevel);
 
+   /**
+    * \brief Logging categories for the main subsystems of the program.  Log using these via the Qt macros, eg:
+    *           qCDebug(Logging::db) << Q_FUNC_INFO << "Query:" << BoundValuesToString(sqlQuery);
+    *        Unlike qDebug() etc, these check whether the category is enabled at the given level \b before evaluating
+    *        anything that is being logged, so disabled debug logging costs no more than a branch.
+    *
+    *        Each category logs at the overall logging level (see \c setLogLevel()) unless it has been given its own
+    *        level (see \c setCategoryLogLevel()).
+    */
+   Q_DECLARE_LOGGING_CATEGORY(db)    //!< Database access and object stores
+   Q_DECLARE_LOGGING_CATEGORY(xml)   //!< Reading and writing BeerXML
+   Q_DECLARE_LOGGING_CATEGORY(model) //!< Recipes, ingredients and other model objects
+   Q_DECLARE_LOGGING_CATEGORY(ui)    //!< Windows, dialogs, widgets and table/tree models
+   Q_DECLARE_LOGGING_CATEGORY(calc)  //!< Units, measurements and brewing calculations
+
+   /**
+    * \brief Info about each of the categories above:
+    *           - the category itself
+    *           - A short name to use in the config file and on the command line
+    *           - A description to show the user on the Options dialog
+    */
+   struct CategoryDetail {
+      QLoggingCategory const & (*category)();
+      char const * name;
+      QString description;
+   };
+   extern QVector<CategoryDetail> const categoryDetails;
+
+   /**
+    * \brief Get the logging level for a category
+    *
+    * \param categoryName Short name of the category (eg "db")
+    * \return The category's own logging level (including one set just for this run by \c setCategoryLogLevels()), or
+    *         \c std::nullopt if it uses the overall logging level
+    */
+   extern std::optional<Level> getCategoryLogLevel(QString const & categoryName);
+
+   /**
+    * \brief Set the logging level for a category, and remember it for future runs of the program.  This replaces any
+    *        level set for the category just for this run by \c setCategoryLogLevels().
+    *
+    * \param categoryName Short name of the category (eg "db")
+    * \param newLevel The level to use, or \c std::nullopt to use the overall logging level
+    */
+   extern void setCategoryLogLevel(QString const & categoryName, std::optional<Level> newLevel);
+
+   /**
+    * \brief Set the logging levels for one or more categories just for this run of the program (eg from the command
+    *        line).  These take precedence over the saved levels, and are never saved themselves (so, eg, saving other
+    *        changes on the Options dialog doesn't make them permanent).
+    *
+    * \param rules Comma-separated list of category=level, eg "db=DEBUG,xml=WARNING".  Names are not case-sensitive.
+    * \return \c false if any of the rules could not be understood (in which case the others are still applied)
+    */
+   extern bool setCategoryLogLevels(QString const & rules);
+
    /**
     * \return \b true if we are logging in the config dir (the default), \b false if we are logging in a directory
     *         configured via \c Logging::setDirectory()
@@ -161,7 +222,20 @@ namespace Logging {
    extern QFileInfoList getLogFileList();
 
    /**
-    * \brief Terminate logging
+    * \brief Log messages are normally written out on a separate thread, a short time after they are logged.  This
+    *        waits until everything logged so far has been written out.  Mostly useful for testing.
+    */
+   extern void flush();
+
+   /**
+    * \return How many times a message was logged when the buffer of messages waiting to be written out was full.  (In
+    *         that case, the thread that logged the message writes out the buffer itself, so nothing is lost, but that
+    *         thread is slowed down.)
+    */
+   extern quint64 getNumBufferOverflows();
+
+   /**
+    * \brief Terminate logging.  Everything logged so far is written out before the log file is closed.
     */
    extern void terminateLogging();
 
@@ -43,6 +43,7 @@
 #include <QDomElement>
 #include <QDomNode>
 #include <QDomNodeList>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileDialog>
 #include <QIcon>
@@ -56,6 +57,7 @@
 #include <QNetworkReply>
 #include <QPen>
 #include <QPixmap>
+#include <QProgressDialog>
 #include <QSize>
 #include <QString>
 #include <QTextStream>
@@ -81,6 +83,7 @@
 #include "ConverterTool.h"
 #include "database/Database.h"
 #include "database/ObjectStoreWrapper.h"
+#include "DiagnosticsDialog.h"
 #include "EquipmentEditor.h"
 #include "EquipmentListModel.h"
 #include "FermentableDialog.h"
@@ -92,6 +95,7 @@
 #include "Html.h"
 #include "HydrometerTool.h"
 #include "InventoryFormatter.h"
+#include "Logging.h"
 #include "MashDesigner.h"
 #include "MashEditor.h"
 #include "MashListModel.h"
@@ -121,6 +125,7 @@
 #include "RefractoDialog.h"
 #include "RelationalUndoableUpdate.h"
 #include "ScaleRecipeTool.h"
+#include "SearchDialog.h"
 #include "StrikeWaterDialog.h"
 #include "StyleEditor.h"
 #include "StyleListModel.h"
@@ -135,10 +140,12 @@
 #include "UndoableAddOrRemoveList.h"
 #include "utils/BtStringConst.h"
 #include "utils/OptionalToStream.h"
+#include "utils/StartupProfiler.h"
 #include "WaterDialog.h"
 #include "WaterEditor.h"
 #include "WaterListModel.h"
 #include "xml/BeerXml.h"
+#include "xml/BeerXmlImport.h"
 #include "YeastDialog.h"
 #include "YeastEditor.h"
 #include "YeastSortFilterProxyModel.h"
@@ -219,28 +226,81 @@ public:
          return;
       }
 
-      qDebug() << Q_FUNC_INFO << "Importing " << fileOpener.selectedFiles().length() << " files";
-      qDebug() << Q_FUNC_INFO << "Directory " << fileOpener.directory();
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Importing " << fileOpener.selectedFiles().length() << " files";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Directory " << fileOpener.directory();
       this->fileOpenDirectory = fileOpener.directory().canonicalPath();
 
-      for (QString filename : fileOpener.selectedFiles()) {
-         //
-         // I guess if the user were importing a lot of files in one go, it might be annoying to have a separate result
-         // message for each one, but TBD whether that's much of a use case.  For now, we keep things simple.
-         //
-         qDebug() << Q_FUNC_INFO << "Importing " << filename;
-         QString userMessage;
-         QTextStream userMessageAsStream{&userMessage};
-         bool succeeded = BeerXML::getInstance().importFromXML(filename, userMessageAsStream);
-         qDebug() << Q_FUNC_INFO << "Import " << (succeeded ? "succeeded" : "failed");
-         this->importExportMsg(IMPORT, filename, succeeded, userMessage);
-      }
+      //
+      // All the selected files are read in parallel as a single import, so the user gets one progress dialog and one
+      // result message, which is a lot less annoying than one of each per file when importing a lot of files in one go.
+      //
+      QStringList const fileNames = fileOpener.selectedFiles();
+      QString userMessage;
+      bool succeeded = this->importFromFiles(fileNames, userMessage);
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Import " << (succeeded ? "succeeded" : "failed");
+      this->importExportMsg(IMPORT,
+                            fileNames.size() == 1 ? fileNames.first() : tr("%n file(s)", "", fileNames.size()),
+                            succeeded,
+                            userMessage);
 
       self.showChanges();
 
       return;
    }
 
+   /**
+    * \brief Import one or more files, showing a progress dialog (with a cancel button) while we do so.  The dialog is
+    *        window modal, so the user can't edit things while we're importing, but the rest of the UI keeps going.
+    *
+    * \param fileNames
+    * \param userMessage Set to the message we want to show the user about the import
+    * \return \c true if the import succeeded, \c false if it failed or was cancelled
+    */
+   bool importFromFiles(QStringList const & fileNames, QString & userMessage) {
+      BeerXmlImport beerXmlImport{fileNames};
+
+      QString const progressLabel{
+         fileNames.size() == 1 ? tr("Importing \"%1\"...").arg(QFileInfo(fileNames.first()).fileName()) :
+                                 tr("Importing %n file(s)...", "", fileNames.size())
+      };
+      QProgressDialog progressDialog{progressLabel,
+                                     tr("Cancel"),
+                                     0,
+                                     0,
+                                     &self};
+      progressDialog.setWindowModality(Qt::WindowModal);
+      // We don't know how many records there are until we have read all the files, so the maximum value keeps going
+      // up, and we don't want the dialog to reset itself if we momentarily catch up with the reading
+      progressDialog.setAutoReset(false);
+      progressDialog.setAutoClose(false);
+      // Small files import quickly enough that there's no point flashing up a dialog
+      progressDialog.setMinimumDuration(500);
+
+      bool succeeded = false;
+      QEventLoop eventLoop;
+      QObject::connect(&beerXmlImport,
+                       &BeerXmlImport::progress,
+                       &progressDialog,
+                       [&progressDialog](int numRecordsProcessed, int numRecordsLoaded) {
+                          progressDialog.setMaximum(numRecordsLoaded);
+                          progressDialog.setValue(numRecordsProcessed);
+                       });
+      QObject::connect(&progressDialog, &QProgressDialog::canceled, &beerXmlImport, &BeerXmlImport::cancel);
+      QObject::connect(&beerXmlImport,
+                       &BeerXmlImport::finished,
+                       &eventLoop,
+                       [&succeeded, &userMessage, &eventLoop](bool importSucceeded, QString const & importMessage) {
+                          succeeded = importSucceeded;
+                          userMessage = importMessage;
+                          eventLoop.quit();
+                       });
+
+      beerXmlImport.start();
+      eventLoop.exec();
+      progressDialog.close();
+      return succeeded;
+   }
+
    enum ImportOrExport {
       EXPORT,
       IMPORT
@@ -292,7 +352,7 @@ public:
             }
          }
       }
-      qDebug() << Q_FUNC_INFO << "Message box text : " << messageBoxText;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Message box text : " << messageBoxText;
       QMessageBox msgBox{succeeded ? QMessageBox::Information : QMessageBox::Critical,
                          messageBoxTitle,
                          messageBoxText};
@@ -308,7 +368,8 @@ private:
 
 
 MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), pimpl{std::make_unique<impl>(*this)} {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::ui) << Q_FUNC_INFO;
+   StartupProfiler::Phase startupPhase{"Construct main window"};
 
    undoStack = new QUndoStack(this);
 
@@ -351,7 +412,8 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), pimpl{std::make_u
 }
 
 void MainWindow::init() {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::ui) << Q_FUNC_INFO;
+   StartupProfiler::Phase startupPhase{"Initialise main window"};
    this->setupCSS();
    // initialize all of the dialog windows
    this->setupDialogs();
@@ -388,9 +450,9 @@ void MainWindow::init() {
 
    // Moved from Database class
    Recipe::connectSignals();
-   qDebug() << Q_FUNC_INFO << "Recipe signals connected";
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Recipe signals connected";
    Mash::connectSignals();
-   qDebug() << Q_FUNC_INFO << "Mash signals connected";
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Mash signals connected";
 
    // I do not like this connection here.
    connect(ancestorDialog, &AncestorDialog::ancestoryChanged, treeView_recipe->model(), &BtTreeModel::versionedRecipe);
@@ -407,7 +469,7 @@ void MainWindow::init() {
    // the databae is changed (as setToolTip() just takes static text as its parameter).
    label_Brewtarget->setToolTip(getLabelToolTip());
 
-   qDebug() << Q_FUNC_INFO << "MainWindow initialisation complete";
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "MainWindow initialisation complete";
    return;
 }
 
@@ -451,13 +513,13 @@ void MainWindow::setSizesInPixelsBasedOnDpi()
    //
    auto dpiX = this->logicalDpiX();
    auto dpiY = this->logicalDpiY();
-   qDebug() << QString("Logical DPI: %1,%2.  Physical DPI: %3,%4")
+   qCDebug(Logging::ui) << QString("Logical DPI: %1,%2.  Physical DPI: %3,%4")
       .arg(dpiX)
       .arg(dpiY)
       .arg(this->physicalDpiX())
       .arg(this->physicalDpiY());
    auto defaultToolBarIconSize = this->toolBar->iconSize();
-   qDebug() << QString("Default toolbar icon size: %1,%2")
+   qCDebug(Logging::ui) << QString("Default toolbar icon size: %1,%2")
       .arg(defaultToolBarIconSize.width())
       .arg(defaultToolBarIconSize.height());
    this->toolBar->setIconSize(QSize(dpiX/4,dpiY/4));
@@ -467,7 +529,7 @@ void MainWindow::setSizesInPixelsBasedOnDpi()
    // size as the toolbar ones.
    //
    auto defaultTabIconSize = this->tabWidget_Trees->iconSize();
-   qDebug() << QString("Default tab icon size: %1,%2")
+   qCDebug(Logging::ui) << QString("Default tab icon size: %1,%2")
       .arg(defaultTabIconSize.width())
       .arg(defaultTabIconSize.height());
    this->tabWidget_Trees->setIconSize(QSize(dpiX/4,dpiY/4));
@@ -482,11 +544,13 @@ void MainWindow::setSizesInPixelsBasedOnDpi()
    //
    // This is a bit more work to implement because its a PNG image in a QLabel object
    //
-   qDebug() << QString("Logo default size: %1,%2").arg(this->label_Brewtarget->width()).arg(this->label_Brewtarget->height());
+   qCDebug(Logging::ui) << QString("Logo default size: %1,%2").arg(this->label_Brewtarget->width())
+      .arg(this->label_Brewtarget->height());
    this->label_Brewtarget->setScaledContents(true);
    this->label_Brewtarget->setFixedSize((265.0/66.0) * dpiX/2,  // width = 265/66 × height = 265/66 × half an inch = (265/66) × (dpiX/2)
                                         dpiY/2);                // height = half an inch = dpiY/2
-   qDebug() << QString("Logo new size: %1,%2").arg(this->label_Brewtarget->width()).arg(this->label_Brewtarget->height());
+   qCDebug(Logging::ui) << QString("Logo new size: %1,%2").arg(this->label_Brewtarget->width())
+      .arg(this->label_Brewtarget->height());
 
    return;
 }
@@ -575,6 +639,8 @@ void MainWindow::setupDialogs()
    waterEditor = new WaterEditor(this);
 
    ancestorDialog = new AncestorDialog(this);
+   searchDialog = new SearchDialog(this);
+   diagnosticsDialog = new DiagnosticsDialog(this);
 
    // Set up the fileSaver dialog.
    fileSaver = new QFileDialog(this, tr("Save"), QDir::homePath(), tr("BeerXML files (*.xml)") );
@@ -880,6 +946,7 @@ void MainWindow::setupTriggers() {
    connect( actionYeasts, &QAction::triggered, yeastDialog, &QWidget::show );                                           // > View > Yeasts
    connect( actionOptions, &QAction::triggered, optionDialog, &OptionDialog::show );                                    // > Tools > Options
    connect( actionManual, &QAction::triggered, this, &MainWindow::openManual );                                         // > About > Manual
+   connect( actionDiagnostics, &QAction::triggered, diagnosticsDialog, &QWidget::show );                                // > About > Diagnostics
    connect( actionScale_Recipe, &QAction::triggered, recipeScaler, &QWidget::show );                                    // > Tools > Scale Recipe
    connect( action_recipeToTextClipboard, &QAction::triggered, recipeFormatter, &RecipeFormatter::toTextClipboard );    // > Tools > Recipe to Clipboard as Text
    connect( actionConvert_Units, &QAction::triggered, converterTool, &QWidget::show );                                  // > Tools > Convert Units
@@ -895,6 +962,8 @@ void MainWindow::setupTriggers() {
    connect( actionDeleteSelected, &QAction::triggered, this, &MainWindow::deleteSelected );
    connect( actionWater_Chemistry, &QAction::triggered, this, &MainWindow::popChemistry);                               // > Tools > Water Chemistry
    connect( actionAncestors, &QAction::triggered, this, &MainWindow::setAncestor);                                      // > Tools > Ancestors
+   connect( actionSearch_Notes, &QAction::triggered, searchDialog, &QWidget::show );                                    // > Tools > Search Notes
+   connect( searchDialog, &SearchDialog::recipeSelected, this, &MainWindow::showSearchResult );
    connect( action_brewit, &QAction::triggered, this, &MainWindow::brewItHelper );
    //One Dialog to rule them all, at least all printing and export.
    connect( actionPrint, &QAction::triggered, printAndPreviewDialog, &QWidget::show);                                   // > File > Print and Preview
@@ -989,12 +1058,12 @@ void MainWindow::deleteSelected() {
 
    // This happens after startup when nothing is selected
    if (!active) {
-      qDebug() << Q_FUNC_INFO << "Nothing selected, so nothing to delete";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Nothing selected, so nothing to delete";
       return;
    }
 
    QModelIndex start = active->selectionModel()->selectedRows().first();
-   qDebug() << Q_FUNC_INFO << "Delete starting from row" << start.row();
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Delete starting from row" << start.row();
    active->deleteSelected(active->selectionModel()->selectedRows());
 
    //
@@ -1012,18 +1081,19 @@ void MainWindow::deleteSelected() {
    if (!start.isValid() || !active->type(start)) {
       int oldRow = start.row();
       start = active->first();
-      qDebug() << Q_FUNC_INFO << "Row" << oldRow << "no longer valid, so returning to first (" << start.row() << ")";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Row" << oldRow << "no longer valid, so returning to first ("
+         << start.row() << ")";
    }
 
    while (start.isValid() && active->type(start) == BtTreeItem::Type::FOLDER) {
-      qDebug() << Q_FUNC_INFO << "Skipping over folder at row" << start.row();
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Skipping over folder at row" << start.row();
       // Once all platforms are on Qt 5.11 or later, we can write:
       // start = start.siblingAtRow(start.row() + 1);
       start = start.sibling(start.row() + 1, start.column());
    }
 
    if (start.isValid()) {
-      qDebug() << Q_FUNC_INFO << "Row" << start.row() << "is" << active->type(start);
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Row" << start.row() << "is" << active->type(start);
       if (active->type(start) == BtTreeItem::Type::RECIPE) {
          this->setRecipe(treeView_recipe->getItem<Recipe>(start));
       }
@@ -1232,6 +1302,15 @@ void MainWindow::setAncestor()
 }
 
 
+void MainWindow::showSearchResult(Recipe * recipe) {
+   if (!recipe) {
+      return;
+   }
+   this->setRecipe(recipe);
+   this->setTreeSelection(treeView_recipe->findElement(recipe));
+   return;
+}
+
 // Can handle null recipes.
 void MainWindow::setRecipe(Recipe* recipe) {
    // Don't like void pointers.
@@ -1239,7 +1318,7 @@ void MainWindow::setRecipe(Recipe* recipe) {
       return;
    }
 
-   qDebug() << Q_FUNC_INFO << "Recipe #" << recipe->key() << ":" << recipe->name();
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Recipe #" << recipe->key() << ":" << recipe->name();
 
    int tabs = 0;
 
@@ -1688,13 +1767,13 @@ void MainWindow::droppedRecipeEquipment(Equipment *kit) {
 
 // This isn't called when we think it is...!
 void MainWindow::droppedRecipeStyle(Style* style) {
-   qDebug() << "MainWindow::droppedRecipeStyle";
+   qCDebug(Logging::ui) << "MainWindow::droppedRecipeStyle";
 
    if (!this->recipeObs) {
       return;
    }
    // When the style is changed, we also need to update what is shown on the Style button
-   qDebug() << "MainWindow::droppedRecipeStyle - do or redo";
+   qCDebug(Logging::ui) << "MainWindow::droppedRecipeStyle - do or redo";
    this->doOrRedoUpdate(
       newRelationalUndoableUpdate(*this->recipeObs,
                                   &Recipe::setStyle,
@@ -1822,7 +1901,7 @@ void MainWindow::updateRecipeBoilTime() {
 }
 
 void MainWindow::updateRecipeEfficiency() {
-   qDebug() << Q_FUNC_INFO << lineEdit_efficiency->getWidgetText();
+   qCDebug(Logging::ui) << Q_FUNC_INFO << lineEdit_efficiency->getWidgetText();
    if (!this->recipeObs) {
       return;
    }
@@ -1890,7 +1969,7 @@ void MainWindow::addYeastToRecipe(std::shared_ptr<Yeast> yeast) {
 }
 
 void MainWindow::addMashStepToMash(std::shared_ptr<MashStep> mashStep) {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::ui) << Q_FUNC_INFO;
    //
    // Mash Steps are a bit different from most other NamedEntity objects in that they don't really have an independent
    // existence.  If you ask a Mash to remove a MashStep then it will also tell the ObjectStore to delete it, but, when
@@ -1973,7 +2052,7 @@ void MainWindow::editUndo()
 {
    Q_ASSERT(this->undoStack != 0);
    if ( !this->undoStack->canUndo() ) {
-      qDebug() << "Undo called but nothing to undo";
+      qCDebug(Logging::ui) << "Undo called but nothing to undo";
    } else {
       this->undoStack->undo();
    }
@@ -1986,7 +2065,7 @@ void MainWindow::editRedo()
 {
    Q_ASSERT(this->undoStack != 0);
    if ( !this->undoStack->canRedo() ) {
-      qDebug() << "Redo called but nothing to redo";
+      qCDebug(Logging::ui) << "Redo called but nothing to redo";
    } else {
       this->undoStack->redo();
    }
@@ -2106,7 +2185,7 @@ void MainWindow::removeSelectedFermentable() {
    QModelIndexList selected = fermentableTable->selectionModel()->selectedIndexes();
    int size = selected.size();
 
-   qDebug() << QString("MainWindow::removeSelectedFermentable() %1 items selected to remove").arg(size);
+   qCDebug(Logging::ui) << QString("MainWindow::removeSelectedFermentable() %1 items selected to remove").arg(size);
 
    if (size == 0) {
       return;
@@ -2431,10 +2510,10 @@ void MainWindow::renameFolder() {
 }
 
 void MainWindow::setTreeSelection(QModelIndex item) {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::ui) << Q_FUNC_INFO;
 
    if (! item.isValid()) {
-      qDebug() << Q_FUNC_INFO << "Item not valid";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Item not valid";
       return;
    }
 
@@ -2445,7 +2524,7 @@ void MainWindow::setTreeSelection(QModelIndex item) {
 
    // Couldn't cast the active item to a BtTreeView
    if ( active == nullptr ) {
-      qDebug() << Q_FUNC_INFO << "Couldn't cast the active item to a BtTreeView";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Couldn't cast the active item to a BtTreeView";
       return;
    }
 
@@ -2590,7 +2669,7 @@ void MainWindow::backup() {
    // NB: QDir does all the necessary magic of translating '/' to whatever current platform's directory separator is
    QString defaultBackupFileName = QDir::currentPath() + "/" + Database::getDefaultBackupFileName();
    QString backupFileName = QFileDialog::getSaveFileName(this, tr("Backup Database"), defaultBackupFileName);
-   qDebug() << QString("Database backup filename \"%1\"").arg(backupFileName);
+   qCDebug(Logging::ui) << QString("Database backup filename \"%1\"").arg(backupFileName);
 
    // If the filename returned from the dialog is empty, it means the user clicked cancel, so we should stop trying to do the backup
    if (!backupFileName.isEmpty())
@@ -2616,7 +2695,12 @@ void MainWindow::restoreFromBackup()
       return;
    }
 
-   QString restoreDbFile = QFileDialog::getOpenFileName(this, tr("Choose File"), "", tr("SQLite (*.sqlite)"));
+   QString restoreDbFile = QFileDialog::getOpenFileName(
+      this,
+      tr("Choose File"),
+      "",
+      tr("SQLite (*.sqlite);;Compressed backups (*.qz);;All files (*)")
+   );
    bool success = Database::instance().restoreFromFile(restoreDbFile);
 
    if( ! success )
@@ -2975,7 +3059,7 @@ void MainWindow::exportSelected() {
    bool succeeded = false;
    QModelIndexList selected = active->selectionModel()->selectedRows();
    if (selected.count() == 0) {
-      qDebug() << Q_FUNC_INFO << "Nothing selected, so nothing to export";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Nothing selected, so nothing to export";
       userMessage = "Nothing selected";
       this->pimpl->importExportMsg(impl::EXPORT, filename, succeeded, userMessage);
       return;
@@ -3038,10 +3122,12 @@ void MainWindow::exportSelected() {
                ++count;
                break;
             case BtTreeItem::Type::FOLDER:
-               qDebug() << Q_FUNC_INFO << "Can't export selected Folder to XML as BeerXML does not support it";
+               qCDebug(Logging::ui) << Q_FUNC_INFO
+                  << "Can't export selected Folder to XML as BeerXML does not support it";
                break;
             case BtTreeItem::Type::BREWNOTE:
-               qDebug() << Q_FUNC_INFO << "Can't export selected BrewNote to XML as BeerXML does not support it";
+               qCDebug(Logging::ui) << Q_FUNC_INFO
+                  << "Can't export selected BrewNote to XML as BeerXML does not support it";
                break;
             default:
                // This shouldn't happen, because we should explicitly cover all the types above
@@ -3052,7 +3138,7 @@ void MainWindow::exportSelected() {
    }
 
    if (0 == count) {
-      qDebug() << Q_FUNC_INFO << "Nothing selected was exportable to XML";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Nothing selected was exportable to XML";
       userMessage = "Nothing exportable selected";
       this->pimpl->importExportMsg(impl::EXPORT, filename, succeeded, userMessage);
       return;
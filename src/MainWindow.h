@@ -56,6 +56,7 @@ class BrewDayScrollWidget;
 class BrewNoteWidget;
 class BtDatePopup;
 class ConverterTool;
+class DiagnosticsDialog;
 class EquipmentEditor;
 class EquipmentListModel;
 class FermentableDialog;
@@ -89,6 +90,7 @@ class RecipeExtrasWidget;
 class RecipeFormatter;
 class RefractoDialog;
 class ScaleRecipeTool;
+class SearchDialog;
 class StrikeWaterDialog;
 class StyleEditor;
 class StyleListModel;
@@ -298,6 +300,8 @@ public slots:
    void lockRecipe(int state);
    //! \brief prepopulate the ancestorDialog when the menu is selected
    void setAncestor();
+   //! \brief View (and select in the tree) a recipe chosen from the search results
+   void showSearchResult(Recipe * recipe);
 
 public:
    //! \brief Doing updates via this method makes them undoable (and redoable).  This is the simplified version
@@ -392,6 +396,8 @@ private:
    WaterEditor* waterEditor;
 
    AncestorDialog* ancestorDialog;
+   SearchDialog* searchDialog;
+   DiagnosticsDialog* diagnosticsDialog;
 
    // all things tables should go here.
    FermentableTableModel* fermTableModel;
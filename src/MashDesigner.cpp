@@ -27,6 +27,7 @@
 
 #include "database/ObjectStoreWrapper.h"
 #include "HeatCalculations.h"
+#include "Logging.h"
 #include "measurement/Measurement.h"
 #include "model/Fermentable.h"
 #include "PhysicalConstants.h"
@@ -309,7 +310,7 @@ double MashDesigner::grainVolume_l() {
 
 // After this, mash and equip are non-null iff we return true.
 bool MashDesigner::initializeMash() {
-   qDebug() << Q_FUNC_INFO << "Observing" << this->recObs;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Observing" << this->recObs;
    if (this->recObs == nullptr) {
       return false;
    }
@@ -341,10 +342,10 @@ bool MashDesigner::initializeMash() {
 
    this->mash = this->recObs->getMash();
    if (this->mash == nullptr) {
-      qDebug() << Q_FUNC_INFO << "Create new Mash";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Create new Mash";
       this->mash = std::make_shared<Mash>("");
    } else {
-      qDebug() << Q_FUNC_INFO << "Clear all steps of existing Mash";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Clear all steps of existing Mash";
       this->mash->removeAllMashSteps();
    }
 
@@ -372,7 +373,7 @@ bool MashDesigner::initializeMash() {
    this->horizontalSlider_amount->setValue(0); // As thick as possible initially.
 
    if (this->mash->key() < 0) {
-      qDebug() << Q_FUNC_INFO << "Add new Mash to Recipe";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Add new Mash to Recipe";
       ObjectStoreWrapper::insert(*mash);
       this->recObs->setMash(mash);
    }
@@ -430,7 +431,7 @@ double MashDesigner::waterFromMash_l() {
       absorption_lKg = PhysicalConstants::grainAbsorption_Lkg;
    }
 
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "waterAdded_l=" << waterAdded_l << ", absorption_lKg=" << absorption_lKg << "grainsInMash_kg=" <<
       this->recObs->grainsInMash_kg();
 
@@ -438,7 +439,7 @@ double MashDesigner::waterFromMash_l() {
 }
 
 void MashDesigner::updateCollectedWort() {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::ui) << Q_FUNC_INFO;
    if (recObs == nullptr) {
       return;
    }
@@ -448,7 +449,7 @@ void MashDesigner::updateCollectedWort() {
    double targetCollectedWort_l = this->recObs->targetCollectedWortVol_l();
 
    double ratio = wort_l / targetCollectedWort_l;
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "waterFromMash=" << wort_l << "Liters, targetCollectedWort=" << targetCollectedWort_l << "Litres, "
       "Unadjusted ratio=" << ratio;
    if (ratio < 0) {
@@ -25,6 +25,7 @@
 #include <QWidget>
 
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "measurement/Unit.h"
 #include "model/Equipment.h"
 #include "model/Mash.h"
@@ -57,7 +58,8 @@ void MashEditor::saveAndClose() {
       this->mashObs = new Mash(lineEdit_name->text());
       isNew = true;
    }
-   qDebug() << Q_FUNC_INFO << "Saving" << (isNew ? "new" : "existing") << "mash (#" << this->mashObs->key() << ")";
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Saving" << (isNew ? "new" : "existing") << "mash (#" << this->mashObs->key()
+      << ")";
 
    mashObs->setEquipAdjust(true); // BeerXML won't like me, but it's just stupid not to adjust for the equipment when you're able.
 
@@ -117,13 +119,13 @@ void MashEditor::setRecipe(Recipe* r) {
    if (this->mashObs && this->m_equip) {
       // Only do this if we have to. Otherwise, it causes some unnecessary updates to the database.
       if (this->mashObs->tunWeight_kg() != this->m_equip->tunWeight_kg()) {
-         qDebug() <<
+         qCDebug(Logging::ui) <<
             Q_FUNC_INFO << "Overwriting mash tunWeight_kg (" << this->mashObs->tunWeight_kg() << ") with equipment "
             "tunWeight_kg (" << this->m_equip->tunWeight_kg() << ")";
          this->mashObs->setTunWeight_kg(this->m_equip->tunWeight_kg());
       }
       if (this->mashObs->tunSpecificHeat_calGC() != this->m_equip->tunSpecificHeat_calGC() ) {
-         qDebug() <<
+         qCDebug(Logging::ui) <<
             Q_FUNC_INFO << "Overwriting mash tunSpecificHeat_calGC (" << this->mashObs->tunSpecificHeat_calGC() << ") "
             "with equipment tunSpecificHeat_calGC (" << this->m_equip->tunSpecificHeat_calGC() << ")";
          this->mashObs->setTunSpecificHeat_calGC(this->m_equip->tunSpecificHeat_calGC());
@@ -159,7 +161,7 @@ void MashEditor::showChanges(QMetaProperty* prop) {
    } else {
       propName = prop->name();
    }
-   qDebug() << Q_FUNC_INFO << "Updating" << (updateAll ? "all" : "property") << propName;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Updating" << (updateAll ? "all" : "property") << propName;
 
    if( propName == PropertyNames::NamedEntity::name || updateAll ) {
       lineEdit_name->setText(mashObs->name());
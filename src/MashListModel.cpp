@@ -24,6 +24,7 @@
 #include <QWidget>
 
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "model/Mash.h"
 #include "model/Recipe.h"
 #include "model/Style.h"
@@ -38,7 +39,7 @@ MashListModel::MashListModel(QWidget* parent) :
 }
 
 void MashListModel::addMash(int mashId) {
-   qDebug() << Q_FUNC_INFO << "New mash #" << mashId;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "New mash #" << mashId;
    Mash* m = ObjectStoreWrapper::getByIdRaw<Mash>(mashId);
    if (!m || !m->display() || m->deleted()) {
       return;
@@ -28,6 +28,7 @@
 #include "BtHorizontalTabs.h"
 #include "config.h"
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "measurement/Unit.h"
 #include "model/Misc.h"
 
@@ -63,8 +64,8 @@ void MiscEditor::save() {
       return;
    }
 
-   qDebug() << Q_FUNC_INFO << comboBox_type->currentIndex();
-   qDebug() << Q_FUNC_INFO << comboBox_use->currentIndex();
+   qCDebug(Logging::ui) << Q_FUNC_INFO << comboBox_type->currentIndex();
+   qCDebug(Logging::ui) << Q_FUNC_INFO << comboBox_use->currentIndex();
 
    this->obsMisc->setName(lineEdit_name->text());
    this->obsMisc->setType(static_cast<Misc::Type>(comboBox_type->currentIndex()));
@@ -75,7 +76,7 @@ void MiscEditor::save() {
    this->obsMisc->setNotes(textEdit_notes->toPlainText());
 
    if (this->obsMisc->key() < 0) {
-      qDebug() << Q_FUNC_INFO << "Inserting into database";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Inserting into database";
       ObjectStoreWrapper::insert(*this->obsMisc);
    }
    // do this late to make sure we've the row in the inventory table
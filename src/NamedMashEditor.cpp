@@ -24,6 +24,7 @@
 #include <QWidget>
 
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "measurement/Unit.h"
 #include "model/Equipment.h"
 #include "model/Mash.h"
@@ -93,7 +94,7 @@ void NamedMashEditor::saveAndClose() {
       return;
    }
 
-   qDebug() << Q_FUNC_INFO << "Saving mash (#" << this->mashObs->key() << ")";
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Saving mash (#" << this->mashObs->key() << ")";
 
    // using toSI aon the spargePh is something of a cheat, but the btLineEdit
    // class will do the right thing. That is how a plan comes together.
@@ -146,7 +147,7 @@ void NamedMashEditor::showChanges(QMetaProperty* prop) {
    } else {
       propName = prop->name();
    }
-   qDebug() << Q_FUNC_INFO << "Updating" << (updateAll ? "all" : "property") << propName;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Updating" << (updateAll ? "all" : "property") << propName;
 
    if( propName == PropertyNames::NamedEntity::name || updateAll ) {
       lineEdit_name->setText(mashObs->name());
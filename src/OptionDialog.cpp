@@ -25,11 +25,13 @@
 
 #include <QAbstractButton>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QDebug>
 #include <QFileDialog>
 #include <QIcon>
 #include <QMap>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QSizePolicy>
 #include <QString>
 #include <QVector>
@@ -85,7 +87,7 @@ namespace {
       auto unitSystems = Measurement::UnitSystem::getUnitSystems(physicalQuantity);
       for (auto unitSystem : unitSystems) {
          if (selection == unitSystem->uniqueName) {
-            qDebug() <<
+            qCDebug(Logging::ui) <<
                Q_FUNC_INFO << "Setting UnitSystem for" << Measurement::getDisplayName(physicalQuantity) << "to" <<
                unitSystem->uniqueName;
             Measurement::setDisplayUnitSystem(physicalQuantity, *unitSystem);
@@ -133,6 +135,7 @@ public:
       spinBox_numBackups         {optionDialog.groupBox_dbConfig},
       label_frequency            {optionDialog.groupBox_dbConfig},
       spinBox_frequency          {optionDialog.groupBox_dbConfig},
+      checkBox_compressBackups   {optionDialog.groupBox_dbConfig},
       languageInfo {
       {"ca", QIcon(":images/flagCatalonia.svg"),   "Catalan",          tr("Catalan")          },
       {"cs", QIcon(":images/flagCzech.svg"),       "Czech",            tr("Czech")            },
@@ -157,7 +160,8 @@ public:
       {"sv", QIcon(":images/flagSweden.svg"),      "Swedish",          tr("Swedish")          },
       {"tr", QIcon(),                              "Turkish",          tr("Turkish")          },
       {"zh", QIcon(":images/flagChina.svg"),       "Chinese",          tr("Chinese")          }
-   } {
+   },
+   loggingCategoryComboBoxes{} {
       //
       // Optimise the select file dialog to select directories
       //
@@ -202,6 +206,7 @@ public:
       this->spinBox_frequency.setObjectName(QStringLiteral("spinBox_frequency"));
       this->spinBox_frequency.setMinimum(1); // Couldn't make any semantic difference between 0 and 1. So start at 1
       this->spinBox_frequency.setMaximum(10);
+      this->checkBox_compressBackups.setObjectName(QStringLiteral("checkBox_compressBackups"));
       this->sqliteVisible(false);
 
       return;
@@ -250,6 +255,7 @@ public:
       this->spinBox_numBackups.setVisible(canSee);
       this->label_frequency.setVisible(canSee);
       this->spinBox_frequency.setVisible(canSee);
+      this->checkBox_compressBackups.setVisible(canSee);
       return;
    }
 
@@ -269,7 +275,8 @@ public:
     * Determine which set of DB config params to show, based on whether PostgresSQL or SQLite is selected
     */
    void setDbDialog(OptionDialog & optionDialog, Database::DbType db) {
-      qDebug() << Q_FUNC_INFO << "Set " << (db == Database::PGSQL ? "PostgresSQL" : "SQLite") << " config params visible";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Set " << (db == Database::PGSQL ? "PostgresSQL" : "SQLite")
+         << " config params visible";
       optionDialog.groupBox_dbConfig->setVisible(false);
 
       this->clearLayout(optionDialog);
@@ -314,6 +321,8 @@ public:
 
          optionDialog.gridLayout->addWidget(&this->label_frequency, 4, 0);
          optionDialog.gridLayout->addWidget(&this->spinBox_frequency, 4, 1);
+
+         optionDialog.gridLayout->addWidget(&this->checkBox_compressBackups, 5, 0, 1, 2);
       }
       optionDialog.groupBox_dbConfig->setVisible(true);
       return;
@@ -337,6 +346,7 @@ public:
       this->pushButton_browseBackupDir.setText(QApplication::translate("optionsDialog", "Browse", nullptr));
       this->label_numBackups.setText(QApplication::translate("optionsDialog", "Number of Backups", nullptr));
       this->label_frequency.setText(QApplication::translate("optionsDialog", "Frequency of Backups", nullptr));
+      this->checkBox_compressBackups.setText(QApplication::translate("optionsDialog", "Compress backups", nullptr));
 
       // set up the tooltips if we are using them
 #ifndef QT_NO_TOOLTIP
@@ -354,7 +364,7 @@ public:
       this->label_backupDir.setToolTip(QApplication::translate("optionsDialog", "Where to save your backups", nullptr));
       this->label_numBackups.setToolTip(QApplication::translate("optionsDialog",
                                                                 "Number of backups to keep: -1 means never remove, 0 means never backup", nullptr));
-      // Actually the backups happen after every X times the program is closed, but the tooltip is already long enough!
+      // Actually the backups happen after every X times the program is started, but the tooltip is already long enough!
       this->label_frequency.setToolTip(QApplication::translate("optionsDialog",
                                                                "How many times Brewtarget needs to be run to trigger another backup: 1 means always backup", nullptr));
 #endif
@@ -468,6 +478,10 @@ public:
       this->spinBox_frequency.setValue(PersistentSettings::value(PersistentSettings::Names::frequency,
                                                                  4,
                                                                  PersistentSettings::Sections::backups).toInt());
+      bool const compressBackups = PersistentSettings::value(PersistentSettings::Names::compress,
+                                                             false,
+                                                             PersistentSettings::Sections::backups).toBool();
+      this->checkBox_compressBackups.setChecked(compressBackups);
 
       // The IBU modifications. These will all be calculated from a 60 min boil. This is gonna get confusing.
       double amt = Localization::toDouble(
@@ -552,11 +566,14 @@ public:
    QSpinBox    spinBox_numBackups;
    QLabel      label_frequency;
    QSpinBox    spinBox_frequency;
+   QCheckBox   checkBox_compressBackups;
 
    DbConnectionTestStates dbConnectionTestState;
 
    QVector<LanguageInfo> languageInfo;
 
+   // One per entry in Logging::categoryDetails, in the same order.  Owned by their parent widget.
+   QVector<QComboBox *> loggingCategoryComboBoxes;
 };
 
 OptionDialog::OptionDialog(QWidget * parent) : QDialog{},
@@ -650,6 +667,17 @@ void OptionDialog::configure_logging() {
       loggingLevelComboBox->addItem(ii.description, QVariant(ii.level));
    }
    loggingLevelComboBox->setCurrentIndex(Logging::getLogLevel());
+   for (auto const & categoryDetail : Logging::categoryDetails) {
+      QComboBox * comboBox = new QComboBox(groupBox_loggingCategories);
+      comboBox->addItem(tr("Same as overall level"), QVariant(-1));
+      for (auto ii : Logging::levelDetails) {
+         comboBox->addItem(ii.description, QVariant(ii.level));
+      }
+      std::optional<Logging::Level> const categoryLevel = Logging::getCategoryLogLevel(categoryDetail.name);
+      comboBox->setCurrentIndex(comboBox->findData(categoryLevel ? QVariant(*categoryLevel) : QVariant(-1)));
+      formLayout_loggingCategories->addRow(categoryDetail.description, comboBox);
+      this->pimpl->loggingCategoryComboBoxes.append(comboBox);
+   }
    checkBox_LogFileLocationUseDefault->setChecked(Logging::getLogInConfigDir());
    lineEdit_LogFileLocation->setText(Logging::getDirectory().absolutePath());
    this->setFileLocationState(Logging::getLogInConfigDir());
@@ -751,6 +779,7 @@ void OptionDialog::resetToDefault() {
       this->pimpl->input_backupDir.setText(PersistentSettings::getConfigDir().canonicalPath());
       this->pimpl->spinBox_frequency.setValue(4);
       this->pimpl->spinBox_numBackups.setValue(10);
+      this->pimpl->checkBox_compressBackups.setChecked(false);
    }
 }
 
@@ -895,6 +924,20 @@ void OptionDialog::saveFormulae() {
 void OptionDialog::saveLoggingSettings() {
    // Saving Logging Options to the Log object
    Logging::setLogLevel(static_cast<Logging::Level>(loggingLevelComboBox->currentData().toInt()));
+   for (int ii = 0; ii < Logging::categoryDetails.size(); ++ii) {
+      // -1 means the category just uses the overall logging level
+      int const categoryLevel = this->pimpl->loggingCategoryComboBoxes.at(ii)->currentData().toInt();
+      std::optional<Logging::Level> const newLevel{
+         categoryLevel < 0 ? std::nullopt : std::optional<Logging::Level>{static_cast<Logging::Level>(categoryLevel)}
+      };
+      //
+      // Only save the levels the user has changed.  Otherwise we'd also save any level that was only set for this run
+      // (eg with --log-categories on the command line).
+      //
+      if (newLevel != Logging::getCategoryLogLevel(Logging::categoryDetails.at(ii).name)) {
+         Logging::setCategoryLogLevel(Logging::categoryDetails.at(ii).name, newLevel);
+      }
+   }
    Logging::setDirectory(
       checkBox_LogFileLocationUseDefault->isChecked() ?
       std::optional<QDir>(std::nullopt) : std::optional<QDir>(lineEdit_LogFileLocation->text())
@@ -963,12 +1006,24 @@ bool OptionDialog::transferDatabase() {
       QString theQuestion =
          tr("Would you like Brewtarget to transfer your data to the new database? NOTE: If you've already loaded the data, say No");
       if (QMessageBox::Yes == QMessageBox::question(this, tr("Transfer database"), theQuestion)) {
+         // The copy can't be cancelled part way through, so no cancel button
+         QProgressDialog progressDialog{tr("Transferring data..."), QString{}, 0, 0, this};
+         progressDialog.setWindowModality(Qt::WindowModal);
+         progressDialog.setMinimumDuration(500);
          Database::instance().convertDatabase(this->pimpl->input_pgHostname.text(),
                                               this->pimpl->input_pgDbName.text(),
                                               this->pimpl->input_pgUsername.text(),
                                               this->pimpl->input_pgPassword.text(),
                                               this->pimpl->input_pgPortNum.text().toInt(),
-                                              static_cast<Database::DbType>(this->comboBox_engine->currentData().toInt()));
+                                              static_cast<Database::DbType>(this->comboBox_engine->currentData().toInt()),
+                                              [&progressDialog](QString const & tableName,
+                                                                qint64 numRowsCopied,
+                                                                qint64 numRows) {
+                                                 progressDialog.setLabelText(tr("Transferring %1...").arg(tableName));
+                                                 progressDialog.setMaximum(static_cast<int>(numRows));
+                                                 progressDialog.setValue(static_cast<int>(numRowsCopied));
+                                              });
+         progressDialog.close();
       }
       // Database engine stuff
       int engine = comboBox_engine->currentData().toInt();
@@ -1018,6 +1073,7 @@ void OptionDialog::saveSqliteConfig() {
    PersistentSettings::insert(PersistentSettings::Names::maximum,   this->pimpl->spinBox_numBackups.value(), PersistentSettings::Sections::backups);
    PersistentSettings::insert(PersistentSettings::Names::frequency, this->pimpl->spinBox_frequency.value(),  PersistentSettings::Sections::backups);
    PersistentSettings::insert(PersistentSettings::Names::directory, this->pimpl->input_backupDir.text(),     PersistentSettings::Sections::backups);
+   PersistentSettings::insert(PersistentSettings::Names::compress,  this->pimpl->checkBox_compressBackups.isChecked(), PersistentSettings::Sections::backups);
 
    return;
 }
@@ -45,6 +45,7 @@
 #define AddSettingName(name) namespace PersistentSettings::Names { BtStringConst const name{#name}; }
 AddSettingName(check_version)
 AddSettingName(color_formula)
+AddSettingName(compress)                         // backups section
 AddSettingName(config_version)
 AddSettingName(converted)
 AddSettingName(count)                            // backups section
@@ -56,7 +57,9 @@ AddSettingName(dbPortnum)
 AddSettingName(dbSchema)
 AddSettingName(dbType)
 AddSettingName(dbUsername)
+AddSettingName(dbWorkerConnections)
 AddSettingName(defaultEquipmentKey)
+AddSettingName(deferStartupWork)
 AddSettingName(deletewhat)
 AddSettingName(directory)                        // backups section
 AddSettingName(files)                            // backups section
@@ -65,8 +68,10 @@ AddSettingName(frequency)                        // backups section
 AddSettingName(geometry)
 AddSettingName(ibu_formula)
 AddSettingName(language)
+AddSettingName(lastCompaction)
 AddSettingName(last_db_merge_req)
 AddSettingName(LogDirectory)
+AddSettingName(LoggingCategoryLevels)
 AddSettingName(LoggingLevel)
 AddSettingName(mashHopAdjustment)
 AddSettingName(mashStepTableWidget_headerState)  // MainWindow section
@@ -76,6 +81,8 @@ AddSettingName(recipeKey)
 AddSettingName(showsnapshots)
 AddSettingName(splitter_horizontal_State)        // MainWindow section
 AddSettingName(splitter_vertical_State)          // MainWindow section
+AddSettingName(sqliteJournalMode)
+AddSettingName(sqliteSharedCache)
 AddSettingName(treeView_equip_headerState)       // MainWindow section
 AddSettingName(treeView_ferm_headerState)        // MainWindow section
 AddSettingName(treeView_hops_headerState)        // MainWindow section
@@ -28,8 +28,31 @@
 #include <QSizePolicy>
 #include <QStandardPaths>
 #include <QTextBrowser>
+#include <QThread>
 
 #include "InventoryFormatter.h"
+#include "Logging.h"
+
+namespace {
+   /**
+    * \brief Generates the inventory HTML from a snapshot, so that a big inventory doesn't hold up the UI
+    */
+   class InventoryHtmlThread : public QThread {
+      // No signals or slots, so no need for Q_OBJECT
+   public:
+      InventoryHtmlThread(InventoryFormatter::Snapshot const & snapshot) : snapshot{snapshot}, html{} {
+         return;
+      }
+
+      void run() override {
+         this->html = InventoryFormatter::createInventoryHtml(this->snapshot);
+         return;
+      }
+
+      InventoryFormatter::Snapshot const snapshot;
+      QString html;
+   };
+}
 
 /**
  * @brief Construct a new Print And Preview Dialog:: Print And Preview Dialog object
@@ -151,7 +174,7 @@ void PrintAndPreviewDialog::collectSupportedPageSizes()
    }
    else if (radioButton_OutputPDF->isChecked())
    {
-      qDebug() << "generating a list of page sizes as there is no printer intalled on the system";
+      qCDebug(Logging::ui) << "generating a list of page sizes as there is no printer intalled on the system";
       supportedPageSizeList = generatePageSizeList();
    }
    foreach(QPageSize pageSize, supportedPageSizeList)
@@ -313,7 +336,7 @@ void PrintAndPreviewDialog::handlePrinting() {
          QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
          fileDialogFilter
          );
-      qDebug() << Q_FUNC_INFO << "Filename to save: " << filename;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Filename to save: " << filename;
       if (radioButton_OutputPDF->isChecked())
       {
          printer->setOutputFormat(QPrinter::PdfFormat);
@@ -355,6 +378,8 @@ void PrintAndPreviewDialog::updatePreview() {
       if (verticalTabWidget->currentIndex() == 0) {
          bool chkRec = checkBox_Recipe->isChecked();
          bool chkBDI = checkBox_BrewdayInstructions->isChecked();
+         // Unlike the inventory below, the recipe HTML is still generated from the live objects, so it has to be
+         // done here on the GUI thread.  See comment in RecipeFormatter.h.
          if (chkRec) {
             pDoc = recipeFormatter->getHtmlFormat();
          }
@@ -368,10 +393,27 @@ void PrintAndPreviewDialog::updatePreview() {
             checkBox_inventoryYeast->isChecked()        * InventoryFormatter::YEAST          +
             checkBox_inventoryMicellaneous->isChecked() * InventoryFormatter::MISCELLANEOUS
          );
-         pDoc = InventoryFormatter::createInventoryHtml(flags);
+         //
+         // We take the snapshot here on the GUI thread, then generate the HTML from it on a worker thread.  If the
+         // options change again before the worker finishes, we'll have started another one, and we ignore the result
+         // of this one.
+         //
+         auto * thread = new InventoryHtmlThread{InventoryFormatter::takeSnapshot(flags)};
+         quint64 const request = ++this->inventoryPreviewRequest;
+         connect(thread, &QThread::finished, this, [this, thread, request]() {
+            if (request == this->inventoryPreviewRequest) {
+               htmlDocument->setHtml(thread->html);
+            }
+         });
+         connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+         thread->start();
+      }
+      // adding the generated HTML to the QTexBrowser.  (For the inventory, this is done when the thread finishes.)
+      if (verticalTabWidget->currentIndex() != 1) {
+         // Any inventory HTML still being generated is now out of date
+         ++this->inventoryPreviewRequest;
+         htmlDocument->setHtml(pDoc);
       }
-      // adding the generated HTML to the QTexBrowser.
-      htmlDocument->setHtml(pDoc);
    }
 
    // choose what displaywidget that should be showing depending on users choice.
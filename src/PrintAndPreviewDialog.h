@@ -137,6 +137,8 @@ private:
    QMap<QString, QPageSize> PageSizeMap;
    QTextBrowser *htmlDocument;
    QPageSize currentlySelectedPageSize;
+   //! Incremented each time we start generating the inventory HTML preview, so we only show the latest one
+   quint64 inventoryPreviewRequest = 0;
 
 };
 #endif
@@ -31,6 +31,8 @@
 #include <QDebug>
 #include <QHash>
 
+#include "Logging.h"
+
 // Internal constants
 namespace {
    struct ColorAndObject{
@@ -171,7 +173,7 @@ void RadarChart::init(QString const unitsName,
 
    this->pimpl->angleInRadiansBetweenAxes = RadiansInACircle / variableNames.size();
 
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "axisMarkInterval:" << this->pimpl->axisMarkInterval << "; maxAxisValue:" <<
       this->pimpl->maxAxisValue;
    return;
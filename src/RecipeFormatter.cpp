@@ -21,6 +21,7 @@
 #include "RecipeFormatter.h"
 
 #include <QClipboard>
+#include <QCoreApplication>
 #include <QDebug>
 #include <QHBoxLayout>
 #include <QObject>
@@ -29,6 +30,7 @@
 #include <QPushButton>
 #include <QStringList>
 #include <QTextDocument>
+#include <QThread>
 #include <QVBoxLayout>
 
 #include "Html.h"
@@ -50,6 +52,7 @@
 #include "model/Water.h"
 #include "model/Yeast.h"
 #include "PersistentSettings.h"
+#include "utils/Tracing.h"
 
 namespace {
    //! Get the maximum number of characters in a list of strings.
@@ -1180,6 +1183,9 @@ void RecipeFormatter::setRecipe(Recipe* recipe) {
 
 
 QString RecipeFormatter::getHtmlFormat(QList<Recipe*> recipes) {
+   TRACE_SPAN("ui", "RecipeFormatter::getHtmlFormat");
+   // It's a coding error to call this from anywhere other than the main thread, as it reads live objects
+   Q_ASSERT(QThread::currentThread() == QCoreApplication::instance()->thread());
    Recipe *current = this->pimpl->rec;
 
    QString hDoc = this->pimpl->buildHtmlHeader();
@@ -1212,6 +1218,9 @@ QString RecipeFormatter::getHtmlFormat(QList<Recipe*> recipes) {
 }
 
 QString RecipeFormatter::getHtmlFormat() {
+   TRACE_SPAN("ui", "RecipeFormatter::getHtmlFormat");
+   // See comment in getHtmlFormat(QList<Recipe*>)
+   Q_ASSERT(QThread::currentThread() == QCoreApplication::instance()->thread());
    QString pDoc = this->pimpl->buildHtmlHeader();
    pDoc += this->pimpl->buildStatTableHtml();
    pDoc += this->pimpl->buildFermentableTableHtml();
@@ -52,11 +52,20 @@ public:
    //! Set the recipe to view.
    void setRecipe(Recipe* recipe);
 
+   /**
+    * \brief HTML view of the recipe set by \c setRecipe().
+    *
+    *        NB: Unlike the inventory printout (see \c InventoryFormatter::Snapshot), this still reads the live recipe
+    *        and its ingredients rather than an \c ObjectStoreSnapshot, so it MUST be called on the main thread, and it
+    *        runs synchronously there (which at least means no edit or recalculation can happen part way through).
+    *        Moving it over to snapshots, so it can run on a worker thread, is a separate job, as it also needs the
+    *        recipe's per-field display settings and its ingredient lists capturing.
+    */
    QString getHtmlFormat();
    QString buildHtmlHeader();
    QString buildHtmlFooter();
 
-   //! Get a whole mess of html views
+   //! Get a whole mess of html views.  Same restrictions as \c getHtmlFormat().
    QString getHtmlFormat(QList<Recipe*> recipes);
 
    //! Get a BBCode view. Why is this here?
@@ -26,6 +26,7 @@
 #include <QString>
 
 #include "Algorithms.h"
+#include "Logging.h"
 #include "measurement/Measurement.h"
 
 RefractoDialog::RefractoDialog(QWidget* parent) : QDialog(parent) {
@@ -68,7 +69,7 @@ void RefractoDialog::calculate() {
       originalPlato = Algorithms::SG_20C20C_toPlato( inputOG );
       lineEdit_op->setText(inputOG);
    } else if (!haveOP && !haveOG) {
-      qDebug() << Q_FUNC_INFO << "no plato or og";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "no plato or og";
       return; // Can't do much if we don't have OG or OP.
    }
 
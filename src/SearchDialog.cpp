@@ -0,0 +1,175 @@
+/*
+ * SearchDialog.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SearchDialog.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QTableWidgetItem>
+#include <QVBoxLayout>
+
+#include "database/Database.h"
+#include "database/FullTextSearch.h"
+#include "database/ObjectStoreWrapper.h"
+#include "model/BrewNote.h"
+#include "model/Instruction.h"
+#include "model/Recipe.h"
+
+namespace {
+   // More results than this aren't useful to a human reader -- they should refine the search instead
+   int constexpr MAX_RESULTS = 200;
+
+   enum {
+      RECIPE_COL,
+      FOUND_IN_COL,
+      SNIPPET_COL,
+      NUM_COLS /*This one MUST be last*/
+   };
+}
+
+SearchDialog::SearchDialog(QWidget * parent) :
+   QDialog{parent},
+   lineEdit_query{nullptr},
+   pushButton_search{nullptr},
+   tableWidget_results{nullptr},
+   label_status{nullptr} {
+   this->setObjectName("searchDialog");
+   this->doLayout();
+
+   // NB: cellActivated covers both double-click and pressing Enter on a result
+   connect(this->lineEdit_query,      &QLineEdit::returnPressed,    this, &SearchDialog::doSearch);
+   connect(this->pushButton_search,   &QAbstractButton::clicked,    this, &SearchDialog::doSearch);
+   connect(this->tableWidget_results, &QTableWidget::cellActivated, this, &SearchDialog::resultActivated);
+   return;
+}
+
+SearchDialog::~SearchDialog() = default;
+
+void SearchDialog::changeEvent(QEvent * event) {
+   if (event->type() == QEvent::LanguageChange) {
+      this->retranslateUi();
+   }
+   QDialog::changeEvent(event);
+   return;
+}
+
+void SearchDialog::doLayout() {
+   QVBoxLayout * verticalLayout = new QVBoxLayout(this);
+      QHBoxLayout * horizontalLayout = new QHBoxLayout;
+         this->lineEdit_query = new QLineEdit(this);
+         this->pushButton_search = new QPushButton(this);
+         this->pushButton_search->setAutoDefault(false);
+         horizontalLayout->addWidget(this->lineEdit_query);
+         horizontalLayout->addWidget(this->pushButton_search);
+      this->tableWidget_results = new QTableWidget(0, NUM_COLS, this);
+         this->tableWidget_results->setEditTriggers(QAbstractItemView::NoEditTriggers);
+         this->tableWidget_results->setSelectionBehavior(QAbstractItemView::SelectRows);
+         this->tableWidget_results->setSelectionMode(QAbstractItemView::SingleSelection);
+         this->tableWidget_results->verticalHeader()->setVisible(false);
+         this->tableWidget_results->horizontalHeader()->setStretchLastSection(true);
+         this->tableWidget_results->setWordWrap(false);
+      this->label_status = new QLabel(this);
+      verticalLayout->addLayout(horizontalLayout);
+      verticalLayout->addWidget(this->tableWidget_results);
+      verticalLayout->addWidget(this->label_status);
+   this->resize(800, 400);
+   this->retranslateUi();
+   return;
+}
+
+void SearchDialog::retranslateUi() {
+   this->setWindowTitle(tr("Search Notes"));
+   this->lineEdit_query->setPlaceholderText(tr("Search recipe notes, tasting notes, brew notes and instructions"));
+   this->pushButton_search->setText(tr("Search"));
+   this->tableWidget_results->setHorizontalHeaderLabels({tr("Recipe"), tr("Found in"), tr("Text")});
+   return;
+}
+
+void SearchDialog::doSearch() {
+   QString const queryText = this->lineEdit_query->text().trimmed();
+   this->tableWidget_results->setRowCount(0);
+   if (queryText.isEmpty()) {
+      this->label_status->clear();
+      return;
+   }
+
+   QElapsedTimer timer;
+   timer.start();
+   QVector<FullTextSearch::Match> const matches = FullTextSearch::search(Database::instance(), queryText, MAX_RESULTS);
+
+   //
+   // Each match tells us where the text was found.  We need to turn that into the Recipe that the user will want to
+   // look at, and skip anything that has been (soft) deleted since it was indexed.
+   //
+   for (auto const & match : matches) {
+      Recipe * recipe = nullptr;
+      QString foundIn;
+      if (match.tableName == "recipe") {
+         recipe = ObjectStoreWrapper::getByIdRaw<Recipe>(match.objectId);
+         foundIn = match.columnName == "taste_notes" ? tr("Tasting notes") : tr("Notes");
+      } else if (match.tableName == "brewnote") {
+         BrewNote * brewNote = ObjectStoreWrapper::getByIdRaw<BrewNote>(match.objectId);
+         if (!brewNote || brewNote->deleted()) {
+            continue;
+         }
+         recipe = brewNote->getOwningRecipe();
+         foundIn = tr("Brew note %1").arg(brewNote->brewDate_short());
+      } else if (match.tableName == "instruction") {
+         Instruction * instruction = ObjectStoreWrapper::getByIdRaw<Instruction>(match.objectId);
+         if (!instruction || instruction->deleted()) {
+            continue;
+         }
+         recipe = instruction->getOwningRecipe();
+         foundIn = tr("Instruction: %1").arg(instruction->name());
+      }
+
+      if (!recipe || recipe->deleted()) {
+         continue;
+      }
+
+      int const row = this->tableWidget_results->rowCount();
+      this->tableWidget_results->insertRow(row);
+      QTableWidgetItem * recipeItem = new QTableWidgetItem(recipe->name());
+      recipeItem->setData(Qt::UserRole, recipe->key());
+      this->tableWidget_results->setItem(row, RECIPE_COL, recipeItem);
+      this->tableWidget_results->setItem(row, FOUND_IN_COL, new QTableWidgetItem(foundIn));
+      // Snippets can span several lines of the original text, but we want one line per result
+      this->tableWidget_results->setItem(row, SNIPPET_COL, new QTableWidgetItem(match.snippet.simplified()));
+   }
+   this->tableWidget_results->resizeColumnsToContents();
+
+   this->label_status->setText(
+      tr("%n result(s) in %1 ms", "", this->tableWidget_results->rowCount()).arg(timer.elapsed())
+   );
+   return;
+}
+
+void SearchDialog::resultActivated(int row, int /*column*/) {
+   QTableWidgetItem * recipeItem = this->tableWidget_results->item(row, RECIPE_COL);
+   if (!recipeItem) {
+      return;
+   }
+
+   Recipe * recipe = ObjectStoreWrapper::getByIdRaw<Recipe>(recipeItem->data(Qt::UserRole).toInt());
+   if (recipe) {
+      emit this->recipeSelected(recipe);
+   }
+   return;
+}
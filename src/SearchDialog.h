@@ -0,0 +1,67 @@
+/*
+ * SearchDialog.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SEARCHDIALOG_H
+#define SEARCHDIALOG_H
+#pragma once
+
+#include <QDialog>
+#include <QEvent>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTableWidget>
+
+class Recipe;
+
+/*!
+ * \class SearchDialog
+ *
+ * \brief Lets the user search the text of recipe notes, tasting notes, brew notes and instructions (via
+ *        \c FullTextSearch) and jump to the recipe each result belongs to.
+ */
+class SearchDialog : public QDialog {
+   Q_OBJECT
+
+public:
+   SearchDialog(QWidget * parent = nullptr);
+   virtual ~SearchDialog();
+
+   void changeEvent(QEvent * event);
+
+public slots:
+   //! \brief Run the search for whatever is in the query box and show the results
+   void doSearch();
+   //! \brief Called when the user double-clicks (or presses Enter on) a result
+   void resultActivated(int row, int column);
+
+signals:
+   //! \brief Emitted when the user wants to view the recipe that a result belongs to
+   void recipeSelected(Recipe * recipe);
+
+private:
+   void doLayout();
+   void retranslateUi();
+
+   QLineEdit *    lineEdit_query;
+   QPushButton *  pushButton_search;
+   QTableWidget * tableWidget_results;
+   QLabel *       label_status;
+};
+
+#endif
@@ -30,6 +30,7 @@
 #include <QVBoxLayout>
 
 #include "brewtarget.h"
+#include "Logging.h"
 #include "TimerMainDialog.h"
 #include "utils/TimerUtils.h"
 
@@ -57,7 +58,7 @@ TimerWidget::TimerWidget(TimerMainDialog *parent, BoilTime* bt) :
    // QSoundEffect will only play wav files.
    //
    soundPlayer{new QSoundEffect{this}} {
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "QSoundEffect supports the following formats:" << QSoundEffect::supportedMimeTypes().join(", ");
    this->setupUi(this);
 
@@ -180,7 +181,7 @@ void TimerWidget::setDefualtAlarmSound() {
 void TimerWidget::setSound(QString s) {
    QUrl source{QUrl::fromLocalFile(s)};
    this->soundPlayer->setSource(source);
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "Setting alarm sound to" << s << "=" << source << "; sound player status =" <<
       static_cast<int>(this->soundPlayer->status());
    return;
@@ -241,7 +242,7 @@ void TimerWidget::reset() {
 }
 
 void TimerWidget::startAlarm(bool loop) {
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "About to play" << this->soundPlayer->source() << "alarm" << (loop ? "in loop" : "once") <<
       ".  Sound player status is" << static_cast<int>(this->soundPlayer->status());
    this->soundPlayer->setLoopCount(loop ? QSoundEffect::Infinite : 1);
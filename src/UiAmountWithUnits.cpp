@@ -30,6 +30,7 @@
 #include <QWidget>
 
 #include "Localization.h"
+#include "Logging.h"
 #include "measurement/Measurement.h"
 #include "utils/OptionalToStream.h"
 
@@ -68,7 +69,7 @@ std::optional<Measurement::SystemOfMeasurement> UiAmountWithUnits::getForcedSyst
 }
 
 void UiAmountWithUnits::setForcedSystemOfMeasurementViaString(QString systemOfMeasurementAsString) {
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "Measurement system" << systemOfMeasurementAsString << "for" << this->configSection << ">" <<
       this->editField;
    this->setForcedSystemOfMeasurement(Measurement::getFromUniqueName(systemOfMeasurementAsString));
@@ -90,7 +91,7 @@ std::optional<Measurement::UnitSystem::RelativeScale> UiAmountWithUnits::getForc
 }
 
 void UiAmountWithUnits::setForcedRelativeScaleViaString(QString relativeScaleAsString) {
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "Scale" << relativeScaleAsString << "for" << this->configSection << ">" << this->editField;
    this->setForcedRelativeScale(Measurement::UnitSystem::getScaleFromUniqueName(relativeScaleAsString));
    return;
@@ -199,7 +200,7 @@ void UiAmountWithUnits::textOrUnitsChanged(PreviousScaleInfo previousScaleInfo)
    QString correctedText;
 
    QString rawValue = this->getWidgetText();
-   qDebug() << Q_FUNC_INFO << "rawValue:" << rawValue;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "rawValue:" << rawValue;
 
    if (rawValue.isEmpty()) {
       return;
@@ -218,9 +219,9 @@ void UiAmountWithUnits::textOrUnitsChanged(PreviousScaleInfo previousScaleInfo)
          precision = 0;
       }
       correctedText = this->displayAmount(amountAsCanonical.quantity, precision);
-      qDebug() <<
+      qCDebug(Logging::ui) <<
          Q_FUNC_INFO << "Interpreted" << rawValue << "as" << amountAsCanonical << "and corrected to" << correctedText;
-      qDebug() << Q_FUNC_INFO << "this->units=" << this->units;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "this->units=" << this->units;
    }
    this->setWidgetText(correctedText);
    return;
@@ -228,7 +229,7 @@ void UiAmountWithUnits::textOrUnitsChanged(PreviousScaleInfo previousScaleInfo)
 
 Measurement::Amount UiAmountWithUnits::convertToSI(PreviousScaleInfo previousScaleInfo) {
    QString rawValue = this->getWidgetText();
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "rawValue:" << rawValue <<  ", old SystemOfMeasurement:" << previousScaleInfo.oldSystemOfMeasurement <<
       ", old ForcedScale: " << previousScaleInfo.oldForcedScale;
 
@@ -265,6 +266,6 @@ Measurement::Amount UiAmountWithUnits::convertToSI(PreviousScaleInfo previousSca
    // gallons, then we'll go with US customary gallons over Imperial ones.)
    //
    auto amount = oldUnitSystem.qstringToSI(rawValue, *defaultUnit);
-   qDebug() << Q_FUNC_INFO << "Converted to" << amount;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Converted to" << amount;
    return amount;
 }
@@ -29,6 +29,7 @@
 
 #include "BtDigitWidget.h"
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "measurement/ColorMethods.h"
 #include "model/Fermentable.h"
 #include "model/Mash.h"
@@ -217,10 +218,10 @@ void WaterDialog::setRecipe(Recipe *rec) {
    for (auto waterId : this->m_rec->getWaterIds()) {
       auto water = ObjectStoreWrapper::getById<Water>(waterId);
       if (water->type() == Water::Types::BASE) {
-         qDebug() << Q_FUNC_INFO << "Base Water" << *water;
+         qCDebug(Logging::ui) << Q_FUNC_INFO << "Base Water" << *water;
          this->m_base = water;
       } else if (water->type() == Water::Types::TARGET) {
-         qDebug() << Q_FUNC_INFO << "Target Water" << *water;
+         qCDebug(Logging::ui) << Q_FUNC_INFO << "Target Water" << *water;
          this->m_target = water;
       }
    }
@@ -274,7 +275,7 @@ void WaterDialog::update_baseProfile(int selected) {
       this->m_base = std::make_shared<Water>(*parent);
       this->m_base->makeChild(*parent);
       this->m_base->setType(Water::Types::BASE);
-      qDebug() << Q_FUNC_INFO << "Made base child" << *this->m_base << "from parent" << parent;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Made base child" << *this->m_base << "from parent" << parent;
 
       baseProfileButton->setWater(this->m_base.get());
       m_base_editor->setWater(this->m_base);
@@ -298,7 +299,7 @@ void WaterDialog::update_targetProfile(int selected) {
       this->m_target = std::make_shared<Water>(*parent);
       this->m_target->makeChild(*parent);
       this->m_target->setType(Water::Types::TARGET);
-      qDebug() << Q_FUNC_INFO << "Made target child" << *this->m_target << "from parent" << parent;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Made target child" << *this->m_target << "from parent" << parent;
 
       targetProfileButton->setWater(this->m_target.get());
       m_target_editor->setWater(this->m_target);
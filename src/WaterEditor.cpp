@@ -24,6 +24,7 @@
 #include <QInputDialog>
 
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "model/Water.h"
 
 // This private implementation class holds all private non-virtual members of WaterEditor
@@ -92,15 +93,15 @@ WaterEditor::WaterEditor(QWidget *parent,
 
 //WaterEditor::~WaterEditor() = default;
 WaterEditor::~WaterEditor() {
-   qDebug() << Q_FUNC_INFO << "Cleaning up";
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Cleaning up";
    if (this->pimpl->observedWater) {
-      qDebug() <<
+      qCDebug(Logging::ui) <<
          Q_FUNC_INFO << this->pimpl->editorName << ": Was observing" << this->pimpl->observedWater->name() <<
          "#" << this->pimpl->observedWater->key() << " @" << static_cast<void *>(this->pimpl->observedWater.get()) <<
          " (use count" << this->pimpl->observedWater.use_count() << ")";
    }
    if (this->pimpl->editedWater) {
-      qDebug() <<
+      qCDebug(Logging::ui) <<
          Q_FUNC_INFO << this->pimpl->editorName << ": Was editing" << this->pimpl->editedWater->name() <<
          "#" << this->pimpl->editedWater->key() << " @" << static_cast<void *>(this->pimpl->editedWater.get());
    }
@@ -110,7 +111,7 @@ WaterEditor::~WaterEditor() {
 void WaterEditor::setWater(std::optional<std::shared_ptr<Water>> water) {
 
    if (this->pimpl->observedWater) {
-      qDebug() <<
+      qCDebug(Logging::ui) <<
          Q_FUNC_INFO << this->pimpl->editorName << ": Stop observing" << this->pimpl->observedWater->name() <<
          "#" << this->pimpl->observedWater->key() << " @" << static_cast<void *>(this->pimpl->observedWater.get()) <<
          " (use count" << this->pimpl->observedWater.use_count() << ")";
@@ -120,7 +121,7 @@ void WaterEditor::setWater(std::optional<std::shared_ptr<Water>> water) {
 
    if (water) {
       this->pimpl->observedWater = water.value();
-      qDebug() <<
+      qCDebug(Logging::ui) <<
          Q_FUNC_INFO << this->pimpl->editorName << ": Now observing" << this->pimpl->observedWater->name() <<
          "#" << this->pimpl->observedWater->key() << " @" << static_cast<void *>(this->pimpl->observedWater.get()) <<
          " (use count" << this->pimpl->observedWater.use_count() << ")";
@@ -134,7 +135,7 @@ void WaterEditor::setWater(std::optional<std::shared_ptr<Water>> water) {
 
       this->showChanges();
    } else {
-      qDebug() << Q_FUNC_INFO << this->pimpl->editorName << ": Observing Nothing";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << this->pimpl->editorName << ": Observing Nothing";
    }
 
    return;
@@ -147,7 +148,7 @@ void WaterEditor::newWater(QString folder) {
       return;
    }
 
-   qDebug() << Q_FUNC_INFO << this->pimpl->editorName << ": Creating new Water, " << name;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << this->pimpl->editorName << ": Creating new Water, " << name;
 
    this->setWater(std::make_shared<Water>(name));
    if (!folder.isEmpty()) {
@@ -170,12 +171,12 @@ void WaterEditor::showChanges(QMetaProperty const * prop) {
    bool updateAll = false;
 
    if (prop == nullptr) {
-      qDebug() << Q_FUNC_INFO << this->pimpl->editorName << ": Update all";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << this->pimpl->editorName << ": Update all";
       updateAll = true;
    }
    else {
       propName = prop->name();
-      qDebug() << Q_FUNC_INFO << this->pimpl->editorName << ": Changed" << propName;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << this->pimpl->editorName << ": Changed" << propName;
    }
 
    if (propName == PropertyNames::NamedEntity::name || updateAll) {
@@ -276,19 +277,19 @@ void WaterEditor::changed(QMetaProperty prop, QVariant /*val*/) {
 }
 
 void WaterEditor::saveAndClose() {
-   qDebug() << Q_FUNC_INFO << this->pimpl->editorName;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << this->pimpl->editorName;
    if (!this->pimpl->observedWater) {
       // For the moment, if we weren't given a Water object (via setWater) then we don't try to save any changes when
       // the editor is closed.  Arguably, if the user has actually filled in a bunch of data, then we should use that
       // to create and save a new Water object.
-      qDebug() << Q_FUNC_INFO << "Save and close with no Water specified, so discarding any inputs";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Save and close with no Water specified, so discarding any inputs";
       return;
    }
 
    // Apply all the edits
    if (this->pimpl->editedWater) {
       *this->pimpl->observedWater = *this->pimpl->editedWater;
-      qDebug() <<
+      qCDebug(Logging::ui) <<
          Q_FUNC_INFO << this->pimpl->editorName << ": Applied edits to Water #" << this->pimpl->observedWater->key() <<
          ":" << this->pimpl->observedWater->name();
    }
@@ -306,7 +307,7 @@ void WaterEditor::saveAndClose() {
 }
 
 void WaterEditor::clearAndClose() {
-   qDebug() << Q_FUNC_INFO << this->pimpl->editorName;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << this->pimpl->editorName;
 
    // At this point, we want to clear edits, but we _don't_ want to stop observing the Water that's been given to us as
    // our creator (eg WaterDialog) may redisplay us without a repeat call to setWater.
@@ -317,7 +318,7 @@ void WaterEditor::clearAndClose() {
    // Revert all the edits in our temporary copy of the "observed" Water
    if (this->pimpl->observedWater && this->pimpl->editedWater) {
       *this->pimpl->editedWater = *this->pimpl->observedWater;
-      qDebug() <<
+      qCDebug(Logging::ui) <<
          Q_FUNC_INFO << this->pimpl->editorName << ": Discarded edits to Water #" <<
          this->pimpl->observedWater->key() << ":" << this->pimpl->observedWater->name();
    }
@@ -33,6 +33,7 @@
 #include <QObject>
 #include <QString>
 #include <QStandardPaths>
+#include <QTimer>
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
 #include <QtNetwork/QNetworkRequest>
@@ -43,6 +44,7 @@
 #include "config.h"
 #include "database/Database.h"
 #include "Localization.h"
+#include "Logging.h"
 #include "MainWindow.h"
 #include "measurement/ColorMethods.h"
 #include "measurement/IbuMethods.h"
@@ -56,6 +58,7 @@
 #include "model/Water.h"
 #include "model/Yeast.h"
 #include "PersistentSettings.h"
+#include "utils/StartupProfiler.h"
 
 // Needed for kill(2)
 #if defined(Q_OS_UNIX)
@@ -67,6 +70,7 @@ namespace {
 
    bool interactive = true;
    bool checkVersion = true;
+   bool deferStartupWork = false;
 
    //! \brief Where the user says the database files are
    QDir userDataDir;
@@ -156,6 +160,11 @@ void Brewtarget::setCheckVersion(bool value) {
    return;
 }
 
+void Brewtarget::setDeferStartupWork(bool value) {
+   deferStartupWork = value;
+   return;
+}
+
 QDir Brewtarget::getDataDir()
 {
    QString dir = qApp->applicationDirPath();
@@ -219,12 +228,12 @@ const QDir Brewtarget::getConfigDir()
    char* xdg_config_home = getenv("XDG_CONFIG_HOME");
 
    if (xdg_config_home) {
-     qInfo() << QString("XDG_CONFIG_HOME directory is %1").arg(xdg_config_home);
+     qCInfo(Logging::ui) << QString("XDG_CONFIG_HOME directory is %1").arg(xdg_config_home);
      dir.setPath(QString(xdg_config_home).append("/brewtarget"));
    }
    else {
      // If XDG_CONFIG_HOME doesn't exist, config goes in ~/.config/brewtarget
-      qInfo() << QString("XDG_CONFIG_HOME not set.  HOME directory is %1").arg(QDir::homePath());
+      qCInfo(Logging::ui) << QString("XDG_CONFIG_HOME not set.  HOME directory is %1").arg(QDir::homePath());
      QString dirPath = QDir::homePath().append("/.config/brewtarget");
      dir = QDir(dirPath);
    }
@@ -260,11 +269,11 @@ QDir Brewtarget::getDefaultUserDataDir()
 #elif defined(Q_OS_WIN) // Windows OS.
    // On Windows the Programs directory is normally not writable so we need to get the appData path from the environment instead.
    userDataDir.setPath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
-   qDebug() << QString("userDataDir=%1").arg(userDataDir.path());
+   qCDebug(Logging::ui) << QString("userDataDir=%1").arg(userDataDir.path());
    if (!userDataDir.exists()) {
-      qDebug() << QString("User data dir \"%1\" does not exist, trying to create").arg(userDataDir.path());
+      qCDebug(Logging::ui) << QString("User data dir \"%1\" does not exist, trying to create").arg(userDataDir.path());
       createDir(userDataDir);
-      qDebug() << "UserDatadit Created";
+      qCDebug(Logging::ui) << "UserDatadit Created";
    }
    return userDataDir;
 #else
@@ -318,11 +327,20 @@ bool Brewtarget::initialize()
    qRegisterMetaType< QList<Salt*> >();
 
    // Make sure all the necessary directories and files we need exist before starting.
-   ensureDirectoriesExist();
+   {
+      StartupProfiler::Phase startupPhase{"Check directories"};
+      ensureDirectoriesExist();
+   }
 
-   readSystemOptions();
+   {
+      StartupProfiler::Phase startupPhase{"Read system options"};
+      readSystemOptions();
+   }
 
-   Localization::loadTranslations(); // Do internationalization.
+   {
+      StartupProfiler::Phase startupPhase{"Load translations"};
+      Localization::loadTranslations(); // Do internationalization.
+   }
 
 #if defined(Q_OS_MAC)
    qt_set_sequence_auto_mnemonic(true); // turns on Mac Keyboard shortcuts
@@ -330,12 +348,13 @@ bool Brewtarget::initialize()
 
    // Check if the database was successfully loaded before
    // loading the main window.
-   qDebug() << "Loading Database...";
+   qCDebug(Logging::ui) << "Loading Database...";
+   StartupProfiler::Phase startupPhase{"Load database"};
    return Database::instance().loadSuccessful();
 }
 
 void Brewtarget::cleanup() {
-   qDebug() << "Brewtarget is cleaning up.";
+   qCDebug(Logging::ui) << "Brewtarget is cleaning up.";
    // Should I do qApp->removeTranslator() first?
    MainWindow::DeleteMainWindow();
 
@@ -363,23 +382,50 @@ int Brewtarget::run() {
       cleanup();
       return 1;
    }
-   qInfo() << QString("Starting Brewtarget v%1 on %2.").arg(VERSIONSTRING).arg(QSysInfo::prettyProductName());
-   Database::instance().checkForNewDefaultData();
+   qCInfo(Logging::ui) << QString("Starting Brewtarget v%1 on %2.").arg(VERSIONSTRING)
+      .arg(QSysInfo::prettyProductName());
+
+   bool const deferNonCriticalWork =
+      deferStartupWork || PersistentSettings::value(PersistentSettings::Names::deferStartupWork, false).toBool();
+   if (!deferNonCriticalWork) {
+      {
+         StartupProfiler::Phase startupPhase{"Check for new default data"};
+         Database::instance().checkForNewDefaultData();
+      }
+      Database::instance().automaticBackup();
+   }
 
    // .:TBD:. Could maybe move the calls to init and setVisible inside createMainWindowInstance() in MainWindow.cpp
    MainWindow & mainWindow = MainWindow::instance();
    mainWindow.init();
-   mainWindow.setVisible(true);
-   splashScreen.finish(&mainWindow);
+   {
+      StartupProfiler::Phase startupPhase{"Show main window"};
+      mainWindow.setVisible(true);
+      splashScreen.finish(&mainWindow);
+   }
 
-   checkForNewVersion(&mainWindow);
+   //
+   // A zero-length timer fires once the event loop is running, which is when the user can start using the main window
+   //
+   QTimer::singleShot(0, &mainWindow, [deferNonCriticalWork, &mainWindow]() {
+      StartupProfiler::markInteractive();
+      if (deferNonCriticalWork) {
+         Database::instance().checkForNewDefaultData();
+         Database::instance().automaticBackup();
+         checkForNewVersion(&mainWindow);
+      }
+      Database::instance().automaticCompaction();
+   });
+   if (!deferNonCriticalWork) {
+      checkForNewVersion(&mainWindow);
+   }
    do {
       ret = qApp->exec();
    } while (ret == 1000);
 
    cleanup();
 
-   qDebug() << Q_FUNC_INFO << "Cleaned up.  Returning " << ret;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Cleaned up.  Returning " << ret;
 
    return ret;
 }
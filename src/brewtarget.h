@@ -80,6 +80,13 @@ namespace Brewtarget {
    //! \brief If this option is false, do not bother the user about new versions.
    void setCheckVersion(bool value);
 
+   /**
+    * \brief If set, work that is not needed to show the main window (eg checking for new default data or for a new
+    *        version of the program, or the automatic DB backup) is not done until the main window is up and running.
+    *        This is also turned on by the deferStartupWork setting.
+    */
+   void setDeferStartupWork(bool value);
+
    //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
    /*!
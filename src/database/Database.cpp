@@ -39,11 +39,13 @@
  */
 #include "database/Database.h"
 
+#include <functional>
 #include <iostream> // For writing to std::cerr in destructor
 #include <mutex>    // For std::once_flag etc
 
 #include <QDateTime>
 #include <QDebug>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileInfo>
 #include <QInputDialog>
@@ -52,6 +54,7 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QObject>
+#include <QProgressDialog>
 #include <QSqlDriver>
 #include <QSqlError>
 #include <QSqlField>
@@ -61,9 +64,15 @@
 #include "brewtarget.h"
 #include "config.h"
 #include "database/BtSqlQuery.h"
+#include "database/DatabaseBackup.h"
+#include "database/DatabaseCompaction.h"
 #include "database/DatabaseSchemaHelper.h"
+#include "database/DatabaseWorkerPool.h"
+#include "database/SqliteCheckpointer.h"
+#include "Logging.h"
 #include "PersistentSettings.h"
 #include "utils/BtStringConst.h"
+#include "utils/StartupProfiler.h"
 
 namespace {
    //
@@ -119,6 +128,24 @@ namespace {
       // MySQL would be ALTER TABLE %1 ADD COLUMN %2 int, FOREIGN KEY (%2) REFERENCES %3(%4)
    };
 
+   //
+   // In WAL mode, SqliteCheckpointer does the checkpoints, but SQLite will still do one itself if the WAL gets to this
+   // many pages (64 MiB with 4 KiB pages), as a backstop in case the background thread can't keep up.
+   //
+   int constexpr SQLITE_WAL_AUTOCHECKPOINT_PAGES = 16384;
+
+   //
+   // When SQLite goes back to writing the WAL from the beginning (after a complete checkpoint), it cuts the file down
+   // to this size.  See comments in database/SqliteCheckpointer.cpp for why this matters.
+   //
+   int constexpr SQLITE_JOURNAL_SIZE_LIMIT_BYTES = 1024 * 1024;
+
+   //! Minimum time between runs of Database::automaticCompaction()
+   qint64 constexpr COMPACTION_INTERVAL_DAYS = 30;
+
+   //! Default number of worker connections for PostgreSQL -- see Database::workerPool()
+   int constexpr DEFAULT_NUM_PGSQL_WORKER_CONNECTIONS = 4;
+
    char const * getDbNativeName(DbNativeVariants const & dbNativeVariants, Database::DbType dbType) {
       switch (dbType) {
          case Database::SQLITE: return dbNativeVariants.sqliteName;
@@ -159,6 +186,12 @@ namespace {
    //
    Database::DbType currentDbType = Database::NODB;
 
+   //! \return \c true if we are on the main (GUI) thread, which is the one that does nearly all the DB writes
+   bool isMainThread() {
+      return QCoreApplication::instance() == nullptr ||
+             QThread::currentThread() == QCoreApplication::instance()->thread();
+   }
+
    // May St. Stevens intercede on my behalf.
    //
    //! \brief opens an SQLite db for transfer
@@ -224,7 +257,11 @@ public:
                                    loaded{false},
                                    loadWasSuccessful{false},
                                    mutex{},
-                                   userDatabaseDidNotExist{false} {
+                                   userDatabaseDidNotExist{false},
+                                   sqliteJournalMode{Database::SqliteJournalMode::Wal},
+                                   sqliteSharedCache{false},
+                                   sqliteCheckpointer{},
+                                   automaticBackupThread{} {
       return;
    }
 
@@ -235,12 +272,12 @@ public:
 
    // Don't know where to put this, so it goes here for right now
    bool loadSQLite(Database & database) {
-      qDebug() << "Loading SQLITE...";
+      qCDebug(Logging::db) << "Loading SQLITE...";
 
       // Set file names.
       this->dbFileName = PersistentSettings::getUserDataDir().filePath("database.sqlite");
       this->dataDbFileName = Brewtarget::getResourceDir().filePath("default_db.sqlite");
-      qDebug().noquote() <<
+      qCDebug(Logging::db).noquote() <<
          Q_FUNC_INFO << "dbFileName = \"" << this->dbFileName << "\"\ndataDbFileName=\"" << this->dataDbFileName << "\"";
       // Set the files.
       this->dbFile.setFileName(this->dbFileName);
@@ -251,6 +288,9 @@ public:
          QFile newdb(QString("%1.new").arg(this->dbFileName));
          if (newdb.exists()) {
             this->dbFile.remove();
+            // Any WAL left over from the old DB (eg after a crash) must not be applied to the restored one
+            QFile::remove(this->dbFileName + "-wal");
+            QFile::remove(this->dbFileName + "-shm");
             newdb.copy(this->dbFileName);
             QFile::setPermissions(this->dbFileName, QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup );
             newdb.remove();
@@ -271,6 +311,20 @@ public:
          Database::lastDbMergeRequest = QDateTime::currentDateTime();
       }
 
+      QString const journalModeName =
+         PersistentSettings::value(PersistentSettings::Names::sqliteJournalMode, "wal").toString().toLower();
+      if (journalModeName == "exclusive") {
+         this->sqliteJournalMode = Database::SqliteJournalMode::Exclusive;
+      } else {
+         if (journalModeName != "wal") {
+            qWarning() << Q_FUNC_INFO << "Unrecognised SQLite journal mode" << journalModeName << "- using WAL";
+         }
+         this->sqliteJournalMode = Database::SqliteJournalMode::Wal;
+      }
+      this->sqliteSharedCache = PersistentSettings::value(PersistentSettings::Names::sqliteSharedCache, false).toBool();
+      qCInfo(Logging::db) <<
+         Q_FUNC_INFO << "SQLite journal mode" << journalModeName << ", shared cache" << this->sqliteSharedCache;
+
       // Open SQLite DB
       // It's a coding error if we didn't already establish that SQLite is the type of DB we're talking to, so assert
       // that and then call the generic code to get a connection
@@ -278,7 +332,7 @@ public:
       QSqlDatabase connection = database.sqlDatabase();
 
       this->dbConName = connection.connectionName();
-      qDebug() << Q_FUNC_INFO << "dbConName=" << this->dbConName;
+      qCDebug(Logging::db) << Q_FUNC_INFO << "dbConName=" << this->dbConName;
 
       //
       // It's quite useful to record the DB version in the logs
@@ -292,26 +346,9 @@ public:
          return false;
       }
       QVariant fieldValue = sqlQuery.value("version");
-      qInfo() << Q_FUNC_INFO << "SQLite version" << fieldValue;
+      qCInfo(Logging::db) << Q_FUNC_INFO << "SQLite version" << fieldValue;
 
-      // NOTE: synchronous=off reduces query time by an order of magnitude!
-      BtSqlQuery pragma(connection);
-      if ( ! pragma.exec( "PRAGMA synchronous = off" ) ) {
-         qCritical() << Q_FUNC_INFO << "Could not disable synchronous writes: " << pragma.lastError().text();
-         return false;
-      }
-      if ( ! pragma.exec( "PRAGMA foreign_keys = on")) {
-         qCritical() << Q_FUNC_INFO << "Could not enable foreign keys: " << pragma.lastError().text();
-         return false;
-      }
-      if ( ! pragma.exec( "PRAGMA locking_mode = EXCLUSIVE")) {
-         qCritical() << Q_FUNC_INFO << "Could not enable exclusive locks: " << pragma.lastError().text();
-         return false;
-      }
-      if ( ! pragma.exec("PRAGMA temp_store = MEMORY") ) {
-         qCritical() << Q_FUNC_INFO << "Could not enable temporary memory: " << pragma.lastError().text();
-         return false;
-      }
+      // NB: PRAGMAs (synchronous, foreign_keys etc) are set for each connection in sqlDatabase()
 
       // older sqlite databases may not have a settings table. I think I will
       // just check to see if anything is in there.
@@ -361,7 +398,7 @@ public:
       QSqlDatabase connection = database.sqlDatabase();
 
       this->dbConName = connection.connectionName();
-      qDebug() << Q_FUNC_INFO << "dbConName=" << this->dbConName;
+      qCDebug(Logging::db) << Q_FUNC_INFO << "dbConName=" << this->dbConName;
 
       //
       // It's quite useful to record the DB version in the logs
@@ -375,7 +412,7 @@ public:
          return false;
       }
       QVariant fieldValue = sqlQuery.value("version");
-      qInfo() << Q_FUNC_INFO << "PostgreSQL version" << fieldValue;
+      qCInfo(Logging::db) << Q_FUNC_INFO << "PostgreSQL version" << fieldValue;
 
       // by the time we had pgsql support, there is a settings table
       this->createFromScratch = ! connection.tables().contains("settings");
@@ -391,7 +428,34 @@ public:
       bool doUpdate = currentVersion < newVersion;
 
       if (doUpdate) {
-         bool success = DatabaseSchemaHelper::migrate(database, currentVersion, newVersion, database.sqlDatabase() );
+         //
+         // On a big DB, the upgrade can take a while, so, if there's someone to see it, we show progress.  (The
+         // dialog only appears if things are taking more than a moment.)
+         //
+         std::unique_ptr<QProgressDialog> progressDialog;
+         DatabaseSchemaHelper::SchemaMigrationProgressHandler progressHandler;
+         if (Brewtarget::isInteractive()) {
+            progressDialog = std::make_unique<QProgressDialog>(
+               QObject::tr("Upgrading database..."), QString{}, 0, newVersion - currentVersion
+            );
+            progressDialog->setWindowModality(Qt::ApplicationModal);
+            progressDialog->setMinimumDuration(500);
+            progressHandler = [&progressDialog](int numStepsDone, int numSteps, QString const & description) {
+               if (numStepsDone < numSteps) {
+                  qCInfo(Logging::db) << "Database upgrade step" << numStepsDone + 1 << "of" << numSteps << description;
+                  progressDialog->setLabelText(
+                     QObject::tr("Upgrading database (step %1 of %2)...").arg(numStepsDone + 1).arg(numSteps)
+                  );
+               }
+               // NB: Setting the value to the maximum closes the dialog
+               progressDialog->setValue(numStepsDone);
+            };
+         }
+         bool success = DatabaseSchemaHelper::migrate(database,
+                                                      currentVersion,
+                                                      newVersion,
+                                                      database.sqlDatabase(),
+                                                      progressHandler);
          if (!success) {
             qCritical() << Q_FUNC_INFO << QString("Database migration %1->%2 failed").arg(currentVersion).arg(newVersion);
             if (err) {
@@ -405,6 +469,15 @@ public:
    }
 
 
+   /**
+    * \brief See \c Database::automaticBackup().  Every so often (per the settings in the backups section), makes a
+    *        backup of the DB and then removes old ones.  In WAL mode, the backup runs in the background (see
+    *        \c DatabaseBackup) and the old ones are removed, in \c finishAutomaticBackup(), once it has succeeded.
+    *        \c Database::unload() waits for it to finish if necessary.
+    *
+    *        (We used to do this at the end of \c Database::unload(), by copying the DB file, which held up closing
+    *        down.  Doing it at start-up instead backs up the same data, as nothing has changed in between.)
+    */
    void automaticBackup(Database & database) {
       int count = PersistentSettings::value(PersistentSettings::Names::count, 0, PersistentSettings::Sections::backups).toInt() + 1;
       int frequency = PersistentSettings::value(PersistentSettings::Names::frequency, 4, PersistentSettings::Sections::backups).toInt();
@@ -432,13 +505,18 @@ public:
       QStringList fileNames = listOfFiles.split(",", Qt::SkipEmptyParts);
 #endif
 
+      bool const compress = PersistentSettings::value(PersistentSettings::Names::compress,
+                                                      false,
+                                                      PersistentSettings::Sections::backups).toBool();
+      QString const suffix{compress ? ".qz" : ""};
+
       QString halfName = QString("%1.%2").arg("databaseBackup").arg(QDate::currentDate().toString("yyyyMMdd"));
       QString newName = halfName;
       // Unique filenames are a pain in the ass. In the case you open Brewtarget
       // twice in a day, this loop makes sure we don't over write (or delete) the
       // wrong thing
       int foobar = 0;
-      while ( foobar < 10000 && QFile::exists( backupDir + "/" + newName ) ) {
+      while ( foobar < 10000 && QFile::exists( backupDir + "/" + newName + suffix ) ) {
          foobar++;
          newName = QString("%1_%2").arg(halfName).arg(foobar,4,10,QChar('0'));
          if ( foobar > 9999 ) {
@@ -446,9 +524,62 @@ public:
             newName = halfName;
          }
       }
+      newName += suffix;
+
       // backup the file first
-      database.backupToDir(backupDir, newName);
+      this->automaticBackupThread = std::make_unique<DatabaseBackup>(database, backupDir + "/" + newName, compress);
+      if (this->sqliteJournalMode == Database::SqliteJournalMode::Wal) {
+         // Removing old backups has to wait until we know the new one is good
+         this->pendingBackupRotation = [backupDir, fileNames, newName, maxBackups]() {
+            rotateBackups(backupDir, fileNames, newName, maxBackups);
+            return;
+         };
+         // The thread object lives on the main thread, so this runs there
+         QObject::connect(this->automaticBackupThread.get(),
+                          &QThread::finished,
+                          this->automaticBackupThread.get(),
+                          [this]() { this->finishAutomaticBackup(); });
+         this->automaticBackupThread->start(QThread::LowPriority);
+      } else if (this->automaticBackupThread->runHere()) {
+         // No other connection can read the DB in this mode, so we have to do the backup here
+         rotateBackups(backupDir, fileNames, newName, maxBackups);
+      } else {
+         qWarning() <<
+            Q_FUNC_INFO << "Automatic backup failed (" << this->automaticBackupThread->errorMessage() <<
+            ") so not removing any old backups";
+      }
+      return;
+   }
 
+   /**
+    * \brief Once the background backup started by \c automaticBackup() has finished, remove old backups if it
+    *        succeeded.  Called when the backup thread finishes, and from \c Database::unload() in case we are closing
+    *        down before that could happen.  Does nothing after the first call for a given backup.
+    */
+   void finishAutomaticBackup() {
+      std::function<void()> rotate;
+      std::swap(rotate, this->pendingBackupRotation);
+      if (!rotate || !this->automaticBackupThread) {
+         return;
+      }
+      if (!this->automaticBackupThread->succeeded()) {
+         qWarning() <<
+            Q_FUNC_INFO << "Automatic backup failed (" << this->automaticBackupThread->errorMessage() <<
+            ") so not removing any old backups";
+         return;
+      }
+      rotate();
+      return;
+   }
+
+   /**
+    * \brief After a successful automatic backup to \c newName in \c backupDir, record it in the list of backups
+    *        (\c fileNames) and remove the oldest ones if there are more than \c maxBackups
+    */
+   static void rotateBackups(QString const & backupDir,
+                             QStringList fileNames,
+                             QString const & newName,
+                             int const maxBackups) {
       // If we have maxBackups == -1, it means never clean. It also means we
       // don't track the filenames.
       if ( maxBackups == -1 )  {
@@ -470,7 +601,7 @@ public:
          // Make sure it exists, and make sure it is a file before we
          // try remove it
          if ( fileThing->exists() && fileThing->isFile() ) {
-            qInfo() <<
+            qCInfo(Logging::db) <<
                Q_FUNC_INFO << "Removing oldest database backup file," << victim << "as more than" << maxBackups <<
                "files in" << backupDir;
             // If we can't remove it, give a warning.
@@ -482,11 +613,73 @@ public:
       }
 
       // re-encode the list
-      listOfFiles = fileNames.join(",");
+      QString const listOfFiles = fileNames.join(",");
 
       // finally, reset the counter and save the new list of files
       PersistentSettings::insert(PersistentSettings::Names::count, 0, PersistentSettings::Sections::backups);
       PersistentSettings::insert(PersistentSettings::Names::files, listOfFiles, PersistentSettings::Sections::backups);
+      return;
+   }
+
+   /**
+    * \brief In WAL mode, copy everything in the WAL back into the DB file, so that the file on its own is complete (eg
+    *        before we copy it).  Does nothing if this thread has no open connection (eg because we are closing down, in
+    *        which case SQLite will already have emptied the WAL when the last connection closed).
+    */
+   void checkpointWal() {
+      if (this->dbType != Database::SQLITE || this->sqliteJournalMode != Database::SqliteJournalMode::Wal) {
+         return;
+      }
+      QString const connectionName = dbConnectionNamesForThisThread.value(this->dbType);
+      if (!QSqlDatabase::contains(connectionName)) {
+         return;
+      }
+      QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
+      BtSqlQuery pragma{connection};
+      if (!pragma.exec("PRAGMA wal_checkpoint(TRUNCATE);") || !pragma.next() || pragma.value(0).toInt() != 0) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not copy all of WAL back to" << this->dbFileName << ":" << pragma.lastError().text();
+      }
+      return;
+   }
+
+   /**
+    * \brief For PostgreSQL, the equivalent of a backup: write everything in the object stores to a new SQLite DB, in
+    *        the same way as when the user switches from one DB to another (see
+    *        \c DatabaseSchemaHelper::copyToNewDatabase and \c ObjectStore::writeAllToNewDb).  Because the object stores
+    *        hold everything in memory, this doesn't need pg_dump (or even a second connection to the PostgreSQL DB)
+    *        and gives a consistent snapshot, as nothing else can change the object stores while we are doing it.  The
+    *        result can be restored in the usual way, or copied back to PostgreSQL.
+    *
+    *        Object stores can only be used from the main thread, so this does not run in the background.
+    */
+   bool writeLogicalSnapshot(QString const & fileName) {
+      qCInfo(Logging::db) << Q_FUNC_INFO << "Writing snapshot of PostgreSQL DB to" << fileName;
+      QString const partialFileName = fileName + ".partial";
+      QFile::remove(partialFileName);
+      QString const connectionName{"snapshot"};
+      bool succeeded = false;
+      {
+         // This needs to be out of scope before we call QSqlDatabase::removeDatabase()
+         QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+         connection.setDatabaseName(partialFileName);
+         if (connection.open()) {
+            // As in Database::convertDatabase(), we don't want this object to load anything or be a singleton
+            Database snapshotDatabase{Database::SQLITE};
+            succeeded = DatabaseSchemaHelper::copyToNewDatabase(snapshotDatabase, connection);
+            connection.close();
+         } else {
+            qCritical() << Q_FUNC_INFO << "Could not create" << partialFileName << ":" << connection.lastError().text();
+         }
+      }
+      QSqlDatabase::removeDatabase(connectionName);
+
+      if (!succeeded) {
+         QFile::remove(partialFileName);
+         return false;
+      }
+      QFile::remove(fileName);
+      return QFile::rename(partialFileName, fileName);
    }
 
    Database::DbType dbType;
@@ -510,6 +703,18 @@ public:
    QString dbFileName;
    QFile dataDbFile;
    QString dataDbFileName;
+   Database::SqliteJournalMode sqliteJournalMode;
+   bool sqliteSharedCache;
+   //! Only used in SqliteJournalMode::Wal mode
+   std::unique_ptr<SqliteCheckpointer> sqliteCheckpointer;
+   //! Set if automaticBackup() started a backup
+   std::unique_ptr<DatabaseBackup> automaticBackupThread;
+   //! Set while a background automatic backup is running: what to do (in finishAutomaticBackup()) if it succeeds
+   std::function<void()> pendingBackupRotation;
+   //! Set if Database::automaticCompaction() ran
+   std::unique_ptr<DatabaseCompaction> compactionThread;
+   //! See Database::workerPool()
+   std::unique_ptr<DatabaseWorkerPool> workerPool;
 
    // And these are for Postgres databases
    QString dbHostname;
@@ -556,7 +761,7 @@ QSqlDatabase Database::sqlDatabase() const {
    Q_ASSERT(!connectionName.isEmpty());
    QSqlDatabase connection = QSqlDatabase::database(connectionName);
    if (connection.isValid()) {
-      qDebug() << Q_FUNC_INFO << "Returning connection " << connectionName;
+      qCDebug(Logging::db) << Q_FUNC_INFO << "Returning connection " << connectionName;
       return connection;
    }
 
@@ -565,7 +770,7 @@ QSqlDatabase Database::sqlDatabase() const {
    // safe, so we don't need to worry about mutexes here.)
    //
    QString driverType{this->pimpl->dbType == Database::PGSQL ? "QPSQL" : "QSQLITE"};
-   qDebug() <<
+   qCDebug(Logging::db) <<
       Q_FUNC_INFO << "Creating connection " << connectionName << " with " << driverType << " driver";
    connection = QSqlDatabase::addDatabase(driverType, connectionName);
    if (!connection.isValid()) {
@@ -576,7 +781,7 @@ QSqlDatabase Database::sqlDatabase() const {
       qCritical() << Q_FUNC_INFO << "Unable to load " << driverType << " database driver";
    }
 
-   qDebug() << Q_FUNC_INFO << "Created connection of type" << connection.driver()->handle().typeName();
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Created connection of type" << connection.driver()->handle().typeName();
 
    //
    // Initialisation parameters depend on the DB type
@@ -589,6 +794,10 @@ QSqlDatabase Database::sqlDatabase() const {
       connection.setPassword    (this->pimpl->dbPassword);
    } else {
       connection.setDatabaseName(this->pimpl->dbFileName);
+      if (this->pimpl->sqliteSharedCache && !isMainThread()) {
+         // Worker threads share one page cache, rather than each reading the same pages from disk into its own
+         connection.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+      }
    }
 
    //
@@ -617,9 +826,92 @@ QSqlDatabase Database::sqlDatabase() const {
       throw errorMessage;
    }
 
+   if (this->pimpl->dbType == Database::SQLITE &&
+       !Database::setSqliteConnectionOptions(connection, this->pimpl->sqliteJournalMode, isMainThread())) {
+      QString const errorMessage = QString{
+         QObject::tr("Could not set options on SQLite DB connection to %1.\n%2")
+      }.arg(this->pimpl->dbFileName).arg(connection.lastError().text());
+      qCritical() << Q_FUNC_INFO << errorMessage;
+      throw errorMessage;
+   }
+
    return connection;
 }
 
+bool Database::setSqliteConnectionOptions(QSqlDatabase & connection,
+                                          Database::SqliteJournalMode journalMode,
+                                          bool isMainConnection) {
+   bool const walMode = journalMode == Database::SqliteJournalMode::Wal;
+   BtSqlQuery pragma(connection);
+   if (isMainConnection) {
+      //
+      // The journal mode is stored in the DB file, so we set it explicitly either way, otherwise a DB that had once
+      // been opened in WAL mode would stay in it.  The result is the mode now in force, which will not be WAL if the
+      // file system doesn't support it (in which case we carry on, as the other settings are still safe).
+      //
+      QString const requestedMode{walMode ? "wal" : "delete"};
+      if (!pragma.exec(QString{"PRAGMA journal_mode = %1"}.arg(requestedMode)) || !pragma.next()) {
+         qCritical() << Q_FUNC_INFO << "Could not set journal mode: " << pragma.lastError().text();
+         return false;
+      }
+      QString const actualMode{pragma.value(0).toString()};
+      if (actualMode.compare(requestedMode, Qt::CaseInsensitive) != 0) {
+         qWarning() << Q_FUNC_INFO << "Asked for SQLite journal mode" << requestedMode << "but got" << actualMode;
+      }
+      if (!walMode && !pragma.exec("PRAGMA locking_mode = EXCLUSIVE")) {
+         qCritical() << Q_FUNC_INFO << "Could not enable exclusive locks: " << pragma.lastError().text();
+         return false;
+      }
+   }
+
+   //
+   // In WAL mode, synchronous = NORMAL means we only wait for the disk at checkpoints, not on every commit, which is
+   // nearly as fast as synchronous = off, but without the risk of corrupting the DB.  With a rollback journal,
+   // synchronous = off reduces query time by an order of magnitude, but at the cost of that risk.
+   //
+   if (!pragma.exec(walMode ? "PRAGMA synchronous = NORMAL" : "PRAGMA synchronous = off")) {
+      qCritical() << Q_FUNC_INFO << "Could not set synchronous writes: " << pragma.lastError().text();
+      return false;
+   }
+   if (!pragma.exec("PRAGMA foreign_keys = on")) {
+      qCritical() << Q_FUNC_INFO << "Could not enable foreign keys: " << pragma.lastError().text();
+      return false;
+   }
+   if (!pragma.exec("PRAGMA temp_store = MEMORY")) {
+      qCritical() << Q_FUNC_INFO << "Could not enable temporary memory: " << pragma.lastError().text();
+      return false;
+   }
+   if (walMode) {
+      if (!pragma.exec(QString{"PRAGMA wal_autocheckpoint = %1"}.arg(SQLITE_WAL_AUTOCHECKPOINT_PAGES)) ||
+          !pragma.exec(QString{"PRAGMA journal_size_limit = %1"}.arg(SQLITE_JOURNAL_SIZE_LIMIT_BYTES))) {
+         qCritical() << Q_FUNC_INFO << "Could not set checkpoint options: " << pragma.lastError().text();
+         return false;
+      }
+   }
+   return true;
+}
+
+Database::SqliteJournalMode Database::sqliteJournalMode() const {
+   return this->pimpl->sqliteJournalMode;
+}
+
+
+void Database::closeConnectionForThisThread() {
+   QString const connectionName = dbConnectionNamesForThisThread.value(this->pimpl->dbType);
+   if (!QSqlDatabase::contains(connectionName)) {
+      return;
+   }
+   {
+      // As in unload(), this QSqlDatabase object needs to be out of scope before we call QSqlDatabase::removeDatabase()
+      QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
+      if (connection.isOpen()) {
+         connection.close();
+      }
+   }
+   QSqlDatabase::removeDatabase(connectionName);
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Closed connection" << connectionName;
+   return;
+}
 
 bool Database::load() {
    this->pimpl->createFromScratch = false;
@@ -628,13 +920,16 @@ bool Database::load() {
 
    // We have had problems on Windows with the DB driver not being found in certain circumstances.  This is some extra
    // diagnostic to help resolve that.
-   qInfo() << Q_FUNC_INFO << "Known DB drivers: " << QSqlDatabase::drivers();
+   qCInfo(Logging::db) << Q_FUNC_INFO << "Known DB drivers: " << QSqlDatabase::drivers();
 
    bool dbIsOpen;
-   if (this->dbType() == Database::PGSQL ) {
-      dbIsOpen = this->pimpl->loadPgSQL(*this);
-   } else {
-      dbIsOpen = this->pimpl->loadSQLite(*this);
+   {
+      StartupProfiler::Phase startupPhase{"Open database and set options"};
+      if (this->dbType() == Database::PGSQL ) {
+         dbIsOpen = this->pimpl->loadPgSQL(*this);
+      } else {
+         dbIsOpen = this->pimpl->loadSQLite(*this);
+      }
    }
 
    if (!dbIsOpen) {
@@ -647,6 +942,7 @@ bool Database::load() {
 
    // This should work regardless of the db being used.
    if (this->pimpl->createFromScratch) {
+      StartupProfiler::Phase startupPhase{"Create database schema"};
       if (!DatabaseSchemaHelper::create(*this, sqldb)) {
          qCritical() << Q_FUNC_INFO << "DatabaseSchemaHelper::create() failed";
          return false;
@@ -656,7 +952,10 @@ bool Database::load() {
    // Update the database if need be. This has to happen before we do anything
    // else or we dump core
    bool schemaErr = false;
-   this->pimpl->schemaUpdated = this->pimpl->updateSchema(*this, &schemaErr);
+   {
+      StartupProfiler::Phase startupPhase{"Check and update database schema"};
+      this->pimpl->schemaUpdated = this->pimpl->updateSchema(*this, &schemaErr);
+   }
 
    if (schemaErr ) {
       if (Brewtarget::isInteractive()) {
@@ -669,6 +968,15 @@ bool Database::load() {
       return false;
    }
 
+   if (this->dbType() == Database::SQLITE && this->pimpl->sqliteJournalMode == Database::SqliteJournalMode::Wal) {
+      this->pimpl->sqliteCheckpointer = std::make_unique<SqliteCheckpointer>(*this, this->pimpl->dbFileName);
+      this->pimpl->sqliteCheckpointer->start(QThread::LowPriority);
+   }
+   if (this->dbType() == Database::PGSQL) {
+      this->setNumWorkerConnections(PersistentSettings::value(PersistentSettings::Names::dbWorkerConnections,
+                                                              DEFAULT_NUM_PGSQL_WORKER_CONNECTIONS).toInt());
+   }
+
    this->pimpl->loadWasSuccessful = true;
    return this->pimpl->loadWasSuccessful;
 }
@@ -710,7 +1018,7 @@ void Database::checkForNewDefaultData() {
             );
             qCritical() << Q_FUNC_INFO << userMessage;
          }
-         qDebug() << Q_FUNC_INFO << "Message box text : " << messageBoxText;
+         qCDebug(Logging::db) << Q_FUNC_INFO << "Message box text : " << messageBoxText;
          QMessageBox msgBox{succeeded ? QMessageBox::Information : QMessageBox::Critical,
                             messageBoxTitle,
                             messageBoxText};
@@ -747,6 +1055,9 @@ bool Database::createBlank(QString const& filename)
 bool Database::copyDataFiles(const QDir newPath)
 {
    QString dbFileName = "database.sqlite";
+   if (currentDbType == Database::SQLITE) {
+      Database::instance().pimpl->checkpointWal();
+   }
    return QFile::copy(PersistentSettings::getUserDataDir().filePath(dbFileName), newPath.filePath(dbFileName));
 }
 
@@ -762,12 +1073,24 @@ void Database::unload() {
    // We really don't want this function to be called twice on the same object or when we didn't get as far as making a
    // connection to the DB etc.
    if (!this->pimpl->loaded) {
-      qDebug() <<
+      qCDebug(Logging::db) <<
          Q_FUNC_INFO << "Nothing to do for Database object for" <<
          getDbNativeName(displayableDbType, this->pimpl->dbType) << "as not loaded";
       return;
    }
 
+   // Background threads have their own connections, which they close when they finish.  Destroying the worker pool
+   // also waits for any writes still queued on it.
+   this->pimpl->workerPool.reset();
+   this->pimpl->compactionThread.reset();
+   if (this->pimpl->automaticBackupThread) {
+      // If the backup finished after the event loop stopped, we won't yet have removed the old backups
+      this->pimpl->automaticBackupThread->wait();
+      this->pimpl->finishAutomaticBackup();
+      this->pimpl->automaticBackupThread.reset();
+   }
+   this->pimpl->sqliteCheckpointer.reset();
+
    // This RAII wrapper does all the hard work on mutex.lock() and mutex.unlock() in an exception-safe way
    QMutexLocker locker(&this->pimpl->mutex);
 
@@ -778,7 +1101,7 @@ void Database::unload() {
    QStringList allConnectionNames{QSqlDatabase::connectionNames()};
    for (QString conName : allConnectionNames) {
       if (0 == conName.indexOf(ourConnectionPrefix)) {
-         qDebug() << Q_FUNC_INFO << "Closing connection " << conName;
+         qCDebug(Logging::db) << Q_FUNC_INFO << "Closing connection " << conName;
          {
             //
             // Extra braces here are to ensure that this QSqlDatabase object is out of scope before the call to
@@ -792,22 +1115,21 @@ void Database::unload() {
          }
          QSqlDatabase::removeDatabase(conName);
       } else {
-         qDebug() <<
+         qCDebug(Logging::db) <<
             Q_FUNC_INFO << "Ignoring connection" << conName << "as does not start with" << ourConnectionPrefix;
       }
    }
 
-   qDebug() << Q_FUNC_INFO << "DB connections all closed";
+   qCDebug(Logging::db) << Q_FUNC_INFO << "DB connections all closed";
 
    if (this->pimpl->loadWasSuccessful && this->dbType() == Database::SQLITE ) {
       this->pimpl->dbFile.close();
-      this->pimpl->automaticBackup(*this);
    }
 
    this->pimpl->loaded = false;
    this->pimpl->loadWasSuccessful = false;
 
-   qDebug() << Q_FUNC_INFO << "Drop Instance done";
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Drop Instance done";
 
    return;
 }
@@ -859,13 +1181,31 @@ char const * Database::getDefaultBackupFileName() {
 }
 
 bool Database::backupToFile(QString newDbFileName) {
-   // Remove the files if they already exist so that
-   // the copy() operation will succeed.
-   QFile::remove(newDbFileName);
+   if (this->dbType() == Database::PGSQL) {
+      return this->pimpl->writeLogicalSnapshot(newDbFileName);
+   }
 
-   bool success = this->pimpl->dbFile.copy(newDbFileName);
+   DatabaseBackup backup{*this, newDbFileName};
+   if (this->pimpl->sqliteJournalMode != Database::SqliteJournalMode::Wal) {
+      // No other connection can read the DB in this mode, so we have to do it here
+      backup.runHere();
+   } else if (QCoreApplication::instance() != nullptr &&
+              QThread::currentThread() == QCoreApplication::instance()->thread()) {
+      //
+      // Keep the UI painting while we wait.  We don't want user input though, as the user could, eg, ask for another
+      // backup or close the program.
+      //
+      QEventLoop eventLoop;
+      QObject::connect(&backup, &QThread::finished, &eventLoop, &QEventLoop::quit);
+      backup.start();
+      eventLoop.exec(QEventLoop::ExcludeUserInputEvents);
+   } else {
+      backup.start();
+      backup.wait();
+   }
+   bool const success = backup.succeeded();
 
-   qDebug() << QString("Database backup to \"%1\" %2").arg(newDbFileName, success ? "succeeded" : "failed");
+   qCDebug(Logging::db) << QString("Database backup to \"%1\" %2").arg(newDbFileName, success ? "succeeded" : "failed");
 
    return success;
 }
@@ -888,12 +1228,73 @@ bool Database::restoreFromFile(QString newDbFileStr) {
       return false;
    }
 
-   bool success = newDbFile.copy(QString("%1.new").arg(this->pimpl->dbFile.fileName()));
+   QString const stagedFileName = QString("%1.new").arg(this->pimpl->dbFile.fileName());
+   QFile::remove(stagedFileName);
+   bool success = false;
+   if (DatabaseBackup::isCompressed(newDbFileStr)) {
+      success = DatabaseBackup::decompress(newDbFileStr, stagedFileName);
+   } else {
+      success = newDbFile.copy(stagedFileName);
+   }
    QFile::setPermissions( newDbFile.fileName(), QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup );
 
    return success;
 }
 
+void Database::automaticBackup() {
+   if (this->dbType() != Database::SQLITE) {
+      return;
+   }
+   StartupProfiler::Phase startupPhase{"Automatic database backup"};
+   this->pimpl->automaticBackup(*this);
+   return;
+}
+
+void Database::automaticCompaction() {
+   QDate const lastCompaction = PersistentSettings::value(PersistentSettings::Names::lastCompaction, QDate{}).toDate();
+   if (lastCompaction.isValid() && lastCompaction.daysTo(QDate::currentDate()) < COMPACTION_INTERVAL_DAYS) {
+      qCDebug(Logging::db) << Q_FUNC_INFO << "Last compaction was on" << lastCompaction << "so nothing to do";
+      return;
+   }
+   PersistentSettings::insert(PersistentSettings::Names::lastCompaction, QDate::currentDate());
+
+   this->pimpl->compactionThread = std::make_unique<DatabaseCompaction>(*this);
+   if (this->dbType() == Database::SQLITE &&
+       this->pimpl->sqliteJournalMode != Database::SqliteJournalMode::Wal) {
+      // No other connection can use the DB in this mode, so we have to do it here
+      this->pimpl->compactionThread->runHere();
+   } else {
+      this->pimpl->compactionThread->start(QThread::LowPriority);
+   }
+   return;
+}
+
+DatabaseWorkerPool * Database::workerPool() const {
+   return this->pimpl->workerPool.get();
+}
+
+bool Database::setNumWorkerConnections(int const numWorkerConnections) {
+   if (numWorkerConnections > 0 &&
+       this->dbType() == Database::SQLITE &&
+       this->pimpl->sqliteJournalMode != Database::SqliteJournalMode::Wal) {
+      qWarning() << Q_FUNC_INFO << "Can't have worker connections to SQLite unless it is in WAL mode";
+      return false;
+   }
+   // Destroying the old pool waits for any writes still queued on it
+   this->pimpl->workerPool.reset();
+   if (numWorkerConnections > 0) {
+      this->pimpl->workerPool = std::make_unique<DatabaseWorkerPool>(*this, numWorkerConnections);
+   }
+   return true;
+}
+
+QString Database::compactionReport() const {
+   if (!this->pimpl->compactionThread) {
+      return QString{};
+   }
+   return this->pimpl->compactionThread->report().toString();
+}
+
 bool Database::verifyDbConnection(Database::DbType testDb, QString const& hostname, int portnum, QString const& schema,
                                   QString const& database, QString const& username, QString const& password) {
    QString const testConnectionName{"testConnDb"};
@@ -946,7 +1347,8 @@ bool Database::verifyDbConnection(Database::DbType testDb, QString const& hostna
 
 void Database::convertDatabase(QString const& Hostname, QString const& DbName,
                                QString const& Username, QString const& Password,
-                               int Portnum, Database::DbType newType) {
+                               int Portnum, Database::DbType newType,
+                               std::function<void(QString const &, qint64, qint64)> const & progressHandler) {
    QSqlDatabase connectionNew;
 
    try {
@@ -971,7 +1373,9 @@ void Database::convertDatabase(QString const& Hostname, QString const& DbName,
       // Don't get newDatabase via Database::instance() as we don't want to use the connection details from
       // PersistentSettings (or to attempt to read data from newDatabase)
       Database newDatabase{newType};
-      DatabaseSchemaHelper::copyToNewDatabase(newDatabase, connectionNew);
+      if (!DatabaseSchemaHelper::migrateToNewDatabase(*this, newDatabase, connectionNew, progressHandler)) {
+         throw QString("Could not copy data to the new database.");
+      }
    }
    catch (QString e) {
       qCritical() << QString("%1 %2").arg(Q_FUNC_INFO).arg(e);
@@ -1106,7 +1510,7 @@ bool Database::updatePrimaryKeySequenceIfNecessary(QSqlDatabase & connection,
                return false;
             }
             if (query.next()) {
-               qInfo() <<
+               qCInfo(Logging::db) <<
                   Q_FUNC_INFO << "Updated sequence value for column" << columnName << "on table" << tableName << "to" <<
                   query.value(0);
             }
@@ -32,6 +32,7 @@
 #define DATABASE_H
 #pragma once
 
+#include <functional>
 #include <memory> // For PImpl
 
 #include <QCoreApplication>
@@ -40,6 +41,7 @@
 #include <QString>
 
 class BtStringConst;
+class DatabaseWorkerPool;
 
 /*!
  * \class Database
@@ -62,6 +64,25 @@ public:
       ALLDB      // Keep this one the last one, or bad things will happen
    };
 
+   /**
+    * \brief How SQLite writes changes to disk, set by the sqliteJournalMode setting ("wal" or "exclusive").
+    *
+    *        \c Wal (the default) uses a write-ahead log with synchronous = NORMAL.  A commit is just an append to the
+    *        WAL file, with no waiting for the disk, so edits are quick.  A power cut or OS crash can lose the last few
+    *        commits, but cannot corrupt the DB.  Other connections (worker threads, a backup, another process) can
+    *        read while we are writing.  Checkpoints (copying the WAL back into the DB file) are done by a background
+    *        thread -- see \c SqliteCheckpointer.
+    *
+    *        \c Exclusive is what we used to do: a rollback journal with synchronous = off and locking_mode =
+    *        EXCLUSIVE.  Commits are quick, but a power cut or OS crash part way through writing can corrupt the whole
+    *        DB, and no other connection can use the DB while we have it open.  It is kept for comparison (see the
+    *        sqliteUpdateLatency benchmark) and for file systems that do not support WAL (eg some network shares).
+    */
+   enum class SqliteJournalMode {
+      Wal,
+      Exclusive
+   };
+
    /*!
     * \brief This should be the ONLY way you get an instance.
     *
@@ -103,6 +124,30 @@ public:
     */
    QSqlDatabase sqlDatabase() const;
 
+   /**
+    * \brief Close and remove the calling thread's connection (if any) to the database.  A worker thread that has called
+    *        \c sqlDatabase() should call this before it finishes, otherwise the connection stays open until
+    *        \c unload().  As with \c QSqlDatabase::removeDatabase(), the caller must not still be holding any
+    *        \c QSqlDatabase or \c QSqlQuery objects for the connection.
+    */
+   void closeConnectionForThisThread();
+
+   /**
+    * \brief Set the options (PRAGMAs) for a newly-opened SQLite connection.  \c sqlDatabase() calls this for every
+    *        connection it opens.  It is exposed so that the benchmarks can try different settings on a scratch DB.
+    *
+    * \param isMainConnection \c true for the main thread's connection, which also sets the journal mode (which is
+    *                         stored in the DB file) and, in \c SqliteJournalMode::Exclusive mode, takes the lock
+    *
+    * \return \c false if there was an error
+    */
+   static bool setSqliteConnectionOptions(QSqlDatabase & connection,
+                                          SqliteJournalMode journalMode,
+                                          bool isMainConnection);
+
+   //! \return The journal mode in use (which is read from PersistentSettings when the DB is loaded)
+   SqliteJournalMode sqliteJournalMode() const;
+
    //! \brief Should be called when we are about to close down.
    void unload();
 
@@ -120,15 +165,65 @@ public:
 
    static char const * getDefaultBackupFileName();
 
-   //! backs up database to chosen file
+   /**
+    * \brief Backs up database to chosen file.
+    *
+    *        For SQLite, this is a consistent copy of the DB made while it is in use (see \c DatabaseBackup).  In
+    *        \c SqliteJournalMode::Wal mode, the copying is done on a background thread; if called from the main
+    *        thread, we keep the UI painting (but ignore user input) until it is done.
+    *
+    *        For PostgreSQL, we write a snapshot of all the data to a new SQLite DB file.
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
    bool backupToFile(QString newDbFileName);
 
    //! backs up database to 'dir' in chosen directory
    bool backupToDir(QString dir, QString filename="");
 
-   //! \brief Reverts database to that of chosen file.
+   //! \brief Reverts database to that of chosen file (which can be a compressed backup) the next time it is loaded.
    bool restoreFromFile(QString newDbFileStr);
 
+   /**
+    * \brief For SQLite, if it's been long enough since the last time (per the backup settings), back up the DB and
+    *        then remove the oldest backups.  In \c SqliteJournalMode::Wal mode the backup is done in the background
+    *        (see \c DatabaseBackup), but in \c SqliteJournalMode::Exclusive mode it has to be done on the calling
+    *        thread, so start-up can defer it (with the rest of the non-critical work) until the main window is shown.
+    *        MUST be called on the main thread, after \c load().
+    */
+   void automaticBackup();
+
+   /**
+    * \brief If it's been long enough since the last time, permanently remove soft-deleted objects that are no longer
+    *        used anywhere and then reclaim the space they took up, in the background where possible (see
+    *        \c DatabaseCompaction).  MUST be called on the main thread, once the user can start using the main window.
+    */
+   void automaticCompaction();
+
+   //! \return Description of what \c automaticCompaction() did in this session, or empty string if it didn't run
+   QString compactionReport() const;
+
+   /**
+    * \return The pool of worker connections on which \c ObjectStore queues writes so the main thread doesn't have to
+    *         wait for them (see \c DatabaseWorkerPool), or \c nullptr if writes should be done synchronously.
+    *
+    *         We only have a pool for PostgreSQL, where each statement is a network round-trip.  (SQLite is in-process
+    *         and only allows one writer at a time, so there's nothing to gain there.)  The number of connections comes
+    *         from the \c dbWorkerConnections setting; setting it to 0 turns the pool off.
+    */
+   DatabaseWorkerPool * workerPool() const;
+
+   /**
+    * \brief Replace the worker pool (see \c workerPool()) with one with the given number of connections, once
+    *        everything queued on the current one has been done.  0 means no pool.  This is what \c load() does, with
+    *        the number from the \c dbWorkerConnections setting, for PostgreSQL.  For SQLite, it is mostly useful for
+    *        testing, and is only allowed in \c SqliteJournalMode::Wal mode (as, otherwise, the workers could not use
+    *        the DB).  MUST be called on the main thread, with no \c DbTransaction open.
+    *
+    * \return \c false if the pool could not be started
+    */
+   bool setNumWorkerConnections(int numWorkerConnections);
+
    static bool verifyDbConnection(Database::DbType testDb,
                                   QString const& hostname,
                                   int portnum = 5432,
@@ -140,9 +235,12 @@ public:
 
    //! \brief Figures out what databases we are copying to and from, opens what
    //   needs opens and then calls the appropriate workhorse to get it done.
+   //   Throws a QString if the copy fails.  progressHandler, if set, is called as each batch of rows is copied (see
+   //   \c DatabaseMigration::progress).
    void convertDatabase(QString const& Hostname, QString const& DbName,
                         QString const& Username, QString const& Password,
-                        int Portnum, Database::DbType newType);
+                        int Portnum, Database::DbType newType,
+                        std::function<void(QString const &, qint64, qint64)> const & progressHandler = nullptr);
 
    /*!
     * \brief If we are supporting multiple databases, we need some way to
@@ -0,0 +1,233 @@
+/*
+ * database/DatabaseBackup.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "database/DatabaseBackup.h"
+
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlError>
+#include <QVersionNumber>
+
+#include "database/BtSqlQuery.h"
+#include "database/Database.h"
+#include "Logging.h"
+#include "utils/Metrics.h"
+
+namespace {
+   //! First version of SQLite to support VACUUM INTO
+   QVersionNumber const vacuumIntoMinVersion{3, 27, 0};
+
+   //! Without VACUUM INTO, how many times we try to get the DB into a state where we can copy the file
+   int constexpr MAX_COPY_ATTEMPTS = 5;
+
+   //! Every SQLite DB file starts with these 16 bytes (including the terminating null)
+   QByteArray const sqliteFileHeader{"SQLite format 3", 16};
+
+   //! \return The first \c sqliteFileHeader.size() bytes of the file, or an empty array if it can't be read
+   QByteArray readFileHeader(QString const & fileName) {
+      QFile file{fileName};
+      if (!file.open(QIODevice::ReadOnly)) {
+         return QByteArray{};
+      }
+      return file.read(sqliteFileHeader.size());
+   }
+}
+
+DatabaseBackup::DatabaseBackup(Database & database, QString const & fileName, bool compress) :
+   QThread{},
+   database{database},
+   fileName{fileName},
+   compress{compress},
+   backupSucceeded{false},
+   backupErrorMessage{} {
+   return;
+}
+
+DatabaseBackup::~DatabaseBackup() {
+   // A backup can't usefully be interrupted part way through, so we just have to wait for it
+   this->wait();
+   return;
+}
+
+bool DatabaseBackup::runHere() {
+   QSqlDatabase connection = this->database.sqlDatabase();
+   this->backupSucceeded = this->backup(connection);
+   return this->backupSucceeded;
+}
+
+bool DatabaseBackup::succeeded() const {
+   return this->backupSucceeded;
+}
+
+QString const & DatabaseBackup::errorMessage() const {
+   return this->backupErrorMessage;
+}
+
+void DatabaseBackup::run() {
+   {
+      // This needs to be out of scope before we call closeConnectionForThisThread()
+      QSqlDatabase connection = this->database.sqlDatabase();
+      this->backupSucceeded = this->backup(connection);
+   }
+   this->database.closeConnectionForThisThread();
+   return;
+}
+
+bool DatabaseBackup::backup(QSqlDatabase & connection) {
+   static Metrics::Histogram & backupLatency = Metrics::histogram("db.backup.latencyNs");
+   Metrics::ScopedLatency scopedLatency{backupLatency};
+
+   qCInfo(Logging::db) << Q_FUNC_INFO << "Backing up" << connection.databaseName() << "to" << this->fileName;
+
+   // VACUUM INTO refuses to write to a file that already exists and is not empty
+   QString const partialFileName = this->fileName + ".partial";
+   QFile::remove(partialFileName);
+
+   BtSqlQuery query{connection};
+   if (!query.exec("SELECT sqlite_version();") || !query.next()) {
+      this->backupErrorMessage = QString{"Could not get SQLite version: %1"}.arg(query.lastError().text());
+      qCritical() << Q_FUNC_INFO << this->backupErrorMessage;
+      return false;
+   }
+   QVersionNumber const sqliteVersion = QVersionNumber::fromString(query.value(0).toString());
+   query.finish();
+
+   if (sqliteVersion >= vacuumIntoMinVersion) {
+      query.prepare("VACUUM INTO :fileName;");
+      query.bindValue(":fileName", partialFileName);
+      if (!query.exec()) {
+         this->backupErrorMessage =
+            QString{"VACUUM INTO %1 failed: %2"}.arg(partialFileName, query.lastError().text());
+         qCritical() << Q_FUNC_INFO << this->backupErrorMessage;
+         QFile::remove(partialFileName);
+         return false;
+      }
+   } else {
+      //
+      // Empty the WAL (if there is one) into the DB file, then take the write lock so that no-one can add anything to
+      // the WAL, or change the DB file, while we are copying it.  (A checkpoint can run while someone else holds the
+      // write lock, but, with nothing in the WAL, it has nothing to write.)  We have to do the checkpoint first, as it
+      // can't be done inside a transaction, so, if someone else writes in between, we have to go round again.
+      //
+      qCInfo(Logging::db) <<
+         Q_FUNC_INFO << "SQLite" << sqliteVersion << "does not support VACUUM INTO, so copying file instead";
+      QString const dbFileName = connection.databaseName();
+      bool copied = false;
+      for (int attempt = 0; attempt < MAX_COPY_ATTEMPTS && !copied; ++attempt) {
+         query.exec("PRAGMA wal_checkpoint(TRUNCATE);");
+         query.finish();
+         if (!query.exec("BEGIN IMMEDIATE;")) {
+            this->backupErrorMessage = QString{"Could not lock DB for backup: %1"}.arg(query.lastError().text());
+            qCritical() << Q_FUNC_INFO << this->backupErrorMessage;
+            return false;
+         }
+         QFileInfo const walFileInfo{dbFileName + "-wal"};
+         if (!walFileInfo.exists() || walFileInfo.size() == 0) {
+            copied = QFile::copy(dbFileName, partialFileName);
+            if (!copied) {
+               // Trying again won't help
+               attempt = MAX_COPY_ATTEMPTS;
+            }
+         }
+         query.exec("ROLLBACK;");
+      }
+      if (!copied) {
+         this->backupErrorMessage = QString{"Could not copy %1 to %2"}.arg(dbFileName, partialFileName);
+         qCritical() << Q_FUNC_INFO << this->backupErrorMessage;
+         QFile::remove(partialFileName);
+         return false;
+      }
+   }
+
+   //
+   // Until the new backup is complete (including compression if requested), we leave any existing backup of the same
+   // name alone, so that a failure part way through never costs us the backup we already had.
+   //
+   QString completeFileName = partialFileName;
+   if (this->compress) {
+      QString const compressedFileName = partialFileName + ".qz.partial";
+      QFile partialFile{partialFileName};
+      QFile compressedFile{compressedFileName};
+      bool compressed = false;
+      if (partialFile.open(QIODevice::ReadOnly) && compressedFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+         QByteArray const compressedContents = qCompress(partialFile.readAll());
+         compressed = partialFile.error() == QFileDevice::NoError &&
+                      compressedFile.write(compressedContents) == compressedContents.size() &&
+                      compressedFile.flush();
+      }
+      partialFile.close();
+      // QFile::close() doesn't return anything, but sets the error if it couldn't write out what was buffered
+      compressedFile.close();
+      compressed = compressed && compressedFile.error() == QFileDevice::NoError;
+      partialFile.remove();
+      if (!compressed) {
+         this->backupErrorMessage = QString{"Could not compress %1 to %2: %3"}.arg(
+            partialFileName, compressedFileName, compressedFile.errorString()
+         );
+         qCritical() << Q_FUNC_INFO << this->backupErrorMessage;
+         // Don't leave a truncated backup lying around
+         QFile::remove(compressedFileName);
+         return false;
+      }
+      completeFileName = compressedFileName;
+   }
+
+   // QFile::rename() won't overwrite an existing file, so the old backup has to go first
+   if (QFile::exists(this->fileName) && !QFile::remove(this->fileName)) {
+      this->backupErrorMessage = QString{"Could not replace %1"}.arg(this->fileName);
+      qCritical() << Q_FUNC_INFO << this->backupErrorMessage;
+      QFile::remove(completeFileName);
+      return false;
+   }
+   if (!QFile::rename(completeFileName, this->fileName)) {
+      this->backupErrorMessage = QString{"Could not rename %1 to %2"}.arg(completeFileName, this->fileName);
+      qCritical() << Q_FUNC_INFO << this->backupErrorMessage;
+      QFile::remove(completeFileName);
+      return false;
+   }
+
+   qCInfo(Logging::db) << Q_FUNC_INFO << "Backup to" << this->fileName << "succeeded";
+   return true;
+}
+
+bool DatabaseBackup::isCompressed(QString const & fileName) {
+   QByteArray const header = readFileHeader(fileName);
+   return !header.isEmpty() && header != sqliteFileHeader;
+}
+
+bool DatabaseBackup::decompress(QString const & fileName, QString const & outputFileName) {
+   QFile inputFile{fileName};
+   if (!inputFile.open(QIODevice::ReadOnly)) {
+      qWarning() << Q_FUNC_INFO << "Could not read" << fileName;
+      return false;
+   }
+   QByteArray const contents = qUncompress(inputFile.readAll());
+   if (!contents.startsWith(sqliteFileHeader)) {
+      qWarning() << Q_FUNC_INFO << fileName << "is not a compressed SQLite DB";
+      return false;
+   }
+   QFile outputFile{outputFileName};
+   if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+       outputFile.write(contents) != contents.size()) {
+      qWarning() << Q_FUNC_INFO << "Could not write" << outputFileName;
+      return false;
+   }
+   return true;
+}
@@ -0,0 +1,101 @@
+/*
+ * database/DatabaseBackup.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATABASE_DATABASEBACKUP_H
+#define DATABASE_DATABASEBACKUP_H
+#pragma once
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QThread>
+
+class Database;
+
+/**
+ * \brief Makes a consistent copy of the SQLite DB while it is in use.
+ *
+ *        We can't just copy the DB file, as (a) in WAL mode, recent changes are in the "-wal" file and not yet in the
+ *        DB file, and (b) another connection could be changing the file while we copy it.  Instead, we ask SQLite to
+ *        write the copy, with VACUUM INTO, which reads the DB in a single read transaction and so sees a snapshot of
+ *        it.  In \c Database::SqliteJournalMode::Wal mode, a reader doesn't block the writer, so this can run on a
+ *        background thread (with its own connection) while the user carries on editing.  (In
+ *        \c Database::SqliteJournalMode::Exclusive mode, no other connection can read the DB, so the backup has to run
+ *        on the main thread -- see \c runHere().)
+ *
+ *        VACUUM INTO needs SQLite 3.27 or newer.  With older versions, we empty the WAL back into the DB file and then
+ *        copy the file while holding the write lock, which stops anyone else changing the DB for the (short) time it
+ *        takes.
+ *
+ *        The copy is written to a temporary file (and, optionally, compressed with \c qCompress into another one -- see
+ *        \c isCompressed() and \c decompress()).  Only once it is complete do we remove any existing backup of the same
+ *        name and rename the new one into its place, so we never leave a half-written backup with a valid-looking name,
+ *        nor lose the old backup when making the new one fails.
+ *
+ *        (For PostgreSQL, see \c Database::backupToFile, which writes a logical snapshot to an SQLite file instead.)
+ */
+class DatabaseBackup : public QThread {
+   // No signals or slots (other than those inherited from QThread), so no need for Q_OBJECT
+public:
+   /**
+    * \param fileName Where to write the backup.  Any existing file of this name will be replaced if the backup
+    *                 succeeds.
+    * \param compress Whether to compress the backup
+    */
+   DatabaseBackup(Database & database, QString const & fileName, bool compress = false);
+   ~DatabaseBackup();
+
+   /**
+    * \brief Do the backup on the calling thread, using its connection, rather than starting a new thread
+    *
+    * \return \c true if the backup succeeded, \c false otherwise
+    */
+   bool runHere();
+
+   //! \return \c true if the backup has finished and succeeded
+   bool succeeded() const;
+
+   //! \return Description of what went wrong, if the backup did not succeed
+   QString const & errorMessage() const;
+
+   /**
+    * \return \c true if \c fileName looks like a backup that we compressed, \c false if it looks like an uncompressed
+    *         SQLite DB (or can't be read)
+    */
+   static bool isCompressed(QString const & fileName);
+
+   /**
+    * \brief Uncompress a compressed backup to \c outputFileName
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   static bool decompress(QString const & fileName, QString const & outputFileName);
+
+protected:
+   virtual void run() override;
+
+private:
+   bool backup(QSqlDatabase & connection);
+
+   Database & database;
+   QString const fileName;
+   bool const compress;
+   bool backupSucceeded;
+   QString backupErrorMessage;
+};
+
+#endif
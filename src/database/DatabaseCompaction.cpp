@@ -0,0 +1,352 @@
+/*
+ * database/DatabaseCompaction.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "database/DatabaseCompaction.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QStringList>
+#include <QTextStream>
+
+#include "database/BtSqlQuery.h"
+#include "database/Database.h"
+#include "database/ObjectStoreTyped.h"
+#include "Logging.h"
+#include "utils/Metrics.h"
+
+namespace {
+   //! Value of PRAGMA auto_vacuum when it is set to INCREMENTAL
+   int constexpr SQLITE_AUTO_VACUUM_INCREMENTAL = 2;
+
+   //! Most pages we free in one go with PRAGMA incremental_vacuum (ie how much we hold the write lock for)
+   int constexpr SQLITE_PAGES_PER_STEP = 256;
+
+   //! How long we leave between steps, so that the main thread can get the write lock if it needs it
+   unsigned long constexpr PAUSE_BETWEEN_STEPS_MS = 50;
+
+   //! How a worker thread asks the main thread to run DatabaseCompaction::mainThreadWork
+   QEvent::Type mainThreadWorkEventType() {
+      static QEvent::Type const type = static_cast<QEvent::Type>(QEvent::registerEventType());
+      return type;
+   }
+
+   //! \return \c true if we are on the main (GUI) thread, which is where the object stores live
+   bool isMainThread() {
+      return QThread::currentThread() == QCoreApplication::instance()->thread();
+   }
+
+   //! \return Size of the DB in bytes, or -1 if we couldn't find out
+   qint64 databaseSizeBytes(Database const & database, QSqlDatabase & connection) {
+      BtSqlQuery query{connection};
+      if (database.dbType() == Database::PGSQL) {
+         if (!query.exec("SELECT pg_database_size(current_database());") || !query.next()) {
+            qWarning() << Q_FUNC_INFO << "Could not get DB size:" << query.lastError().text();
+            return -1;
+         }
+         return query.value(0).toLongLong();
+      }
+
+      if (!query.exec("PRAGMA page_count;") || !query.next()) {
+         qWarning() << Q_FUNC_INFO << "Could not get DB page count:" << query.lastError().text();
+         return -1;
+      }
+      qint64 const pageCount = query.value(0).toLongLong();
+      query.finish();
+      if (!query.exec("PRAGMA page_size;") || !query.next()) {
+         qWarning() << Q_FUNC_INFO << "Could not get DB page size:" << query.lastError().text();
+         return -1;
+      }
+      return pageCount * query.value(0).toLongLong();
+   }
+}
+
+QString DatabaseCompaction::Report::toString() const {
+   QString result;
+   QTextStream resultAsStream{&result};
+   int numPurged = 0;
+   for (int num : this->numPurgedByTable) {
+      numPurged += num;
+   }
+   resultAsStream << "Database compaction: purged " << numPurged << " soft-deleted object(s) no longer in use\n";
+   for (auto ii = this->numPurgedByTable.constBegin(); ii != this->numPurgedByTable.constEnd(); ++ii) {
+      resultAsStream << "   " << ii.key() << ": " << ii.value() << "\n";
+   }
+   if (this->bytesBefore >= 0) {
+      resultAsStream << "Database size before: " << this->bytesBefore / 1024 << " KiB\n";
+   }
+   if (this->bytesAfter >= 0) {
+      resultAsStream << "Database size after:  " << this->bytesAfter / 1024 << " KiB\n";
+   }
+   if (!this->errorMessage.isEmpty()) {
+      resultAsStream << "Error: " << this->errorMessage << "\n";
+   } else if (!this->finished) {
+      resultAsStream << "(Still reclaiming space)\n";
+   }
+   return result;
+}
+
+DatabaseCompaction::DatabaseCompaction(Database & database, int const batchSize) :
+   QThread{},
+   database{database},
+   batchSize{batchSize},
+   mutex{},
+   stopCondition{},
+   stopRequested{false},
+   mainThreadWork{},
+   mainThreadWorkDone{},
+   currentReport{} {
+   return;
+}
+
+DatabaseCompaction::~DatabaseCompaction() {
+   this->stop();
+   return;
+}
+
+bool DatabaseCompaction::runHere() {
+   // It's a coding error to call this from anywhere other than the main thread
+   Q_ASSERT(isMainThread());
+
+   QSqlDatabase connection = this->database.sqlDatabase();
+   this->recordBytesBefore(connection);
+   this->purge();
+   return this->reclaimSpace(connection);
+}
+
+void DatabaseCompaction::stop() {
+   {
+      QMutexLocker locker(&this->mutex);
+      this->stopRequested = true;
+      this->stopCondition.wakeAll();
+      this->mainThreadWorkDone.wakeAll();
+   }
+   this->wait();
+   return;
+}
+
+DatabaseCompaction::Report DatabaseCompaction::report() const {
+   QMutexLocker locker(&this->mutex);
+   return this->currentReport;
+}
+
+void DatabaseCompaction::run() {
+   {
+      // This needs to be out of scope before we call closeConnectionForThisThread()
+      QSqlDatabase connection = this->database.sqlDatabase();
+      this->recordBytesBefore(connection);
+      this->purge();
+      if (!this->isStopRequested()) {
+         this->reclaimSpace(connection);
+      }
+   }
+   this->database.closeConnectionForThisThread();
+   return;
+}
+
+void DatabaseCompaction::customEvent(QEvent * event) {
+   if (event->type() != mainThreadWorkEventType()) {
+      QThread::customEvent(event);
+      return;
+   }
+   std::function<void()> work;
+   {
+      QMutexLocker locker(&this->mutex);
+      work = this->mainThreadWork;
+   }
+   //
+   // If the worker gave up waiting because stop() was called, there's nothing to do.  Otherwise, it's still waiting,
+   // so anything the work refers to on its stack is still there.  (stop() is only called on this thread, so it can't
+   // be called while the work is running.)
+   //
+   if (work) {
+      work();
+   }
+   QMutexLocker locker(&this->mutex);
+   this->mainThreadWork = nullptr;
+   this->mainThreadWorkDone.wakeAll();
+   return;
+}
+
+void DatabaseCompaction::recordBytesBefore(QSqlDatabase & connection) {
+   qint64 const bytesBefore = databaseSizeBytes(this->database, connection);
+   QMutexLocker locker(&this->mutex);
+   this->currentReport.bytesBefore = bytesBefore;
+   return;
+}
+
+void DatabaseCompaction::purge() {
+   static Metrics::Counter & numObjectsPurged = Metrics::counter("db.compaction.objectsPurged");
+   bool purgedAnything = true;
+   while (purgedAnything && !this->isStopRequested()) {
+      purgedAnything = false;
+      QMap<QString, QVector<int> > softDeletedIds;
+      if (!this->runOnMainThread([&softDeletedIds]() { softDeletedIds = FindSoftDeleted(); })) {
+         return;
+      }
+      QMap<QString, QVector<int> > const idsToPurge = FindUnreferenced(softDeletedIds);
+      for (auto ii = idsToPurge.constBegin(); ii != idsToPurge.constEnd(); ++ii) {
+         QString const & tableName = ii.key();
+         for (int firstId = 0; firstId < ii.value().size(); firstId += this->batchSize) {
+            QVector<int> const batch = ii.value().mid(firstId, this->batchSize);
+            int numPurged = 0;
+            if (!this->runOnMainThread([&]() { numPurged = HardDeleteSoftDeleted(tableName, batch); })) {
+               return;
+            }
+            if (numPurged > 0) {
+               purgedAnything = true;
+               numObjectsPurged.add(numPurged);
+               QMutexLocker locker(&this->mutex);
+               this->currentReport.numPurgedByTable[tableName] += numPurged;
+            }
+         }
+      }
+   }
+   return;
+}
+
+bool DatabaseCompaction::runOnMainThread(std::function<void()> work) {
+   if (isMainThread()) {
+      work();
+      return true;
+   }
+
+   QMutexLocker locker(&this->mutex);
+   this->mainThreadWork = std::move(work);
+   // Qt takes ownership of the event
+   QCoreApplication::postEvent(this, new QEvent{mainThreadWorkEventType()});
+   while (this->mainThreadWork && !this->stopRequested) {
+      this->mainThreadWorkDone.wait(&this->mutex);
+   }
+   // If we were asked to stop before the main thread got to the work, make sure it never does
+   bool const done = !this->mainThreadWork;
+   this->mainThreadWork = nullptr;
+   return done;
+}
+
+bool DatabaseCompaction::isStopRequested(unsigned long const waitMs) {
+   QMutexLocker locker(&this->mutex);
+   // Only pause if we're on our own thread -- no point holding up the caller of runHere()
+   if (!this->stopRequested && waitMs > 0 && QThread::currentThread() == this) {
+      this->stopCondition.wait(&this->mutex, waitMs);
+   }
+   return this->stopRequested;
+}
+
+bool DatabaseCompaction::reclaimSpace(QSqlDatabase & connection) {
+   static Metrics::Histogram & reclaimLatency = Metrics::histogram("db.compaction.reclaimLatencyNs");
+   Metrics::ScopedLatency scopedLatency{reclaimLatency};
+
+   qCInfo(Logging::db) << Q_FUNC_INFO << "Reclaiming space in" << connection.databaseName();
+   bool const succeeded = this->database.dbType() == Database::PGSQL ? this->reclaimSpacePgsql(connection) :
+                                                                       this->reclaimSpaceSqlite(connection);
+   qint64 const bytesAfter = databaseSizeBytes(this->database, connection);
+
+   QMutexLocker locker(&this->mutex);
+   this->currentReport.bytesAfter = bytesAfter;
+   this->currentReport.finished = succeeded && !this->stopRequested;
+   qCInfo(Logging::db).noquote() << Q_FUNC_INFO << this->currentReport.toString();
+   return succeeded;
+}
+
+bool DatabaseCompaction::reclaimSpaceSqlite(QSqlDatabase & connection) {
+   BtSqlQuery query{connection};
+   if (!query.exec("PRAGMA auto_vacuum;") || !query.next()) {
+      QMutexLocker locker(&this->mutex);
+      this->currentReport.errorMessage = QString{"Could not read auto_vacuum: %1"}.arg(query.lastError().text());
+      qWarning() << Q_FUNC_INFO << this->currentReport.errorMessage;
+      return false;
+   }
+   int const autoVacuum = query.value(0).toInt();
+   query.finish();
+
+   if (autoVacuum != SQLITE_AUTO_VACUUM_INCREMENTAL) {
+      // See class comment for why we don't do the full VACUUM that would be needed to change this
+      qCInfo(Logging::db) <<
+         Q_FUNC_INFO << "Incremental auto-vacuum is not enabled for this DB, so just running ANALYZE";
+   } else {
+      int previousFreePages = -1;
+      while (!this->isStopRequested()) {
+         if (!query.exec("PRAGMA freelist_count;") || !query.next()) {
+            QMutexLocker locker(&this->mutex);
+            this->currentReport.errorMessage = QString{"Could not read freelist_count: %1"}.arg(
+               query.lastError().text()
+            );
+            qWarning() << Q_FUNC_INFO << this->currentReport.errorMessage;
+            return false;
+         }
+         int const freePages = query.value(0).toInt();
+         query.finish();
+         // Stop if there's nothing left to do, or if the last step didn't manage to do anything
+         if (freePages == 0 || freePages == previousFreePages) {
+            break;
+         }
+         previousFreePages = freePages;
+
+         qCDebug(Logging::db) << Q_FUNC_INFO << freePages << "free pages";
+         if (!query.exec(QString{"PRAGMA incremental_vacuum(%1);"}.arg(SQLITE_PAGES_PER_STEP))) {
+            QMutexLocker locker(&this->mutex);
+            this->currentReport.errorMessage = QString{"incremental_vacuum failed: %1"}.arg(query.lastError().text());
+            qWarning() << Q_FUNC_INFO << this->currentReport.errorMessage;
+            return false;
+         }
+         // Some versions of SQLite only free one page each time the statement is stepped, so step it to the end
+         while (query.next()) {
+         }
+         query.finish();
+
+         if (this->isStopRequested(PAUSE_BETWEEN_STEPS_MS)) {
+            return true;
+         }
+      }
+   }
+
+   if (this->isStopRequested()) {
+      return true;
+   }
+   if (!query.exec("ANALYZE;")) {
+      QMutexLocker locker(&this->mutex);
+      this->currentReport.errorMessage = QString{"ANALYZE failed: %1"}.arg(query.lastError().text());
+      qWarning() << Q_FUNC_INFO << this->currentReport.errorMessage;
+      return false;
+   }
+   return true;
+}
+
+bool DatabaseCompaction::reclaimSpacePgsql(QSqlDatabase & connection) {
+   //
+   // VACUUM can't run inside a transaction, but it doesn't need to -- each one is independent.  Doing one table at a
+   // time means we can stop between tables if asked to.  Unlike VACUUM FULL, plain VACUUM doesn't lock out other
+   // connections, but it also mostly just makes the space available for reuse rather than shrinking the files.
+   //
+   for (auto const * table : GetAllTableDefinitions()) {
+      if (this->isStopRequested(PAUSE_BETWEEN_STEPS_MS)) {
+         return true;
+      }
+      BtSqlQuery query{connection};
+      if (!query.exec(QString{"VACUUM (ANALYZE) %1;"}.arg(*table->tableName))) {
+         QMutexLocker locker(&this->mutex);
+         this->currentReport.errorMessage = QString{"VACUUM of %1 failed: %2"}.arg(*table->tableName,
+                                                                                   query.lastError().text());
+         qWarning() << Q_FUNC_INFO << this->currentReport.errorMessage;
+         return false;
+      }
+   }
+   return true;
+}
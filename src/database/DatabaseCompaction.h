@@ -0,0 +1,142 @@
+/*
+ * database/DatabaseCompaction.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATABASE_DATABASECOMPACTION_H
+#define DATABASE_DATABASECOMPACTION_H
+#pragma once
+
+#include <functional>
+
+#include <QEvent>
+#include <QMap>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+class Database;
+
+/**
+ * \brief Gets rid of soft-deleted objects that are no longer needed, and then gives the space they took up back to
+ *        the file system.
+ *
+ *        When the user deletes something, \c ObjectStoreTyped::softDelete just marks it deleted, so it stays in the DB
+ *        and in the object store, and every \c getAll, \c findAllMatching, tree load etc has to skip over it.  Over
+ *        years of use, this adds up.  Compaction is in two stages:
+ *          - First we purge, ie hard delete, the soft-deleted objects that nothing else in the DB refers to (see
+ *            \c FindUnreferenced).  Anything still used -- eg a deleted \c Hop that is the parent of one in a
+ *            \c Recipe, or a deleted \c Recipe that has \c BrewNote objects -- is left alone.  Purging one object can
+ *            leave others unreferenced (eg a deleted \c Mash whose deleted \c MashStep objects were purged first), so
+ *            we keep going until there is nothing more to purge.  Checking for references is all DB reads, so we do
+ *            it on our own thread, but the object stores live on the main thread, so that is where the objects are
+ *            deleted: a batch at a time, one transaction per batch, via the event loop (see \c runOnMainThread()).
+ *          - Then we reclaim the space and update the query planner statistics:
+ *               - for SQLite, with PRAGMA incremental_vacuum, a few pages at a time so that we never hold the write
+ *                 lock for long, followed by ANALYZE.  Incremental vacuum needs auto_vacuum to be INCREMENTAL, which
+ *                 \c DatabaseSchemaHelper::create sets for new DBs.  An existing DB can only be switched over by a
+ *                 full VACUUM, which would hold the write lock (and so block the user's changes) for as long as it
+ *                 takes, so we don't do that, and just run ANALYZE for those DBs.
+ *               - for PostgreSQL, with VACUUM (ANALYZE), one table at a time.
+ *
+ *        All of this is normally done by \c start() on a background thread with its own connection.  But, for SQLite
+ *        in \c Database::SqliteJournalMode::Exclusive mode, no other connection can use the DB, so \c runHere() does
+ *        it all on the main thread.
+ *
+ *        \c report() says what was purged and how the size of the DB changed.
+ */
+class DatabaseCompaction : public QThread {
+   // No signals or slots (other than those inherited from QThread), so no need for Q_OBJECT
+public:
+   /**
+    * \brief What a compaction did
+    */
+   struct Report {
+      //! Number of objects purged, by table name
+      QMap<QString, int> numPurgedByTable;
+      //! Size of the DB before purging, or -1 if not known
+      qint64 bytesBefore = -1;
+      //! Size of the DB after reclaiming space, or -1 if not known (including if we haven't got that far yet)
+      qint64 bytesAfter = -1;
+      //! \c true once the space has been reclaimed
+      bool finished = false;
+      //! Set if something went wrong
+      QString errorMessage;
+
+      //! \return Human-readable description of the above, eg for \c DiagnosticsDialog
+      QString toString() const;
+   };
+
+   /**
+    * \param database
+    * \param batchSize How many objects to delete in each DB transaction
+    */
+   DatabaseCompaction(Database & database, int batchSize = 100);
+   ~DatabaseCompaction();
+
+   /**
+    * \brief Purge and reclaim space on the calling thread, using its connection, rather than starting a new thread.
+    *        MUST be called on the main thread.
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool runHere();
+
+   //! \brief Ask the thread to finish as soon as it can (ie between steps of reclaiming space), and wait until it has
+   void stop();
+
+   //! \return Copy of what we've done so far.  Safe to call from any thread.
+   Report report() const;
+
+protected:
+   virtual void run() override;
+
+   //! \brief This is where the main thread does the work passed to \c runOnMainThread()
+   virtual void customEvent(QEvent * event) override;
+
+private:
+   //! \brief Record the size of the DB before we start
+   void recordBytesBefore(QSqlDatabase & connection);
+   //! \brief Hard delete everything we can (see class comment)
+   void purge();
+   /**
+    * \brief Run \c work on the main thread and wait for it to finish.  If we are on the main thread, it is just run
+    *        here and now.
+    *
+    * \return \c false if \c stop() was called before \c work could run (in which case it won't)
+    */
+   bool runOnMainThread(std::function<void()> work);
+   bool reclaimSpace(QSqlDatabase & connection);
+   bool reclaimSpaceSqlite(QSqlDatabase & connection);
+   bool reclaimSpacePgsql(QSqlDatabase & connection);
+   //! \return \c true if \c stop() has been called, waiting up to \c waitMs for it to be called if not
+   bool isStopRequested(unsigned long waitMs = 0);
+
+   Database & database;
+   int const batchSize;
+
+   mutable QMutex mutex;
+   QWaitCondition stopCondition;
+   bool stopRequested;
+   //! Work waiting to be done by the main thread, or \c nullptr if there isn't any
+   std::function<void()> mainThreadWork;
+   QWaitCondition mainThreadWorkDone;
+   Report currentReport;
+};
+
+#endif
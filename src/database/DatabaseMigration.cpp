@@ -0,0 +1,556 @@
+/*
+ * database/DatabaseMigration.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "database/DatabaseMigration.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDate>
+#include <QDebug>
+#include <QEventLoop>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QSqlError>
+#include <QStringList>
+#include <QThread>
+#include <QtEndian>
+
+#include "database/BtSqlQuery.h"
+#include "database/Database.h"
+#include "database/DatabaseWorkerPool.h"
+#include "database/DbTransaction.h"
+#include "Logging.h"
+#include "utils/Metrics.h"
+
+namespace {
+   //
+   // Most bind values we put in one INSERT statement.  Older versions of SQLite have a limit of 999 (raised to 32766
+   // in SQLite 3.32).  PostgreSQL allows many more, but there is not much to be gained from bigger batches once we're
+   // down to one round trip per few hundred rows.
+   //
+   int constexpr MAX_BIND_VALUES = 999;
+
+   //! Most tables we copy at once (and therefore most pairs of connections we have open)
+   int constexpr MAX_WORKERS = 4;
+
+   //! No signals or slots, so no need for Q_OBJECT
+   class WorkerThread : public QThread {
+   public:
+      WorkerThread(std::function<void()> work) : QThread{}, work{work} {
+         return;
+      }
+      ~WorkerThread() {
+         this->wait();
+         return;
+      }
+   protected:
+      virtual void run() override {
+         this->work();
+         return;
+      }
+   private:
+      std::function<void()> const work;
+   };
+
+   /**
+    * \brief Convert a value read from a DB to the type we want for the field, so that (a) we write the right thing to
+    *        the other DB (eg SQLite stores bools as integers, but PostgreSQL won't accept an integer for a boolean
+    *        column) and (b) we can compare what was read from two different DBs.
+    *
+    * \param rowContents The canonical text of the value is appended to this, for the row checksum.  Doubles are only
+    *                    written to 15 significant digits, as not every DB/driver combination round-trips all 17.
+    */
+   QVariant normaliseValue(QVariant const & value, ObjectStore::FieldType const fieldType, QByteArray & rowContents) {
+      QVariant normalisedValue;
+      if (value.isNull()) {
+         rowContents += '\x01';
+         switch (fieldType) {
+            case ObjectStore::Bool:   normalisedValue = QVariant{QVariant::Bool};   break;
+            case ObjectStore::Int:    normalisedValue = QVariant{QVariant::Int};    break;
+            case ObjectStore::UInt:   normalisedValue = QVariant{QVariant::UInt};   break;
+            case ObjectStore::Double: normalisedValue = QVariant{QVariant::Double}; break;
+            case ObjectStore::Date:   normalisedValue = QVariant{QVariant::Date};   break;
+            case ObjectStore::String:
+            case ObjectStore::Enum:   normalisedValue = QVariant{QVariant::String}; break;
+         }
+      } else {
+         switch (fieldType) {
+            case ObjectStore::Bool:
+               normalisedValue = value.toBool();
+               rowContents += value.toBool() ? '1' : '0';
+               break;
+            case ObjectStore::Int:
+               normalisedValue = value.toInt();
+               rowContents += QByteArray::number(value.toInt());
+               break;
+            case ObjectStore::UInt:
+               normalisedValue = value.toUInt();
+               rowContents += QByteArray::number(value.toUInt());
+               break;
+            case ObjectStore::Double:
+               normalisedValue = value.toDouble();
+               rowContents += QByteArray::number(value.toDouble(), 'g', 15);
+               break;
+            case ObjectStore::Date:
+               normalisedValue = value.toDate();
+               rowContents += value.toDate().toString(Qt::ISODate).toUtf8();
+               break;
+            case ObjectStore::String:
+            case ObjectStore::Enum:
+               normalisedValue = value.toString();
+               rowContents += value.toString().toUtf8();
+               break;
+         }
+      }
+      rowContents += '\x1f';
+      return normalisedValue;
+   }
+
+   /**
+    * \return A checksum for one row.  We add these up for all the rows in a table, which gives a checksum for the
+    *         table that doesn't depend on the order the rows are read in.
+    */
+   quint64 rowChecksum(QByteArray const & rowContents) {
+      QByteArray const hash = QCryptographicHash::hash(rowContents, QCryptographicHash::Sha1);
+      return qFromLittleEndian<quint64>(hash.constData());
+   }
+
+   //! \return INSERT statement for \c numRows rows
+   QString insertSql(QString const & tableName, QStringList const & columnNames, int const numRows) {
+      QStringList placeholders;
+      for (int ii = 0; ii < columnNames.size(); ++ii) {
+         placeholders.append("?");
+      }
+      QString const rowPlaceholders = QString{"(%1)"}.arg(placeholders.join(", "));
+      QStringList allRowPlaceholders;
+      for (int ii = 0; ii < numRows; ++ii) {
+         allRowPlaceholders.append(rowPlaceholders);
+      }
+      return QString{"INSERT INTO %1 (%2) VALUES %3"}.arg(tableName,
+                                                           columnNames.join(", "),
+                                                           allRowPlaceholders.join(", "));
+   }
+}
+
+// This private implementation class holds all private non-virtual members of DatabaseMigration
+class DatabaseMigration::impl {
+public:
+   struct TableToCopy {
+      ObjectStore::TableDefinition const * definition;
+      //! Number of rows when we started, used for progress
+      qint64 numRows;
+   };
+
+   impl(DatabaseMigration & self,
+        Database & sourceDatabase,
+        Database & targetDatabase,
+        QSqlDatabase & targetConnection,
+        QVector<ObjectStore::TableDefinition const *> const & tables) :
+      self{self},
+      sourceDatabase{sourceDatabase},
+      targetDatabase{targetDatabase},
+      targetConnection{targetConnection},
+      targetDriverName{targetConnection.driverName()},
+      targetHostName{targetConnection.hostName()},
+      targetDatabaseName{targetConnection.databaseName()},
+      targetUserName{targetConnection.userName()},
+      targetPassword{targetConnection.password()},
+      targetPort{targetConnection.port()},
+      targetConnectOptions{targetConnection.connectOptions()},
+      tables{tables},
+      tablesToCopy{},
+      nextTableIndex{0},
+      numRowsCopied{0},
+      numRows{0},
+      copyOnCallingThread{false},
+      failed{false},
+      mutex{},
+      errorMessage{} {
+      return;
+   }
+
+   ~impl() = default;
+
+   /**
+    * \brief Record the first thing that went wrong and tell all the workers to stop
+    */
+   void setError(QString const & message) {
+      qCritical() << Q_FUNC_INFO << message;
+      QMutexLocker locker(&this->mutex);
+      if (!this->failed) {
+         this->errorMessage = message;
+         this->failed = true;
+      }
+      return;
+   }
+
+   /**
+    * \brief Work out how many rows there are in each table, so we can show progress and copy the biggest tables first
+    *        (which, with several workers, usually means we finish sooner)
+    */
+   bool countRows(QSqlDatabase & source) {
+      QSet<QString> tableNames;
+      for (auto table : this->tables) {
+         QString const tableName = *table->tableName;
+         // Skip duplicates, just in case
+         if (tableNames.contains(tableName)) {
+            continue;
+         }
+         tableNames.insert(tableName);
+         BtSqlQuery query{source};
+         if (!query.exec(QString{"SELECT COUNT(*) FROM %1"}.arg(tableName)) || !query.next()) {
+            this->setError(QString{"Could not count rows in %1: %2"}.arg(tableName, query.lastError().text()));
+            return false;
+         }
+         this->tablesToCopy.append(TableToCopy{table, query.value(0).toLongLong()});
+         this->numRows += this->tablesToCopy.last().numRows;
+      }
+      std::sort(this->tablesToCopy.begin(),
+                this->tablesToCopy.end(),
+                [](TableToCopy const & lhs, TableToCopy const & rhs) { return lhs.numRows > rhs.numRows; });
+      qCInfo(Logging::db) <<
+         Q_FUNC_INFO << "Copying" << this->numRows << "rows in" << this->tablesToCopy.size() << "tables";
+      return true;
+   }
+
+   //! \return The next table for a worker to copy, or \c nullptr if there are no more (or we've given up)
+   TableToCopy const * nextTable() {
+      int const tableIndex = this->nextTableIndex++;
+      if (this->failed || tableIndex >= this->tablesToCopy.size()) {
+         return nullptr;
+      }
+      return &this->tablesToCopy.at(tableIndex);
+   }
+
+   //! \brief Keep copying tables until there are none left
+   void copyTables(QSqlDatabase & source, QSqlDatabase & target) {
+      try {
+         for (TableToCopy const * table = this->nextTable(); table; table = this->nextTable()) {
+            if (!this->copyTable(source, target, *table)) {
+               return;
+            }
+         }
+      } catch (std::exception const & exception) {
+         // BtSqlQuery throws if it can't prepare a statement
+         this->setError(exception.what());
+      }
+      return;
+   }
+
+   /**
+    * \brief What each worker thread does.  Source connection comes from \c Database, as usual.  Target connection is
+    *        set up in the same way as \c targetConnection.
+    */
+   void runWorker(int const workerNumber) {
+      QString const targetConnectionName = QString{"migration-%1"}.arg(workerNumber);
+      try {
+         // Connections need to be out of scope before we remove them
+         QSqlDatabase source = this->sourceDatabase.sqlDatabase();
+         QSqlDatabase target = QSqlDatabase::addDatabase(this->targetDriverName, targetConnectionName);
+         target.setHostName(this->targetHostName);
+         target.setDatabaseName(this->targetDatabaseName);
+         target.setUserName(this->targetUserName);
+         target.setPassword(this->targetPassword);
+         target.setPort(this->targetPort);
+         target.setConnectOptions(this->targetConnectOptions);
+         if (target.open()) {
+            this->copyTables(source, target);
+            target.close();
+         } else {
+            this->setError(QString{"Could not open new DB: %1"}.arg(target.lastError().text()));
+         }
+      } catch (QString const & errorMessage) {
+         // Database::sqlDatabase() throws if it can't open the connection
+         this->setError(errorMessage);
+      }
+      QSqlDatabase::removeDatabase(targetConnectionName);
+      this->sourceDatabase.closeConnectionForThisThread();
+      return;
+   }
+
+   //! \brief Write one batch of rows
+   bool writeBatch(BtSqlQuery & insert, QString const & tableName, QVector<QVariant> const & values) {
+      for (int ii = 0; ii < values.size(); ++ii) {
+         insert.bindValue(ii, values.at(ii));
+      }
+      if (!insert.exec()) {
+         this->setError(QString{"Error writing to %1: %2"}.arg(tableName, insert.lastError().text()));
+         return false;
+      }
+      return true;
+   }
+
+   /**
+    * \brief Read all rows of a table and add up their checksums
+    *
+    * \param writeBatchFunction If set, called with each batch of rows (as normalised values) as they are read
+    *
+    * \return \c false if there was an error
+    */
+   bool readTable(QSqlDatabase & connection,
+                  ObjectStore::TableDefinition const & table,
+                  qint64 & numRowsRead,
+                  quint64 & checksum,
+                  std::function<bool(QVector<QVariant> const &)> const & writeBatchFunction = nullptr) {
+      auto const & fields = table.tableFields;
+      QStringList columnNames;
+      for (auto const & field : fields) {
+         columnNames.append(*field.columnName);
+      }
+      int const batchSize = std::max(1, MAX_BIND_VALUES / fields.size()) * fields.size();
+
+      BtSqlQuery select{connection};
+      select.setForwardOnly(true);
+      if (!select.exec(QString{"SELECT %1 FROM %2"}.arg(columnNames.join(", "), *table.tableName))) {
+         this->setError(QString{"Error reading %1: %2"}.arg(*table.tableName, select.lastError().text()));
+         return false;
+      }
+
+      numRowsRead = 0;
+      checksum = 0;
+      QVector<QVariant> batch;
+      batch.reserve(batchSize);
+      while (select.next()) {
+         QByteArray rowContents;
+         for (int ii = 0; ii < fields.size(); ++ii) {
+            batch.append(normaliseValue(select.value(ii), fields.at(ii).fieldType, rowContents));
+         }
+         checksum += rowChecksum(rowContents);
+         ++numRowsRead;
+         if (batch.size() == batchSize) {
+            if (writeBatchFunction && !writeBatchFunction(batch)) {
+               return false;
+            }
+            batch.clear();
+         }
+         if (this->failed) {
+            // Another worker has had a problem, so no point carrying on
+            return false;
+         }
+      }
+      if (select.lastError().isValid()) {
+         this->setError(QString{"Error reading %1: %2"}.arg(*table.tableName, select.lastError().text()));
+         return false;
+      }
+      if (!batch.isEmpty() && writeBatchFunction && !writeBatchFunction(batch)) {
+         return false;
+      }
+      return true;
+   }
+
+   //! \brief Copy one table and check that what's in the target matches what we read from the source
+   bool copyTable(QSqlDatabase & source, QSqlDatabase & target, TableToCopy const & table) {
+      static Metrics::Histogram & copyTableLatency = Metrics::histogram("db.migrationCopyTable.latencyNs");
+      Metrics::ScopedLatency scopedLatency{copyTableLatency};
+
+      QString const tableName = *table.definition->tableName;
+      auto const & fields = table.definition->tableFields;
+      qCDebug(Logging::db) << Q_FUNC_INFO << "Copying" << table.numRows << "rows of" << tableName;
+
+      QStringList columnNames;
+      for (auto const & field : fields) {
+         columnNames.append(*field.columnName);
+      }
+      int const rowsPerBatch = std::max(1, MAX_BIND_VALUES / fields.size());
+
+      qint64 sourceNumRows = 0;
+      quint64 sourceChecksum = 0;
+      {
+         // Foreign keys are off while we copy, as the tables they refer to might not have been copied yet
+         DbTransaction dbTransaction{this->targetDatabase, target, DbTransaction::DISABLE_FOREIGN_KEYS};
+
+         BtSqlQuery insert{target};
+         insert.prepare(insertSql(tableName, columnNames, rowsPerBatch));
+         auto writeBatchFunction = [&](QVector<QVariant> const & batch) {
+            int const rowsInBatch = batch.size() / fields.size();
+            bool succeeded = false;
+            if (rowsInBatch == rowsPerBatch) {
+               succeeded = this->writeBatch(insert, tableName, batch);
+            } else {
+               // Last batch of the table is usually shorter
+               BtSqlQuery lastInsert{target};
+               lastInsert.prepare(insertSql(tableName, columnNames, rowsInBatch));
+               succeeded = this->writeBatch(lastInsert, tableName, batch);
+            }
+            if (succeeded) {
+               qint64 const numRowsCopied = this->numRowsCopied += rowsInBatch;
+               emit this->self.progress(tableName, numRowsCopied, this->numRows);
+            }
+            return succeeded;
+         };
+         if (!this->readTable(source, *table.definition, sourceNumRows, sourceChecksum, writeBatchFunction)) {
+            return false;
+         }
+         if (!dbTransaction.commit()) {
+            this->setError(QString{"Error committing %1: %2"}.arg(tableName, target.lastError().text()));
+            return false;
+         }
+      }
+
+      // We wrote the primary keys ourselves, so some DBs need to be told what the next one is
+      if (!fields.isEmpty() && fields.first().fieldType == ObjectStore::Int) {
+         this->targetDatabase.updatePrimaryKeySequenceIfNecessary(target,
+                                                                  table.definition->tableName,
+                                                                  fields.first().columnName);
+      }
+
+      qint64 targetNumRows = 0;
+      quint64 targetChecksum = 0;
+      if (!this->readTable(target, *table.definition, targetNumRows, targetChecksum)) {
+         return false;
+      }
+      if (targetNumRows != sourceNumRows || targetChecksum != sourceChecksum) {
+         this->setError(
+            QString{"Copy of %1 does not match: read %2 rows (checksum %3) but wrote %4 rows (checksum %5)"}.arg(
+               tableName
+            ).arg(sourceNumRows).arg(sourceChecksum, 0, 16).arg(targetNumRows).arg(targetChecksum, 0, 16)
+         );
+         return false;
+      }
+      qCInfo(Logging::db) <<
+         Q_FUNC_INFO << "Copied and verified" << targetNumRows << "rows of" << tableName << "( checksum" <<
+         QString::number(targetChecksum, 16) << ")";
+      return true;
+   }
+
+   DatabaseMigration & self;
+   Database & sourceDatabase;
+   Database & targetDatabase;
+   //! Only to be used on the thread that called run()
+   QSqlDatabase & targetConnection;
+
+   // Settings for opening more connections to the target DB
+   QString const targetDriverName;
+   QString const targetHostName;
+   QString const targetDatabaseName;
+   QString const targetUserName;
+   QString const targetPassword;
+   int const targetPort;
+   QString const targetConnectOptions;
+
+   QVector<ObjectStore::TableDefinition const *> const tables;
+   QVector<TableToCopy> tablesToCopy;
+   std::atomic<int> nextTableIndex;
+   std::atomic<qint64> numRowsCopied;
+   qint64 numRows;
+   bool copyOnCallingThread;
+   std::atomic<bool> failed;
+
+   //! Guards errorMessage
+   QMutex mutex;
+   QString errorMessage;
+};
+
+DatabaseMigration::DatabaseMigration(Database & sourceDatabase,
+                                     Database & targetDatabase,
+                                     QSqlDatabase & targetConnection,
+                                     QVector<ObjectStore::TableDefinition const *> const & tables,
+                                     QObject * parent) :
+   QObject{parent},
+   pimpl{std::make_unique<impl>(*this, sourceDatabase, targetDatabase, targetConnection, tables)} {
+   return;
+}
+
+// See https://herbsutter.com/gotw/_100/ for why we need to explicitly define the destructor here (and not in the
+// header file)
+DatabaseMigration::~DatabaseMigration() = default;
+
+bool DatabaseMigration::run() {
+   static Metrics::Histogram & migrationLatency = Metrics::histogram("db.migration.latencyNs");
+   Metrics::ScopedLatency scopedLatency{migrationLatency};
+
+   // Make sure we copy any changes that are still queued to be written to the source DB
+   DatabaseWorkerPool * workerPool = this->pimpl->sourceDatabase.workerPool();
+   if (workerPool) {
+      workerPool->waitForAll();
+   }
+
+   {
+      // This needs to be out of scope before any worker thread could remove a connection
+      QSqlDatabase source = this->pimpl->sourceDatabase.sqlDatabase();
+      if (!this->pimpl->countRows(source)) {
+         return false;
+      }
+
+      if (this->pimpl->copyOnCallingThread ||
+          (this->pimpl->sourceDatabase.dbType() == Database::SQLITE &&
+           this->pimpl->sourceDatabase.sqliteJournalMode() == Database::SqliteJournalMode::Exclusive)) {
+         // In exclusive mode, no other connection can read the source DB, so we have to do it all here
+         this->pimpl->copyTables(source, this->pimpl->targetConnection);
+         return !this->pimpl->failed;
+      }
+   }
+
+   // SQLite only allows one writer at a time, so there's no point in having more than one worker
+   int numWorkers = 1;
+   if (this->pimpl->targetDatabase.dbType() == Database::PGSQL) {
+      numWorkers = qBound(1, QThread::idealThreadCount(), MAX_WORKERS);
+   }
+   numWorkers = std::min(numWorkers, this->pimpl->tablesToCopy.size());
+
+   std::vector<std::unique_ptr<WorkerThread>> workers;
+   for (int ii = 0; ii < numWorkers; ++ii) {
+      workers.push_back(std::make_unique<WorkerThread>([this, ii]() { this->pimpl->runWorker(ii); }));
+   }
+
+   if (QCoreApplication::instance() != nullptr &&
+       QThread::currentThread() == QCoreApplication::instance()->thread()) {
+      //
+      // As in Database::backupToFile(), keep the UI painting (including any progress dialog) while we wait, but don't
+      // let the user do anything else.
+      //
+      QEventLoop eventLoop;
+      int numWorkersFinished = 0;
+      for (auto & worker : workers) {
+         QObject::connect(worker.get(), &QThread::finished, &eventLoop, [&]() {
+            if (++numWorkersFinished == numWorkers) {
+               eventLoop.quit();
+            }
+         });
+         worker->start();
+      }
+      if (numWorkers > 0) {
+         eventLoop.exec(QEventLoop::ExcludeUserInputEvents);
+      }
+   } else {
+      for (auto & worker : workers) {
+         worker->start();
+      }
+      for (auto & worker : workers) {
+         worker->wait();
+      }
+   }
+
+   return !this->pimpl->failed;
+}
+
+void DatabaseMigration::setCopyOnCallingThread(bool const copyOnCallingThread) {
+   this->pimpl->copyOnCallingThread = copyOnCallingThread;
+   return;
+}
+
+QString const & DatabaseMigration::errorMessage() const {
+   return this->pimpl->errorMessage;
+}
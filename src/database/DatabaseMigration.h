@@ -0,0 +1,107 @@
+/*
+ * database/DatabaseMigration.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATABASE_DATABASEMIGRATION_H
+#define DATABASE_DATABASEMIGRATION_H
+#pragma once
+
+#include <memory> // For PImpl
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+
+#include "database/ObjectStore.h"
+
+class Database;
+
+/**
+ * \brief Copies the contents of one DB to another (eg when the user switches from SQLite to PostgreSQL), table by
+ *        table, without going via the object stores.
+ *
+ *        \c ObjectStore::writeAllToNewDb inserts every cached object with its own INSERT statement, one after the
+ *        other.  For a big DB on a remote server, that's a lot of round trips.  Instead, we:
+ *           - copy several tables at once, each on its own worker thread with its own pair of connections (source
+ *             and target).  Foreign keys are turned off on the target while we copy, so the order doesn't matter.
+ *             (There is only one worker when the target is SQLite, as SQLite only allows one writer at a time.)
+ *           - read rows from the source with a forward-only query, and write them to the target in batches using
+ *             multi-row INSERT statements, so we never hold more than a batch of rows in memory
+ *           - emit \c progress as we go
+ *           - at the end of each table, read back what we wrote and check the number of rows and a checksum of their
+ *             contents against what we read from the source
+ *
+ *        Each table is copied in its own transaction on the target.  If anything fails, we stop all the workers, and
+ *        the caller should treat the target DB as unusable.
+ *
+ *        In \c Database::SqliteJournalMode::Exclusive mode, no other connection can read an SQLite source DB, so we
+ *        copy one table at a time on the calling thread using its connection.
+ */
+class DatabaseMigration : public QObject {
+   Q_OBJECT
+
+public:
+   /**
+    * \param sourceDatabase Where to copy from.  Must be loaded (ie usually \c Database::instance()).
+    * \param targetDatabase Where to copy to
+    * \param targetConnection An open connection to the target DB, whose settings (host, file name, etc) are used to
+    *                         open the other connections to it.  The tables must already exist and be empty.
+    * \param tables The tables to copy.  The first field of each is assumed to be its primary key.
+    */
+   DatabaseMigration(Database & sourceDatabase,
+                     Database & targetDatabase,
+                     QSqlDatabase & targetConnection,
+                     QVector<ObjectStore::TableDefinition const *> const & tables,
+                     QObject * parent = nullptr);
+   virtual ~DatabaseMigration();
+
+   /**
+    * \brief Do the copy.  This blocks until it is finished, but, if called from the main thread, we keep the UI
+    *        painting (but ignore user input) and \c progress signals are delivered while we wait.
+    *
+    * \return \c true if all the tables were copied and verified, \c false otherwise
+    */
+   bool run();
+
+   /**
+    * \brief Copy one table at a time on the calling thread, using \c targetConnection, as we do for a source DB in
+    *        \c Database::SqliteJournalMode::Exclusive mode.  (Lets the unit tests cover that path whatever mode the
+    *        source DB is in.)  Must be called before \c run().
+    */
+   void setCopyOnCallingThread(bool copyOnCallingThread);
+
+   //! \return Description of what went wrong, if \c run() returned \c false
+   QString const & errorMessage() const;
+
+signals:
+   /**
+    * \brief Emitted, on the thread that called \c run(), after each batch of rows has been written
+    *
+    * \param tableName The table the batch was for
+    * \param numRowsCopied How many rows have been copied so far from all tables
+    * \param numRows How many rows there are to copy in total
+    */
+   void progress(QString const & tableName, qint64 numRowsCopied, qint64 numRows);
+
+private:
+   // Private implementation details - see https://herbsutter.com/gotw/_100/
+   class impl;
+   std::unique_ptr<impl> pimpl;
+};
+
+#endif
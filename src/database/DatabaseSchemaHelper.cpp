@@ -23,12 +23,16 @@
 #include "database/DatabaseSchemaHelper.h"
 
 #include <algorithm> // For std::sort and std::set_difference
+#include <memory>
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QMessageBox>
 #include <QSqlError>
 #include <QSqlField>
 #include <QSqlRecord>
+#include <QSet>
 #include <QString>
 #include <QTextStream>
 #include <QVariant>
@@ -36,18 +40,32 @@
 #include "brewtarget.h"
 #include "database/BtSqlQuery.h"
 #include "database/Database.h"
+#include "database/DatabaseMigration.h"
 #include "database/DbTransaction.h"
+#include "database/DefaultDataManifest.h"
+#include "database/FullTextSearch.h"
+#include "database/ObjectStoreTyped.h"
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "model/BrewNote.h"
 #include "model/Recipe.h"
 #include "model/Water.h"
+#include "utils/StartupProfiler.h"
 #include "xml/BeerXml.h"
 
-int const DatabaseSchemaHelper::dbVersion = 10;
+int const DatabaseSchemaHelper::dbVersion = 13;
 
 namespace {
    char const * const FOLDER_FOR_SUPPLIED_RECIPES = "brewtarget";
 
+   //
+   // Like the settings table, this is created manually, since it's only used in this file.  It holds the hash of each
+   // record from the default data file that we have merged into the DB -- see DefaultDataManifest.
+   //
+   char const * const CREATE_DEFAULT_DATA_MERGED_SQL = "CREATE TABLE default_data_merged (hash %1 PRIMARY KEY)";
+   //! So that DatabaseMigration can copy default_data_merged along with the object store tables
+   ObjectStore::TableDefinition const DEFAULT_DATA_MERGED_TABLE{"default_data_merged", {{ObjectStore::String, "hash"}}};
+
    struct QueryAndParameters {
       QString sql;
       QVector<QVariant> bindValues = {};
@@ -78,14 +96,14 @@ namespace {
 
       for (auto & query : queries) {
          if (query.onlyRunIfPriorQueryHadResults && !priorQueryHadResults) {
-            qInfo() <<
+            qCInfo(Logging::db) <<
                Q_FUNC_INFO << "Skipping upgrade query \"" << query.sql << "\" as was dependent on prior upgrade "
                "query (\"" << priorQuerySql << "\") returning results, and it didn't";
             // We deliberately don't update priorQueryHadResults or priorQuerySql in this case, as it allows more than
             // one query in a row to be dependent on a single "dummy-run" query
             continue;
          }
-         qDebug() << Q_FUNC_INFO << query.sql;
+         qCDebug(Logging::db) << Q_FUNC_INFO << query.sql;
 
          q.prepare(query.sql);
          for (auto & bv : query.bindValues) {
@@ -108,17 +126,18 @@ namespace {
    // This is when we first defined the settings table, and defined the version as a string.
    // In the new world, this will create the settings table and define the version as an int.
    // Since we don't set the version until the very last step of the update, I think this will be fine.
-   bool migrate_to_202(Database & db, BtSqlQuery q) {
+   bool migrate_to_202(Database & db, QSqlDatabase & connection) {
+      BtSqlQuery q{connection};
       bool ret = true;
 
       // Add "projected_ferm_points" to brewnote table
       QString queryString{"ALTER TABLE brewnote ADD COLUMN projected_ferm_points "};
       QTextStream queryStringAsStream{&queryString};
       queryStringAsStream << db.getDbNativeTypeName<double>() << ";"; // Previously DEFAULT 0.0
-      qDebug() << Q_FUNC_INFO << queryString;
+      qCDebug(Logging::db) << Q_FUNC_INFO << queryString;
       ret &= q.exec(queryString);
       queryString = "ALTER TABLE brewnote SET projected_ferm_points = -1.0;";
-      qDebug() << Q_FUNC_INFO << queryString;
+      qCDebug(Logging::db) << Q_FUNC_INFO << queryString;
       ret &= q.exec(queryString);
 
       // Add the settings table
@@ -127,13 +146,14 @@ namespace {
          "id " << db.getDbNativePrimaryKeyDeclaration() << ",\n"
          "repopulatechildrenonnextstart " << db.getDbNativeTypeName<int>() << ",\n" // Previously DEFAULT 0
          "version " << db.getDbNativeTypeName<int>() << ");"; // Previously DEFAULT 0
-      qDebug() << Q_FUNC_INFO << queryString;
+      qCDebug(Logging::db) << Q_FUNC_INFO << queryString;
       ret &= q.exec(queryString);
 
       return ret;
    }
 
-   bool migrate_to_210(Database & db, BtSqlQuery & q) {
+   bool migrate_to_210(Database & db, QSqlDatabase & connection) {
+      BtSqlQuery q{connection};
       QVector<QueryAndParameters> migrationQueries{
          {QString("ALTER TABLE equipment   ADD COLUMN folder text")}, // Previously DEFAULT ''
          {QString("ALTER TABLE fermentable ADD COLUMN folder text")}, // Previously DEFAULT ''
@@ -190,7 +210,8 @@ namespace {
       return executeSqlQueries(q, migrationQueries);
    }
 
-   bool migrate_to_4(Database & db, BtSqlQuery & q) {
+   bool migrate_to_4(Database & db, QSqlDatabase & connection) {
+      BtSqlQuery q{connection};
       QVector<QueryAndParameters> const migrationQueries{
          // Save old settings
          {QString("ALTER TABLE settings RENAME TO oldsettings")},
@@ -210,7 +231,8 @@ namespace {
       return executeSqlQueries(q, migrationQueries);
    }
 
-   bool migrate_to_5(Database & db, BtSqlQuery q) {
+   bool migrate_to_5(Database & db, QSqlDatabase & connection) {
+      BtSqlQuery q{connection};
       QVector<QueryAndParameters> const migrationQueries{
          // Drop the previous bugged TRIGGER
          {QString("DROP TRIGGER dec_ins_num")},
@@ -227,13 +249,15 @@ namespace {
    }
 
    //
-   bool migrate_to_6(Database & db, BtSqlQuery q) {
+   bool migrate_to_6(Database & db, QSqlDatabase & connection) {
+      BtSqlQuery q{connection};
       bool ret = true;
       // I drop this table in version 8. There is no sense doing anything here, and it breaks other things.
       return ret;
    }
 
-   bool migrate_to_7(Database & db, BtSqlQuery q) {
+   bool migrate_to_7(Database & db, QSqlDatabase & connection) {
+      BtSqlQuery q{connection};
       QVector<QueryAndParameters> const migrationQueries{
          // Add "attenuation" to brewnote table
          {"ALTER TABLE brewnote ADD COLUMN attenuation real"} // Previously DEFAULT 0.0
@@ -241,7 +265,8 @@ namespace {
       return executeSqlQueries(q, migrationQueries);
    }
 
-   bool migrate_to_8(Database & db, BtSqlQuery q) {
+   bool migrate_to_8(Database & db, QSqlDatabase & connection) {
+      BtSqlQuery q{connection};
       QString createTmpBrewnoteSql;
       QTextStream createTmpBrewnoteSqlStream(&createTmpBrewnoteSql);
       createTmpBrewnoteSqlStream <<
@@ -469,7 +494,8 @@ namespace {
 
    // To support the water chemistry, I need to add two columns to water and to
    // create the salt and salt_in_recipe tables
-   bool migrate_to_9(Database & db, BtSqlQuery q) {
+   bool migrate_to_9(Database & db, QSqlDatabase & connection) {
+      BtSqlQuery q{connection};
       QString createSaltSql;
       QTextStream createSaltSqlStream(&createSaltSql);
       createSaltSqlStream <<
@@ -516,7 +542,8 @@ namespace {
       return executeSqlQueries(q, migrationQueries);
    }
 
-   bool migrate_to_10(Database & db, BtSqlQuery q) {
+   bool migrate_to_10(Database & db, QSqlDatabase & connection) {
+      BtSqlQuery q{connection};
       QVector<QueryAndParameters> const migrationQueries{
          // DB-specific version of ALTER TABLE recipe ADD COLUMN ancestor_id INTEGER REFERENCES recipe(id)
          {QString(db.getSqlToAddColumnAsForeignKey()).arg("recipe",
@@ -531,60 +558,180 @@ namespace {
       return executeSqlQueries(q, migrationQueries);
    }
 
+   bool migrate_to_11(Database & db, QSqlDatabase & connection) {
+      //
+      // Add the full-text search index.  This is the one place where we don't hard-code the SQL in the migration,
+      // because the index is purely derived data: it holds nothing that isn't also in the primary tables, so a later
+      // schema version can always drop it and rebuild it from scratch.
+      //
+      return FullTextSearch::createIndex(db, connection) && FullTextSearch::rebuildIndex(db, connection);
+   }
+
+   bool migrate_to_12(Database & db, QSqlDatabase & connection) {
+      BtSqlQuery q{connection};
+      //
+      // Existing DBs start with no record of which default data has been merged, so the next merge will try to import
+      // everything, same as it did before, and the BeerXML duplicate detection will skip what the user already has.
+      //
+      QVector<QueryAndParameters> const migrationQueries{
+         {QString(CREATE_DEFAULT_DATA_MERGED_SQL).arg(db.getDbNativeTypeName<QString>())}
+      };
+      return executeSqlQueries(q, migrationQueries);
+   }
+
+   bool migrate_to_13(Database & db, QSqlDatabase & connection) {
+      //
+      // Add indexes on junction tables and foreign keys.  As with the full-text search index in migrate_to_11, we
+      // generate these from the current table definitions rather than hard-coding them, because indexes hold no data
+      // of their own: a later schema version that changes the tables can drop and re-create them as needed.
+      //
+      return CreateAllDatabaseIndexes(db, connection);
+   }
+
+   //! \return The hashes of the default data records that have already been merged into the DB
+   QSet<QByteArray> readMergedHashes(QSqlDatabase & connection) {
+      QSet<QByteArray> mergedHashes;
+      BtSqlQuery query{connection};
+      if (!query.exec("SELECT hash FROM default_data_merged")) {
+         qCritical() << Q_FUNC_INFO << "Error reading merged default data hashes:" << query.lastError().text();
+         return mergedHashes;
+      }
+      while (query.next()) {
+         mergedHashes.insert(query.value(0).toString().toLatin1());
+      }
+      return mergedHashes;
+   }
+
+   //! \brief Record that the given default data records have been merged into the DB
+   bool recordMergedHashes(Database & database,
+                           QSqlDatabase & connection,
+                           QVector<DefaultDataManifest::Record> const & records) {
+      // If the default data file contains two identical records, they have the same hash, which we only store once
+      QSet<QByteArray> hashes;
+      for (auto const & record : records) {
+         hashes.insert(record.hash);
+      }
+
+      DbTransaction dbTransaction{database, connection};
+      BtSqlQuery query{connection};
+      query.prepare("INSERT INTO default_data_merged (hash) VALUES (:hash)");
+      for (auto const & hash : hashes) {
+         query.bindValue(":hash", QString::fromLatin1(hash));
+         if (!query.exec()) {
+            qCritical() << Q_FUNC_INFO << "Error recording merged default data hash:" << query.lastError().text();
+            return false;
+         }
+      }
+      return dbTransaction.commit();
+   }
+
+   /**
+    * \brief First part of copying everything to a new DB: create the tables
+    */
+   bool createNewDatabase(Database & newDatabase, QSqlDatabase & connectionNew) {
+      // this is to prevent us from over-writing or doing heavens knows what to an existing db
+      if (connectionNew.tables().contains(QLatin1String("settings"))) {
+         qWarning() << Q_FUNC_INFO << "It appears the database is already configured.";
+         return false;
+      }
+
+      // The crucial bit is creating the new tables in the new DB.  Once that is done then, assuming disabling of
+      // foreign keys works OK, it should be turn-the-handle to write out all the data.
+      if (!DatabaseSchemaHelper::create(newDatabase, connectionNew)) {
+         qCritical() << Q_FUNC_INFO << "Error creating tables in new DB";
+         return false;
+      }
+      return true;
+   }
+
+   /**
+    * \brief Last part of copying everything to a new DB.  Data is written to the new DB with the existing primary keys,
+    *        bypassing the usual insert logic, so we need to build the search index in one go afterwards.
+    */
+   bool rebuildSearchIndexInNewDatabase(Database & newDatabase, QSqlDatabase & connectionNew) {
+      DbTransaction dbTransaction{newDatabase, connectionNew};
+      if (!FullTextSearch::rebuildIndex(newDatabase, connectionNew)) {
+         qCritical() << Q_FUNC_INFO << "Error building search index in new DB";
+         return false;
+      }
+      return dbTransaction.commit();
+   }
+
+   /**
+    * \brief One step of upgrading the DB schema, from version \c toVersion - 1 to \c toVersion
+    */
+   struct MigrationStep {
+      int toVersion;
+      //! For logging and progress reporting
+      char const * description;
+      bool (*migrate)(Database & db, QSqlDatabase & connection);
+   };
+
+   //
+   // NOTE: Add a new step here when adding a new schema change (and increment DatabaseSchemaHelper::dbVersion)
+   //
+   // Versions 1 to 3 were strings ("2.0.0", "2.0.2" and "2.1.0") that the migrations set (or didn't) themselves, and
+   // migrate_to_4 replaces the string with an integer.  After that, runMigrationStep() records the version.
+   //
+   MigrationStep const migrationSteps[] {
+      { 2, "Add settings table",                         migrate_to_202},
+      { 3, "Add folders and ingredient inheritance",     migrate_to_210},
+      { 4, "Store schema version as an integer",         migrate_to_4  },
+      { 5, "Fix instruction numbering trigger",          migrate_to_5  },
+      { 6, "Nothing to do",                              migrate_to_6  },
+      { 7, "Add brew note attenuation",                  migrate_to_7  },
+      { 8, "Rebuild brew notes and rearrange inventory", migrate_to_8  },
+      { 9, "Add water chemistry",                        migrate_to_9  },
+      {10, "Add recipe ancestors and locking",           migrate_to_10 },
+      {11, "Build full-text search index",               migrate_to_11 },
+      {12, "Track merged default data",                  migrate_to_12 },
+      {13, "Add indexes on junction tables",             migrate_to_13 }
+   };
+
+   //! First version at which the version number is stored (as an integer) in the settings table
+   int const FIRST_RECORDED_VERSION = 4;
+
+   MigrationStep const * findMigrationStep(int toVersion) {
+      for (auto const & step : migrationSteps) {
+         if (step.toVersion == toVersion) {
+            return &step;
+         }
+      }
+      return nullptr;
+   }
+
    /*!
-    * \brief Migrate from version \c oldVersion to \c oldVersion+1
+    * \brief Run one migration step and, if it succeeds, record the new schema version.  Caller is responsible for the
+    *        transaction.
     */
-   bool migrateNext(Database & database, int oldVersion, QSqlDatabase db ) {
-      qDebug() << Q_FUNC_INFO << "Migrating DB schema from v" << oldVersion << "to v" << oldVersion + 1;
-      BtSqlQuery sqlQuery(db);
-      bool ret = true;
+   bool runMigrationStep(Database & database, QSqlDatabase & connection, MigrationStep const & step) {
+      qCInfo(Logging::db) <<
+         Q_FUNC_INFO << "Migrating DB schema to v" << step.toVersion << "(" << step.description << ")";
+      StartupProfiler::Phase startupPhase{"Migrate DB schema", QString::number(step.toVersion)};
+      QElapsedTimer timer;
+      timer.start();
 
-      // NOTE: Add a new case when adding a new schema change
-      switch(oldVersion)
-      {
-         case 1: // == '2.0.0'
-            ret &= migrate_to_202(database, sqlQuery);
-            break;
-         case 2: // == '2.0.2'
-            ret &= migrate_to_210(database, sqlQuery);
-            break;
-         case 3: // == '2.1.0'
-            ret &= migrate_to_4(database, sqlQuery);
-            break;
-         case 4:
-            ret &= migrate_to_5(database, sqlQuery);
-            break;
-         case 5:
-            ret &= migrate_to_6(database, sqlQuery);
-            break;
-         case 6:
-            ret &= migrate_to_7(database, sqlQuery);
-            break;
-         case 7:
-            ret &= migrate_to_8(database, sqlQuery);
-            break;
-         case 8:
-            ret &= migrate_to_9(database, sqlQuery);
-            break;
-         case 9:
-            ret &= migrate_to_10(database, sqlQuery);
-            break;
-         default:
-            qCritical() << QString("Unknown version %1").arg(oldVersion);
-            return false;
+      if (!step.migrate(database, connection)) {
+         qCritical() << Q_FUNC_INFO << "Error migrating DB schema to v" << step.toVersion;
+         return false;
       }
 
       // Set the db version
-      if( oldVersion > 3 )
-      {
-         QString queryString{"UPDATE settings SET version=:version WHERE id=1"};
-         sqlQuery.prepare(queryString);
-         QVariant bindValue{QString::number(oldVersion + 1)};
-         sqlQuery.bindValue(":version", bindValue);
-         ret &= sqlQuery.exec();
+      if (step.toVersion > FIRST_RECORDED_VERSION) {
+         BtSqlQuery sqlQuery{connection};
+         sqlQuery.prepare("UPDATE settings SET version=:version WHERE id=1");
+         sqlQuery.bindValue(":version", QVariant{QString::number(step.toVersion)});
+         if (!sqlQuery.exec()) {
+            qCritical() <<
+               Q_FUNC_INFO << "Error setting DB schema version to" << step.toVersion << ":" <<
+               sqlQuery.lastError().text();
+            return false;
+         }
       }
 
-      return ret;
+      qCInfo(Logging::db) <<
+         Q_FUNC_INFO << "Migrated DB schema to v" << step.toVersion << "in" << timer.elapsed() << "ms";
+      return true;
    }
 
 }
@@ -593,8 +740,8 @@ bool DatabaseSchemaHelper::upgrade = false;
 
 bool DatabaseSchemaHelper::create(Database & database, QSqlDatabase connection) {
    //--------------------------------------------------------------------------
-   // NOTE: if you edit this function, increment dbVersion and edit
-   // migrateNext() appropriately.
+   // NOTE: if you edit this function, increment dbVersion and add a step to
+   // migrationSteps appropriately.
    //--------------------------------------------------------------------------
 
    // NOTE: none of the BeerXML property names should EVER change. This is to
@@ -609,16 +756,26 @@ bool DatabaseSchemaHelper::create(Database & database, QSqlDatabase connection)
    //       display=0 means the ingredient is in a recipe already and should not
    //                 be shown in a list, available to be put into a recipe.
 
+   // For SQLite, incremental auto-vacuum (which DatabaseCompaction uses to give space back to the file system) can only
+   // be turned on (without a full VACUUM) before any tables are created, and outside a transaction.
+   if (database.dbType() == Database::SQLITE) {
+      connection.exec("PRAGMA auto_vacuum = INCREMENTAL");
+   }
+
    // Start transaction
    // By the magic of RAII, this will abort if we exit this function (including by throwing an exception) without
    // having called dbTransaction.commit().
    DbTransaction dbTransaction{database, connection};
 
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::db) << Q_FUNC_INFO;
    if (!CreateAllDatabaseTables(database, connection)) {
       return false;
    }
 
+   if (!FullTextSearch::createIndex(database, connection)) {
+      return false;
+   }
+
    //
    // Create the settings table manually, since it's only used in this file
    //
@@ -627,8 +784,8 @@ bool DatabaseSchemaHelper::create(Database & database, QSqlDatabase connection)
    //
    QVector<QueryAndParameters> const setUpQueries{
       {QString("CREATE TABLE settings (id %2, repopulatechildrenonnextstart %1, version %1)").arg(database.getDbNativeTypeName<int>(), database.getDbNativePrimaryKeyDeclaration())},
-      {QString("INSERT INTO settings (repopulatechildrenonnextstart, version) VALUES (?, ?)"), {QVariant(1), QVariant(dbVersion)}}
-
+      {QString("INSERT INTO settings (repopulatechildrenonnextstart, version) VALUES (?, ?)"), {QVariant(1), QVariant(dbVersion)}},
+      {QString(CREATE_DEFAULT_DATA_MERGED_SQL).arg(database.getDbNativeTypeName<QString>())}
    };
    BtSqlQuery sqlQuery{connection};
 
@@ -643,32 +800,63 @@ bool DatabaseSchemaHelper::create(Database & database, QSqlDatabase connection)
    return true;
 }
 
-bool DatabaseSchemaHelper::migrate(Database & database, int oldVersion, int newVersion, QSqlDatabase connection) {
+bool DatabaseSchemaHelper::migrate(Database & database,
+                                   int oldVersion,
+                                   int newVersion,
+                                   QSqlDatabase connection,
+                                   SchemaMigrationProgressHandler const & progressHandler) {
    if( oldVersion >= newVersion || newVersion > dbVersion ) {
-      qDebug() << Q_FUNC_INFO <<
+      qCDebug(Logging::db) << Q_FUNC_INFO <<
          QString("Requested backwards migration from %1 to %2: You are an imbecile").arg(oldVersion).arg(newVersion);
       return false;
    }
 
-   bool ret = true;
-   qDebug() << Q_FUNC_INFO << "Migrating database schema from v" << oldVersion << "to v" << newVersion;
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Migrating database schema from v" << oldVersion << "to v" << newVersion;
 
-   // Start transaction
-   // By the magic of RAII, this will abort if we exit this function (including by throwing an exception) without
-   // having called dbTransaction.commit().  (It will also turn foreign keys back on either way -- whether the
-   // transaction is committed or rolled back.)
-   DbTransaction dbTransaction{database, connection, DbTransaction::DISABLE_FOREIGN_KEYS};
+   //
+   // Each step runs in its own transaction (with foreign keys turned off, as steps often rebuild tables) and records
+   // the new schema version as part of that transaction.  So, if we are interrupted part-way through (eg the user gives
+   // up waiting on a big DB and kills the app), then the DB is left at whichever version we had got to, and next time
+   // we start we carry on from there, rather than starting all over again.
+   //
+   // The exception is the steps before FIRST_RECORDED_VERSION, which have no way to record what they've done, so they
+   // share one transaction with the step to FIRST_RECORDED_VERSION.
+   //
+   // By the magic of RAII, a transaction will abort if we exit this function (including by throwing an exception)
+   // without having called commit().  (It will also turn foreign keys back on either way -- whether the transaction is
+   // committed or rolled back.)
+   //
+   int const numSteps = newVersion - oldVersion;
+   std::unique_ptr<DbTransaction> dbTransaction;
+   for (int version = oldVersion; version < newVersion; ++version) {
+      MigrationStep const * step = findMigrationStep(version + 1);
+      if (!step) {
+         qCritical() << QString("Unknown version %1").arg(version);
+         return false;
+      }
 
-   for ( ; oldVersion < newVersion && ret; ++oldVersion ) {
-      ret &= migrateNext(database, oldVersion, connection);
-   }
+      if (progressHandler) {
+         progressHandler(version - oldVersion, numSteps, step->description);
+      }
 
-   // If all statements executed OK, we can commit, otherwise the transaction will roll back when we exit this function
-   if (ret) {
-      ret &= dbTransaction.commit();
+      if (!dbTransaction) {
+         dbTransaction = std::make_unique<DbTransaction>(database, connection, DbTransaction::DISABLE_FOREIGN_KEYS);
+      }
+      if (!runMigrationStep(database, connection, *step)) {
+         return false;
+      }
+      if (step->toVersion >= FIRST_RECORDED_VERSION) {
+         if (!dbTransaction->commit()) {
+            return false;
+         }
+         dbTransaction.reset();
+      }
    }
 
-   return ret;
+   if (progressHandler) {
+      progressHandler(numSteps, numSteps, QString{});
+   }
+   return true;
 }
 
 int DatabaseSchemaHelper::currentVersion(QSqlDatabase db) {
@@ -685,7 +873,7 @@ int DatabaseSchemaHelper::currentVersion(QSqlDatabase db) {
 
    // Get the string before we kill it by convert()-ing
    QString stringVer( ver.toString() );
-   qDebug() << Q_FUNC_INFO << "Database schema version" << stringVer;
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Database schema version" << stringVer;
 
    // Initially, versioning was done with strings, so we need to convert
    // the old version strings to integer versions
@@ -710,29 +898,41 @@ int DatabaseSchemaHelper::currentVersion(QSqlDatabase db) {
 }
 
 bool DatabaseSchemaHelper::copyToNewDatabase(Database & newDatabase, QSqlDatabase & connectionNew) {
+   if (!createNewDatabase(newDatabase, connectionNew)) {
+      return false;
+   }
 
-   // this is to prevent us from over-writing or doing heavens knows what to an existing db
-   if (connectionNew.tables().contains(QLatin1String("settings"))) {
-      qWarning() << Q_FUNC_INFO << "It appears the database is already configured.";
+   if (!WriteAllObjectStoresToNewDb(newDatabase, connectionNew)) {
+      qCritical() << Q_FUNC_INFO << "Error writing data to new DB";
       return false;
    }
 
-   // The crucial bit is creating the new tables in the new DB.  Once that is done then, assuming disabling of foreign
-   // keys works OK, it should be turn-the-handle to write out all the data.
-   if (!DatabaseSchemaHelper::create(newDatabase, connectionNew)) {
-      qCritical() << Q_FUNC_INFO << "Error creating tables in new DB";
+   return rebuildSearchIndexInNewDatabase(newDatabase, connectionNew);
+}
+
+bool DatabaseSchemaHelper::migrateToNewDatabase(Database & oldDatabase,
+                                                Database & newDatabase,
+                                                QSqlDatabase & connectionNew,
+                                                MigrationProgressHandler const & progressHandler) {
+   if (!createNewDatabase(newDatabase, connectionNew)) {
       return false;
    }
 
-   if (!WriteAllObjectStoresToNewDb(newDatabase, connectionNew)) {
-      qCritical() << Q_FUNC_INFO << "Error writing data to new DB";
+   QVector<ObjectStore::TableDefinition const *> tables = GetAllTableDefinitions();
+   tables.append(&DEFAULT_DATA_MERGED_TABLE);
+   DatabaseMigration migration{oldDatabase, newDatabase, connectionNew, tables};
+   if (progressHandler) {
+      // Passing migration as the context object means progressHandler is called on this thread, not the worker threads
+      QObject::connect(&migration, &DatabaseMigration::progress, &migration, progressHandler);
+   }
+   if (!migration.run()) {
+      qCritical() << Q_FUNC_INFO << "Error copying data to new DB:" << migration.errorMessage();
       return false;
    }
 
-   return true;
+   return rebuildSearchIndexInNewDatabase(newDatabase, connectionNew);
 }
 
-
 /**
  * \brief Imports any new default data to the database.  This is what gets called when the user responds Yes to the
  *        dialog saying "There are new ingredients, would you like to merge?"
@@ -754,6 +954,12 @@ bool DatabaseSchemaHelper::copyToNewDatabase(Database & newDatabase, QSqlDatabas
  *           - Our XML import code already does duplicate detection, so don't need the special tracking tables any more.
  *             We just try to import all the default data, and any records that the user already has will be skipped
  *             over.
+ *
+ *        Parsing, validating and duplicate-checking all the default data takes a while though, so we don't quite do
+ *        that any more.  Instead, the default_data_merged table holds the hash of each default data record we have
+ *        merged, and DefaultDataManifest lists the hash of every record in the default data file.  So we only need to
+ *        import the records whose hashes we haven't seen before, which, for a typical update, is a handful.  (The
+ *        duplicate detection is still there as a backstop, eg for existing DBs, which start with no hashes.)
  */
 bool DatabaseSchemaHelper::updateDatabase(QTextStream & userMessage) {
 
@@ -763,17 +969,54 @@ bool DatabaseSchemaHelper::updateDatabase(QTextStream & userMessage) {
    // folder.
    //
    QList<Recipe *> allRecipesBeforeImport = ObjectStoreWrapper::getAllRaw<Recipe>();
-   qDebug() << Q_FUNC_INFO << allRecipesBeforeImport.size() << "Recipes before import";
+   qCDebug(Logging::db) << Q_FUNC_INFO << allRecipesBeforeImport.size() << "Recipes before import";
 
    QString const defaultDataFileName = Brewtarget::getResourceDir().filePath("DefaultData.xml");
-   bool succeeded = BeerXML::getInstance().importFromXML(defaultDataFileName, userMessage);
+   QFile defaultDataFile{defaultDataFileName};
+   if (!defaultDataFile.open(QIODevice::ReadOnly)) {
+      qCritical() << Q_FUNC_INFO << "Could not read" << defaultDataFileName;
+      userMessage << QObject::tr("Could not read %1").arg(defaultDataFileName);
+      return false;
+   }
+   QByteArray const defaultData = defaultDataFile.readAll();
 
+   //
+   // If the shipped manifest doesn't match the data file (eg because someone edited the data file and forgot to
+   // regenerate the manifest), we can make our own.  It's only a bit slower.
+   //
+   std::optional<DefaultDataManifest> manifest =
+      DefaultDataManifest::read(DefaultDataManifest::manifestFileName(defaultDataFileName));
+   if (!manifest || manifest->dataFileHash() != DefaultDataManifest::hash(defaultData)) {
+      qWarning() << Q_FUNC_INFO << "Manifest missing or out of date for" << defaultDataFileName << "so rebuilding it";
+      manifest = DefaultDataManifest::build(defaultData);
+   }
+
+   Database & database = Database::instance();
+   QSqlDatabase connection = database.sqlDatabase();
+   QSet<QByteArray> const mergedHashes = readMergedHashes(connection);
+   QVector<DefaultDataManifest::Record> const newRecords = manifest->recordsNotIn(mergedHashes);
+   qCInfo(Logging::db) <<
+      Q_FUNC_INFO << newRecords.size() << "of" << manifest->records().size() << "default data records not yet merged";
+   if (newRecords.isEmpty()) {
+      userMessage << QObject::tr("All default data has already been added to the database.");
+      return true;
+   }
+
+   QByteArray const newData = DefaultDataManifest::extract(defaultData, newRecords);
+   if (newData.isEmpty()) {
+      // Shouldn't happen, as we checked the manifest matches the file
+      qCritical() << Q_FUNC_INFO << "Could not extract new records from" << defaultDataFileName;
+      userMessage << QObject::tr("Could not read %1").arg(defaultDataFileName);
+      return false;
+   }
+
+   bool succeeded = BeerXML::getInstance().importFromXML(newData, defaultDataFileName, userMessage);
    if (succeeded) {
       //
       // Now see what Recipes exist that weren't there before the import
       //
       QList<Recipe *> allRecipesAfterImport = ObjectStoreWrapper::getAllRaw<Recipe>();
-      qDebug() << Q_FUNC_INFO << allRecipesAfterImport.size() << "Recipes after import";
+      qCDebug(Logging::db) << Q_FUNC_INFO << allRecipesAfterImport.size() << "Recipes after import";
 
       //
       // Once the lists are sorted, finding the difference is just a library call
@@ -785,10 +1028,13 @@ bool DatabaseSchemaHelper::updateDatabase(QTextStream & userMessage) {
       std::set_difference(allRecipesAfterImport.begin(), allRecipesAfterImport.end(),
                           allRecipesBeforeImport.begin(), allRecipesBeforeImport.end(),
                           std::back_inserter(newlyImportedRecipes));
-      qDebug() << Q_FUNC_INFO << newlyImportedRecipes.size() << "newly imported Recipes";
+      qCDebug(Logging::db) << Q_FUNC_INFO << newlyImportedRecipes.size() << "newly imported Recipes";
       for (auto recipe : newlyImportedRecipes) {
          recipe->setFolder(FOLDER_FOR_SUPPLIED_RECIPES);
       }
+
+      // If this fails, the same records will be offered again next time, and the duplicate detection will skip them
+      succeeded = recordMergedHashes(database, connection, newRecords);
    }
 
    return succeeded;
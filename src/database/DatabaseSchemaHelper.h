@@ -23,7 +23,10 @@
 #define DATABASE_DATABASESCHEMAHELPER_H
 #pragma once
 
+#include <functional>
+
 #include <QSqlDatabase>
+#include <QString>
 
 #include "Database.h"
 
@@ -44,10 +47,29 @@ namespace DatabaseSchemaHelper {
     */
    bool create(Database & database, QSqlDatabase db);
 
+   /**
+    * \brief Called before each schema migration step and once at the end
+    *
+    * \param numStepsDone How many steps have been completed so far
+    * \param numSteps Total number of steps we are running
+    * \param description What the next step does (empty at the end)
+    */
+   using SchemaMigrationProgressHandler =
+      std::function<void(int numStepsDone, int numSteps, QString const & description)>;
+
    /*!
     * \brief Migrate schema from \c oldVersion to \c newVersion
+    *
+    *        Each step is committed separately, so, if this fails or is interrupted, the DB is left at the last version
+    *        successfully migrated to, and a later call can carry on from there.
+    *
+    * \param progressHandler If set, called as we go along
     */
-   bool migrate(Database & database, int oldVersion, int newVersion, QSqlDatabase connection);
+   bool migrate(Database & database,
+                int oldVersion,
+                int newVersion,
+                QSqlDatabase connection,
+                SchemaMigrationProgressHandler const & progressHandler = nullptr);
 
    //! \brief Current schema version of the given database
    int currentVersion(QSqlDatabase db = QSqlDatabase());
@@ -55,6 +77,22 @@ namespace DatabaseSchemaHelper {
    //! \brief does the heavy lifting to copy the contents from one db to the next
    bool copyToNewDatabase(Database & newDatabase, QSqlDatabase & connectionNew);
 
+   //! \brief See \c DatabaseMigration::progress
+   using MigrationProgressHandler =
+      std::function<void(QString const & tableName, qint64 numRowsCopied, qint64 numRows)>;
+
+   /**
+    * \brief As \c copyToNewDatabase, but copies the tables straight from \c oldDatabase (see \c DatabaseMigration)
+    *        rather than from the object stores.  This is what we use when the user switches DB, as it's a lot quicker
+    *        for big DBs.
+    *
+    * \param progressHandler If set, called on this thread as the data is copied
+    */
+   bool migrateToNewDatabase(Database & oldDatabase,
+                             Database & newDatabase,
+                             QSqlDatabase & connectionNew,
+                             MigrationProgressHandler const & progressHandler = nullptr);
+
    /**
     * \brief Populates (or updates) default Recipes, Hops, Styles, etc in the DB
     *
@@ -0,0 +1,224 @@
+/*
+ * database/DatabaseWorkerPool.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "database/DatabaseWorkerPool.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QThread>
+
+#include "database/Database.h"
+#include "Logging.h"
+#include "utils/Metrics.h"
+
+namespace {
+   //! How a worker tells the main thread that a task is done, so that its callback can be run there
+   class CallbackEvent : public QEvent {
+   public:
+      static QEvent::Type eventType() {
+         static QEvent::Type const type = static_cast<QEvent::Type>(QEvent::registerEventType());
+         return type;
+      }
+
+      CallbackEvent(DatabaseWorkerPool::Callback callback, bool succeeded) :
+         QEvent{CallbackEvent::eventType()},
+         callback{std::move(callback)},
+         succeeded{succeeded} {
+         return;
+      }
+
+      DatabaseWorkerPool::Callback const callback;
+      bool const succeeded;
+   };
+
+   struct Job {
+      DatabaseWorkerPool::Task task;
+      DatabaseWorkerPool::Callback callback;
+      //! Started when the job is queued, so we can see how long jobs wait for a worker
+      QElapsedTimer queuedTimer;
+   };
+}
+
+class DatabaseWorkerPool::Worker : public QThread {
+   // No signals or slots (other than those inherited from QThread), so no need for Q_OBJECT
+public:
+   Worker(DatabaseWorkerPool & pool) :
+      QThread{},
+      pool{pool},
+      mutex{},
+      jobAvailable{},
+      jobs{},
+      stopRequested{false} {
+      return;
+   }
+
+   ~Worker() {
+      this->stop();
+      return;
+   }
+
+   void enqueue(Job job) {
+      QMutexLocker locker(&this->mutex);
+      this->jobs.enqueue(std::move(job));
+      this->jobAvailable.wakeOne();
+      return;
+   }
+
+   //! \brief Ask the thread to finish once it has done everything already queued, and wait until it has
+   void stop() {
+      {
+         QMutexLocker locker(&this->mutex);
+         this->stopRequested = true;
+         this->jobAvailable.wakeAll();
+      }
+      this->wait();
+      return;
+   }
+
+protected:
+   virtual void run() override {
+      {
+         // This needs to be out of scope before we call closeConnectionForThisThread()
+         QSqlDatabase connection;
+         bool haveConnection = false;
+         try {
+            connection = this->pool.database.sqlDatabase();
+            haveConnection = true;
+         } catch (QString const & errorMessage) {
+            // We still need to drain the queue, otherwise waitForAll() would never return
+            qCritical() << Q_FUNC_INFO << "No DB connection, so queued work will fail:" << errorMessage;
+         }
+
+         static Metrics::Histogram & queueLatency = Metrics::histogram("db.workerPool.queueLatencyNs");
+         static Metrics::Histogram & taskLatency  = Metrics::histogram("db.workerPool.taskLatencyNs");
+         static Metrics::Counter   & numFailed    = Metrics::counter("db.workerPool.tasksFailed");
+         for (;;) {
+            Job job;
+            {
+               QMutexLocker locker(&this->mutex);
+               while (this->jobs.isEmpty() && !this->stopRequested) {
+                  this->jobAvailable.wait(&this->mutex);
+               }
+               if (this->jobs.isEmpty()) {
+                  break;
+               }
+               job = this->jobs.dequeue();
+            }
+
+            queueLatency.record(job.queuedTimer.nsecsElapsed());
+            bool succeeded = false;
+            if (haveConnection) {
+               Metrics::ScopedLatency const latency{taskLatency};
+               succeeded = job.task(connection);
+            }
+            if (!succeeded) {
+               numFailed.add();
+            }
+            this->pool.taskDone(std::move(job.callback), succeeded);
+         }
+      }
+      this->pool.database.closeConnectionForThisThread();
+      return;
+   }
+
+private:
+   DatabaseWorkerPool & pool;
+
+   QMutex mutex;
+   QWaitCondition jobAvailable;
+   QQueue<Job> jobs;
+   bool stopRequested;
+};
+
+DatabaseWorkerPool::DatabaseWorkerPool(Database & database, int const numWorkers) :
+   QObject{},
+   database{database},
+   workers{},
+   mutex{},
+   allDone{},
+   numOutstanding{0} {
+   Q_ASSERT(numWorkers > 0);
+   qCInfo(Logging::db) << Q_FUNC_INFO << "Starting" << numWorkers << "DB worker thread(s)";
+   for (int ii = 0; ii < numWorkers; ++ii) {
+      this->workers.push_back(std::make_unique<Worker>(*this));
+      this->workers.back()->start();
+   }
+   return;
+}
+
+DatabaseWorkerPool::~DatabaseWorkerPool() {
+   // Each worker finishes its queue before stopping
+   for (auto & worker : this->workers) {
+      worker->stop();
+   }
+   return;
+}
+
+void DatabaseWorkerPool::enqueue(QString const & orderingKey, Task task, Callback callback) {
+   {
+      QMutexLocker locker(&this->mutex);
+      ++this->numOutstanding;
+   }
+   Job job{std::move(task), std::move(callback), QElapsedTimer{}};
+   job.queuedTimer.start();
+   // Same key always maps to same worker, which is what gives us the ordering guarantee
+   uint const workerIndex = qHash(orderingKey) % static_cast<uint>(this->workers.size());
+   this->workers.at(workerIndex)->enqueue(std::move(job));
+   return;
+}
+
+void DatabaseWorkerPool::waitForAll() {
+   static Metrics::Histogram & waitLatency = Metrics::histogram("db.workerPool.waitForAllLatencyNs");
+   Metrics::ScopedLatency const latency{waitLatency};
+   QMutexLocker locker(&this->mutex);
+   while (this->numOutstanding > 0) {
+      this->allDone.wait(&this->mutex);
+   }
+   return;
+}
+
+int DatabaseWorkerPool::numWorkers() const {
+   return static_cast<int>(this->workers.size());
+}
+
+void DatabaseWorkerPool::customEvent(QEvent * event) {
+   if (event->type() != CallbackEvent::eventType()) {
+      QObject::customEvent(event);
+      return;
+   }
+   auto const * callbackEvent = static_cast<CallbackEvent const *>(event);
+   callbackEvent->callback(callbackEvent->succeeded);
+   return;
+}
+
+void DatabaseWorkerPool::taskDone(Callback callback, bool const succeeded) {
+   if (callback) {
+      // Qt takes ownership of the event
+      QCoreApplication::postEvent(this, new CallbackEvent{std::move(callback), succeeded});
+   }
+   QMutexLocker locker(&this->mutex);
+   --this->numOutstanding;
+   if (this->numOutstanding == 0) {
+      this->allDone.wakeAll();
+   }
+   return;
+}
@@ -0,0 +1,113 @@
+/*
+ * database/DatabaseWorkerPool.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATABASE_DATABASEWORKERPOOL_H
+#define DATABASE_DATABASEWORKERPOOL_H
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QEvent>
+#include <QMutex>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QWaitCondition>
+
+class Database;
+
+/**
+ * \brief A small pool of worker threads, each with its own DB connection, that run DB work queued from the main
+ *        thread, so that the main thread does not have to wait for it.
+ *
+ *        With PostgreSQL, every statement is a network round-trip, so, eg, each edit the user makes in the UI costs at
+ *        least one round-trip (more with the transaction around it) before the UI can carry on.  The pool lets
+ *        \c ObjectStore::updateProperty hand the write off and return straight away (see \c Database::workerPool()).
+ *
+ *        Each piece of work is queued with an "ordering key" (typically identifying the object being written).  All
+ *        work with the same key goes to the same worker, which runs its work in the order it was queued, so writes to
+ *        any one object happen in the order they were made.  Work with different keys is spread over the workers and
+ *        so can be in flight at the same time, on different connections.  There is no ordering between different
+ *        keys, so anything that needs to see the results of earlier work (eg a synchronous insert or delete on the
+ *        main thread) should call \c waitForAll() first.  \c DbTransaction does this for any transaction started on the
+ *        main thread, and nothing should wait for the pool from inside a transaction (see \c DbTransaction for why).
+ *
+ *        Callbacks are run on the main thread (strictly, the thread this object lives on), via the event loop, after
+ *        the work has been done.  Callbacks still queued when the pool is destroyed are dropped.
+ */
+class DatabaseWorkerPool : public QObject {
+   // No signals or slots (other than those inherited from QObject), so no need for Q_OBJECT
+public:
+   /**
+    * \brief Work to be done on a worker thread.  Should return \c true if it succeeded, \c false otherwise.  It MUST
+    *        NOT touch any objects that live on the main thread -- ie everything it needs should be copied into it when
+    *        it is queued.
+    */
+   using Task = std::function<bool(QSqlDatabase & connection)>;
+
+   //! \brief Called on the main thread with the result of the corresponding \c Task
+   using Callback = std::function<void(bool succeeded)>;
+
+   /**
+    * \param database
+    * \param numWorkers Number of worker threads (and thus DB connections) to start.  Must be at least 1.
+    */
+   DatabaseWorkerPool(Database & database, int numWorkers);
+
+   /**
+    * \brief Runs everything that is already queued, then stops the workers (which close their DB connections)
+    */
+   ~DatabaseWorkerPool();
+
+   /**
+    * \brief Queue some work to be done on a worker thread
+    *
+    * \param orderingKey Work with the same key is run in the order it was queued
+    * \param task
+    * \param callback If supplied, is called on the main thread once \c task has run
+    */
+   void enqueue(QString const & orderingKey, Task task, Callback callback = nullptr);
+
+   /**
+    * \brief Wait until all the work queued so far has been done.  (Callbacks for it will not yet have run, as they are
+    *        delivered via the event loop.)
+    */
+   void waitForAll();
+
+   int numWorkers() const;
+
+protected:
+   virtual void customEvent(QEvent * event) override;
+
+private:
+   class Worker;
+
+   //! Called by a \c Worker each time it finishes a \c Task
+   void taskDone(Callback callback, bool succeeded);
+
+   Database & database;
+   std::vector<std::unique_ptr<Worker> > workers;
+
+   QMutex mutex;
+   QWaitCondition allDone;
+   int numOutstanding;
+};
+
+#endif
@@ -18,17 +18,72 @@
  */
 #include "database/DbTransaction.h"
 
+#include <QCoreApplication>
 #include <QDebug>
+#include <QHash>
 #include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
 
 #include "database/Database.h"
+#include "database/DatabaseWorkerPool.h"
+#include "Logging.h"
+#include "utils/Metrics.h"
 
+namespace {
+   //
+   // How many DbTransaction objects currently exist for each connection.  Connections are per-thread (see
+   // Database::sqlDatabase()) so this needs to be too.
+   //
+   thread_local QHash<QString, int> connectionNameToNumTransactions;
+
+   QString savepointName(int nestingLevel) {
+      return QString{"bt_savepoint_%1"}.arg(nestingLevel);
+   }
+
+   bool execSavepointCommand(QSqlDatabase & connection, QString const & command) {
+      QSqlQuery sqlQuery{connection};
+      if (!sqlQuery.exec(command)) {
+         qCritical() << Q_FUNC_INFO << "Error executing" << command << ":" << sqlQuery.lastError().text();
+         return false;
+      }
+      return true;
+   }
+}
 
 DbTransaction::DbTransaction(Database & database, QSqlDatabase & connection, DbTransaction::SpecialBehaviours specialBehaviours) :
    database{database},
    connection{connection},
    committed{false},
-   specialBehaviours{specialBehaviours} {
+   specialBehaviours{specialBehaviours},
+   nestingLevel{connectionNameToNumTransactions.value(connection.connectionName(), 0)} {
+   connectionNameToNumTransactions.insert(this->connection.connectionName(), this->nestingLevel + 1);
+
+   if (this->nestingLevel > 0) {
+      //
+      // We're inside another transaction on this connection, so we use a savepoint rather than trying to start a new
+      // transaction (which would fail).  Foreign keys can't be turned on or off inside a transaction, so if that was
+      // asked for, it's a coding error.
+      //
+      if (this->specialBehaviours & DISABLE_FOREIGN_KEYS) {
+         qWarning() << Q_FUNC_INFO << "Cannot disable foreign keys in nested transaction";
+         this->specialBehaviours &= ~DISABLE_FOREIGN_KEYS;
+      }
+      bool succeeded = execSavepointCommand(this->connection, "SAVEPOINT " + savepointName(this->nestingLevel));
+      qCDebug(Logging::db) <<
+         Q_FUNC_INFO << "Database savepoint" << this->nestingLevel << "begin: " << (succeeded ? "succeeded" : "failed");
+      return;
+   }
+
+   // See class comment.  Worker threads run their own transactions, which mustn't wait for the pool they are part of.
+   if (QCoreApplication::instance() == nullptr ||
+       QThread::currentThread() == QCoreApplication::instance()->thread()) {
+      DatabaseWorkerPool * workerPool = this->database.workerPool();
+      if (workerPool) {
+         workerPool->waitForAll();
+      }
+   }
+
    // Note that, on SQLite at least, turning foreign keys on and off has to happen outside a transaction, so we have to
    // be careful about the order in which we do things.
    if (this->specialBehaviours & DISABLE_FOREIGN_KEYS) {
@@ -36,7 +91,7 @@ DbTransaction::DbTransaction(Database & database, QSqlDatabase & connection, DbT
    }
 
    bool succeeded = this->connection.transaction();
-   qDebug() << Q_FUNC_INFO << "Database transaction begin: " << (succeeded ? "succeeded" : "failed");
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Database transaction begin: " << (succeeded ? "succeeded" : "failed");
    if (!succeeded) {
       qCritical() << Q_FUNC_INFO << "Unable to start database transaction:" << connection.lastError().text();
    }
@@ -44,10 +99,27 @@ DbTransaction::DbTransaction(Database & database, QSqlDatabase & connection, DbT
 }
 
 DbTransaction::~DbTransaction() {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::db) << Q_FUNC_INFO;
+   if (this->nestingLevel > 0) {
+      connectionNameToNumTransactions.insert(this->connection.connectionName(), this->nestingLevel);
+      if (!committed) {
+         // Rolling back to a savepoint leaves it in place, so we also need to release it
+         QString const savepoint = savepointName(this->nestingLevel);
+         bool succeeded = execSavepointCommand(this->connection, "ROLLBACK TO SAVEPOINT " + savepoint) &&
+                          execSavepointCommand(this->connection, "RELEASE SAVEPOINT " + savepoint);
+         qCDebug(Logging::db) <<
+            Q_FUNC_INFO << "Database savepoint" << this->nestingLevel << "rollback: " <<
+            (succeeded ? "succeeded" : "failed");
+      }
+      return;
+   }
+
+   connectionNameToNumTransactions.remove(this->connection.connectionName());
    if (!committed) {
+      static Metrics::Counter & numRollbacks = Metrics::counter("db.transactions.rolledBack");
+      numRollbacks.add();
       bool succeeded = this->connection.rollback();
-      qDebug() << Q_FUNC_INFO << "Database transaction rollback: " << (succeeded ? "succeeded" : "failed");
+      qCDebug(Logging::db) << Q_FUNC_INFO << "Database transaction rollback: " << (succeeded ? "succeeded" : "failed");
       if (!succeeded) {
          qCritical() << Q_FUNC_INFO << "Unable to rollback database transaction:" << connection.lastError().text();
       }
@@ -61,10 +133,27 @@ DbTransaction::~DbTransaction() {
 }
 
 bool DbTransaction::commit() {
+   if (this->nestingLevel > 0) {
+      // Nothing is actually written to the DB until the outermost transaction commits
+      this->committed = execSavepointCommand(this->connection, "RELEASE SAVEPOINT " + savepointName(this->nestingLevel));
+      qCDebug(Logging::db) <<
+         Q_FUNC_INFO << "Database savepoint" << this->nestingLevel << "release: " <<
+         (this->committed ? "succeeded" : "failed");
+      return this->committed;
+   }
+
    this->committed = connection.commit();
-   qDebug() << Q_FUNC_INFO << "Database transaction commit: " << (this->committed ? "succeeded" : "failed");
+   if (this->committed) {
+      static Metrics::Counter & numCommits = Metrics::counter("db.transactions.committed");
+      numCommits.add();
+   }
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Database transaction commit: " << (this->committed ? "succeeded" : "failed");
    if (!this->committed) {
       qCritical() << Q_FUNC_INFO << "Unable to commit database transaction:" << connection.lastError().text();
    }
    return this->committed;
 }
+
+bool DbTransaction::isInProgress(QSqlDatabase const & connection) {
+   return connectionNameToNumTransactions.value(connection.connectionName(), 0) > 0;
+}
@@ -26,6 +26,18 @@ class Database;
 
 /**
  * \brief RAII wrapper for transaction(), commit(), rollback() member functions of QSqlDatabase
+ *
+ *        \c DbTransaction objects can be nested (on the same thread and connection).  Eg, a caller that wants to store
+ *        several objects atomically can create a \c DbTransaction around multiple calls to \c ObjectStore functions,
+ *        each of which creates its own \c DbTransaction.  Only the outermost one starts a real DB transaction.  Inner
+ *        ones use SQL savepoints (supported by both SQLite and PostgreSQL), so rolling back an inner one undoes only
+ *        its own work, and nothing is actually committed to the DB until the outermost one commits.
+ *
+ *        On the main thread, the outermost \c DbTransaction first waits for any writes queued on the DB's worker pool
+ *        (see \c Database::workerPool()) to be done.  So the transaction sees the results of those writes and, because
+ *        nothing is queued while a transaction is open (see \c ObjectStore::updateProperty), a worker can never be
+ *        held up by rows the transaction has locked.  (With PostgreSQL, waiting for a worker that is itself waiting
+ *        for us would deadlock.)
  */
 class DbTransaction {
 public:
@@ -52,12 +64,20 @@ public:
     */
    bool commit();
 
+   /**
+    * \return \c true if there is a \c DbTransaction for \c connection that has not yet gone out of scope (on this
+    *         thread, which, given connections are per-thread, amounts to the same thing)
+    */
+   static bool isInProgress(QSqlDatabase const & connection);
+
 private:
    Database & database;
    // This is intended to be a short-lived object, so it's OK to store a reference to a QSqlDatabase object
    QSqlDatabase & connection;
    bool committed;
    int specialBehaviours;
+   // 0 for the outermost transaction on this connection, 1 for one nested inside it, etc
+   int nestingLevel;
 
    // RAII class shouldn't be getting copied or moved
    DbTransaction(DbTransaction const &) = delete;
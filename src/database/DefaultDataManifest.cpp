@@ -0,0 +1,261 @@
+/*
+ * database/DefaultDataManifest.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "database/DefaultDataManifest.h"
+
+#include <cstring>
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+
+namespace {
+   char const * const MANIFEST_COMMENT =
+      "# Top-level records in the default data file -- see src/database/DefaultDataManifest.h.  Do not edit by hand.";
+   char const * const FILE_HASH_KEY = "file";
+
+   //! Markup that isn't an element, and can't contain elements, so we skip over it
+   struct SkippedMarkup {
+      char const * start;
+      char const * end;
+   };
+   SkippedMarkup const skippedMarkup[] {
+      {"<?",         "?>" }, // XML declaration and processing instructions
+      {"<!--",       "-->"}, // Comments
+      {"<![CDATA[",  "]]>"}, // CDATA sections
+      {"<!",         ">"  }  // DOCTYPE etc (must come after the other "<!" markup)
+   };
+
+   /**
+    * \return Position of the first character after the markup starting at \c pos if it is one of the \c skippedMarkup
+    *         types, \c pos if it isn't, or -1 if it is unterminated
+    */
+   int skipMarkup(QByteArray const & data, int pos) {
+      for (auto const & markup : skippedMarkup) {
+         if (std::strncmp(data.constData() + pos, markup.start, std::strlen(markup.start)) == 0) {
+            int const end = data.indexOf(markup.end, pos + static_cast<int>(std::strlen(markup.start)));
+            return end < 0 ? -1 : end + static_cast<int>(std::strlen(markup.end));
+         }
+      }
+      return pos;
+   }
+
+   //! \return The name from the tag starting at \c pos, which ends at \c tagEnd
+   QByteArray tagName(QByteArray const & data, int pos, int tagEnd) {
+      int nameStart = pos + 1;
+      if (data.at(nameStart) == '/') {
+         ++nameStart;
+      }
+      int nameEnd = nameStart;
+      while (nameEnd < tagEnd && !std::strchr(" \t\r\n/", data.at(nameEnd))) {
+         ++nameEnd;
+      }
+      return data.mid(nameStart, nameEnd - nameStart);
+   }
+}
+
+bool DefaultDataManifest::Record::operator==(Record const & other) const {
+   return this->hash        == other.hash   &&
+          this->offset      == other.offset &&
+          this->length      == other.length &&
+          this->sectionName == other.sectionName;
+}
+
+QString DefaultDataManifest::manifestFileName(QString const & dataFileName) {
+   QFileInfo const dataFileInfo{dataFileName};
+   return dataFileInfo.dir().filePath(dataFileInfo.completeBaseName() + ".manifest");
+}
+
+DefaultDataManifest DefaultDataManifest::build(QByteArray const & dataFileContents) {
+   DefaultDataManifest manifest;
+   manifest.fileHash = DefaultDataManifest::hash(dataFileContents);
+
+   //
+   // BeerXML doesn't have a root element, so the top-level elements (depth 0) are the sections (<HOPS>, <RECIPES>,
+   // etc) and the records we want are the elements inside them (depth 1).
+   //
+   int depth = 0;
+   QByteArray sectionName;
+   int recordStart = -1;
+   for (int pos = dataFileContents.indexOf('<'); pos >= 0; ) {
+      int const afterMarkup = skipMarkup(dataFileContents, pos);
+      if (afterMarkup < 0) {
+         break;
+      }
+      if (afterMarkup != pos) {
+         pos = dataFileContents.indexOf('<', afterMarkup);
+         continue;
+      }
+
+      int const tagEnd = dataFileContents.indexOf('>', pos);
+      if (tagEnd < 0) {
+         // The file is truncated.  We'll leave it to the BeerXML import to complain about it.
+         break;
+      }
+      bool const isEndTag = dataFileContents.at(pos + 1) == '/';
+      bool const isEmptyElement = dataFileContents.at(tagEnd - 1) == '/';
+      int recordEnd = -1;
+      if (isEndTag) {
+         --depth;
+         if (depth == 1) {
+            recordEnd = tagEnd + 1;
+         }
+      } else {
+         if (depth == 0) {
+            sectionName = tagName(dataFileContents, pos, tagEnd);
+         } else if (depth == 1) {
+            recordStart = pos;
+            if (isEmptyElement) {
+               recordEnd = tagEnd + 1;
+            }
+         }
+         if (!isEmptyElement) {
+            ++depth;
+         }
+      }
+
+      if (recordEnd >= 0) {
+         QByteArray const record = dataFileContents.mid(recordStart, recordEnd - recordStart);
+         manifest.manifestRecords.append(
+            Record{DefaultDataManifest::hash(record), recordStart, recordEnd - recordStart, sectionName}
+         );
+      }
+
+      pos = dataFileContents.indexOf('<', tagEnd + 1);
+   }
+
+   return manifest;
+}
+
+std::optional<DefaultDataManifest> DefaultDataManifest::read(QString const & manifestFileName) {
+   QFile manifestFile{manifestFileName};
+   if (!manifestFile.open(QIODevice::ReadOnly)) {
+      qWarning() << Q_FUNC_INFO << "Could not read" << manifestFileName;
+      return std::nullopt;
+   }
+
+   DefaultDataManifest manifest;
+   int lineNumber = 0;
+   while (!manifestFile.atEnd()) {
+      QByteArray const line = manifestFile.readLine().trimmed();
+      ++lineNumber;
+      if (line.isEmpty() || line.startsWith('#')) {
+         continue;
+      }
+      QList<QByteArray> const fields = line.split(' ');
+      if (fields.size() == 2 && fields.at(0) == FILE_HASH_KEY) {
+         manifest.fileHash = fields.at(1);
+         continue;
+      }
+      bool offsetOk = false;
+      bool lengthOk = false;
+      Record record;
+      if (fields.size() == 4) {
+         record = Record{fields.at(0), fields.at(1).toInt(&offsetOk), fields.at(2).toInt(&lengthOk), fields.at(3)};
+      }
+      if (!offsetOk || !lengthOk) {
+         qWarning() << Q_FUNC_INFO << "Invalid line" << lineNumber << "in" << manifestFileName << ":" << line;
+         return std::nullopt;
+      }
+      manifest.manifestRecords.append(record);
+   }
+
+   if (manifest.fileHash.isEmpty()) {
+      qWarning() << Q_FUNC_INFO << "No data file hash in" << manifestFileName;
+      return std::nullopt;
+   }
+   return manifest;
+}
+
+bool DefaultDataManifest::write(QString const & manifestFileName) const {
+   QFile manifestFile{manifestFileName};
+   if (!manifestFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      qWarning() << Q_FUNC_INFO << "Could not write" << manifestFileName;
+      return false;
+   }
+
+   QByteArray contents{MANIFEST_COMMENT};
+   contents += "\n";
+   contents += QByteArray{FILE_HASH_KEY} + " " + this->fileHash + "\n";
+   for (auto const & record : this->manifestRecords) {
+      contents += record.hash + " " + QByteArray::number(record.offset) + " " + QByteArray::number(record.length) +
+                  " " + record.sectionName + "\n";
+   }
+   return manifestFile.write(contents) == contents.size();
+}
+
+QByteArray const & DefaultDataManifest::dataFileHash() const {
+   return this->fileHash;
+}
+
+QVector<DefaultDataManifest::Record> const & DefaultDataManifest::records() const {
+   return this->manifestRecords;
+}
+
+QVector<DefaultDataManifest::Record> DefaultDataManifest::recordsNotIn(QSet<QByteArray> const & knownHashes) const {
+   QVector<Record> newRecords;
+   for (auto const & record : this->manifestRecords) {
+      if (!knownHashes.contains(record.hash)) {
+         newRecords.append(record);
+      }
+   }
+   return newRecords;
+}
+
+QByteArray DefaultDataManifest::extract(QByteArray const & dataFileContents, QVector<Record> const & records) {
+   // BeerXML requires the XML declaration on the first line, so we keep the data file's one
+   int const firstLineEnd = dataFileContents.indexOf('\n');
+   if (firstLineEnd < 0) {
+      return QByteArray{};
+   }
+   QByteArray document = dataFileContents.left(firstLineEnd + 1);
+
+   // Consecutive records from the same section go in one copy of that section
+   QByteArray currentSectionName;
+   for (auto const & record : records) {
+      QByteArray const contents = dataFileContents.mid(record.offset, record.length);
+      if (record.offset < 0 || contents.size() != record.length || DefaultDataManifest::hash(contents) != record.hash) {
+         qWarning() << Q_FUNC_INFO << "Record at offset" << record.offset << "does not match data file";
+         return QByteArray{};
+      }
+      if (record.sectionName != currentSectionName) {
+         if (!currentSectionName.isEmpty()) {
+            document += "</" + currentSectionName + ">\n";
+         }
+         currentSectionName = record.sectionName;
+         document += "<" + currentSectionName + ">\n";
+      }
+      document += contents + "\n";
+   }
+   if (!currentSectionName.isEmpty()) {
+      document += "</" + currentSectionName + ">\n";
+   }
+
+   return document;
+}
+
+QByteArray DefaultDataManifest::hash(QByteArray const & data) {
+   return QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex();
+}
+
+bool DefaultDataManifest::operator==(DefaultDataManifest const & other) const {
+   return this->fileHash == other.fileHash && this->manifestRecords == other.manifestRecords;
+}
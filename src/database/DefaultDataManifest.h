@@ -0,0 +1,117 @@
+/*
+ * database/DefaultDataManifest.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATABASE_DEFAULTDATAMANIFEST_H
+#define DATABASE_DEFAULTDATAMANIFEST_H
+#pragma once
+
+#include <optional>
+
+#include <QByteArray>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+/**
+ * \brief A list of the top-level records (each \<HOP\>, \<RECIPE\>, etc) in the default data file, with a content hash
+ *        for each one.
+ *
+ *        When the default data file changes, we only want to import the records that are new since the user last
+ *        merged it.  We store the hashes of the records we have merged in the user's DB (see
+ *        \c DatabaseSchemaHelper::updateDatabase), so, with the manifest, we can work out which records are new
+ *        without parsing anything, then cut just those records out of the file (see \c extract()) and import them.
+ *
+ *        The manifest is shipped next to the default data file (as DefaultData.manifest) so we don't have to scan
+ *        the file for records at run-time.  It includes a hash of the whole data file, so, if someone edits the data
+ *        file without regenerating the manifest, we notice and \c build() a new one instead.  (The unit tests check
+ *        that the shipped manifest is up-to-date.)
+ *
+ *        Hashes are SHA-256 of the bytes of the record in the file, from the \c < of the opening tag to the \c > of
+ *        the closing tag, so any edit to a record (even just whitespace) makes it a new record.  That's OK because
+ *        the BeerXML import skips records that duplicate ones already in the DB.
+ */
+class DefaultDataManifest {
+public:
+   struct Record {
+      //! Hex-encoded SHA-256 of the record
+      QByteArray hash;
+      //! Where the record starts in the data file
+      int offset;
+      //! Length of the record in bytes
+      int length;
+      //! Tag name of the section the record is in (eg HOPS, RECIPES)
+      QByteArray sectionName;
+
+      bool operator==(Record const & other) const;
+   };
+
+   /**
+    * \return Name of the manifest file for a given default data file (ie "DefaultData.manifest" in the same directory
+    *         for "DefaultData.xml")
+    */
+   static QString manifestFileName(QString const & dataFileName);
+
+   /**
+    * \brief Make the manifest for the contents of a default data file.  This relies only on the file being well-formed
+    *        XML without attributes (which BeerXML doesn't use) -- ie it doesn't validate the file.
+    */
+   static DefaultDataManifest build(QByteArray const & dataFileContents);
+
+   /**
+    * \brief Read a manifest file
+    *
+    * \return The manifest, or \c std::nullopt if the file could not be read or was not a valid manifest
+    */
+   static std::optional<DefaultDataManifest> read(QString const & manifestFileName);
+
+   /**
+    * \brief Write the manifest to file (which is how DefaultData.manifest is generated)
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool write(QString const & manifestFileName) const;
+
+   //! \return Hex-encoded SHA-256 of the whole data file
+   QByteArray const & dataFileHash() const;
+
+   QVector<Record> const & records() const;
+
+   //! \return The records whose hashes are not in \c knownHashes, in the order they appear in the data file
+   QVector<Record> recordsNotIn(QSet<QByteArray> const & knownHashes) const;
+
+   /**
+    * \brief Make a BeerXML document containing just the given records from the data file
+    *
+    * \param dataFileContents Contents of the data file this manifest was built from
+    * \param records Some or all of the records in this manifest, in data file order
+    *
+    * \return The BeerXML document, or an empty array if any of the records is not in \c dataFileContents
+    */
+   static QByteArray extract(QByteArray const & dataFileContents, QVector<Record> const & records);
+
+   //! \return Hex-encoded SHA-256 of \c data
+   static QByteArray hash(QByteArray const & data);
+
+   bool operator==(DefaultDataManifest const & other) const;
+
+private:
+   QByteArray fileHash;
+   QVector<Record> manifestRecords;
+};
+
+#endif
@@ -0,0 +1,423 @@
+/*
+ * database/FullTextSearch.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "database/FullTextSearch.h"
+
+#include <array>
+
+#include <QDebug>
+#include <QRegularExpression>
+#include <QSqlError>
+#include <QStringList>
+#include <QTextStream>
+#include <QVariant>
+
+#include "database/BtSqlQuery.h"
+#include "database/Database.h"
+#include "database/DatabaseWorkerPool.h"
+#include "Logging.h"
+
+QString const FullTextSearch::SNIPPET_MATCH_START{"«"};
+QString const FullTextSearch::SNIPPET_MATCH_END{"»"};
+
+namespace {
+   char const * const SEARCH_TABLE_NAME = "search_text";
+
+   //
+   // PostgreSQL text search configuration.  We use 'english' to get stemming comparable to the porter tokenizer we ask
+   // for on SQLite (so that, eg, searching for "stuck" finds "sticking").
+   //
+   char const * const PG_TEXT_SEARCH_CONFIG = "english";
+
+   // Number of words either side of a match to include in a snippet
+   int constexpr SNIPPET_NUM_TOKENS = 12;
+
+   struct IndexedColumn {
+      char const * tableName;
+      char const * columnName;
+   };
+
+   //
+   // The columns whose contents we index.  NB: Because the position in this list is part of the key of each row in the
+   // search_text table, new entries must only ever be added at the end (and need a schema migration to rebuild the
+   // index).
+   //
+   std::array<IndexedColumn, 4> const indexedColumns {{
+      {"recipe",      "notes"      },
+      {"recipe",      "taste_notes"},
+      {"brewnote",    "notes"      },
+      {"instruction", "directions" }
+   }};
+   int constexpr numIndexedColumns = static_cast<int>(std::tuple_size<decltype(indexedColumns)>::value);
+
+   /**
+    * \return Position of the specified column in \c indexedColumns, or -1 if it's not there
+    */
+   int columnIndexOf(QString const & tableName, QString const & columnName) {
+      for (int ii = 0; ii < numIndexedColumns; ++ii) {
+         if (tableName == indexedColumns[ii].tableName && columnName == indexedColumns[ii].columnName) {
+            return ii;
+         }
+      }
+      return -1;
+   }
+
+   /**
+    * \brief The primary key in search_text for a given column of a given object
+    */
+   int searchKey(int objectId, int columnIndex) {
+      return objectId * numIndexedColumns + columnIndex;
+   }
+
+   /**
+    * \brief On SQLite, we need to know whether search_text is an FTS5 table or the fallback ordinary one
+    */
+   bool isFts5(QSqlDatabase & connection) {
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare("SELECT sql FROM sqlite_master WHERE type = 'table' AND name = :name;");
+      sqlQuery.bindValue(":name", QString{SEARCH_TABLE_NAME});
+      if (!sqlQuery.exec() || !sqlQuery.next()) {
+         return false;
+      }
+      return sqlQuery.value(0).toString().contains("fts5", Qt::CaseInsensitive);
+   }
+
+   QStringList splitIntoWords(QString const & queryText) {
+#if QT_VERSION < QT_VERSION_CHECK(5,15,0)
+      return queryText.split(QRegularExpression{"\\s+"}, QString::SkipEmptyParts);
+#else
+      return queryText.split(QRegularExpression{"\\s+"}, Qt::SkipEmptyParts);
+#endif
+   }
+
+   /**
+    * \brief Turn what the user typed into an FTS5 query expression.
+    *
+    *        We quote every word so that punctuation (which is everywhere in brewing notes, eg "1.050", "60-min") can't
+    *        generate an FTS5 syntax error, and make the last word a prefix match.
+    */
+   QString toFts5Query(QString const & queryText) {
+      QStringList terms;
+      for (QString word : splitIntoWords(queryText)) {
+         terms.append(QString{"\"%1\""}.arg(word.replace("\"", "\"\"")));
+      }
+      if (!terms.isEmpty()) {
+         terms.last().append("*");
+      }
+      return terms.join(" ");
+   }
+
+   /**
+    * \brief Equivalent of \c toFts5Query for PostgreSQL.  Words are ANDed with &, and :* marks a prefix match.  We
+    *        strip anything that would be an operator in tsquery syntax.
+    */
+   QString toTsQuery(QString const & queryText) {
+      QStringList terms;
+      for (QString word : splitIntoWords(queryText)) {
+         word.remove(QRegularExpression{"[&|!():*'\\\\<>]"});
+         if (!word.isEmpty()) {
+            terms.append(QString{"'%1'"}.arg(word));
+         }
+      }
+      if (!terms.isEmpty()) {
+         terms.last().append(":*");
+      }
+      return terms.join(" & ");
+   }
+
+   bool insertIntoIndex(Database & database, QSqlDatabase & connection, int key, QString const & text) {
+      QString queryString;
+      QTextStream queryStringAsStream{&queryString};
+      if (database.dbType() == Database::PGSQL) {
+         queryStringAsStream <<
+            "INSERT INTO " << SEARCH_TABLE_NAME << " (id, content, content_tsv) "
+            "VALUES (:id, :content, to_tsvector('" << PG_TEXT_SEARCH_CONFIG << "', :contentForVector));";
+      } else {
+         queryStringAsStream <<
+            "INSERT INTO " << SEARCH_TABLE_NAME << " (rowid, content) VALUES (:id, :content);";
+      }
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare(queryString);
+      sqlQuery.bindValue(":id", key);
+      sqlQuery.bindValue(":content", text);
+      if (database.dbType() == Database::PGSQL) {
+         sqlQuery.bindValue(":contentForVector", text);
+      }
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
+      return true;
+   }
+
+   bool deleteFromIndex(Database & database, QSqlDatabase & connection, int key) {
+      QString queryString;
+      QTextStream queryStringAsStream{&queryString};
+      queryStringAsStream <<
+         "DELETE FROM " << SEARCH_TABLE_NAME << " WHERE " <<
+         (database.dbType() == Database::PGSQL ? "id" : "rowid") << " = :id;";
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare(queryString);
+      sqlQuery.bindValue(":id", key);
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
+      return true;
+   }
+
+}
+
+bool FullTextSearch::isIndexed(QString const & tableName, QString const & columnName) {
+   return columnIndexOf(tableName, columnName) >= 0;
+}
+
+bool FullTextSearch::createIndex(Database & database, QSqlDatabase & connection) {
+   QString queryString;
+   QTextStream queryStringAsStream{&queryString};
+   BtSqlQuery sqlQuery{connection};
+
+   if (database.dbType() == Database::PGSQL) {
+      queryStringAsStream <<
+         "CREATE TABLE " << SEARCH_TABLE_NAME << " ("
+            "id          " << database.getDbNativeTypeName<int>() << " PRIMARY KEY, "
+            "content     " << database.getDbNativeTypeName<QString>() << ", "
+            "content_tsv TSVECTOR"
+         ");";
+      sqlQuery.prepare(queryString);
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
+
+      queryString.clear();
+      queryStringAsStream <<
+         "CREATE INDEX " << SEARCH_TABLE_NAME << "_tsv_idx ON " << SEARCH_TABLE_NAME << " USING GIN (content_tsv);";
+      sqlQuery.prepare(queryString);
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
+      return true;
+   }
+
+   //
+   // On SQLite, we want an FTS5 virtual table.  Its only indexed column is the text itself; the rowid is our key.
+   //
+   queryStringAsStream <<
+      "CREATE VIRTUAL TABLE " << SEARCH_TABLE_NAME << " USING fts5(content, tokenize = 'porter unicode61');";
+   sqlQuery.prepare(queryString);
+   if (sqlQuery.exec()) {
+      return true;
+   }
+
+   //
+   // Most builds of SQLite (including the one embedded in Qt) include FTS5, but it's a compile-time option so we can't
+   // rely on it.  If it's not there, we create an ordinary table with the same columns, and search() will fall back to
+   // using LIKE.  This is a lot slower on a big database, but it's better than having no search at all.
+   //
+   qWarning() <<
+      Q_FUNC_INFO << "Unable to create FTS5 table (" << sqlQuery.lastError().text() << ") so falling back to "
+      "unindexed search";
+   queryString.clear();
+   queryStringAsStream <<
+      "CREATE TABLE " << SEARCH_TABLE_NAME << " ("
+         "id      " << database.getDbNativePrimaryKeyDeclaration() << ", "
+         "content " << database.getDbNativeTypeName<QString>() <<
+      ");";
+   sqlQuery.prepare(queryString);
+   if (!sqlQuery.exec()) {
+      qCritical() <<
+         Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+      return false;
+   }
+   return true;
+}
+
+bool FullTextSearch::rebuildIndex(Database & database, QSqlDatabase & connection) {
+   QString queryString;
+   QTextStream queryStringAsStream{&queryString};
+   queryStringAsStream << "DELETE FROM " << SEARCH_TABLE_NAME << ";";
+   BtSqlQuery sqlQuery{connection};
+   sqlQuery.prepare(queryString);
+   if (!sqlQuery.exec()) {
+      qCritical() <<
+         Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+      return false;
+   }
+
+   int numRowsIndexed = 0;
+   for (int columnIndex = 0; columnIndex < numIndexedColumns; ++columnIndex) {
+      IndexedColumn const & indexedColumn = indexedColumns[columnIndex];
+      queryString.clear();
+      queryStringAsStream <<
+         "SELECT id, " << indexedColumn.columnName << " FROM " << indexedColumn.tableName <<
+         " WHERE " << indexedColumn.columnName << " IS NOT NULL;";
+      BtSqlQuery selectQuery{connection};
+      selectQuery.prepare(queryString);
+      if (!selectQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << selectQuery.lastError().text();
+         return false;
+      }
+      while (selectQuery.next()) {
+         QString const text = selectQuery.value(1).toString();
+         if (text.trimmed().isEmpty()) {
+            continue;
+         }
+         if (!insertIntoIndex(database, connection, searchKey(selectQuery.value(0).toInt(), columnIndex), text)) {
+            return false;
+         }
+         ++numRowsIndexed;
+      }
+   }
+
+   qCInfo(Logging::db) << Q_FUNC_INFO << "Indexed" << numRowsIndexed << "text fields for full-text search";
+   return true;
+}
+
+bool FullTextSearch::updateIndex(Database & database,
+                                 QSqlDatabase & connection,
+                                 QString const & tableName,
+                                 int objectId,
+                                 QString const & columnName,
+                                 QString const & text) {
+   int const columnIndex = columnIndexOf(tableName, columnName);
+   if (columnIndex < 0) {
+      return true;
+   }
+
+   int const key = searchKey(objectId, columnIndex);
+   if (!deleteFromIndex(database, connection, key)) {
+      return false;
+   }
+
+   // There's no point storing empty text, as it can never match anything
+   if (text.trimmed().isEmpty()) {
+      return true;
+   }
+
+   return insertIntoIndex(database, connection, key, text);
+}
+
+bool FullTextSearch::removeFromIndex(Database & database,
+                                     QSqlDatabase & connection,
+                                     QString const & tableName,
+                                     int objectId) {
+   for (int columnIndex = 0; columnIndex < numIndexedColumns; ++columnIndex) {
+      if (tableName == indexedColumns[columnIndex].tableName) {
+         if (!deleteFromIndex(database, connection, searchKey(objectId, columnIndex))) {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+QVector<FullTextSearch::Match> FullTextSearch::search(Database & database, QString const & queryText, int maxResults) {
+   QVector<FullTextSearch::Match> results;
+
+   // Index updates may still be queued (see ObjectStore::updateProperty), and we want to find what the user just typed
+   DatabaseWorkerPool * workerPool = database.workerPool();
+   if (workerPool) {
+      workerPool->waitForAll();
+   }
+
+   QSqlDatabase connection = database.sqlDatabase();
+   QString queryString;
+   QTextStream queryStringAsStream{&queryString};
+   QString matchExpression;
+
+   //
+   // Whichever DB we're using, we want a query that returns key, snippet and rank -- in that order -- best match first
+   //
+   if (database.dbType() == Database::PGSQL) {
+      matchExpression = toTsQuery(queryText);
+      queryStringAsStream <<
+         "SELECT id, "
+                "ts_headline('" << PG_TEXT_SEARCH_CONFIG << "', content, query, "
+                            "'StartSel=" << SNIPPET_MATCH_START << ", StopSel=" << SNIPPET_MATCH_END << ", "
+                            "MaxWords=" << SNIPPET_NUM_TOKENS * 2 << ", MinWords=" << SNIPPET_NUM_TOKENS / 2 << "'), "
+                "ts_rank(content_tsv, query) AS rank "
+         "FROM " << SEARCH_TABLE_NAME << ", to_tsquery('" << PG_TEXT_SEARCH_CONFIG << "', :query) query "
+         "WHERE content_tsv @@ query "
+         "ORDER BY rank DESC "
+         "LIMIT :maxResults;";
+   } else if (isFts5(connection)) {
+      matchExpression = toFts5Query(queryText);
+      // NB: bm25() returns "better" matches as more negative numbers, hence ordering ascending and negating the rank
+      queryStringAsStream <<
+         "SELECT rowid, "
+                "snippet(" << SEARCH_TABLE_NAME << ", 0, "
+                        "'" << SNIPPET_MATCH_START << "', '" << SNIPPET_MATCH_END << "', '...', " <<
+                        SNIPPET_NUM_TOKENS << "), "
+                "-bm25(" << SEARCH_TABLE_NAME << ") "
+         "FROM " << SEARCH_TABLE_NAME << " "
+         "WHERE " << SEARCH_TABLE_NAME << " MATCH :query "
+         "ORDER BY bm25(" << SEARCH_TABLE_NAME << ") "
+         "LIMIT :maxResults;";
+   } else {
+      // Fallback for SQLite without FTS5 -- see comment in createIndex()
+      matchExpression = QString{"%%1%"}.arg(queryText.trimmed());
+      queryStringAsStream <<
+         "SELECT rowid, content, 0 "
+         "FROM " << SEARCH_TABLE_NAME << " "
+         "WHERE content LIKE :query "
+         "LIMIT :maxResults;";
+   }
+
+   if (matchExpression.isEmpty()) {
+      return results;
+   }
+
+   BtSqlQuery sqlQuery{connection};
+   sqlQuery.prepare(queryString);
+   sqlQuery.bindValue(":query", matchExpression);
+   sqlQuery.bindValue(":maxResults", maxResults);
+   if (!sqlQuery.exec()) {
+      qCritical() <<
+         Q_FUNC_INFO << "Error executing database query " << queryString << " (with query =" << matchExpression <<
+         "): " << sqlQuery.lastError().text();
+      return results;
+   }
+
+   while (sqlQuery.next()) {
+      int const key = sqlQuery.value(0).toInt();
+      IndexedColumn const & indexedColumn = indexedColumns[key % numIndexedColumns];
+      results.append(FullTextSearch::Match{indexedColumn.tableName,
+                                           indexedColumn.columnName,
+                                           key / numIndexedColumns,
+                                           sqlQuery.value(1).toString(),
+                                           sqlQuery.value(2).toDouble()});
+   }
+
+   qCDebug(Logging::db) << Q_FUNC_INFO << results.size() << "matches for" << queryText;
+   return results;
+}
+
+bool FullTextSearch::isWordBased(Database & database) {
+   if (database.dbType() == Database::PGSQL) {
+      return true;
+   }
+   QSqlDatabase connection = database.sqlDatabase();
+   return isFts5(connection);
+}
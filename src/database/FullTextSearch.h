@@ -0,0 +1,122 @@
+/*
+ * database/FullTextSearch.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATABASE_FULLTEXTSEARCH_H
+#define DATABASE_FULLTEXTSEARCH_H
+#pragma once
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+
+class Database;
+
+/**
+ * \brief Full-text search over the free-text fields that users write in (recipe notes, tasting notes, brew notes and
+ *        instruction directions).
+ *
+ *        The index lives in the database alongside the tables managed by \c ObjectStore, in a single table called
+ *        \c search_text:
+ *           - On SQLite, this is an FTS5 virtual table (see https://www.sqlite.org/fts5.html), ranked with bm25().
+ *             (If the SQLite library we are linked against was built without FTS5, we fall back to an ordinary table
+ *             and a LIKE search so that the rest of the program does not need to care.)
+ *           - On PostgreSQL, it is an ordinary table with a \c tsvector column and a GIN index on it, ranked with
+ *             ts_rank().
+ *
+ *        Each row of \c search_text holds the text of one indexed column of one object.  Its primary key is derived
+ *        from the object's primary key and the position of the column in our list of indexed columns, which means we
+ *        can update or delete a row without a full scan, and do not need to store the table/column names in every row.
+ *
+ *        \c ObjectStore keeps the index in step with the primary tables (in the same DB transaction) whenever an
+ *        object is inserted, updated or hard-deleted.  The index is only ever derived data, so it can always be thrown
+ *        away and rebuilt from the primary tables with \c rebuildIndex().
+ */
+namespace FullTextSearch {
+
+   /**
+    * \brief One hit returned from \c search()
+    */
+   struct Match {
+      //! Name of the primary table of the object that matched, eg "recipe", "brewnote", "instruction"
+      QString tableName;
+      //! Name of the column in that table whose text matched, eg "notes", "taste_notes"
+      QString columnName;
+      //! Primary key of the object that matched
+      int objectId;
+      //! Extract of the matching text, with matched terms wrapped in \c SNIPPET_MATCH_START / \c SNIPPET_MATCH_END
+      QString snippet;
+      //! Relevance of the match.  Only meaningful for ordering results of a single search.  Higher is better.
+      double rank;
+   };
+
+   extern QString const SNIPPET_MATCH_START;
+   extern QString const SNIPPET_MATCH_END;
+
+   /**
+    * \return \c true if the specified column of the specified primary table is one whose contents we index
+    */
+   bool isIndexed(QString const & tableName, QString const & columnName);
+
+   /**
+    * \brief Create the search index table(s).  It is the caller's responsibility to handle transactions.
+    */
+   bool createIndex(Database & database, QSqlDatabase & connection);
+
+   /**
+    * \brief Empty the search index and repopulate it from the primary tables.  Used after schema migration and after
+    *        copying data between databases.  It is the caller's responsibility to handle transactions.
+    */
+   bool rebuildIndex(Database & database, QSqlDatabase & connection);
+
+   /**
+    * \brief Set the indexed text for one column of one object, replacing whatever was there before.  Does nothing if
+    *        the column is not one we index.  It is the caller's responsibility to handle transactions.
+    */
+   bool updateIndex(Database & database,
+                    QSqlDatabase & connection,
+                    QString const & tableName,
+                    int objectId,
+                    QString const & columnName,
+                    QString const & text);
+
+   /**
+    * \brief Remove all indexed text for one object.  Does nothing if the table is not one we index.
+    */
+   bool removeFromIndex(Database & database, QSqlDatabase & connection, QString const & tableName, int objectId);
+
+   /**
+    * \brief Search the index
+    *
+    * \param database
+    * \param queryText What the user typed.  Words are ANDed together, and the last word is treated as a prefix so
+    *                  that results make sense while the user is still typing.
+    * \param maxResults
+    *
+    * \return Matches, best first.  Note that these can include soft-deleted objects, which it is the caller's
+    *         responsibility to filter out if required.
+    */
+   QVector<Match> search(Database & database, QString const & queryText, int maxResults = 100);
+
+   /**
+    * \return \c true if \c search() matches words in any order, \c false if we are using the LIKE fallback (see class
+    *         comment), which only finds the query text exactly as typed (ignoring ASCII case)
+    */
+   bool isWordBased(Database & database);
+}
+
+#endif
@@ -18,22 +18,44 @@
  */
 #include "database/ObjectStore.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 
 #include <QDebug>
 #include <QHash>
+#include <QMessageBox>
+#include <QSet>
 #include <QSqlDriver>
 #include <QSqlError>
 #include <QSqlField>
 #include <QSqlRecord>
+#include <QStringList>
 
+#include "brewtarget.h"
 #include "database/BtSqlQuery.h"
 #include "database/Database.h"
+#include "database/DatabaseWorkerPool.h"
 #include "database/DbTransaction.h"
+#include "database/FullTextSearch.h"
+#include "Logging.h"
 #include "model/NamedParameterBundle.h"
+#include "utils/MemoryAccounting.h"
+#include "utils/Metrics.h"
+#include "utils/StartupProfiler.h"
+#include "utils/Tracing.h"
 
 // Private implementation details that don't need access to class member variables
 namespace {
+   //
+   // See ObjectStore::changeGeneration().  Object stores are only modified on the main thread, but we make this atomic
+   // so it's safe to read from anywhere.
+   //
+   std::atomic<quint64> changeGenerationCounter{0};
+   void bumpChangeGeneration() {
+      changeGenerationCounter.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
 
    /**
     * For a given field type, get the native database typename
@@ -92,7 +114,7 @@ namespace {
       bool firstFieldOutput = false;
       for (auto const & fieldDefn: tableDefinition.tableFields) {
          if (fieldDefn.foreignKeyTo != nullptr) {
-            qDebug() << Q_FUNC_INFO << "Skipping" << fieldDefn.columnName << "as foreign key";
+            qCDebug(Logging::db) << Q_FUNC_INFO << "Skipping" << fieldDefn.columnName << "as foreign key";
             // It's (currently) a coding error if a foreign key is anything other than an integer
             Q_ASSERT(fieldDefn.fieldType == ObjectStore::FieldType::Int);
             continue;
@@ -124,7 +146,7 @@ namespace {
       }
       queryStringAsStream << "\n);";
 
-      qDebug().noquote() << Q_FUNC_INFO << "Table creation: " << queryString;
+      qCDebug(Logging::db).noquote() << Q_FUNC_INFO << "Table creation: " << queryString;
 
       BtSqlQuery sqlQuery{connection};
       sqlQuery.prepare(queryString);
@@ -183,7 +205,7 @@ namespace {
             ).arg(
                *fieldDefn.foreignKeyTo->tableFields[0].columnName
             );
-            qDebug().noquote() << Q_FUNC_INFO << "Foreign keys: " << queryString;
+            qCDebug(Logging::db).noquote() << Q_FUNC_INFO << "Foreign keys: " << queryString;
 
             sqlQuery.prepare(queryString);
             if (!sqlQuery.exec()) {
@@ -197,6 +219,63 @@ namespace {
       return true;
    }
 
+   /**
+    * \brief Create the indexes on a table -- see \c ObjectStore::createIndexes()
+    *
+    * \param indexes Any indexes the caller has worked out are needed.  We add the ones declared in
+    *                \c tableDefinition and the ones for its foreign keys.
+    *
+    * \return true if succeeded, false otherwise
+    */
+   bool createIndexesOnTable(QSqlDatabase & connection,
+                             ObjectStore::TableDefinition const & tableDefinition,
+                             QVector< QVector<char const *> > indexes) {
+      for (auto const & indexDefn : tableDefinition.indexes) {
+         indexes.append(indexDefn.columnNames);
+      }
+      for (auto const & fieldDefn : tableDefinition.tableFields) {
+         if (fieldDefn.foreignKeyTo == nullptr) {
+            continue;
+         }
+         // An index on (a, b, ...) also serves for lookups on a, so we don't need another one just on a
+         char const * const columnName = *fieldDefn.columnName;
+         bool const alreadyIndexed = std::any_of(
+            indexes.cbegin(),
+            indexes.cend(),
+            [columnName](QVector<char const *> const & columnNames) {
+               return std::strcmp(columnNames.first(), columnName) == 0;
+            }
+         );
+         if (!alreadyIndexed) {
+            indexes.append(QVector<char const *>{columnName});
+         }
+      }
+
+      //
+      // We name the index after the table and columns, which, with "IF NOT EXISTS", means we can safely run this again
+      // on a DB that already has the indexes.  (PostgreSQL truncates names over 63 characters, but it does so
+      // consistently, so this still works.)
+      //
+      BtSqlQuery sqlQuery{connection};
+      for (auto const & columnNames : indexes) {
+         QStringList columns;
+         for (char const * columnName : columnNames) {
+            columns.append(columnName);
+         }
+         QString const queryString = QString{"CREATE INDEX IF NOT EXISTS idx_%1_%2 ON %1 (%3);"}.arg(
+            *tableDefinition.tableName, columns.join("_"), columns.join(", ")
+         );
+         qCDebug(Logging::db).noquote() << Q_FUNC_INFO << "Index creation: " << queryString;
+         sqlQuery.prepare(queryString);
+         if (!sqlQuery.exec()) {
+            qCritical() <<
+               Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+            return false;
+         }
+      }
+      return true;
+   }
+
    /**
     * Return a string containing all the bound values on a query.   This is quite a useful thing to have logged when
     * you get an error!
@@ -276,26 +355,89 @@ namespace {
       return junctionTable.tableFields.size() > 3 ? junctionTable.tableFields[3].columnName : BtString::NULL_STR;
    }
 
+   //
+   // Most bind values we put in one statement when writing several junction table rows at once.  Older versions of
+   // SQLite have a limit of 999 (raised to 32766 in SQLite 3.32).  PostgreSQL allows many more, but a recipe never has
+   // anywhere near this many ingredients, so in practice we'll only ever need one statement of each type.
+   //
+   int constexpr MAX_BIND_VALUES = 999;
+
    /**
-    * \brief Insert data from an object property to a junction table
+    * \brief One row of a junction table, as far as we are concerned when syncing it with an object property
+    */
+   struct JunctionTableRow {
+      //! Primary key of the row itself (ie column 0 of the junction table).  Not used for rows we have yet to insert.
+      int id;
+      int otherPrimaryKey;
+      //! Value of the order by column, if there is one, counting from 1
+      int itemNumber;
+   };
+
+   /**
+    * \brief Run a statement over a list of items, putting as many items as will fit (see \c MAX_BIND_VALUES) into
+    *        each statement, so that, eg, deleting ten rows is one round trip to the DB rather than ten.
+    *
+    * \param connection
+    * \param numItems
+    * \param numBindValuesPerItem
+    * \param makeQueryString Given a number of items, returns the SQL for that many, using positional (\c ?)
+    *                        placeholders
+    * \param bindItems Given the first item and number of items in a batch, binds their values (with \c addBindValue)
+    * \param readResults If set, called after each statement has run, to read its results (eg with \c next())
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool execInBatches(QSqlDatabase & connection,
+                      int const numItems,
+                      int const numBindValuesPerItem,
+                      std::function<QString(int)> const & makeQueryString,
+                      std::function<void(BtSqlQuery &, int, int)> const & bindItems,
+                      std::function<void(BtSqlQuery &)> const & readResults = nullptr) {
+      int const maxItemsPerBatch = std::max(1, MAX_BIND_VALUES / numBindValuesPerItem);
+      for (int firstItem = 0; firstItem < numItems; firstItem += maxItemsPerBatch) {
+         int const itemsInBatch = std::min(maxItemsPerBatch, numItems - firstItem);
+         QString const queryString = makeQueryString(itemsInBatch);
+         BtSqlQuery sqlQuery{connection};
+         sqlQuery.prepare(queryString);
+         bindItems(sqlQuery, firstItem, itemsInBatch);
+         qCDebug(Logging::db).noquote() <<
+            Q_FUNC_INFO << queryString << "Bind values:" << BoundValuesToString(sqlQuery);
+         if (!sqlQuery.exec()) {
+            qCritical() <<
+               Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+            return false;
+         }
+         if (readResults) {
+            readResults(sqlQuery);
+         }
+      }
+      return true;
+   }
+
+   //! \return \c numPlaceholders positional placeholders, separated by commas, eg "?, ?, ?"
+   QString commaSeparatedPlaceholders(int const numPlaceholders) {
+      QStringList placeholders;
+      for (int ii = 0; ii < numPlaceholders; ++ii) {
+         placeholders.append("?");
+      }
+      return placeholders.join(", ");
+   }
+
+   /**
+    * \brief Read the list of "other" primary keys that an object property holds for a junction table
     *
     * \param junctionTable
     * \param object
     * \param primaryKey  Note that this must be supplied separately as, for a new object, we may not (yet) have set its
     *                    primary key (ie we cannot just read primary key from object)
-    * \param connection
+    * \param propertyValues Set to the keys, in order.  Empty if it's a single-entry property that is not set.
     *
     * \return \c true if succeeded, \c false otherwise
     */
-   bool insertIntoJunctionTableDefinition(ObjectStore::JunctionTableDefinition const & junctionTable,
-                                          QObject const & object,
-                                          QVariant const & primaryKey,
-                                          QSqlDatabase & connection) {
-      qDebug() <<
-         Q_FUNC_INFO << "Writing" << object.metaObject()->className() << "property" <<
-         GetJunctionTableDefinitionPropertyName(junctionTable) << " into junction table " <<
-         junctionTable.tableName;
-
+   bool readJunctionTablePropertyValues(ObjectStore::JunctionTableDefinition const & junctionTable,
+                                        QObject const & object,
+                                        QVariant const & primaryKey,
+                                        QVector<int> & propertyValues) {
       //
       // It's a coding error if the caller has supplied us anything other than an int inside the primaryKey QVariant.
       //
@@ -308,53 +450,6 @@ namespace {
          return false;    // Continue but bail out of the current DB transaction on other builds
       }
 
-      //
-      // Construct the query
-      //
-      // We may be inserting more than one row.  In theory we COULD combine all the rows into a single insert statement
-      // using either BtSqlQuery::execBatch() or directly constructing one of the common (but technically non-standard)
-      // syntaxes, eg the following works on a lot of databases (including PostgreSQL and newer versions of SQLite) for
-      // up to 1000 rows):
-      //    INSERT INTO table (columnA, columnB, ..., columnN)
-      //         VALUES       (r1_valA, r1_valB, ..., r1_valN),
-      //                      (r2_valA, r2_valB, ..., r2_valN),
-      //                      ...,
-      //                      (rm_valA, rm_valB, ..., rm_valN);
-      // However, we DON"T do this.  The variable binding is more complicated/error-prone than when just doing
-      // individual inserts.  (Even with BtSqlQuery::execBatch(), we'd have to loop to construct the lists of bind
-      // parameters.)  And there's likely no noticeable performance benefit given that we're typically inserting only
-      // a handful of rows at a time (eg all the Hops in a Recipe).
-      //
-      // So instead, we just do individual inserts.  Note that orderByColumn column is only used if specified, and
-      // that, if it is, we assume it's an integer type and that we create the values ourselves.
-      //
-      QString queryString{"INSERT INTO "};
-      QTextStream queryStringAsStream{&queryString};
-      queryStringAsStream << junctionTable.tableName << " (" <<
-         GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << ", " <<
-         GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
-      if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
-         queryStringAsStream << ", " << GetJunctionTableDefinitionOrderByColumn(junctionTable);
-      }
-      QString const thisPrimaryKeyBindName  = QString{":"} + *GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable);
-      QString const otherPrimaryKeyBindName = QString{":"} + *GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
-      QString const orderByBindName         = QString{":"} + *GetJunctionTableDefinitionOrderByColumn(junctionTable);
-      queryStringAsStream << ") VALUES (" << thisPrimaryKeyBindName << ", " << otherPrimaryKeyBindName;
-      if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
-         queryStringAsStream << ", " << orderByBindName;
-      }
-      queryStringAsStream << ");";
-      qDebug() << Q_FUNC_INFO << "Using query string" << queryString;
-
-      //
-      // Note that, when we are using bind values, we do NOT want to call the
-      // BtSqlQuery::BtSqlQuery(const QString &, QSqlDatabase db) version of the BtSqlQuery constructor because that would
-      // result in the supplied query being executed immediately (ie before we've had a chance to bind parameters).
-      //
-      BtSqlQuery sqlQuery{connection};
-      sqlQuery.prepare(queryString);
-
-      // Get the list of data to bind to it
       QVariant propertyValuesWrapper = object.property(*GetJunctionTableDefinitionPropertyName(junctionTable));
       if (!propertyValuesWrapper.isValid()) {
          // It's a programming error if we couldn't read a property value
@@ -366,7 +461,7 @@ namespace {
       }
 
       // We now need to extract the property values from their QVariant wrapper
-      QVector<int> propertyValues;
+      propertyValues.clear();
       if (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY) {
          // If it's single entry only, just turn it into a one-item list so that the remaining processing is the same
          bool succeeded = false;
@@ -380,7 +475,7 @@ namespace {
          // If the foreign key returned is not valid, it's not an error, it just means there is no associated object,
          // eg this Hop does not have a parent.
          if (theValue <= 0) {
-            qDebug() <<
+            qCDebug(Logging::db) <<
                Q_FUNC_INFO << "Property" << GetJunctionTableDefinitionPropertyName(junctionTable) << "of" <<
                object.metaObject()->className() << "#" << primaryKey.toInt() << "is" << theValue <<
                "which we assume means \"unset\", so nothing to write to junction table" <<
@@ -407,31 +502,281 @@ namespace {
          propertyValues = propertyValuesWrapper.value< QVector<int> >();
       }
 
-      // Now loop through and bind/run the insert query once for each item in the list
-      int itemNumber = 1;
-      qDebug() <<
+      qCDebug(Logging::db) <<
          Q_FUNC_INFO << propertyValues.size() << "value(s) (in" << propertyValuesWrapper.typeName() << ") for property" <<
          GetJunctionTableDefinitionPropertyName(junctionTable) << "of" << object.metaObject()->className() <<
          "#" << primaryKey.toInt();
-      for (int curValue : propertyValues) {
-         sqlQuery.bindValue(thisPrimaryKeyBindName, primaryKey);
-         sqlQuery.bindValue(otherPrimaryKeyBindName, curValue);
-         if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
-            sqlQuery.bindValue(orderByBindName, itemNumber);
+      return true;
+   }
+
+   /**
+    * \brief Insert rows for one object into a junction table
+    *
+    *        We put as many rows as we can into each INSERT statement, using the multi-row syntax:
+    *           INSERT INTO table (columnA, columnB, ..., columnN)
+    *                VALUES       (r1_valA, r1_valB, ..., r1_valN),
+    *                             (r2_valA, r2_valB, ..., r2_valN),
+    *                             ...,
+    *                             (rm_valA, rm_valB, ..., rm_valN);
+    *        This is technically non-standard but works on all the DBs we support (PostgreSQL, and SQLite since
+    *        3.7.11).
+    *
+    *        Note that orderByColumn column is only used if specified, and that, if it is, we assume it's an integer
+    *        type and that we create the values ourselves.
+    *
+    * \param junctionTable
+    * \param primaryKey
+    * \param rows  The \c id field of each row is ignored, as the DB will assign it
+    * \param connection
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool insertJunctionTableRows(ObjectStore::JunctionTableDefinition const & junctionTable,
+                                QVariant const & primaryKey,
+                                QVector<JunctionTableRow> const & rows,
+                                QSqlDatabase & connection) {
+      bool const hasOrderByColumn = !GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull();
+      int const numColumns = hasOrderByColumn ? 3 : 2;
+
+      QString columnNames;
+      QTextStream columnNamesAsStream{&columnNames};
+      columnNamesAsStream <<
+         GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << ", " <<
+         GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
+      if (hasOrderByColumn) {
+         columnNamesAsStream << ", " << GetJunctionTableDefinitionOrderByColumn(junctionTable);
+      }
+
+      return execInBatches(
+         connection,
+         rows.size(),
+         numColumns,
+         [&](int const numRows) {
+            QString const rowPlaceholders = QString{"(%1)"}.arg(commaSeparatedPlaceholders(numColumns));
+            QStringList allRowPlaceholders;
+            for (int ii = 0; ii < numRows; ++ii) {
+               allRowPlaceholders.append(rowPlaceholders);
+            }
+            return QString{"INSERT INTO %1 (%2) VALUES %3;"}.arg(*junctionTable.tableName,
+                                                                   columnNames,
+                                                                   allRowPlaceholders.join(", "));
+         },
+         [&](BtSqlQuery & sqlQuery, int const firstRow, int const numRows) {
+            for (int ii = firstRow; ii < firstRow + numRows; ++ii) {
+               sqlQuery.addBindValue(primaryKey);
+               sqlQuery.addBindValue(rows.at(ii).otherPrimaryKey);
+               if (hasOrderByColumn) {
+                  sqlQuery.addBindValue(rows.at(ii).itemNumber);
+               }
+            }
          }
-         qDebug() <<
-            Q_FUNC_INFO <<
-            GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << " #" << primaryKey.toInt() << ":" <<
-            GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable) << "N°" << itemNumber << " is #" << curValue;
+      );
+   }
 
-         if (!sqlQuery.exec()) {
-            qCritical() <<
-               Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-            return false;
+   /**
+    * \brief Insert data from an object property to a junction table
+    *
+    * \param junctionTable
+    * \param object
+    * \param primaryKey  Note that this must be supplied separately as, for a new object, we may not (yet) have set its
+    *                    primary key (ie we cannot just read primary key from object)
+    * \param connection
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool insertIntoJunctionTableDefinition(ObjectStore::JunctionTableDefinition const & junctionTable,
+                                          QObject const & object,
+                                          QVariant const & primaryKey,
+                                          QSqlDatabase & connection) {
+      qCDebug(Logging::db) <<
+         Q_FUNC_INFO << "Writing" << object.metaObject()->className() << "property" <<
+         GetJunctionTableDefinitionPropertyName(junctionTable) << " into junction table " <<
+         junctionTable.tableName;
+
+      QVector<int> propertyValues;
+      if (!readJunctionTablePropertyValues(junctionTable, object, primaryKey, propertyValues)) {
+         return false;
+      }
+
+      QVector<JunctionTableRow> rows;
+      rows.reserve(propertyValues.size());
+      int itemNumber = 1;
+      for (int curValue : propertyValues) {
+         rows.append(JunctionTableRow{0, curValue, itemNumber});
+         ++itemNumber;
+      }
+      return insertJunctionTableRows(junctionTable, primaryKey, rows, connection);
+   }
+
+   /**
+    * \brief Bring the rows for one object in a junction table into line with the corresponding object property, by
+    *        working out and applying the smallest set of changes rather than deleting all the rows and inserting them
+    *        again.  Eg, adding one hop to a recipe with 40 hops is one INSERT, and swapping two instructions is one
+    *        UPDATE (of two rows).
+    *
+    *        We match existing rows to property values by the other primary key (in order, in case the same key appears
+    *        more than once).  Then:
+    *           - rows with no matching value are deleted
+    *           - values with no matching row are inserted
+    *           - matched rows whose order by column (if there is one) no longer has the right value are updated
+    *        Each of these is done in as few statements as possible (see \c execInBatches).
+    *
+    *        Note that we always number items 1, 2, 3, ... (as \c insertIntoJunctionTableDefinition does), so inserting
+    *        or removing an item near the start of a list still means renumbering the items after it.  But that is
+    *        still only one UPDATE statement, and it doesn't touch the rows that don't move.
+    *
+    *        NB: Caller is responsible for handling transactions
+    *
+    *        This doesn't touch the object itself (the caller reads the property values with
+    *        \c readJunctionTablePropertyValues), so it is safe to call on a worker thread -- see
+    *        \c ObjectStore::updateProperty.
+    *
+    * \param junctionTable
+    * \param propertyValues What the property currently holds
+    * \param primaryKey
+    * \param connection
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool syncJunctionTableDefinition(ObjectStore::JunctionTableDefinition const & junctionTable,
+                                    QVector<int> const & propertyValues,
+                                    QVariant const & primaryKey,
+                                    QSqlDatabase & connection) {
+      qCDebug(Logging::db) <<
+         Q_FUNC_INFO << "Syncing property" << GetJunctionTableDefinitionPropertyName(junctionTable) <<
+         "of #" << primaryKey.toInt() << "with junction table" << junctionTable.tableName;
+
+      BtStringConst const & idColumn = junctionTable.tableFields[0].columnName;
+      bool const hasOrderByColumn = !GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull();
+
+      //
+      // Read what's currently in the DB for this object
+      //
+      QString queryString{"SELECT "};
+      QTextStream queryStringAsStream{&queryString};
+      queryStringAsStream <<
+         idColumn << ", " << GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
+      if (hasOrderByColumn) {
+         queryStringAsStream << ", " << GetJunctionTableDefinitionOrderByColumn(junctionTable);
+      }
+      queryStringAsStream <<
+         " FROM " << junctionTable.tableName <<
+         " WHERE " << GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << " = :thisPrimaryKey" <<
+         " ORDER BY " << (hasOrderByColumn ? GetJunctionTableDefinitionOrderByColumn(junctionTable) : idColumn) << ";";
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare(queryString);
+      sqlQuery.bindValue(":thisPrimaryKey", primaryKey);
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
+
+      // For each other primary key, the indexes in existingRows of the rows that have it, in order
+      QVector<JunctionTableRow> existingRows;
+      QHash<int, QVector<int>> existingRowIndexes;
+      while (sqlQuery.next()) {
+         JunctionTableRow row{sqlQuery.value(0).toInt(),
+                              sqlQuery.value(1).toInt(),
+                              hasOrderByColumn ? sqlQuery.value(2).toInt() : 0};
+         existingRowIndexes[row.otherPrimaryKey].append(existingRows.size());
+         existingRows.append(row);
+      }
+
+      //
+      // Work out what needs to change
+      //
+      QVector<bool> existingRowMatched(existingRows.size(), false);
+      QVector<JunctionTableRow> rowsToInsert;
+      QVector<JunctionTableRow> rowsToRenumber;
+      int itemNumber = 1;
+      for (int curValue : propertyValues) {
+         auto matchingRows = existingRowIndexes.find(curValue);
+         if (matchingRows == existingRowIndexes.end() || matchingRows->isEmpty()) {
+            rowsToInsert.append(JunctionTableRow{0, curValue, itemNumber});
+         } else {
+            int const existingRowIndex = matchingRows->takeFirst();
+            existingRowMatched[existingRowIndex] = true;
+            JunctionTableRow const & existingRow = existingRows.at(existingRowIndex);
+            if (hasOrderByColumn && existingRow.itemNumber != itemNumber) {
+               rowsToRenumber.append(JunctionTableRow{existingRow.id, curValue, itemNumber});
+            }
          }
          ++itemNumber;
       }
+      QVector<int> idsToDelete;
+      for (int ii = 0; ii < existingRows.size(); ++ii) {
+         if (!existingRowMatched.at(ii)) {
+            idsToDelete.append(existingRows.at(ii).id);
+         }
+      }
+      qCDebug(Logging::db) <<
+         Q_FUNC_INFO << junctionTable.tableName << "for #" << primaryKey.toInt() << ":" << existingRows.size() <<
+         "existing row(s);" << idsToDelete.size() << "to delete," << rowsToInsert.size() << "to insert," <<
+         rowsToRenumber.size() << "to renumber";
+
+      //
+      // Apply the changes.  Deletes go first, as there's no point renumbering rows we're about to remove.
+      //
+      if (!execInBatches(
+         connection,
+         idsToDelete.size(),
+         1,
+         [&](int const numRows) {
+            return QString{"DELETE FROM %1 WHERE %2 IN (%3);"}.arg(*junctionTable.tableName,
+                                                                     *idColumn,
+                                                                     commaSeparatedPlaceholders(numRows));
+         },
+         [&](BtSqlQuery & deleteQuery, int const firstRow, int const numRows) {
+            for (int ii = firstRow; ii < firstRow + numRows; ++ii) {
+               deleteQuery.addBindValue(idsToDelete.at(ii));
+            }
+         }
+      )) {
+         return false;
+      }
 
+      //
+      // Renumbering several rows in one statement needs a CASE expression:
+      //    UPDATE table SET orderByColumn = CASE id WHEN ? THEN ? WHEN ? THEN ? ... END WHERE id IN (?, ?, ...);
+      // The CAST is because PostgreSQL otherwise can't work out the type of the THEN values.
+      //
+      if (!execInBatches(
+         connection,
+         rowsToRenumber.size(),
+         3,
+         [&](int const numRows) {
+            QStringList whenClauses;
+            for (int ii = 0; ii < numRows; ++ii) {
+               whenClauses.append("WHEN ? THEN CAST(? AS INTEGER)");
+            }
+            return QString{"UPDATE %1 SET %2 = CASE %3 %4 END WHERE %3 IN (%5);"}.arg(
+               *junctionTable.tableName,
+               *GetJunctionTableDefinitionOrderByColumn(junctionTable),
+               *idColumn,
+               whenClauses.join(" "),
+               commaSeparatedPlaceholders(numRows)
+            );
+         },
+         [&](BtSqlQuery & updateQuery, int const firstRow, int const numRows) {
+            for (int ii = firstRow; ii < firstRow + numRows; ++ii) {
+               updateQuery.addBindValue(rowsToRenumber.at(ii).id);
+               updateQuery.addBindValue(rowsToRenumber.at(ii).itemNumber);
+            }
+            for (int ii = firstRow; ii < firstRow + numRows; ++ii) {
+               updateQuery.addBindValue(rowsToRenumber.at(ii).id);
+            }
+         }
+      )) {
+         return false;
+      }
+
+      if (!insertJunctionTableRows(junctionTable, primaryKey, rowsToInsert, connection)) {
+         return false;
+      }
+
+      static Metrics::Histogram & rowsChanged = Metrics::histogram("db.junctionTable.rowsChangedPerSync");
+      rowsChanged.record(idsToDelete.size() + rowsToInsert.size() + rowsToRenumber.size());
       return true;
    }
 
@@ -448,7 +793,7 @@ namespace {
                                           QVariant const & primaryKey,
                                           QSqlDatabase & connection) {
 
-      qDebug() <<
+      qCDebug(Logging::db) <<
          Q_FUNC_INFO << "Deleting property " << GetJunctionTableDefinitionPropertyName(junctionTable) <<
          " in junction table " << junctionTable.tableName;
 
@@ -466,7 +811,7 @@ namespace {
 
       // Bind the primary key value
       sqlQuery.bindValue(thisPrimaryKeyBindName, primaryKey);
-      qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+      qCDebug(Logging::db).noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
 
       // Run the query
       if (!sqlQuery.exec()) {
@@ -555,16 +900,58 @@ public:
    }
 
    /**
-    * \brief Update the specified property on an object
+    * \brief Keep the full-text search index (see \c FullTextSearch) in step with any indexed columns of an object.
+    *        For most types of object, none of the columns are indexed, so this does nothing.
     *
     *        NB: Caller is responsible for handling transactions
     *
+    *        (For a change to a single property, see \c writePropertyUpdate instead.)
+    *
     * \return \c true if succeeded, \c false otherwise
     */
-   bool updatePropertyInDb(QSqlDatabase & connection, QObject const & object, BtStringConst const & propertyName) {
-      // We'll need some of this info even if it's a junction table property we're updating
-      BtStringConst const & primaryKeyColumn {this->getPrimaryKeyColumn()};
-      QVariant const        primaryKey       {this->getPrimaryKey(object)};
+   bool updateSearchIndex(QSqlDatabase & connection, QObject const & object, int primaryKey) {
+      for (auto const & fieldDefn : this->primaryTable.tableFields) {
+         if (FullTextSearch::isIndexed(*this->primaryTable.tableName, *fieldDefn.columnName)) {
+            if (!FullTextSearch::updateIndex(*this->database,
+                                             connection,
+                                             *this->primaryTable.tableName,
+                                             primaryKey,
+                                             *fieldDefn.columnName,
+                                             object.property(*fieldDefn.propertyName).toString())) {
+               return false;
+            }
+         }
+      }
+      return true;
+   }
+
+   /**
+    * \brief Everything we need to write a change to one property of one object to the DB.  This is read off the object
+    *        up front by \c readPropertyUpdate so that \c writePropertyUpdate doesn't need to touch the object, and can
+    *        thus be run on a worker thread (see \c ObjectStore::updateProperty).
+    */
+   struct PropertyUpdate {
+      QVariant primaryKey;
+      //! Set if it's a simple property, in which case \c bindValue is what to store in its column
+      TableField const * fieldDefn = nullptr;
+      QVariant bindValue;
+      //! Only used if the column is in the full-text search index (see \c FullTextSearch)
+      QString searchText;
+      //! Set if the property is stored in a junction table, in which case \c otherPrimaryKeys is what to store
+      JunctionTableDefinition const * junctionTable = nullptr;
+      QVector<int> otherPrimaryKeys;
+      //! For logging
+      char const * className = nullptr;
+   };
+
+   /**
+    * \brief Read the current value of the specified property on an object, ready to be written to the DB
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool readPropertyUpdate(QObject const & object, BtStringConst const & propertyName, PropertyUpdate & update) {
+      update.primaryKey = this->getPrimaryKey(object);
+      update.className = object.metaObject()->className();
 
       //
       // First check whether this is a simple property.  (If not we look for it in the ones we store in junction tables.)
@@ -576,45 +963,15 @@ public:
       );
 
       if (matchingFieldDefn != this->primaryTable.tableFields.end()) {
-         //
-         // We're updating a simple property
-         //
-         // Construct the SQL, which will be of the form
-         //
-         //    UPDATE tablename
-         //    SET columnName = :columnName
-         //    WHERE primaryKeyColumn = :primaryKeyColumn;
-         //
-         QString queryString{"UPDATE "};
-         QTextStream queryStringAsStream{&queryString};
-         queryStringAsStream << this->primaryTable.tableName << " SET ";
-
-         BtStringConst const & columnToUpdateInDb = matchingFieldDefn->columnName;
-
-         queryStringAsStream << " " << columnToUpdateInDb << " = :" << columnToUpdateInDb;
-         queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
-
-         qDebug() <<
-            Q_FUNC_INFO << "Updating" << object.metaObject()->className() << "property" << propertyName <<
-            "with database query" << queryString;
-
-         //
-         // Bind the values
-         //
-         BtSqlQuery sqlQuery{connection};
-         sqlQuery.prepare(queryString);
-         QVariant propertyBindValue{object.property(*propertyName)};
-         auto fieldDefn = std::find_if(
-            this->primaryTable.tableFields.begin(),
-            this->primaryTable.tableFields.end(),
-            [propertyName](TableField const & fd){return propertyName == fd.propertyName;}
-         );
-         // It's a coding error if we're trying to update a property that's not in the field definitions
-         Q_ASSERT(fieldDefn != this->primaryTable.tableFields.end());
-         if (fieldDefn->fieldType == ObjectStore::Enum) {
+         update.fieldDefn = &*matchingFieldDefn;
+         update.bindValue = object.property(*propertyName);
+         if (FullTextSearch::isIndexed(*this->primaryTable.tableName, *matchingFieldDefn->columnName)) {
+            update.searchText = update.bindValue.toString();
+         }
+         if (matchingFieldDefn->fieldType == ObjectStore::Enum) {
             // Enums need to be converted to strings first
-            propertyBindValue = QVariant{enumToString(*fieldDefn, propertyBindValue)};
-         } else if (fieldDefn->foreignKeyTo) {
+            update.bindValue = QVariant{enumToString(*matchingFieldDefn, update.bindValue)};
+         } else if (matchingFieldDefn->foreignKeyTo) {
             //
             // If the columns if a foreign key and the caller is setting it to a non-positive value then we actually
             // need to store NULL in the DB.  (In the code we store foreign key IDs as ints, and use -1 to mean null.
@@ -624,63 +981,130 @@ public:
             // Firstly, we assert it's a coding error if we've created a foreign key column that's not an int.  For the
             // moment at least, we don't support other types of primary/foreign key.
             //
-            Q_ASSERT(ObjectStore::FieldType::Int == fieldDefn->fieldType);
-            if (propertyBindValue.toInt() <= 0) {
-               qDebug() << Q_FUNC_INFO << "Treating" << propertyBindValue << "foreign key value as NULL";
-               propertyBindValue = QVariant(QVariant::Int);
+            Q_ASSERT(ObjectStore::FieldType::Int == matchingFieldDefn->fieldType);
+            if (update.bindValue.toInt() <= 0) {
+               qCDebug(Logging::db) << Q_FUNC_INFO << "Treating" << update.bindValue << "foreign key value as NULL";
+               update.bindValue = QVariant(QVariant::Int);
             }
          }
-         sqlQuery.bindValue(QString{":%1"}.arg(*columnToUpdateInDb), propertyBindValue);
-         sqlQuery.bindValue(QString{":%1"}.arg(*primaryKeyColumn), primaryKey);
-         qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+         return true;
+      }
 
-         //
-         // Run the query
-         //
-         if (!sqlQuery.exec()) {
-            qCritical() <<
-               Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-            return false;
+      //
+      // The property we've been given isn't a simple property, so look for it in the ones we store in junction tables
+      //
+      auto matchingJunctionTableDefinitionDefn = std::find_if(
+         this->junctionTables.begin(),
+         this->junctionTables.end(),
+         [propertyName](JunctionTableDefinition const & jt) {
+            return GetJunctionTableDefinitionPropertyName(jt) == propertyName;
          }
-      } else {
-         //
-         // The property we've been given isn't a simple property, so look for it in the ones we store in junction tables
-         //
-         auto matchingJunctionTableDefinitionDefn = std::find_if(
-            this->junctionTables.begin(),
-            this->junctionTables.end(),
-            [propertyName](JunctionTableDefinition const & jt) {
-               return GetJunctionTableDefinitionPropertyName(jt) == propertyName;
-            }
-         );
+      );
 
-         // It's a coding error if we couldn't find the property either as a simple field or an associative entity
-         if (matchingJunctionTableDefinitionDefn == this->junctionTables.end()) {
-            qCritical() <<
-               Q_FUNC_INFO << "Unable to find rule for storing property" << object.metaObject()->className() << "::" <<
-               propertyName << "in either" << this->primaryTable.tableName << "or any associated table";
-            Q_ASSERT(false);
-         }
+      // It's a coding error if we couldn't find the property either as a simple field or an associative entity
+      if (matchingJunctionTableDefinitionDefn == this->junctionTables.end()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Unable to find rule for storing property" << object.metaObject()->className() << "::" <<
+            propertyName << "in either" << this->primaryTable.tableName << "or any associated table";
+         Q_ASSERT(false);
+         return false;
+      }
+
+      update.junctionTable = &*matchingJunctionTableDefinitionDefn;
+      return readJunctionTablePropertyValues(*update.junctionTable,
+                                             object,
+                                             update.primaryKey,
+                                             update.otherPrimaryKeys);
+   }
 
+   /**
+    * \brief Write to the DB a property value previously read by \c readPropertyUpdate.  Safe to call on any thread.
+    *
+    *        NB: Caller is responsible for handling transactions
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool writePropertyUpdate(QSqlDatabase & connection, PropertyUpdate const & update) {
+      if (update.junctionTable) {
          //
-         // As elsewhere, the simplest way to update a junction table is to blat any rows relating to the current object and then
-         // write out data based on the current property values.
+         // Rather than rewriting all the rows relating to the current object, we just change the ones that differ
+         // from the current property values.
          //
-         qDebug() <<
-            Q_FUNC_INFO << "Updating" << object.metaObject()->className() << "property" << propertyName <<
-            "in junction table" << matchingJunctionTableDefinitionDefn->tableName;
-         if (!deleteFromJunctionTableDefinition(*matchingJunctionTableDefinitionDefn, primaryKey, connection)) {
-            return false;
-         }
-         if (!insertIntoJunctionTableDefinition(*matchingJunctionTableDefinitionDefn, object, primaryKey, connection)) {
-            return false;
-         }
+         qCDebug(Logging::db) <<
+            Q_FUNC_INFO << "Updating" << update.className << "property" <<
+            GetJunctionTableDefinitionPropertyName(*update.junctionTable) << "in junction table" <<
+            update.junctionTable->tableName;
+         return syncJunctionTableDefinition(*update.junctionTable,
+                                            update.otherPrimaryKeys,
+                                            update.primaryKey,
+                                            connection);
+      }
+
+      //
+      // We're updating a simple property
+      //
+      // Construct the SQL, which will be of the form
+      //
+      //    UPDATE tablename
+      //    SET columnName = :columnName
+      //    WHERE primaryKeyColumn = :primaryKeyColumn;
+      //
+      BtStringConst const & primaryKeyColumn {this->getPrimaryKeyColumn()};
+      BtStringConst const & columnToUpdateInDb = update.fieldDefn->columnName;
+      QString queryString{"UPDATE "};
+      QTextStream queryStringAsStream{&queryString};
+      queryStringAsStream << this->primaryTable.tableName << " SET ";
+      queryStringAsStream << " " << columnToUpdateInDb << " = :" << columnToUpdateInDb;
+      queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
+
+      qCDebug(Logging::db) <<
+         Q_FUNC_INFO << "Updating" << update.className << "property" << update.fieldDefn->propertyName <<
+         "with database query" << queryString;
+
+      //
+      // Bind the values
+      //
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare(queryString);
+      sqlQuery.bindValue(QString{":%1"}.arg(*columnToUpdateInDb), update.bindValue);
+      sqlQuery.bindValue(QString{":%1"}.arg(*primaryKeyColumn), update.primaryKey);
+      qCDebug(Logging::db).noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+
+      //
+      // Run the query
+      //
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
+
+      if (FullTextSearch::isIndexed(*this->primaryTable.tableName, *columnToUpdateInDb)) {
+         return FullTextSearch::updateIndex(*this->database,
+                                            connection,
+                                            *this->primaryTable.tableName,
+                                            update.primaryKey.toInt(),
+                                            *columnToUpdateInDb,
+                                            update.searchText);
       }
 
       // If we made it this far then everything worked
       return true;
    }
 
+   /**
+    * \brief Any writes queued on the worker pool (see \c ObjectStore::updateProperty) need to be done before we read
+    *        something that they might change.  (Anything done in a \c DbTransaction on the main thread doesn't need
+    *        this, as \c DbTransaction does it.)  MUST NOT be called with a \c DbTransaction open.
+    */
+   void waitForQueuedWrites() {
+      DatabaseWorkerPool * workerPool = this->database->workerPool();
+      if (workerPool) {
+         workerPool->waitForAll();
+      }
+      return;
+   }
+
    /**
     * \brief Insert an object in the database
     *
@@ -717,7 +1141,7 @@ public:
       this->appendColumNames(queryStringAsStream, writePrimaryKey, true);
       queryStringAsStream << ");";
 
-      qDebug() <<
+      qCDebug(Logging::db) <<
          Q_FUNC_INFO << "Inserting" << object.metaObject()->className() << "main table row with database query " <<
          queryString;
 
@@ -743,7 +1167,7 @@ public:
          sqlQuery.bindValue(QString{":"} + *fieldDefn.columnName, bindValue);
       }
 
-      qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+      qCDebug(Logging::db).noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
 
       //
       // Run the query
@@ -803,7 +1227,7 @@ public:
          }
       }
 
-      qDebug() <<
+      qCDebug(Logging::db) <<
          Q_FUNC_INFO << object.metaObject()->className() << "#" << primaryKeyInDb << "inserted in database using" <<
          queryString;
 
@@ -831,7 +1255,8 @@ public:
 ObjectStore::ObjectStore(TableDefinition const &           primaryTable,
                          JunctionTableDefinitions const & junctionTables) :
    pimpl{ std::make_unique<impl>(primaryTable, junctionTables) } {
-   qDebug() << Q_FUNC_INFO << "Construct of object store for primary table" << this->pimpl->primaryTable.tableName;
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Construct of object store for primary table"
+      << this->pimpl->primaryTable.tableName;
    return;
 }
 
@@ -850,7 +1275,7 @@ ObjectStore::~ObjectStore() {
 void ObjectStore::logDiagnostics() const {
    for (int key : this->pimpl->allObjects.keys()) {
       std::shared_ptr<QObject> object = this->pimpl->allObjects.value(key);
-      qDebug() <<
+      qCDebug(Logging::db) <<
          Q_FUNC_INFO << "Object @" << static_cast<void *>(object.get()) << "stored as #" << key << "has key" <<
          this->pimpl->getPrimaryKey(*object) << "and shared pointer use count" << object.use_count();
    }
@@ -902,12 +1327,34 @@ bool ObjectStore::addTableConstraints(Database & database, QSqlDatabase & connec
    return true;
 }
 
+bool ObjectStore::createIndexes(Database & database, QSqlDatabase & connection) const {
+   if (!createIndexesOnTable(connection, this->pimpl->primaryTable, {})) {
+      return false;
+   }
+
+   for (auto const & junctionTable : this->pimpl->junctionTables) {
+      QVector<char const *> coveringIndex{*GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable)};
+      if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
+         coveringIndex.append(*GetJunctionTableDefinitionOrderByColumn(junctionTable));
+      }
+      coveringIndex.append(*GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable));
+      if (!createIndexesOnTable(connection, junctionTable, QVector< QVector<char const *> >{coveringIndex})) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
 void ObjectStore::loadAll(Database * database) {
+   TRACE_SPAN("db", "ObjectStore::loadAll");
+   StartupProfiler::Phase startupPhase{"Load DB table", *this->pimpl->primaryTable.tableName};
    if (database) {
       this->pimpl->database = database;
    } else {
       this->pimpl->database = &Database::instance();
    }
+   bumpChangeGeneration();
 
    // Start transaction
    // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
@@ -938,7 +1385,7 @@ void ObjectStore::loadAll(Database * database) {
       return;
    }
 
-   qDebug() <<
+   qCDebug(Logging::db) <<
       Q_FUNC_INFO << "Reading main table rows from" << this->pimpl->primaryTable.tableName <<
       "database table using query " << queryString;
 
@@ -1022,6 +1469,13 @@ void ObjectStore::loadAll(Database * database) {
          }
       }
 
+      if (MemoryAccounting::isEnabled()) {
+         // Bundles only live while we construct one object, but it's useful to know how big they get relative to the
+         // objects built from them
+         static Metrics::Histogram & bundleBytes = Metrics::histogram("memory.namedParameterBundle.bytes");
+         bundleBytes.record(MemoryAccounting::approxHeapSizeOf(namedParameterBundle));
+      }
+
       // Get a new object...
       auto object = this->createNewObject(namedParameterBundle);
 
@@ -1036,9 +1490,12 @@ void ObjectStore::loadAll(Database * database) {
 //         this->metaObject()->className();
    }
 
-   qDebug() <<
+   qCDebug(Logging::db) <<
       Q_FUNC_INFO << "Read" << this->pimpl->allObjects.size() << "entries from primary table" <<
       this->pimpl->primaryTable.tableName;
+   Metrics::counter(QString{"db.rowsLoaded.%1"}.arg(*this->pimpl->primaryTable.tableName)).add(
+      this->pimpl->allObjects.size()
+   );
 
    //
    // Now we load the data from the junction tables.  This, pretty much by definition, isn't needed for the object's
@@ -1048,7 +1505,7 @@ void ObjectStore::loadAll(Database * database) {
    // simplicity of separate queries.
    //
    for (auto const & junctionTable : this->pimpl->junctionTables) {
-      qDebug() <<
+      qCDebug(Logging::db) <<
          Q_FUNC_INFO << "Reading junction table " << junctionTable.tableName << " into " <<
          GetJunctionTableDefinitionPropertyName(junctionTable);
 
@@ -1077,7 +1534,7 @@ void ObjectStore::loadAll(Database * database) {
          return;
       }
 
-      qDebug() << Q_FUNC_INFO << "Reading junction table rows from database query " << queryString;
+      qCDebug(Logging::db) << Q_FUNC_INFO << "Reading junction table rows from database query " << queryString;
 
       //
       // The simplest way to process the data is first to build the ID-to-ordered-list-of-IDs map in memory, then loop
@@ -1088,7 +1545,7 @@ void ObjectStore::loadAll(Database * database) {
       while (sqlQuery.next()) {
          int thisPrimaryKey = sqlQuery.value(*GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable)).toInt();
          int otherPrimaryKey = sqlQuery.value(*GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable)).toInt();
-         qDebug() << Q_FUNC_INFO << "Interim store of" << thisPrimaryKey << "<->" << otherPrimaryKey;
+         qCDebug(Logging::db) << Q_FUNC_INFO << "Interim store of" << thisPrimaryKey << "<->" << otherPrimaryKey;
 
          if (thisPrimaryKey != previousPrimaryKey) {
             thisToOtherKeys.insert(thisPrimaryKey, QVector<int>{});
@@ -1123,7 +1580,7 @@ void ObjectStore::loadAll(Database * database) {
          //
          bool success = false;
          if (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY) {
-            qDebug() <<
+            qCDebug(Logging::db) <<
                Q_FUNC_INFO << currentObject->metaObject()->className() << " #" << currentMapping.key() << ", " <<
                GetJunctionTableDefinitionPropertyName(junctionTable) << "=" << currentMapping.value().first();
             success = currentObject->setProperty(*GetJunctionTableDefinitionPropertyName(junctionTable),
@@ -1144,7 +1601,7 @@ void ObjectStore::loadAll(Database * database) {
             // wrapper around QVector<int>.
             //
             QVariant wrappedConvertedOtherKeys = QVariant::fromValue(currentMapping.value());
-            qDebug() <<
+            qCDebug(Logging::db) <<
                Q_FUNC_INFO << currentObject->metaObject()->className() << " #" << currentMapping.key() << ", " <<
                GetJunctionTableDefinitionPropertyName(junctionTable) << "=" << currentMapping.value() << "(" <<
                wrappedConvertedOtherKeys << ")";
@@ -1204,12 +1661,18 @@ QList<std::shared_ptr<QObject> > ObjectStore::getByIds(QVector<int> const & list
 
 
 int ObjectStore::insert(std::shared_ptr<QObject> object) {
+   TRACE_SPAN("db", "ObjectStore::insert");
+   bumpChangeGeneration();
    // Start transaction
    // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
    QSqlDatabase connection = this->pimpl->database->sqlDatabase();
    DbTransaction dbTransaction{*this->pimpl->database, connection};
 
    int primaryKey = this->pimpl->insertObjectInDb(connection, *object, false);
+   if (primaryKey > 0 && !this->pimpl->updateSearchIndex(connection, *object, primaryKey)) {
+      // We'll already have logged the error.  The object is still usable, just not yet searchable.
+      qWarning() << Q_FUNC_INFO << "Unable to index new" << object->metaObject()->className() << "#" << primaryKey;
+   }
 
    //
    // Add the object to our list of all objects of this type (asserting that it should be impossible for an object with
@@ -1243,6 +1706,7 @@ int ObjectStore::insert(std::shared_ptr<QObject> object) {
 }
 
 void ObjectStore::update(std::shared_ptr<QObject> object) {
+   bumpChangeGeneration();
    // Start transaction
    // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
    QSqlDatabase connection = this->pimpl->database->sqlDatabase();
@@ -1307,25 +1771,25 @@ void ObjectStore::update(std::shared_ptr<QObject> object) {
       return;
    }
 
+   if (!this->pimpl->updateSearchIndex(connection, *object, primaryKey.toInt())) {
+      return;
+   }
+
    //
    // Now update data in the junction tables
    //
    for (auto const & junctionTable : this->pimpl->junctionTables) {
-      qDebug() <<
+      qCDebug(Logging::db) <<
          Q_FUNC_INFO << "Updating property " << GetJunctionTableDefinitionPropertyName(junctionTable) <<
          " in junction table " << junctionTable.tableName;
 
       //
-      // The simplest thing to do with each junction table is to blat any rows relating to the current object and then
-      // write out data based on the current property values.  This may often mean we're deleting rows and rewriting
-      // them but, for the small quantity of data we're talking about, it doesn't seem worth the complexity of
-      // optimising (eg read what's in the DB, compare with what's in the object property, work out what deletes,
-      // inserts and updates are needed to sync them, etc.
+      // Usually only a few rows (if any) in each junction table will have changed, so we work out and write just those
+      // rather than deleting and rewriting all the rows for this object.
       //
-      if (!deleteFromJunctionTableDefinition(junctionTable, primaryKey, connection)) {
-         return;
-      }
-      if (!insertIntoJunctionTableDefinition(junctionTable, *object, primaryKey, connection)) {
+      QVector<int> propertyValues;
+      if (!readJunctionTablePropertyValues(junctionTable, *object, primaryKey, propertyValues) ||
+          !syncJunctionTableDefinition(junctionTable, propertyValues, primaryKey, connection)) {
          return;
       }
    }
@@ -1371,32 +1835,120 @@ int ObjectStore::insertOrUpdate(QObject & object) {
 }
 
 void ObjectStore::updateProperty(QObject const & object, BtStringConst const & propertyName) {
-   // Start transaction
-   // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
-   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
-   DbTransaction dbTransaction{*this->pimpl->database, connection};
-
-   if (!this->pimpl->updatePropertyInDb(connection, object, propertyName)) {
-      // Something went wrong.  Bailing out here will abort the transaction and avoid sending the signal.
+   TRACE_SPAN("db", "ObjectStore::updateProperty");
+   static Metrics::Counter & numUpdatePropertyCalls = Metrics::counter("db.updateProperty.calls");
+   static Metrics::Histogram & updatePropertyLatency = Metrics::histogram("db.updateProperty.latencyNs");
+   numUpdatePropertyCalls.add();
+   Metrics::ScopedLatency const latency{updatePropertyLatency};
+   // The in-memory object has already changed, even if we fail to write the change to the DB below
+   bumpChangeGeneration();
+
+   impl::PropertyUpdate update;
+   if (!this->pimpl->readPropertyUpdate(object, propertyName, update)) {
+      // We'll already have logged the error
       return;
    }
+   int const primaryKey = update.primaryKey.toInt();
 
-   // Everything went fine so we can commit the transaction
-   dbTransaction.commit();
+   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
+   DatabaseWorkerPool * workerPool = this->pimpl->database->workerPool();
+   if (workerPool && !DbTransaction::isInProgress(connection)) {
+      //
+      // Hand the write off to a worker so we don't have to wait for the round-trip(s) to the DB.  Using the table name
+      // and primary key as the ordering key means changes to any one object are written in the order they were made.
+      //
+      // If the caller has a transaction open though, we do the write here, as part of that transaction, because the
+      // caller is relying on everything in it being atomic.  (Also, a worker could end up waiting for rows locked by
+      // that transaction, and we'd then deadlock if we waited for the worker before committing.)
+      //
+      static Metrics::Counter & numQueued = Metrics::counter("db.updateProperty.queued");
+      numQueued.add();
+      impl * pimpl = this->pimpl.get();
+      workerPool->enqueue(
+         QString{"%1#%2"}.arg(*this->pimpl->primaryTable.tableName).arg(primaryKey),
+         [pimpl, update](QSqlDatabase & workerConnection) {
+            DbTransaction dbTransaction{*pimpl->database, workerConnection};
+            return pimpl->writePropertyUpdate(workerConnection, update) && dbTransaction.commit();
+         },
+         [this, className = QString{update.className}, propertyNameBytes = QByteArray{*propertyName}, primaryKey](
+            bool const succeeded
+         ) {
+            if (!succeeded) {
+               this->retryPropertyUpdate(className, primaryKey, propertyNameBytes);
+            }
+            return;
+         }
+      );
+   } else {
+      // Start transaction
+      // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
+      DbTransaction dbTransaction{*this->pimpl->database, connection};
+
+      if (!this->pimpl->writePropertyUpdate(connection, update)) {
+         // Something went wrong.  Bailing out here will abort the transaction and avoid sending the signal.
+         return;
+      }
 
-   // Tell any bits of the UI that need to know that the property was updated
-   emit this->signalPropertyChanged(this->pimpl->getPrimaryKey(object).toInt(), propertyName);
+      // Everything went fine so we can commit the transaction
+      dbTransaction.commit();
+   }
+
+   //
+   // Tell any bits of the UI that need to know that the property was updated.  If the write was queued, we don't wait
+   // for it, as the UI only looks at the in-memory objects, which are already up-to-date.
+   //
+   emit this->signalPropertyChanged(primaryKey, propertyName);
 
    return;
 }
 
 
+void ObjectStore::retryPropertyUpdate(QString const & className,
+                                      int const primaryKey,
+                                      QByteArray const & propertyName) {
+   static Metrics::Counter & numRetried = Metrics::counter("db.updateProperty.retried");
+   numRetried.add();
+   qWarning() <<
+      Q_FUNC_INFO << "Queued write of" << className << "#" << primaryKey << "property" << propertyName <<
+      "failed, so retrying on the main connection";
+
+   //
+   // The in-memory object is what we want in the DB, and it may have changed again since the write that failed, so we
+   // read the property afresh rather than retrying the old value.  If the object has gone, there is nothing to write.
+   //
+   auto object = this->getById(primaryKey);
+   if (!object) {
+      return;
+   }
+   BtStringConst const propertyNameAsBtStringConst{propertyName.constData()};
+   impl::PropertyUpdate update;
+   if (this->pimpl->readPropertyUpdate(*object, propertyNameAsBtStringConst, update)) {
+      QSqlDatabase connection = this->pimpl->database->sqlDatabase();
+      DbTransaction dbTransaction{*this->pimpl->database, connection};
+      if (this->pimpl->writePropertyUpdate(connection, update) && dbTransaction.commit()) {
+         return;
+      }
+   }
+
+   // As with other failures to write to the DB, the user needs to know, as their change will be lost when they exit
+   QString const errorMessage = QObject::tr(
+      "Could not save a change to the %1 property of %2 #%3 to the database.  It will be lost when you exit unless "
+      "you change it again."
+   ).arg(QString{propertyName}, className).arg(primaryKey);
+   qCritical() << Q_FUNC_INFO << errorMessage;
+   if (Brewtarget::isInteractive()) {
+      QMessageBox::critical(nullptr, QObject::tr("Database Failure"), errorMessage);
+   }
+   return;
+}
+
 std::shared_ptr<QObject>  ObjectStore::defaultSoftDelete(int id) {
    //
    // We assume on soft-delete that there is nothing to do on related objects - eg if a Mash is soft deleted (ie marked
    // deleted but remains in the DB) then there isn't actually anything we need to do with its MashSteps.
    //
-   qDebug() << Q_FUNC_INFO << "Soft delete item #" << id;
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Soft delete item #" << id;
+   bumpChangeGeneration();
    auto object = this->pimpl->allObjects.value(id);
    if (this->pimpl->allObjects.contains(id)) {
       this->pimpl->allObjects.remove(id);
@@ -1416,7 +1968,8 @@ std::shared_ptr<QObject>  ObjectStore::defaultHardDelete(int id) {
    // the object model than here in the object store as they can be subtle, and it would be cumbersome to model them
    // generically.
    //
-   qDebug() << Q_FUNC_INFO << "Hard delete item #" << id;
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Hard delete item #" << id;
+   bumpChangeGeneration();
    auto object = this->pimpl->allObjects.value(id);
    QSqlDatabase connection = this->pimpl->database->sqlDatabase();
    DbTransaction dbTransaction{*this->pimpl->database, connection};
@@ -1434,7 +1987,7 @@ std::shared_ptr<QObject>  ObjectStore::defaultHardDelete(int id) {
    queryStringAsStream << this->pimpl->primaryTable.tableName;
    BtStringConst const & primaryKeyColumn = this->pimpl->getPrimaryKeyColumn();
    queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
-   qDebug() <<
+   qCDebug(Logging::db) <<
       Q_FUNC_INFO << "Deleting main table row #" << id << "with database query " << queryString;
 
    //
@@ -1444,7 +1997,7 @@ std::shared_ptr<QObject>  ObjectStore::defaultHardDelete(int id) {
    BtSqlQuery sqlQuery{connection};
    sqlQuery.prepare(queryString);
    sqlQuery.bindValue(QString{":"} + *primaryKeyColumn, primaryKey);
-   qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+   qCDebug(Logging::db).noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
 
    //
    // Run the query
@@ -1455,6 +2008,10 @@ std::shared_ptr<QObject>  ObjectStore::defaultHardDelete(int id) {
       return object;
    }
 
+   if (!FullTextSearch::removeFromIndex(*this->pimpl->database, connection, *this->pimpl->primaryTable.tableName, id)) {
+      return object;
+   }
+
    //
    // Now remove data in the junction tables
    //
@@ -1580,3 +2137,84 @@ bool ObjectStore::writeAllToNewDb(Database & databaseNew, QSqlDatabase & connect
 
    return true;
 }
+
+QVector<ObjectStore::TableDefinition const *> ObjectStore::getTableDefinitions() const {
+   QVector<TableDefinition const *> tableDefinitions{&this->pimpl->primaryTable};
+   for (auto const & junctionTable : this->pimpl->junctionTables) {
+      tableDefinitions.append(&junctionTable);
+   }
+   return tableDefinitions;
+}
+
+QVector<int> ObjectStore::findUnreferenced(QVector<int> const & ids,
+                                           QVector<TableDefinition const *> const & allTables) const {
+   if (ids.isEmpty()) {
+      return ids;
+   }
+
+   this->pimpl->waitForQueuedWrites();
+   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
+   BtStringConst const & primaryKeyColumn = this->pimpl->getPrimaryKeyColumn();
+   QSet<int> referencedIds;
+   for (auto const * table : allTables) {
+      bool const isOurPrimaryTable = (table == &this->pimpl->primaryTable);
+      bool const isOurJunctionTable = std::any_of(
+         this->pimpl->junctionTables.cbegin(),
+         this->pimpl->junctionTables.cend(),
+         [table](JunctionTableDefinition const & junctionTable) { return &junctionTable == table; }
+      );
+      for (int fieldIndex = 0; fieldIndex < table->tableFields.size(); ++fieldIndex) {
+         TableField const & field = table->tableFields.at(fieldIndex);
+         if (field.foreignKeyTo != &this->pimpl->primaryTable) {
+            continue;
+         }
+         // See comment in header.  (Per ObjectStore::JunctionTableDefinition, the second field is the "this" key.)
+         if (isOurJunctionTable && fieldIndex == 1) {
+            continue;
+         }
+
+         bool const succeeded = execInBatches(
+            connection,
+            ids.size(),
+            1,
+            [&](int const numIds) {
+               QString queryString = QString{"SELECT DISTINCT %1 FROM %2 WHERE %1 IN (%3)"}.arg(
+                  *field.columnName, *table->tableName, commaSeparatedPlaceholders(numIds)
+               );
+               if (isOurPrimaryTable) {
+                  queryString += QString{" AND %1 <> %2"}.arg(*primaryKeyColumn, *field.columnName);
+               }
+               return queryString + ";";
+            },
+            [&](BtSqlQuery & sqlQuery, int const firstId, int const numIds) {
+               for (int ii = firstId; ii < firstId + numIds; ++ii) {
+                  sqlQuery.addBindValue(ids.at(ii));
+               }
+            },
+            [&](BtSqlQuery & sqlQuery) {
+               while (sqlQuery.next()) {
+                  referencedIds.insert(sqlQuery.value(0).toInt());
+               }
+            }
+         );
+         if (!succeeded) {
+            return QVector<int>{};
+         }
+      }
+   }
+
+   QVector<int> unreferencedIds;
+   for (int id : ids) {
+      if (!referencedIds.contains(id)) {
+         unreferencedIds.append(id);
+      }
+   }
+   qCDebug(Logging::db) <<
+      Q_FUNC_INFO << unreferencedIds.size() << "of" << ids.size() << "objects in" <<
+      this->pimpl->primaryTable.tableName << "are not referred to";
+   return unreferencedIds;
+}
+
+quint64 ObjectStore::changeGeneration() {
+   return changeGenerationCounter.load(std::memory_order_relaxed);
+}
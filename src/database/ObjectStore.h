@@ -24,6 +24,7 @@
 #include <memory> // For PImpl
 #include <optional>
 
+#include <QByteArray>
 #include <QObject>
 #include <QSqlDatabase>
 #include <QString>
@@ -112,6 +113,21 @@ public:
       }
    };
 
+   /**
+    * \brief A secondary index on a table.  We create these automatically for foreign key columns and for the ways we
+    *        read junction tables (see \c createIndexes), so this is only needed for any other columns that are used to
+    *        look things up.
+    */
+   struct IndexDefinition {
+      //! If there is more than one column, this is the order in which they are indexed
+      QVector<char const *> const columnNames;
+      //! Constructor
+      IndexDefinition(std::initializer_list<char const *> const columnNames) :
+         columnNames{columnNames} {
+         return;
+      }
+   };
+
    /**
     * \brief The main table in which objects of the type handled by this \c ObjectStore live, and how to map between
     *        object properties and table fields.
@@ -119,11 +135,15 @@ public:
    struct TableDefinition {
       BtStringConst tableName;
       QVector<TableField> const tableFields;
+      //! Any indexes needed over and above the ones \c createIndexes makes anyway
+      QVector<IndexDefinition> const indexes;
       //! Constructor
       TableDefinition(char const * const tableName = nullptr,
-                      std::initializer_list<TableField> const tableFields = {}) :
+                      std::initializer_list<TableField> const tableFields = {},
+                      std::initializer_list<IndexDefinition> const indexes = {}) :
          tableName{tableName},
-         tableFields{tableFields} {
+         tableFields{tableFields},
+         indexes{indexes} {
          return;
       }
    };
@@ -173,13 +193,15 @@ public:
     *                           values (typically integers).  However, if \c assumedNumEntries is set to
     *                           \c MAX_ONE_ENTRY, then we'll pull at most one matching row and pass an integer (wrapped
     *                           in QVariant and thus 0 for an integer if no row returned).
+    * \param indexes  Optional.  See \c IndexDefinition.
     */
    struct JunctionTableDefinition : public TableDefinition {
       AssumedNumEntries assumedNumEntries = MULTIPLE_ENTRIES_OK;
       JunctionTableDefinition(char const * const tableName = nullptr,
                               std::initializer_list<TableField> tableFields = {},
-                              AssumedNumEntries assumedNumEntries = MULTIPLE_ENTRIES_OK) :
-         TableDefinition{tableName, tableFields},
+                              AssumedNumEntries assumedNumEntries = MULTIPLE_ENTRIES_OK,
+                              std::initializer_list<IndexDefinition> indexes = {}) :
+         TableDefinition{tableName, tableFields, indexes},
          assumedNumEntries{assumedNumEntries} {
          return;
       }
@@ -219,6 +241,21 @@ public:
     */
    bool addTableConstraints(Database & database, QSqlDatabase & connection) const;
 
+   /**
+    * \brief Create the secondary indexes on the table(s) for the objects handled by this store.  Must be called after
+    *        \c addTableConstraints(), as that is what creates the foreign key columns.  Indexes that already exist are
+    *        left alone, so this is also safe to call on an existing DB.
+    *
+    *        As well as any indexes in \c TableDefinition::indexes, we create:
+    *           - for each junction table, an index on this object's key, the order column (if there is one) and the
+    *             other object's key, which covers both reading the table in \c loadAll() and finding the rows for a
+    *             given object when we update or delete them
+    *           - an index on each foreign key column (unless it's already the first column of one of the other
+    *             indexes), so that the DB does not have to scan the whole table to check the constraint when the row
+    *             it refers to is deleted
+    */
+   bool createIndexes(Database & database, QSqlDatabase & connection) const;
+
    /**
     * \brief Load from database all objects handled by this store
     *
@@ -284,6 +321,12 @@ public:
 
    /**
     * \brief Update a single property of an existing object in the DB
+    *
+    *        If the DB has a worker pool (see \c Database::workerPool()) and the caller does not have a \c DbTransaction
+    *        open, the write is queued on the pool and this returns without waiting for it.  Any \c DbTransaction
+    *        started on the main thread (which includes those in the other member functions here) waits for such queued
+    *        writes first.  If a queued write fails, it is retried synchronously, and, if that fails too, the user is
+    *        told (see \c retryPropertyUpdate()).
     */
    void updateProperty(QObject const & object, BtStringConst const & propertyName);
 
@@ -403,6 +446,39 @@ public:
     */
    bool writeAllToNewDb(Database & databaseNew, QSqlDatabase & connectionNew) const;
 
+   /**
+    * \brief The definitions of the primary table and any junction tables for this store.  Used for copying the tables
+    *        straight from one DB to another, without going via the objects (see \c DatabaseMigration).
+    */
+   QVector<TableDefinition const *> getTableDefinitions() const;
+
+   /**
+    * \brief Of the supplied objects, find the ones that nothing else in the DB refers to (ie no foreign key in any of
+    *        \c allTables holds their ID), and which could therefore be hard deleted without losing anything else.
+    *
+    *        Rows in our own junction tables that are keyed on the object itself (eg its list of hops if it's a
+    *        \c Recipe, or its parent if it's a \c Hop) don't count, as they belong to the object and are deleted with
+    *        it.  Nor does an object referring to itself (eg a \c Recipe that is its own ancestor).  But anything else
+    *        does, including rows for other objects that are themselves soft deleted.
+    *
+    *        This only reads the DB, not the cached objects, so it can be called on any thread (which will use its own
+    *        connection).
+    *
+    * \param ids
+    * \param allTables All the tables in the DB (see \c GetAllTableDefinitions)
+    *
+    * \return The subset of \c ids that are not referred to, or an empty list if there was an error
+    */
+   QVector<int> findUnreferenced(QVector<int> const & ids, QVector<TableDefinition const *> const & allTables) const;
+
+   /**
+    * \brief A counter that goes up every time any object store changes anything (inserts, updates, deletes or loads
+    *        objects).  Because some object properties are calculated from other objects (eg the inventory amount of a
+    *        \c Hop lives in an \c InventoryHop), this is global rather than per-store.  If it has not changed since a
+    *        previous call, then nothing in any of the stores has changed either.  See \c ObjectStoreSnapshot.
+    */
+   static quint64 changeGeneration();
+
 signals:
    /**
     * \brief Signal emitted when a new object is inserted in the database.  Parts of the UI that need to display all
@@ -490,6 +566,12 @@ private:
    class impl;
    std::unique_ptr<impl> pimpl;
 
+   /**
+    * \brief Called (on the main thread) when a write queued by \c updateProperty() has failed.  Writes the current
+    *        value of the property on the main connection instead, and tells the user if that fails too.
+    */
+   void retryPropertyUpdate(QString const & className, int const primaryKey, QByteArray const & propertyName);
+
    //! No copy constructor, as never want anyone, not even our friends, to make copies of a singleton
    ObjectStore(ObjectStore const &) = delete;
    //! No assignment operator , as never want anyone, not even our friends, to make copies of a singleton.
@@ -0,0 +1,180 @@
+/*
+ * database/ObjectStoreSnapshot.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "database/ObjectStoreSnapshot.h"
+
+#include <cstring>
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QMetaObject>
+#include <QMetaProperty>
+#include <QThread>
+
+#include "utils/Metrics.h"
+
+struct ObjectStoreSnapshot::Data {
+   quint64 generation = 0;
+   QVector<Record> records;
+};
+
+namespace {
+   /**
+    * \brief Property types we can safely copy into a snapshot, because they don't refer to any other object
+    */
+   bool isCapturable(QMetaProperty const & metaProperty) {
+      if (!metaProperty.isReadable()) {
+         return false;
+      }
+      if (metaProperty.isEnumType()) {
+         return true;
+      }
+      int const type = metaProperty.userType();
+      switch (type) {
+         case QMetaType::Bool:
+         case QMetaType::Int:
+         case QMetaType::UInt:
+         case QMetaType::LongLong:
+         case QMetaType::ULongLong:
+         case QMetaType::Double:
+         case QMetaType::QString:
+         case QMetaType::QStringList:
+         case QMetaType::QDate:
+         case QMetaType::QDateTime:
+            return true;
+         default:
+            break;
+      }
+      return type == qMetaTypeId<QVector<int> >();
+   }
+
+   /**
+    * \brief The properties we capture for a given class, in the order their values are stored in each \c Record
+    */
+   struct Layout {
+      QVector<QMetaProperty> properties;
+      std::shared_ptr<QHash<QByteArray, int> const> propertyIndexes;
+   };
+
+   Layout makeLayout(QMetaObject const & metaObject) {
+      Layout layout;
+      auto propertyIndexes = std::make_shared<QHash<QByteArray, int> >();
+      for (int ii = 0; ii < metaObject.propertyCount(); ++ii) {
+         QMetaProperty const metaProperty = metaObject.property(ii);
+         if (isCapturable(metaProperty)) {
+            propertyIndexes->insert(QByteArray{metaProperty.name()}, layout.properties.size());
+            layout.properties.append(metaProperty);
+         }
+      }
+      layout.propertyIndexes = propertyIndexes;
+      return layout;
+   }
+}
+
+QVariant ObjectStoreSnapshot::Record::value(BtStringConst const & propertyName) const {
+   char const * const name = *propertyName;
+   // Using fromRawData saves copying the name just to look it up
+   auto const index = this->propertyIndexes->find(QByteArray::fromRawData(name, static_cast<int>(std::strlen(name))));
+   if (index == this->propertyIndexes->cend()) {
+      return QVariant{};
+   }
+   return this->values.at(index.value());
+}
+
+ObjectStoreSnapshot::ObjectStoreSnapshot() : data{std::make_shared<Data const>()} {
+   return;
+}
+
+ObjectStoreSnapshot::~ObjectStoreSnapshot() = default;
+
+ObjectStoreSnapshot ObjectStoreSnapshot::capture(ObjectStore const & objectStore) {
+   // It's a coding error to call this from anywhere other than the main thread
+   Q_ASSERT(QThread::currentThread() == QCoreApplication::instance()->thread());
+
+   //
+   // The last snapshot taken of each store, if anyone is still using it.  We don't want to hold a full copy of every
+   // store we have ever printed for the rest of the session, so this doesn't keep the data alive.  Only accessed on
+   // the main thread, so no need for a mutex.
+   //
+   static QHash<ObjectStore const *, std::weak_ptr<Data const> > lastSnapshots;
+
+   quint64 const generation = ObjectStore::changeGeneration();
+   std::shared_ptr<Data const> lastData = lastSnapshots.value(&objectStore).lock();
+   if (lastData && lastData->generation == generation) {
+      static Metrics::Counter & numReused = Metrics::counter("db.snapshot.reused");
+      numReused.add();
+      ObjectStoreSnapshot snapshot;
+      snapshot.data = lastData;
+      return snapshot;
+   }
+   // Whatever we had is out of date (or gone), so drop it now rather than when we've made its replacement
+   lastData.reset();
+   lastSnapshots.remove(&objectStore);
+
+   static Metrics::Histogram & captureLatency = Metrics::histogram("db.snapshot.captureLatencyNs");
+   Metrics::ScopedLatency const latency{captureLatency};
+
+   auto data = std::make_shared<Data>();
+   data->generation = generation;
+
+   // All the objects in a store are normally the same class, so this will usually only ever hold one layout
+   QHash<QMetaObject const *, Layout> layouts;
+   QList<QObject *> const objects = objectStore.getAllRaw();
+   data->records.reserve(objects.size());
+   for (QObject const * object : objects) {
+      QMetaObject const * metaObject = object->metaObject();
+      if (!layouts.contains(metaObject)) {
+         layouts.insert(metaObject, makeLayout(*metaObject));
+      }
+      Layout const & layout = layouts[metaObject];
+
+      Record record;
+      record.propertyIndexes = layout.propertyIndexes;
+      record.values.reserve(layout.properties.size());
+      for (auto const & metaProperty : layout.properties) {
+         record.values.append(metaProperty.read(object));
+      }
+      data->records.append(record);
+   }
+
+   ObjectStoreSnapshot snapshot;
+   snapshot.data = data;
+   lastSnapshots.insert(&objectStore, data);
+   return snapshot;
+}
+
+quint64 ObjectStoreSnapshot::generation() const {
+   return this->data->generation;
+}
+
+QVector<ObjectStoreSnapshot::Record> const & ObjectStoreSnapshot::records() const {
+   return this->data->records;
+}
+
+QVector<ObjectStoreSnapshot::Record> ObjectStoreSnapshot::findAllMatching(
+   std::function<bool(Record const &)> const & matchFunction
+) const {
+   QVector<Record> matches;
+   for (auto const & record : this->data->records) {
+      if (matchFunction(record)) {
+         matches.append(record);
+      }
+   }
+   return matches;
+}
@@ -0,0 +1,114 @@
+/*
+ * database/ObjectStoreSnapshot.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATABASE_OBJECTSTORESNAPSHOT_H
+#define DATABASE_OBJECTSTORESNAPSHOT_H
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include <QByteArray>
+#include <QHash>
+#include <QVariant>
+#include <QVector>
+
+#include "database/ObjectStoreTyped.h"
+#include "utils/BtStringConst.h"
+
+/**
+ * \brief A read-only copy of the contents of an object store at a moment in time, for things like printing and
+ *        reporting that want to do their work on a worker thread.
+ *
+ *        The objects in an \c ObjectStore live on the main thread and can change at any time (eg because the user
+ *        edits something, or a recipe recalculates itself).  Reading them from another thread is not safe, and even on
+ *        the main thread, a long-running report could see some objects before a change and some after it.  So,
+ *        instead, on the main thread, we \c capture() each object's properties as a flat \c Record of values, which
+ *        the worker then reads at its leisure.  Nothing in a snapshot points back to the live objects, so reading it
+ *        does not need any locking and cannot cause any signals to be emitted.
+ *
+ *        A snapshot is cheap to copy and safe to share between threads: the records are held by a shared pointer and
+ *        are never modified after capture, and the property values are \c QVariant, \c QString etc, which are
+ *        themselves implicitly shared.  It is also often cheap to take: we remember the last snapshot of each store
+ *        (without keeping it alive once no-one else is using it), and, if \c ObjectStore::changeGeneration() says
+ *        nothing has changed since, we return that rather than reading all the objects again.
+ *
+ *        We capture every readable property whose value is a plain value type (numbers, strings, dates, enums and
+ *        lists of IDs).  Properties that return pointers to other objects (eg \c Recipe::hops) are skipped, as they
+ *        would lead back to live objects; use the corresponding ID property instead (eg \c Recipe::hopIds) and look
+ *        the ID up in a snapshot of the other store.
+ *
+ *        So far, the inventory printout (\c InventoryFormatter) is built from snapshots, but the recipe printout
+ *        (\c RecipeFormatter) is not yet.
+ */
+class ObjectStoreSnapshot {
+public:
+   /**
+    * \brief The captured property values of one object
+    */
+   class Record {
+   public:
+      /**
+       * \return The value the property had when the snapshot was taken, or an invalid \c QVariant if the object does
+       *         not have the property or it was not captured (see class comment)
+       */
+      QVariant value(BtStringConst const & propertyName) const;
+
+      //! Convenience function for getting a value as a particular type, eg \c record.get<double>(...)
+      template<typename T>
+      T get(BtStringConst const & propertyName) const {
+         return this->value(propertyName).value<T>();
+      }
+
+   private:
+      friend class ObjectStoreSnapshot;
+      using PropertyIndexes = QHash<QByteArray, int>;
+      std::shared_ptr<PropertyIndexes const> propertyIndexes;
+      QVector<QVariant> values;
+   };
+
+   //! An empty snapshot
+   ObjectStoreSnapshot();
+   ~ObjectStoreSnapshot();
+
+   /**
+    * \brief Take a snapshot of a store.  MUST be called on the main thread (as that's where the objects live).
+    */
+   static ObjectStoreSnapshot capture(ObjectStore const & objectStore);
+
+   //! Convenience version of \c capture, eg \c ObjectStoreSnapshot::capture<Hop>()
+   template<class NE>
+   static ObjectStoreSnapshot capture() {
+      return ObjectStoreSnapshot::capture(ObjectStoreTyped<NE>::getInstance());
+   }
+
+   //! \return The value of \c ObjectStore::changeGeneration() when the snapshot was taken
+   quint64 generation() const;
+
+   //! \return All the records, in no particular order
+   QVector<Record> const & records() const;
+
+   //! \return The records for which \c matchFunction returns \c true
+   QVector<Record> findAllMatching(std::function<bool(Record const &)> const & matchFunction) const;
+
+private:
+   struct Data;
+   std::shared_ptr<Data const> data;
+};
+
+#endif
@@ -19,8 +19,11 @@
 #include "database/ObjectStoreTyped.h"
 
 #include  <mutex> // for std::once_flag
+#include <utility>
 
+#include "database/Database.h"
 #include "database/DbTransaction.h"
+#include "Logging.h"
 #include "model/BrewNote.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
@@ -754,6 +757,47 @@ template ObjectStoreTyped<Style> &                ObjectStoreTyped<Style>::getIn
 template ObjectStoreTyped<Water> &                ObjectStoreTyped<Water>::getInstance();
 template ObjectStoreTyped<Yeast> &                ObjectStoreTyped<Yeast>::getInstance();
 
+template<class NE>
+std::unique_ptr<ObjectStoreTyped<NE>> ObjectStoreTyped<NE>::createDetachedInstance() {
+   return std::make_unique<ObjectStoreTyped<NE>>(PRIMARY_TABLE<NE>, JUNCTION_TABLES<NE>);
+}
+
+// Same again for this function
+template std::unique_ptr<ObjectStoreTyped<BrewNote>>
+   ObjectStoreTyped<BrewNote>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<Equipment>>
+   ObjectStoreTyped<Equipment>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<Fermentable>>
+   ObjectStoreTyped<Fermentable>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<Hop>>
+   ObjectStoreTyped<Hop>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<Instruction>>
+   ObjectStoreTyped<Instruction>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<InventoryFermentable>>
+   ObjectStoreTyped<InventoryFermentable>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<InventoryHop>>
+   ObjectStoreTyped<InventoryHop>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<InventoryMisc>>
+   ObjectStoreTyped<InventoryMisc>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<InventoryYeast>>
+   ObjectStoreTyped<InventoryYeast>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<Mash>>
+   ObjectStoreTyped<Mash>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<MashStep>>
+   ObjectStoreTyped<MashStep>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<Misc>>
+   ObjectStoreTyped<Misc>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<Recipe>>
+   ObjectStoreTyped<Recipe>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<Salt>>
+   ObjectStoreTyped<Salt>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<Style>>
+   ObjectStoreTyped<Style>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<Water>>
+   ObjectStoreTyped<Water>::createDetachedInstance();
+template std::unique_ptr<ObjectStoreTyped<Yeast>>
+   ObjectStoreTyped<Yeast>::createDetachedInstance();
+
 namespace {
    QVector<ObjectStore const *> AllObjectStores {
       &ostSingleton<BrewNote>,
@@ -777,7 +821,7 @@ namespace {
 }
 
 bool CreateAllDatabaseTables(Database & database, QSqlDatabase & connection) {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::db) << Q_FUNC_INFO;
    for (auto ii : AllObjectStores) {
       if (!ii->createTables(database, connection)) {
          return false;
@@ -788,6 +832,16 @@ bool CreateAllDatabaseTables(Database & database, QSqlDatabase & connection) {
          return false;
       }
    }
+   return CreateAllDatabaseIndexes(database, connection);
+}
+
+bool CreateAllDatabaseIndexes(Database & database, QSqlDatabase & connection) {
+   qCDebug(Logging::db) << Q_FUNC_INFO;
+   for (auto objectStore : AllObjectStores) {
+      if (!objectStore->createIndexes(database, connection)) {
+         return false;
+      }
+   }
    return true;
 }
 
@@ -809,3 +863,122 @@ bool WriteAllObjectStoresToNewDb(Database & newDatabase, QSqlDatabase & connecti
    dbTransaction.commit();
    return true;
 }
+
+QVector<ObjectStore::TableDefinition const *> GetAllTableDefinitions() {
+   QVector<ObjectStore::TableDefinition const *> tableDefinitions;
+   for (ObjectStore const * objectStore : AllObjectStores) {
+      tableDefinitions += objectStore->getTableDefinitions();
+   }
+   return tableDefinitions;
+}
+
+namespace {
+   //! \return The IDs of the soft-deleted objects of one type
+   template<class NE>
+   QVector<int> findSoftDeleted() {
+      auto const & objectStore = ObjectStoreTyped<NE>::getInstance();
+      QVector<int> softDeletedIds;
+      for (NE const * ne : objectStore.findAllMatching([](NE * ne) { return ne->deleted(); })) {
+         softDeletedIds.append(ne->key());
+      }
+      return softDeletedIds;
+   }
+
+   //! \brief See \c ObjectStore::findUnreferenced
+   template<class NE>
+   QVector<int> findUnreferenced(QVector<int> const & ids,
+                                 QVector<ObjectStore::TableDefinition const *> const & allTables) {
+      return ObjectStoreTyped<NE>::getInstance().findUnreferenced(ids, allTables);
+   }
+
+   /**
+    * \brief Hard delete, in one transaction, those of the given objects of one type that are still soft deleted
+    *
+    * \return Number of objects purged
+    */
+   template<class NE>
+   int hardDeleteSoftDeleted(QVector<int> const & ids) {
+      auto & objectStore = ObjectStoreTyped<NE>::getInstance();
+      Database & database = Database::instance();
+      QSqlDatabase connection = database.sqlDatabase();
+      DbTransaction dbTransaction{database, connection};
+      int numPurged = 0;
+      for (int id : ids) {
+         // If we were called from DatabaseCompaction, the user might have undeleted the object in the meantime
+         auto object = objectStore.getById(id);
+         if (!object || !object->deleted()) {
+            continue;
+         }
+         objectStore.hardDelete(id);
+         // If the delete failed (which will have been logged), the object will still be in the store
+         if (!objectStore.contains(id)) {
+            ++numPurged;
+         }
+      }
+      dbTransaction.commit();
+      qCDebug(Logging::db) <<
+         Q_FUNC_INFO << "Purged" << numPurged << "of" << ids.size() << "soft-deleted" <<
+         NE::staticMetaObject.className();
+      return numPurged;
+   }
+
+   //! \brief The functions above for one type of object that can be soft deleted
+   struct SoftDeletableType {
+      QVector<int> (*findSoftDeleted)();
+      QVector<int> (*findUnreferenced)(QVector<int> const &, QVector<ObjectStore::TableDefinition const *> const &);
+      int (*hardDeleteSoftDeleted)(QVector<int> const &);
+   };
+
+   template<class NE>
+   std::pair<QString, SoftDeletableType> softDeletableType() {
+      return {*PRIMARY_TABLE<NE>.tableName,
+              SoftDeletableType{&findSoftDeleted<NE>, &findUnreferenced<NE>, &hardDeleteSoftDeleted<NE>}};
+   }
+
+   //! \return The types of object that can be soft deleted, by the name of the table each is stored in
+   QMap<QString, SoftDeletableType> const & softDeletableTypes() {
+      static QMap<QString, SoftDeletableType> const types{
+         softDeletableType<BrewNote>(),
+         softDeletableType<Equipment>(),
+         softDeletableType<Fermentable>(),
+         softDeletableType<Hop>(),
+         softDeletableType<Instruction>(),
+         softDeletableType<Mash>(),
+         softDeletableType<MashStep>(),
+         softDeletableType<Misc>(),
+         softDeletableType<Recipe>(),
+         softDeletableType<Salt>(),
+         softDeletableType<Style>(),
+         softDeletableType<Water>(),
+         softDeletableType<Yeast>()
+      };
+      return types;
+   }
+}
+
+QMap<QString, QVector<int> > FindSoftDeleted() {
+   QMap<QString, QVector<int> > softDeletedIdsByTable;
+   for (auto ii = softDeletableTypes().constBegin(); ii != softDeletableTypes().constEnd(); ++ii) {
+      QVector<int> const softDeletedIds = ii.value().findSoftDeleted();
+      if (!softDeletedIds.isEmpty()) {
+         softDeletedIdsByTable.insert(ii.key(), softDeletedIds);
+      }
+   }
+   return softDeletedIdsByTable;
+}
+
+QMap<QString, QVector<int> > FindUnreferenced(QMap<QString, QVector<int> > const & softDeletedIdsByTable) {
+   QVector<ObjectStore::TableDefinition const *> const allTables = GetAllTableDefinitions();
+   QMap<QString, QVector<int> > unreferencedIdsByTable;
+   for (auto ii = softDeletedIdsByTable.constBegin(); ii != softDeletedIdsByTable.constEnd(); ++ii) {
+      QVector<int> const unreferencedIds = softDeletableTypes().value(ii.key()).findUnreferenced(ii.value(), allTables);
+      if (!unreferencedIds.isEmpty()) {
+         unreferencedIdsByTable.insert(ii.key(), unreferencedIds);
+      }
+   }
+   return unreferencedIdsByTable;
+}
+
+int HardDeleteSoftDeleted(QString const & tableName, QVector<int> const & ids) {
+   return softDeletableTypes().value(tableName).hardDeleteSoftDeleted(ids);
+}
@@ -22,9 +22,13 @@
 #include <memory>
 
 #include <QDebug>
+#include <QMap>
+#include <QString>
 
 #include "database/ObjectStore.h"
+#include "Logging.h"
 #include "model/NamedEntity.h"
+#include "utils/MemoryAccounting.h"
 
 /**
  * \brief Read, write and cache any subclass of \c NamedEntity in the database
@@ -41,7 +45,15 @@ public:
     */
    ObjectStoreTyped(TableDefinition const & primaryTable,
                     JunctionTableDefinitions const & junctionTables = JunctionTableDefinitions{}) :
-      ObjectStore(primaryTable, junctionTables) {
+      ObjectStore(primaryTable, junctionTables),
+      memoryRegistration{
+         [this, name = QString{"objectStore/%1"}.arg(*primaryTable.tableName)](
+            QMap<QString, MemoryAccounting::Usage> & usage
+         ) {
+            usage[name] += this->getMemoryUsage();
+            return;
+         }
+      } {
       return;
    }
 
@@ -54,6 +66,13 @@ public:
     */
    static ObjectStoreTyped<NE> & getInstance();
 
+   /**
+    * \brief Create a new, empty, store with the same database mappings as the one returned by \c getInstance().
+    *        Objects read in by calling \c loadAll() on it are not visible to the rest of the program, so this is only
+    *        useful for measuring the cost of loading (eg in unitTests/Benchmarks.cpp).
+    */
+   static std::unique_ptr<ObjectStoreTyped<NE>> createDetachedInstance();
+
    /**
     * \brief Insert a new object in the DB (and in our cache list)
     */
@@ -285,6 +304,21 @@ public:
       return this->convertRaw(this->ObjectStore::getAll());
    }
 
+   /**
+    * \brief Approximate number and size of the objects we are holding.  See \c MemoryAccounting.
+    */
+   MemoryAccounting::Usage getMemoryUsage() const {
+      MemoryAccounting::Usage usage;
+      for (auto const & object : this->ObjectStore::getAll()) {
+         ++usage.numObjects;
+         usage.approxBytes += MemoryAccounting::approxSizeOfSharedObject(*object, sizeof(NE));
+      }
+      // Each entry in our cache is an ID and a shared pointer in a hash node
+      usage.approxBytes +=
+         usage.numObjects * (MemoryAccounting::containerNodeOverhead + sizeof(int) + sizeof(std::shared_ptr<QObject>));
+      return usage;
+   }
+
 protected:
    /**
     * \brief Create a new object of the type we are handling, using the parameters read from the DB
@@ -300,6 +334,8 @@ protected:
    }
 
 private:
+   MemoryAccounting::Registration memoryRegistration;
+
    /**
     * \brief Do a hard or soft delete
     *
@@ -307,7 +343,7 @@ private:
     * \param hard \c true for hard delete, \c false for soft delete
     */
    std::shared_ptr<NE> hardOrSoftDelete(int id, bool hard) {
-      qDebug() <<
+      qCDebug(Logging::db) <<
          Q_FUNC_INFO << (hard ? "Hard" : "Soft") << "delete " << NE::staticMetaObject.className() << " #" << id;
       if (id <= 0 || !this->contains(id)) {
          // Trying to delete a non-existent object is a coding error, but might be recoverable
@@ -393,6 +429,15 @@ private:
  */
 bool CreateAllDatabaseTables(Database & database, QSqlDatabase & connection);
 
+/**
+ * \brief Create the secondary indexes for all the object stores (see \c ObjectStore::createIndexes).  This is done as
+ *        part of \c CreateAllDatabaseTables, but is also needed separately for upgrading existing DBs.  Caller's
+ *        responsibility to handle transactions.
+ *
+ * \return false if something went wrong, true otherwise
+ */
+bool CreateAllDatabaseIndexes(Database & database, QSqlDatabase & connection);
+
 /**
  * \brief Write all data in all object stores to a new database
  *
@@ -402,4 +447,35 @@ bool CreateAllDatabaseTables(Database & database, QSqlDatabase & connection);
  */
 bool WriteAllObjectStoresToNewDb(Database & newDatabase, QSqlDatabase & connectionNew);
 
+/**
+ * \return The definitions of all the tables in all the object stores (see \c ObjectStore::getTableDefinitions)
+ */
+QVector<ObjectStore::TableDefinition const *> GetAllTableDefinitions();
+
+/**
+ * \return The IDs of all soft-deleted objects, by primary table name.  MUST be called on the main thread (as that's
+ *         where the object stores live).  See \c DatabaseCompaction.
+ */
+QMap<QString, QVector<int> > FindSoftDeleted();
+
+/**
+ * \brief Of the soft-deleted objects returned by \c FindSoftDeleted, find those that nothing else in the DB refers to
+ *        (see \c ObjectStore::findUnreferenced).  This only reads the DB (not the object stores), so it can be called
+ *        on any thread that has its own connection.
+ *
+ * \return The IDs of the unreferenced objects, by primary table name
+ */
+QMap<QString, QVector<int> > FindUnreferenced(QMap<QString, QVector<int> > const & softDeletedIdsByTable);
+
+/**
+ * \brief Hard delete, in one DB transaction, those of the given objects that are still soft deleted.  MUST be called
+ *        on the main thread.
+ *
+ * \param tableName Primary table name, as returned by \c FindSoftDeleted
+ * \param ids
+ *
+ * \return The number of objects purged
+ */
+int HardDeleteSoftDeleted(QString const & tableName, QVector<int> const & ids);
+
 #endif
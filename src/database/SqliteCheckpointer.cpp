@@ -0,0 +1,139 @@
+/*
+ * database/SqliteCheckpointer.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "database/SqliteCheckpointer.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSqlDatabase>
+#include <QSqlError>
+
+#include "database/BtSqlQuery.h"
+#include "database/Database.h"
+#include "Logging.h"
+#include "utils/Metrics.h"
+
+namespace {
+   //! How often we look at the WAL file
+   unsigned long constexpr POLL_INTERVAL_MS = 1000;
+
+   //
+   // Once the WAL has this much in it, we checkpoint even if the user is still busy.  This is about the same as
+   // SQLite's own default (1000 pages of 4 KiB).  It needs to be bigger than the journal_size_limit that Database
+   // sets, as that is the size the WAL file is cut back to when SQLite starts writing it again from the beginning.
+   // (Otherwise, the size of the file would not tell us how much is in it.)
+   //
+   qint64 constexpr WAL_SIZE_CHECKPOINT_BYTES = 4 * 1024 * 1024;
+
+   //! If nothing has been written to the WAL for this long, we empty it
+   qint64 constexpr IDLE_CHECKPOINT_MS = 5000;
+
+   /**
+    * \brief Run a checkpoint of the given type ("PASSIVE" or "TRUNCATE")
+    *
+    * \return \c true if the checkpoint ran (whether or not it was able to copy everything), \c false if there was an
+    *         error
+    */
+   bool checkpoint(QSqlDatabase & connection, char const * const checkpointType) {
+      static Metrics::Histogram & checkpointLatency = Metrics::histogram("db.sqliteCheckpoint.latencyNs");
+      Metrics::ScopedLatency scopedLatency{checkpointLatency};
+
+      BtSqlQuery query{connection};
+      if (!query.exec(QString{"PRAGMA wal_checkpoint(%1);"}.arg(checkpointType)) || !query.next()) {
+         qWarning() << Q_FUNC_INFO << checkpointType << "checkpoint failed:" << query.lastError().text();
+         return false;
+      }
+      //
+      // Result is one row of three columns: 1 if the checkpoint could not finish because another connection was using
+      // the DB (which is fine -- we'll get it next time), the number of pages in the WAL, and the number of those that
+      // have been copied back to the DB file.
+      //
+      qCDebug(Logging::db) <<
+         Q_FUNC_INFO << checkpointType << "checkpoint: busy =" << query.value(0).toInt() << ", WAL pages =" <<
+         query.value(1).toInt() << ", pages copied =" << query.value(2).toInt();
+      return true;
+   }
+}
+
+SqliteCheckpointer::SqliteCheckpointer(Database & database, QString const & dbFileName) :
+   QThread{},
+   database{database},
+   walFileName{dbFileName + "-wal"},
+   mutex{},
+   stopCondition{},
+   stopRequested{false} {
+   return;
+}
+
+SqliteCheckpointer::~SqliteCheckpointer() {
+   this->stop();
+   return;
+}
+
+void SqliteCheckpointer::stop() {
+   {
+      QMutexLocker locker(&this->mutex);
+      this->stopRequested = true;
+      this->stopCondition.wakeAll();
+   }
+   this->wait();
+   return;
+}
+
+void SqliteCheckpointer::run() {
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Checkpointing" << this->walFileName;
+   {
+      // This needs to be out of scope before we call closeConnectionForThisThread()
+      QSqlDatabase connection = this->database.sqlDatabase();
+
+      // When we last checkpointed.  Anything written to the WAL after this has not yet been checkpointed.
+      QDateTime lastCheckpoint = QDateTime::currentDateTime();
+
+      QMutexLocker locker(&this->mutex);
+      while (!this->stopRequested) {
+         this->stopCondition.wait(&this->mutex, POLL_INTERVAL_MS);
+         if (this->stopRequested) {
+            break;
+         }
+
+         // Don't hold up stop() while we are talking to the DB
+         locker.unlock();
+
+         QFileInfo const walFileInfo{this->walFileName};
+         qint64 const walSize = walFileInfo.exists() ? walFileInfo.size() : 0;
+         QDateTime const now = QDateTime::currentDateTime();
+         QDateTime const lastWrite = walFileInfo.lastModified();
+         if (walSize >= WAL_SIZE_CHECKPOINT_BYTES && lastWrite >= lastCheckpoint) {
+            checkpoint(connection, "PASSIVE");
+            lastCheckpoint = now;
+         } else if (walSize > 0 && lastWrite.msecsTo(now) >= IDLE_CHECKPOINT_MS) {
+            // If another connection is part way through a transaction, this will wait for it (up to the busy timeout)
+            // and otherwise give up and try again next time.
+            checkpoint(connection, "TRUNCATE");
+            lastCheckpoint = now;
+         }
+
+         locker.relock();
+      }
+   }
+   this->database.closeConnectionForThisThread();
+   qCDebug(Logging::db) << Q_FUNC_INFO << "Stopped checkpointing" << this->walFileName;
+   return;
+}
@@ -0,0 +1,70 @@
+/*
+ * database/SqliteCheckpointer.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATABASE_SQLITECHECKPOINTER_H
+#define DATABASE_SQLITECHECKPOINTER_H
+#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+class Database;
+
+/**
+ * \brief When SQLite is in WAL mode (see \c Database::SqliteJournalMode), commits are appended to the write-ahead log
+ *        (the "-wal" file next to the DB) and only later copied back into the DB file by a "checkpoint".  By default,
+ *        SQLite does this itself, on whichever connection happens to commit the transaction that takes the WAL over
+ *        1000 pages, which means that every so often one edit in the UI takes much longer than the others.
+ *
+ *        Instead, we turn the automatic checkpoint down to a rarely-reached backstop and run checkpoints on this
+ *        background thread, which has its own connection.  It looks at the WAL file once a second and:
+ *          - if the WAL has grown past a size limit since the last checkpoint, does a PASSIVE checkpoint (which copies
+ *            as much as it can without waiting for, or holding up, anyone else);
+ *          - if the WAL is not empty and nothing has been written for a few seconds (eg the user has stopped typing),
+ *            does a TRUNCATE checkpoint, which copies everything back and empties the WAL, so the DB file on its own
+ *            is up-to-date.
+ *
+ *        Checkpoint timings are recorded in the db.sqliteCheckpoint.latencyNs histogram (see \c Metrics).
+ */
+class SqliteCheckpointer : public QThread {
+   // No signals or slots, so no need for Q_OBJECT
+public:
+   /**
+    * \param dbFileName The SQLite DB file.  The WAL is the file of the same name with "-wal" on the end.
+    */
+   SqliteCheckpointer(Database & database, QString const & dbFileName);
+   ~SqliteCheckpointer();
+
+   //! \brief Ask the thread to finish, and wait until it has
+   void stop();
+
+protected:
+   virtual void run() override;
+
+private:
+   Database & database;
+   QString const walFileName;
+
+   QMutex mutex;
+   QWaitCondition stopCondition;
+   bool stopRequested;
+};
+
+#endif
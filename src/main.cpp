@@ -36,6 +36,10 @@
 #include "database/Database.h"
 #include "Logging.h"
 #include "PersistentSettings.h"
+#include "utils/MemoryAccounting.h"
+#include "utils/Metrics.h"
+#include "utils/StartupProfiler.h"
+#include "utils/Tracing.h"
 
 namespace {
    /*!
@@ -109,6 +113,50 @@ int main(int argc, char **argv) {
     */
    QCommandLineOption const userDirectoryOption("user-dir", "Override the user data directory used by the application with <directory>", "directory", QString());
    parser.addOption(userDirectoryOption);
+   /*!
+    * \brief Sets logging levels for individual logging categories, just for this run of the application.
+    *
+    * Eg "--log-categories db=DEBUG,xml=DEBUG" to get debug logging from just the database and BeerXML code.  See
+    * \c Logging::setCategoryLogLevels().
+    */
+   QCommandLineOption const logCategoriesOption(
+      "log-categories",
+      "Set logging levels for <rules>, eg db=DEBUG,xml=WARNING (categories: db, xml, model, ui, calc)",
+      "rules"
+   );
+   parser.addOption(logCategoriesOption);
+   /*!
+    * \brief Records where time is spent in the main parts of the program (DB access, recipe calculations, BeerXML
+    *        import, etc) and, on exit, writes it to <file> in a format that can be viewed in chrome://tracing or
+    *        https://ui.perfetto.dev.  See \c Tracing.
+    */
+   QCommandLineOption const traceOption("trace", "On exit, write a performance trace of this run to <file>", "file");
+   parser.addOption(traceOption);
+   /*!
+    * \brief On exit, writes the counters and timing histograms collected during the run (see \c Metrics) to <file>
+    *        as JSON, eg to compare one build with another.
+    */
+   QCommandLineOption const dumpMetricsOption(
+      "dump-metrics", "On exit, write runtime metrics as JSON to <file>", "file"
+   );
+   parser.addOption(dumpMetricsOption);
+   /*!
+    * \brief Estimates how much memory each part of the program (each type of object in the DB, each tree and table of
+    *        ingredients, etc) is using, and shows it in Help > Diagnostics.  See \c MemoryAccounting.
+    */
+   QCommandLineOption const memoryAccountingOption(
+      "memory-accounting", "Show approximate memory use per subsystem in Help > Diagnostics"
+   );
+   parser.addOption(memoryAccountingOption);
+   /*!
+    * \brief Gets the main window up as quickly as possible by putting off things that can wait until it is shown (eg
+    *        checking for new default data).  Same as the deferStartupWork setting, but just for this run.  See
+    *        \c StartupProfiler for how to see where start-up time goes.
+    */
+   QCommandLineOption const deferStartupWorkOption(
+      "defer-startup-work", "Do non-essential start-up work only once the main window is shown"
+   );
+   parser.addOption(deferStartupWorkOption);
    parser.addHelpOption();
    parser.addVersionOption();
    parser.process(app);
@@ -116,16 +164,32 @@ int main(int argc, char **argv) {
    //
    // Having initialised various QApplication settings and read command line options, we can now allow Qt to work out where to get config from
    //
-   PersistentSettings::initialise(parser.value(userDirectoryOption));
+   {
+      StartupProfiler::Phase startupPhase{"Initialise persistent settings"};
+      PersistentSettings::initialise(parser.value(userDirectoryOption));
+   }
 
    //
    // And once we have config, we can initialise logging
    //
-   Logging::initializeLogging();
+   {
+      StartupProfiler::Phase startupPhase{"Initialise logging"};
+      Logging::initializeLogging();
+   }
+   if (parser.isSet(logCategoriesOption)) {
+      Logging::setCategoryLogLevels(parser.value(logCategoriesOption));
+   }
+   if (parser.isSet(traceOption)) {
+      Tracing::setEnabled(true);
+   }
+   if (parser.isSet(memoryAccountingOption)) {
+      MemoryAccounting::setEnabled(true);
+   }
 
    // Initialize Xerces XML tools
    // NB: This is also where where we would initialise xalanc::XalanTransformer if we were using it
    try {
+      StartupProfiler::Phase startupPhase{"Initialise Xerces"};
       xercesc::XMLPlatformUtils::Initialize();
    } catch (xercesc::XMLException const & xercesInitException) {
       qCritical() << Q_FUNC_INFO << "Xerces XML Parser Initialisation Failed: " << xercesInitException.getMessage();
@@ -175,6 +239,10 @@ int main(int argc, char **argv) {
       }
    }
 
+   if (parser.isSet(deferStartupWorkOption)) {
+      Brewtarget::setDeferStartupWork(true);
+   }
+
    if (parser.isSet(importFromXmlOption)) importFromXml(parser.value(importFromXmlOption));
    if (parser.isSet(createBlankDBOption)) createBlankDb(parser.value(createBlankDBOption));
 
@@ -190,6 +258,14 @@ int main(int argc, char **argv) {
 
       auto mainAppReturnValue = Brewtarget::run();
 
+      if (parser.isSet(traceOption)) {
+         Tracing::setEnabled(false);
+         Tracing::writeChromeTrace(parser.value(traceOption));
+      }
+      if (parser.isSet(dumpMetricsOption)) {
+         Metrics::writeJson(parser.value(dumpMetricsOption));
+      }
+
       //
       // Clean exit of Xerces XML tools
       // If we, in future, want to use XalanTransformer, this needs to be extended to:
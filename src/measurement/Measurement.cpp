@@ -27,6 +27,7 @@
 
 #include "Algorithms.h"
 #include "Localization.h"
+#include "Logging.h"
 #include "measurement/UnitSystem.h"
 #include "model/NamedEntity.h"
 #include "model/Style.h" // For PropertyNames::Style::colorMin_srm, PropertyNames::Style::colorMax_srm
@@ -46,6 +47,12 @@ namespace {
     */
    QMap<Measurement::PhysicalQuantity, Measurement::UnitSystem const *> physicalQuantityToUnitSystem;
 
+   //
+   // Bumped every time a display setting changes -- see Measurement::getDisplaySettingsGeneration().  Display settings
+   // are only ever changed from the GUI thread, so there's no need for this to be atomic.
+   //
+   unsigned int displaySettingsGeneration = 0;
+
    //
    // Load the previous stored setting for which UnitSystem we use for a particular physical quantity
    //
@@ -108,10 +115,11 @@ void Measurement::setDisplayUnitSystem(Measurement::PhysicalQuantity physicalQua
                                        Measurement::UnitSystem const & unitSystem) {
    // It's a coding error if we try to store a UnitSystem against a PhysicalQuantity to which it does not relate!
    Q_ASSERT(physicalQuantity == unitSystem.getPhysicalQuantity());
-   qDebug() <<
+   qCDebug(Logging::calc) <<
       Q_FUNC_INFO << "Setting UnitSystem for" << Measurement::getDisplayName(physicalQuantity) << "to" <<
       unitSystem.uniqueName;
    physicalQuantityToUnitSystem.insert(physicalQuantity, &unitSystem);
+   ++displaySettingsGeneration;
    return;
 }
 
@@ -122,6 +130,10 @@ void Measurement::setDisplayUnitSystem(UnitSystem const & unitSystem) {
    return;
 }
 
+unsigned int Measurement::getDisplaySettingsGeneration() {
+   return displaySettingsGeneration;
+}
+
 Measurement::UnitSystem const & Measurement::getDisplayUnitSystem(Measurement::PhysicalQuantity physicalQuantity) {
    // It is a coding error if physicalQuantityToUnitSystem has not had data loaded into it by the time this function is
    // called.
@@ -389,6 +401,7 @@ void Measurement::setForcedSystemOfMeasurementForField(QString const & field,
                                  section,
                                  PersistentSettings::Extension::UNIT);
    }
+   ++displaySettingsGeneration;
    return;
 }
 
@@ -408,6 +421,7 @@ void Measurement::setForcedRelativeScaleForField(QString const & field,
                                  section,
                                  PersistentSettings::Extension::SCALE);
    }
+   ++displaySettingsGeneration;
    return;
 }
 
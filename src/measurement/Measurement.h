@@ -50,6 +50,14 @@ namespace Measurement {
     */
    void setDisplayUnitSystem(UnitSystem const & unitSystem);
 
+   /**
+    * \brief Returns a number that changes whenever any setting that affects how amounts are displayed changes -- ie
+    *        the display \c UnitSystem for any \c PhysicalQuantity, or the forced \c SystemOfMeasurement or
+    *        \c RelativeScale for any field.  Code that caches display strings (eg \c BtTableModel) can compare this
+    *        with the value it saw when it filled its cache to know whether the cache is stale.
+    */
+   unsigned int getDisplaySettingsGeneration();
+
    /**
     * \brief Get the display \c UnitSystem for the specified \c PhysicalQuantity
     *        Callers should not call this with \c Mixed as a parameter
@@ -31,6 +31,7 @@
 
 #include "Algorithms.h"
 #include "Localization.h"
+#include "Logging.h"
 #include "measurement/Measurement.h"
 #include "measurement/UnitSystem.h"
 
@@ -216,11 +217,11 @@ Measurement::Unit const * Measurement::Unit::getUnit(QString const & name,
                                                      std::optional<Measurement::PhysicalQuantity> physicalQuantity) {
    auto const numMatches = nameToUnit.count(name);
    if (0 == numMatches) {
-      qDebug() << Q_FUNC_INFO << name << "does not match any Unit";
+      qCDebug(Logging::calc) << Q_FUNC_INFO << name << "does not match any Unit";
       return nullptr;
    }
 
-   qDebug() << Q_FUNC_INFO << name << "has" << numMatches << "match(es)";
+   qCDebug(Logging::calc) << Q_FUNC_INFO << name << "has" << numMatches << "match(es)";
 
    // Under most circumstances, there is a one-to-one relationship between unit string and Unit. C will only map to
    // Measurement::Unit::Celsius, for example. If there's only one match, just return it.
@@ -243,13 +244,14 @@ Measurement::Unit const * Measurement::Unit::getUnit(QString const & name,
    for (auto ii = nameToUnit.find(name); ii != nameToUnit.end() && ii.key() == name; ++ii) {
       Measurement::Unit const * unit = ii.value();
       auto const & displayUnitSystem = Measurement::getDisplayUnitSystem(unit->getPhysicalQuantity());
-      qDebug() <<
+      qCDebug(Logging::calc) <<
          Q_FUNC_INFO << "Look at" << *unit << "from" << unit->getUnitSystem() << "(Display Unit System for" <<
          unit->getPhysicalQuantity() << "is" << displayUnitSystem << ")";
       if (physicalQuantity && unit->getPhysicalQuantity() != *physicalQuantity) {
          // If the caller knows the amount is, say, a Volume, don't bother trying to match against units for any other
          // physical quantity.
-         qDebug() << Q_FUNC_INFO << "Ignoring match in" << unit->getPhysicalQuantity() << "as not" << *physicalQuantity;
+         qCDebug(Logging::calc) << Q_FUNC_INFO << "Ignoring match in" << unit->getPhysicalQuantity() << "as not"
+            << *physicalQuantity;
          continue;
       }
 
@@ -28,6 +28,7 @@
 #include <QRegExp>
 
 #include "Localization.h"
+#include "Logging.h"
 #include "measurement/Unit.h"
 #include "utils/EnumStringMapping.h"
 
@@ -209,7 +210,7 @@ Measurement::Amount Measurement::UnitSystem::qstringToSI(QString qstr, Unit cons
 
    // make sure we can parse the string
    if (amtUnit.indexIn(qstr) == -1) {
-      qDebug() << Q_FUNC_INFO << "Unable to parse" << qstr;
+      qCDebug(Logging::calc) << Q_FUNC_INFO << "Unable to parse" << qstr;
       return Amount{0.0, Measurement::Unit::getCanonicalUnit(this->pimpl->physicalQuantity)};
    }
 
@@ -233,20 +234,21 @@ Measurement::Amount Measurement::UnitSystem::qstringToSI(QString qstr, Unit cons
          unitToUse = Measurement::Unit::getUnit(unitName, this->pimpl->physicalQuantity);
       }
       if (unitToUse) {
-         qDebug() << Q_FUNC_INFO << this->uniqueName << ":" << unitName << "interpreted as" << unitToUse->name;
+         qCDebug(Logging::calc) << Q_FUNC_INFO << this->uniqueName << ":" << unitName << "interpreted as"
+            << unitToUse->name;
       } else {
-         qDebug() <<
+         qCDebug(Logging::calc) <<
             Q_FUNC_INFO << this->uniqueName << ":" << unitName << "not recognised for" << this->pimpl->physicalQuantity;
       }
    }
 
    if (!unitToUse) {
-      qDebug() << Q_FUNC_INFO << "Defaulting to" << defUnit;
+      qCDebug(Logging::calc) << Q_FUNC_INFO << "Defaulting to" << defUnit;
       unitToUse = &defUnit;
    }
 
    Measurement::Amount siAmount = unitToUse->toSI(amt);
-   qDebug() <<
+   qCDebug(Logging::calc) <<
       Q_FUNC_INFO << this->uniqueName << ": " << qstr << "is" << amt << " " << unitToUse->name << "=" << siAmount.quantity <<
       "in" << siAmount.unit.name;
 
@@ -26,6 +26,7 @@
 #include <QObject>
 
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "model/MashStep.h"
 #include "model/NamedParameterBundle.h"
 #include "model/Recipe.h"
@@ -221,7 +222,7 @@ void Mash::swapMashSteps(MashStep & ms1, MashStep & ms2) {
 
    this->pimpl->setCanonicalMashStepNumbers();
 
-   qDebug() <<
+   qCDebug(Logging::model) <<
       Q_FUNC_INFO << "Swapping steps" << ms1.stepNumber() << "(#" << ms1.key() << ") and " << ms2.stepNumber() <<
       " (#" << ms2.key() << ")";
 
@@ -250,7 +251,7 @@ void Mash::swapMashSteps(MashStep & ms1, MashStep & ms2) {
 
 void Mash::removeAllMashSteps() {
    auto steps = this->mashSteps();
-   qDebug() << Q_FUNC_INFO << "Removing" << steps.size() << "steps from" << *this;
+   qCDebug(Logging::model) << Q_FUNC_INFO << "Removing" << steps.size() << "steps from" << *this;
    for (auto ms : this->mashSteps()) {
       ObjectStoreWrapper::hardDelete(*ms);
    }
@@ -378,7 +379,7 @@ void Mash::acceptMashStepChange(QMetaProperty prop, QVariant /*val*/) {
 
 std::shared_ptr<MashStep> Mash::addMashStep(std::shared_ptr<MashStep> mashStep) {
    if (this->key() > 0) {
-      qDebug() << Q_FUNC_INFO << "Add MashStep #" << mashStep->key() << "to Mash #" << this->key();
+      qCDebug(Logging::model) << Q_FUNC_INFO << "Add MashStep #" << mashStep->key() << "to Mash #" << this->key();
       mashStep->setMashId(this->key());
    }
 
@@ -386,7 +387,7 @@ std::shared_ptr<MashStep> Mash::addMashStep(std::shared_ptr<MashStep> mashStep)
 
    // MashStep needs to be in the DB for us to add it to the Mash
    if (mashStep->key() < 0) {
-      qDebug() << Q_FUNC_INFO << "Inserting MashStep in DB for Mash #" << this->key();
+      qCDebug(Logging::model) << Q_FUNC_INFO << "Inserting MashStep in DB for Mash #" << this->key();
       ObjectStoreWrapper::insert(mashStep);
    }
 
@@ -400,7 +401,7 @@ std::shared_ptr<MashStep> Mash::addMashStep(std::shared_ptr<MashStep> mashStep)
    // any time by just asking the relevant ObjectStore for all MashSteps with Mash ID the same as ours.)
    //
    if (this->key() < 0) {
-      qDebug() << Q_FUNC_INFO << "Adding MashStep #" << mashStep->key() << "to Mash #" << this->key();
+      qCDebug(Logging::model) << Q_FUNC_INFO << "Adding MashStep #" << mashStep->key() << "to Mash #" << this->key();
       this->pimpl->mashStepIds.append(mashStep->key());
    }
 
@@ -25,11 +25,30 @@
 #include <typeinfo>
 
 #include <QDebug>
+#include <QHash>
 #include <QMetaProperty>
 
 #include "database/ObjectStore.h"
+#include "Logging.h"
 #include "model/NamedParameterBundle.h"
 #include "model/Recipe.h"
+#include "utils/Metrics.h"
+
+namespace {
+   //
+   // Counter of changed() signals sent by each subclass of NamedEntity.  Each thread remembers which counter goes with
+   // which class, so, after the first signal from a given class, counting does not need to take a lock.
+   //
+   Metrics::Counter & changedSignalCounter(QMetaObject const * metaObject) {
+      thread_local QHash<QMetaObject const *, Metrics::Counter *> metaObjectToCounter;
+      Metrics::Counter * counter = metaObjectToCounter.value(metaObject, nullptr);
+      if (!counter) {
+         counter = &Metrics::counter(QString{"model.changedSignals.%1"}.arg(metaObject->className()));
+         metaObjectToCounter.insert(metaObject, counter);
+      }
+      return *counter;
+   }
+}
 
 NamedEntity::NamedEntity(QString t_name, bool t_display, QString folder) :
    QObject    {nullptr  },
@@ -353,6 +372,7 @@ void NamedEntity::propagatePropertyChange(BtStringConst const & propertyName, bo
       Q_ASSERT(idx >= 0);
       QMetaProperty metaProperty = this->metaObject()->property(idx);
       QVariant value = metaProperty.read(this);
+      changedSignalCounter(this->metaObject()).add();
       emit this->changed(metaProperty, value);
    }
 
@@ -374,13 +394,13 @@ void NamedEntity::setParent(NamedEntity const & parentNamedEntity) {
 
 void NamedEntity::hardDeleteOwnedEntities() {
    // If we are not overridden in the subclass then there is no work to do
-   qDebug() << Q_FUNC_INFO << this->metaObject()->className() << "owns no other entities";
+   qCDebug(Logging::model) << Q_FUNC_INFO << this->metaObject()->className() << "owns no other entities";
    return;
 }
 
 void NamedEntity::hardDeleteOrphanedEntities() {
    // If we are not overridden in the subclass then there is no work to do
-   qDebug() << Q_FUNC_INFO << this->metaObject()->className() << "leaves no other entities as orphans";
+   qCDebug(Logging::model) << Q_FUNC_INFO << this->metaObject()->className() << "leaves no other entities as orphans";
    return;
 }
 
@@ -390,7 +410,7 @@ void NamedEntity::hardDeleteOrphanedEntities() {
 NamedEntityModifyingMarker::NamedEntityModifyingMarker(NamedEntity & namedEntity) :
    namedEntity{namedEntity},
    savedModificationState{namedEntity.isBeingModified()} {
-   qDebug() <<
+   qCDebug(Logging::model) <<
       Q_FUNC_INFO << "Marking" << this->namedEntity.metaObject()->className() << "#" << this->namedEntity.key() <<
       "as being modified (" << (this->savedModificationState ? "no change" : "previously was not") << ")";
    this->namedEntity.setBeingModified(true);
@@ -398,7 +418,7 @@ NamedEntityModifyingMarker::NamedEntityModifyingMarker(NamedEntity & namedEntity
 }
 
 NamedEntityModifyingMarker::~NamedEntityModifyingMarker() {
-   qDebug() <<
+   qCDebug(Logging::model) <<
       Q_FUNC_INFO << "Restoring" << this->namedEntity.metaObject()->className() << "#" << this->namedEntity.key() <<
       "\"being modified\" state to" << (this->savedModificationState ? "on" : "off");
    this->namedEntity.setBeingModified(this->savedModificationState);
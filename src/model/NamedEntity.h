@@ -35,6 +35,7 @@
 #include <QObject>
 #include <QVariant>
 
+#include "Logging.h"
 #include "utils/BtStringConst.h"
 
 class NamedParameterBundle;
@@ -375,7 +376,7 @@ protected:
                                 T & memberVariable,
                                 T const newValue) {
       if (newValue == memberVariable) {
-         qDebug() <<
+         qCDebug(Logging::model) <<
             Q_FUNC_INFO << this->metaObject()->className() << "#" << this->key() << ": ignoring call to setter for" <<
             propertyName << "as value not changing";
          return true;
@@ -28,6 +28,8 @@
 #include <QString>
 #include <QTextStream>
 
+#include "Logging.h"
+
 namespace {
    template <class T> T valueFromQVariant(QVariant const & qv);
    template <> QString valueFromQVariant(QVariant const & qv) {return qv.toString();}
@@ -83,7 +85,7 @@ QVariant NamedParameterBundle::operator()(BtStringConst const & parameterName) c
       }
       // In non-strict mode we'll just construct an empty QVariant and return that in the hope that its default value
       // (eg 0 for a numeric type, empty string for a QString) is OK.
-      qInfo() << Q_FUNC_INFO << errorMessage << ", so using generic default";
+      qCInfo(Logging::model) << Q_FUNC_INFO << errorMessage << ", so using generic default";
       return QVariant{};
    }
    QVariant returnValue = this->value(*parameterName);
@@ -33,6 +33,7 @@
 #include "database/ObjectStoreWrapper.h"
 #include "HeatCalculations.h"
 #include "Localization.h"
+#include "Logging.h"
 #include "measurement/ColorMethods.h"
 #include "measurement/IbuMethods.h"
 #include "measurement/Measurement.h"
@@ -51,6 +52,8 @@
 #include "PersistentSettings.h"
 #include "PhysicalConstants.h"
 #include "PreInstruction.h"
+#include "utils/Metrics.h"
+#include "utils/Tracing.h"
 
 namespace {
    /**
@@ -64,7 +67,7 @@ namespace {
          return false;
       }
 
-      qDebug() <<
+      qCDebug(Logging::model) <<
          Q_FUNC_INFO << var.metaObject()->className() << "#" << var.key() << "has parent #" << parentOfVar->key();
       //
       // Parameter has a parent.  See if it (the parameter, not its parent!) is used in a recipe.
@@ -84,7 +87,8 @@ namespace {
          // we had two completely unrelated shared_ptr objects (one in the object store and one newly created here)
          // pointing to the same address.  We need to get an instance of shared_ptr that's copied from (and thus
          // shares the internal reference count of) the one held by the object store.
-         qDebug() << Q_FUNC_INFO << var.metaObject()->className() << "#" << var.key() << "not used in any recipe";
+         qCDebug(Logging::model) << Q_FUNC_INFO << var.metaObject()->className() << "#" << var.key()
+            << "not used in any recipe";
          return true;
       }
 
@@ -126,7 +130,7 @@ namespace {
          return ObjectStoreWrapper::getById<NE>(var.key());
       }
 
-      qDebug() << Q_FUNC_INFO << "Making copy of " << var.metaObject()->className() << "#" << var.key();
+      qCDebug(Logging::model) << Q_FUNC_INFO << "Making copy of " << var.metaObject()->className() << "#" << var.key();
 
       // We need to make a copy...
       auto copy = std::make_shared<NE>(var);
@@ -210,7 +214,7 @@ public:
     *        to another - typically because we are copying the Recipe.
     */
    template<class NE> void copyList(Recipe & us, Recipe const & other) {
-      qDebug() << Q_FUNC_INFO;
+      qCDebug(Logging::model) << Q_FUNC_INFO;
       for (int otherIngId : other.pimpl->accessIds<NE>()) {
          // Make and store a copy of the current Hop/Fermentable/etc object we're looking at in the other Recipe
          auto otherIngredient = ObjectStoreWrapper::getById<NE>(otherIngId);
@@ -218,7 +222,7 @@ public:
          // Store the ID of the copy in our recipe
          this->accessIds<NE>().append(ourIngredient->key());
 
-         qDebug() <<
+         qCDebug(Logging::model) <<
             Q_FUNC_INFO << "After adding" << ourIngredient->metaObject()->className() << "#" << ourIngredient->key() <<
             ", Recipe" << us.name() << "has" << this->accessIds<NE>().size() << "of" <<
             NE::staticMetaObject.className();
@@ -237,7 +241,7 @@ public:
     *        of" Hops/Fermentables/etc records (which are distinguished by having a parent ID.
     */
    template<class NE> void hardDeleteAllMy() {
-      qDebug() << Q_FUNC_INFO;
+      qCDebug(Logging::model) << Q_FUNC_INFO;
       for (auto id : this->accessIds<NE>()) {
          ObjectStoreWrapper::hardDelete<NE>(id);
       }
@@ -524,7 +528,7 @@ void Recipe::setKey(int key) {
    //
    this->NamedEntity::setKey(key);
    if (this->m_ancestor_id <= 0) {
-      qDebug() << Q_FUNC_INFO << "Setting default ancestor ID on Recipe #" << key;
+      qCDebug(Logging::model) << Q_FUNC_INFO << "Setting default ancestor ID on Recipe #" << key;
 
       // We want to store the new ancestor ID in the DB, but we don't want to signal the UI about this change, so
       // suppress signal sending.
@@ -535,7 +539,7 @@ void Recipe::setKey(int key) {
 
 
 void Recipe::connectSignals() {
-   qDebug() << Q_FUNC_INFO << "Connecting signals for Recipes";
+   qCDebug(Logging::model) << Q_FUNC_INFO << "Connecting signals for Recipes";
    // Connect fermentable, hop changed signals to their parent recipe
    for (auto recipe : ObjectStoreTyped<Recipe>::getInstance().getAllRaw()) {
 //      qDebug() << Q_FUNC_INFO << "Connecting signals for Recipe #" << recipe->key();
@@ -1247,7 +1251,7 @@ template<class NE> std::shared_ptr<NE> Recipe::add(std::shared_ptr<NE> ne) {
    if (ne->key() <= 0) {
       // With shared pointer parameter, ObjectStoreWrapper::insert returns what we passed it (ie our shared pointer
       // remains valid after the call).
-      qDebug() << Q_FUNC_INFO << "Inserting" << ne->metaObject()->className() << "in object store";
+      qCDebug(Logging::model) << Q_FUNC_INFO << "Inserting" << ne->metaObject()->className() << "in object store";
       ObjectStoreWrapper::insert(ne);
    } else {
       //
@@ -1342,7 +1346,7 @@ template<class NE> std::shared_ptr<NE> Recipe::remove(std::shared_ptr<NE> var) {
    // other Recipes.
    //
    if (isUnusedInstanceOfUseOf(*var)) {
-      qDebug() <<
+      qCDebug(Logging::model) <<
          Q_FUNC_INFO << "Deleting" << var->metaObject()->className() << "#" << var->key() <<
          "as it is \"instance of use of\" that is no longer needed";
       ObjectStoreWrapper::hardDelete<NE>(var->key());
@@ -1396,7 +1400,7 @@ void Recipe::clearInstructions() {
 
 void Recipe::insertInstruction(Instruction const & ins, int pos) {
    if (this->pimpl->instructionIds.contains(ins.key())) {
-      qDebug() <<
+      qCDebug(Logging::model) <<
          Q_FUNC_INFO << "Request to insert instruction ID" << ins.key() << "at position" << pos << "for recipe #" <<
          this->key() << "ignored as this instruction is already in the list at position" <<
          this->instructionNumber(ins);
@@ -1406,7 +1410,7 @@ void Recipe::insertInstruction(Instruction const & ins, int pos) {
    // The position should be indexed from 1, so it's a coding error if it's less than this
    Q_ASSERT(pos >= 1);
 
-   qDebug() <<
+   qCDebug(Logging::model) <<
       Q_FUNC_INFO << "Inserting instruction #" << ins.key() << "(" << ins.name() << ") at position" << pos <<
       "in list of" << this->pimpl->instructionIds.size();
    this->pimpl->instructionIds.insert(pos - 1, ins.key());
@@ -1758,7 +1762,7 @@ void Recipe::setAncestor(Recipe & ancestor) {
    //    - Recipe A is modified
    // This means that, if Recipe A already has a direct ancestor, then Recipe B needs to take it
    //
-   qDebug() <<
+   qCDebug(Logging::model) <<
       Q_FUNC_INFO << "Setting Recipe #" << ancestor.key() << "to be immediate prior version (ancestor) of Recipe #" <<
       this->key();
 
@@ -2080,6 +2084,10 @@ void Recipe::recalcIfNeeded(QString classNameOfWhatWasAddedOrChanged) {
 }
 
 void Recipe::recalcAll() {
+   TRACE_SPAN("model", "Recipe::recalcAll");
+   static Metrics::Counter & numRecalcAllCalls = Metrics::counter("model.recalcAll.calls");
+   static Metrics::Counter & numRecalcAllSkipped = Metrics::counter("model.recalcAll.skipped");
+   numRecalcAllCalls.add();
    // WARNING
    // Infinite recursion possible, since these methods will emit changed(),
    // causing other objects to call finalVolume_l() for example, which may
@@ -2089,6 +2097,7 @@ void Recipe::recalcAll() {
 
    // Someone has already called this function back in the call stack, so return to avoid recursion.
    if (! m_recalcMutex.tryLock()) {
+      numRecalcAllSkipped.add();
       return;
    }
 
@@ -2110,6 +2119,7 @@ void Recipe::recalcAll() {
 }
 
 void Recipe::recalcABV_pct() {
+   TRACE_SPAN("model", "Recipe::recalcABV_pct");
    double ret;
 
    // The complex formula, and variations comes from Ritchie Products Ltd, (Zymurgy, Summer 1995, vol. 18, no. 2)
@@ -2125,6 +2135,7 @@ void Recipe::recalcABV_pct() {
 }
 
 void Recipe::recalcColor_srm() {
+   TRACE_SPAN("model", "Recipe::recalcColor_srm");
    Fermentable * ferm;
    double mcu = 0.0;
    double ret;
@@ -2149,6 +2160,7 @@ void Recipe::recalcColor_srm() {
 }
 
 void Recipe::recalcIBU() {
+   TRACE_SPAN("model", "Recipe::recalcIBU");
    int i;
    double ibus = 0.0;
    double tmp = 0.0;
@@ -2180,6 +2192,7 @@ void Recipe::recalcIBU() {
 }
 
 void Recipe::recalcVolumeEstimates() {
+   TRACE_SPAN("model", "Recipe::recalcVolumeEstimates");
    double waterAdded_l;
    double absorption_lKg;
    double tmp = 0.0;
@@ -2280,6 +2293,7 @@ void Recipe::recalcVolumeEstimates() {
 }
 
 void Recipe::recalcGrainsInMash_kg() {
+   TRACE_SPAN("model", "Recipe::recalcGrainsInMash_kg");
    int i, size;
    double ret = 0.0;
    Fermentable * ferm;
@@ -2303,6 +2317,7 @@ void Recipe::recalcGrainsInMash_kg() {
 }
 
 void Recipe::recalcGrains_kg() {
+   TRACE_SPAN("model", "Recipe::recalcGrains_kg");
    int i, size;
    double ret = 0.0;
 
@@ -2321,6 +2336,7 @@ void Recipe::recalcGrains_kg() {
 }
 
 void Recipe::recalcSRMColor() {
+   TRACE_SPAN("model", "Recipe::recalcSRMColor");
    QColor tmp = Algorithms::srmToColor(m_color_srm);
 
    if (tmp != m_SRMColor) {
@@ -2333,6 +2349,7 @@ void Recipe::recalcSRMColor() {
 
 // the formula in here are taken from http://hbd.org/ensmingr/
 void Recipe::recalcCalories() {
+   TRACE_SPAN("model", "Recipe::recalcCalories");
    double startPlato, finishPlato, RE, abw, oog, ffg, tmp;
 
    oog = m_og;
@@ -2418,6 +2435,7 @@ QHash<QString, double> Recipe::calcTotalPoints() {
 }
 
 void Recipe::recalcBoilGrav() {
+   TRACE_SPAN("model", "Recipe::recalcBoilGrav");
    double sugar_kg = 0.0;
    double sugar_kg_ignoreEfficiency = 0.0;
    double lateAddition_kg           = 0.0;
@@ -2447,6 +2465,7 @@ void Recipe::recalcBoilGrav() {
 }
 
 void Recipe::recalcOgFg() {
+   TRACE_SPAN("model", "Recipe::recalcOgFg");
    int i;
    double plato;
    double sugar_kg = 0;
@@ -2775,10 +2794,10 @@ void Recipe::acceptChangeToContainedObject(QMetaProperty prop, QVariant val) {
    QObject * signalSender = this->sender();
    if (signalSender != nullptr) {
       QString signalSenderClassName = signalSender->metaObject()->className();
-      qDebug() << Q_FUNC_INFO << "Signal received from " << signalSenderClassName;
+      qCDebug(Logging::model) << Q_FUNC_INFO << "Signal received from " << signalSenderClassName;
       this->recalcIfNeeded(signalSenderClassName);
    } else {
-      qDebug() << Q_FUNC_INFO << "No sender";
+      qCDebug(Logging::model) << Q_FUNC_INFO << "No sender";
    }
    return;
 }
@@ -2861,14 +2880,14 @@ void Recipe::hardDeleteOrphanedEntities() {
    //
    Mash * mash = this->mash();
    if (mash && mash->name() == "") {
-      qDebug() << Q_FUNC_INFO << "Checking whether our unnamed Mash is used elsewhere";
+      qCDebug(Logging::model) << Q_FUNC_INFO << "Checking whether our unnamed Mash is used elsewhere";
       auto recipesUsingThisMash = ObjectStoreWrapper::findAllMatching<Recipe>(
          [mash](Recipe const * rec) {
             return rec->uses(*mash);
          }
       );
       if (1 == recipesUsingThisMash.size()) {
-         qDebug() <<
+         qCDebug(Logging::model) <<
             Q_FUNC_INFO << "Deleting unnamed Mash # " << mash->key() << " used only by Recipe #" << this->key();
          Q_ASSERT(recipesUsingThisMash.at(0)->key() == this->key());
          ObjectStoreWrapper::hardDelete<Mash>(*mash);
@@ -2899,7 +2918,7 @@ void RecipeHelper::prepareForPropertyChange(NamedEntity & ne, BtStringConst cons
       return;
    }
 
-   qDebug() <<
+   qCDebug(Logging::model) <<
       Q_FUNC_INFO << "Modifying: " << ne.metaObject()->className() << "#" << ne.key() << "property" << propertyName;
 
    //
@@ -2923,7 +2942,8 @@ void RecipeHelper::prepareForPropertyChange(NamedEntity & ne, BtStringConst cons
 
    // If the object we're about to change already has descendants, then we don't want to create new ones.
    if (owner->hasDescendants()) {
-      qDebug() << Q_FUNC_INFO << "Recipe #" << owner->key() << "already has descendants, so not creating any more";
+      qCDebug(Logging::model) << Q_FUNC_INFO << "Recipe #" << owner->key()
+         << "already has descendants, so not creating any more";
       return;
    }
 
@@ -2941,14 +2961,14 @@ void RecipeHelper::prepareForPropertyChange(NamedEntity & ne, BtStringConst cons
 
    // Create a deep copy of the Recipe, and put it in the DB, so it has an ID.
    // (This will also emit signalObjectInserted for the new Recipe from ObjectStoreTyped<Recipe>.)
-   qDebug() << Q_FUNC_INFO << "Copying Recipe" << owner->key();
+   qCDebug(Logging::model) << Q_FUNC_INFO << "Copying Recipe" << owner->key();
 
    // We also don't want to trigger versioning on the newly spawned Recipe until we're completely done here!
    std::shared_ptr<Recipe> spawn = std::make_shared<Recipe>(*owner);
    NamedEntityModifyingMarker spawnModifyingMarker(*spawn);
    ObjectStoreWrapper::insert(spawn);
 
-   qDebug() << Q_FUNC_INFO << "Copied Recipe #" << owner->key() << "to new Recipe #" << spawn->key();
+   qCDebug(Logging::model) << Q_FUNC_INFO << "Copied Recipe #" << owner->key() << "to new Recipe #" << spawn->key();
 
    // We assert that the newly created version of the recipe has not yet been brewed (and therefore will not get
    // automatically versioned on subsequent changes before it is brewed).
@@ -2982,14 +3002,14 @@ bool RecipeHelper::getAutomaticVersioningEnabled() {
 RecipeHelper::SuspendRecipeVersioning::SuspendRecipeVersioning() {
    this->savedVersioningValue = RecipeHelper::getAutomaticVersioningEnabled();
    if (this->savedVersioningValue) {
-      qDebug() << Q_FUNC_INFO << "Temporarily suspending automatic Recipe versioning";
+      qCDebug(Logging::model) << Q_FUNC_INFO << "Temporarily suspending automatic Recipe versioning";
       RecipeHelper::setAutomaticVersioningEnabled(false);
    }
    return;
 }
 RecipeHelper::SuspendRecipeVersioning::~SuspendRecipeVersioning() {
    if (this->savedVersioningValue) {
-      qDebug() << Q_FUNC_INFO << "Re-enabling automatic Recipe versioning";
+      qCDebug(Logging::model) << Q_FUNC_INFO << "Re-enabling automatic Recipe versioning";
       RecipeHelper::setAutomaticVersioningEnabled(true);
    }
    return;
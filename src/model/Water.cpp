@@ -20,6 +20,7 @@
 #include "model/Water.h"
 
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "model/NamedParameterBundle.h"
 #include "model/Recipe.h"
 
@@ -120,7 +121,8 @@ void Water::swap(Water & other) noexcept {
 
 Water::~Water() = default;
 /*Water::~Water() {
-   qDebug() << Q_FUNC_INFO << "Deleting Water #" << this->key() << ":" << this->name() << "@" << static_cast<void *>(this);
+   qCDebug(Logging::model) << Q_FUNC_INFO << "Deleting Water #" << this->key() << ":" << this->name() << "@"
+      << static_cast<void *>(this);
    ObjectStoreWrapper::logDiagnostics<Water>();
    return;
 }*/
@@ -140,7 +142,7 @@ Water & Water::operator=(Water other) {
    if (this->key() > 0) {
       // We have to be careful not to create a new shared pointer for the object, but instead to get a copy of the one
       // held by the object store.
-      qDebug() <<
+      qCDebug(Logging::model) <<
          Q_FUNC_INFO << "After assignment, updating Water #" << this->key() << "(" << this->name() << ") @" <<
          static_cast<void *>(this) << "in DB";
       ObjectStoreWrapper::update(*this);
@@ -24,6 +24,7 @@
 #include <QHeaderView>
 #include <QMenu>
 
+#include "Logging.h"
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
 #include "measurement/UnitSystem.h"
@@ -47,12 +48,40 @@ BtTableModel::BtTableModel(QTableView * parent,
    QAbstractTableModel{parent},
    parentTableWidget{parent},
    editable{editable},
-   columnIdToInfo{columnIdToInfo} {
+   columnIdToInfo{columnIdToInfo},
+   displayCache{},
+   displayCacheGeneration{Measurement::getDisplaySettingsGeneration()},
+   bulkInsertIsReset{false},
+   memoryRegistration{[this](QMap<QString, MemoryAccounting::Usage> & usage) {
+      // By the time this gets called, metaObject() will give us the subclass (eg HopTableModel)
+      usage[QString{"tableModel/%1"}.arg(this->metaObject()->className())] += this->getMemoryUsage();
+      return;
+   }} {
+   connect(this, &QAbstractItemModel::rowsInserted,  this, &BtTableModel::displayCacheRowsInserted);
+   connect(this, &QAbstractItemModel::rowsRemoved,   this, &BtTableModel::displayCacheRowsRemoved);
+   connect(this, &QAbstractItemModel::rowsMoved,     this, &BtTableModel::displayCacheClear);
+   connect(this, &QAbstractItemModel::modelReset,    this, &BtTableModel::displayCacheClear);
+   connect(this, &QAbstractItemModel::layoutChanged, this, &BtTableModel::displayCacheClear);
    return;
 }
 
 BtTableModel::~BtTableModel() = default;
 
+MemoryAccounting::Usage BtTableModel::getMemoryUsage() const {
+   MemoryAccounting::Usage usage;
+   // Each row is a shared pointer to an object belonging to an ObjectStore (where the object itself is counted)
+   usage.numObjects = this->rowCount();
+   usage.approxBytes =
+      usage.numObjects * (MemoryAccounting::containerNodeOverhead + sizeof(std::shared_ptr<QObject>));
+   for (auto const & cachedRow : this->displayCache) {
+      usage.approxBytes += MemoryAccounting::containerNodeOverhead + cachedRow.capacity() * sizeof(QString);
+      for (auto const & cachedCell : cachedRow) {
+         usage.approxBytes += MemoryAccounting::approxHeapSizeOf(cachedCell);
+      }
+   }
+   return usage;
+}
+
 std::optional<Measurement::SystemOfMeasurement> BtTableModel::getForcedSystemOfMeasurementForColumn(int column) const {
    QString attribute = this->columnGetAttribute(column);
    return attribute.isEmpty() ? std::nullopt : Measurement::getForcedSystemOfMeasurementForField(attribute,
@@ -69,6 +98,7 @@ void BtTableModel::setForcedSystemOfMeasurementForColumn(int column,
                                                          std::optional<Measurement::SystemOfMeasurement> systemOfMeasurement) {
    QString attribute = this->columnGetAttribute(column);
    if (!attribute.isEmpty()) {
+      // NB: This will also invalidate displayCache -- see cachedDisplayString()
       Measurement::setForcedSystemOfMeasurementForField(attribute, this->objectName(), systemOfMeasurement);
       // As we're setting/changing the forced SystemOfMeasurement, we want to clear the forced RelativeScale
       Measurement::setForcedRelativeScaleForField(attribute, this->objectName(), std::nullopt);
@@ -85,6 +115,103 @@ void BtTableModel::setForcedRelativeScaleForColumn(int column,
    return;
 }
 
+QVariant BtTableModel::cachedDisplayString(int row, int column, std::function<QString()> const & formatter) const {
+   //
+   // If any display setting has changed since we last looked, then everything we have cached is potentially wrong.
+   // (Note that this also covers the case where the forced units/scale for a column were changed by another table
+   // model with the same objectName.)
+   //
+   unsigned int const currentGeneration = Measurement::getDisplaySettingsGeneration();
+   if (this->displayCacheGeneration != currentGeneration) {
+      this->displayCache.clear();
+      this->displayCacheGeneration = currentGeneration;
+   }
+
+   if (row < 0 || column < 0 || column >= this->columnCount()) {
+      // This is almost certainly a coding error, but we can still give the caller what they asked for
+      qWarning() << Q_FUNC_INFO << "Bad cell (" << row << "," << column << ")";
+      return QVariant(formatter());
+   }
+
+   if (row >= this->displayCache.size()) {
+      this->displayCache.resize(row + 1);
+   }
+   QVector<QString> & cachedRow = this->displayCache[row];
+   if (cachedRow.isEmpty()) {
+      cachedRow.resize(this->columnCount());
+   }
+   QString & cachedCell = cachedRow[column];
+   if (cachedCell.isNull()) {
+      cachedCell = formatter();
+   }
+   return QVariant(cachedCell);
+}
+
+void BtTableModel::invalidateCachedDisplayCell(int row, int column) {
+   if (row >= 0 && row < this->displayCache.size()) {
+      QVector<QString> & cachedRow = this->displayCache[row];
+      if (column >= 0 && column < cachedRow.size()) {
+         cachedRow[column] = QString{};
+      }
+   }
+   return;
+}
+
+void BtTableModel::invalidateCachedDisplayForProperty(int row, char const * propertyName) {
+   if (row < 0 || row >= this->displayCache.size()) {
+      return;
+   }
+   for (auto ii = this->columnIdToInfo.cbegin(); ii != this->columnIdToInfo.cend(); ++ii) {
+      if (ii.value().attribute == propertyName) {
+         this->invalidateCachedDisplayCell(row, ii.key());
+         return;
+      }
+   }
+   this->displayCache[row].clear();
+   return;
+}
+
+void BtTableModel::beginBulkInsertRows(int numRows) {
+   Q_ASSERT(numRows > 0);
+   int const size = this->rowCount();
+   this->bulkInsertIsReset = (size == 0);
+   if (this->bulkInsertIsReset) {
+      this->beginResetModel();
+   } else {
+      this->beginInsertRows(QModelIndex(), size, size + numRows - 1);
+   }
+   return;
+}
+
+void BtTableModel::endBulkInsertRows() {
+   if (this->bulkInsertIsReset) {
+      this->endResetModel();
+   } else {
+      this->endInsertRows();
+   }
+   return;
+}
+
+void BtTableModel::displayCacheRowsInserted(QModelIndex const & /*parent*/, int first, int last) {
+   // If the new rows are beyond the end of the cache, there's nothing to shift down
+   if (first < this->displayCache.size()) {
+      this->displayCache.insert(first, last - first + 1, QVector<QString>{});
+   }
+   return;
+}
+
+void BtTableModel::displayCacheRowsRemoved(QModelIndex const & /*parent*/, int first, int last) {
+   if (first < this->displayCache.size()) {
+      this->displayCache.remove(first, qMin(last + 1, this->displayCache.size()) - first);
+   }
+   return;
+}
+
+void BtTableModel::displayCacheClear() {
+   this->displayCache.clear();
+   return;
+}
+
 QVariant BtTableModel::getColumName(int column) const {
    if (this->columnIdToInfo.contains(column)) {
       return QVariant(this->columnIdToInfo.value(column).headerName);
@@ -125,7 +252,7 @@ void BtTableModel::doContextMenu(QPoint const & point, QHeaderView * hView, QMen
       // It's the menu, so SystemOfMeasurement
       std::optional<Measurement::SystemOfMeasurement> whatSelected =
          UnitAndScalePopUpMenu::dataFromQAction<Measurement::SystemOfMeasurement>(*invoked);
-      qDebug() << Q_FUNC_INFO << "Column" << selected << ", selected SystemOfMeasurement" << whatSelected;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Column" << selected << ", selected SystemOfMeasurement" << whatSelected;
       this->setForcedSystemOfMeasurementForColumn(selected, whatSelected);
       // Choosing a forced SystemOfMeasurement resets any selection of forced RelativeScale, but this is handled by
       // unsetForcedSystemOfMeasurementForColumn() and setForcedSystemOfMeasurementForColumn()
@@ -133,7 +260,7 @@ void BtTableModel::doContextMenu(QPoint const & point, QHeaderView * hView, QMen
       // It's the sub-menu, so UnitSystem::RelativeScale
       std::optional<Measurement::UnitSystem::RelativeScale> whatSelected =
          UnitAndScalePopUpMenu::dataFromQAction<Measurement::UnitSystem::RelativeScale>(*invoked);
-      qDebug() << Q_FUNC_INFO << "Column" << selected << ", selected RelativeScale" << whatSelected;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Column" << selected << ", selected RelativeScale" << whatSelected;
       this->setForcedRelativeScaleForColumn(selected, whatSelected);
    }
    return;
@@ -141,7 +268,7 @@ void BtTableModel::doContextMenu(QPoint const & point, QHeaderView * hView, QMen
 
 // oofrab
 void BtTableModel::contextMenu(QPoint const & point) {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::ui) << Q_FUNC_INFO;
    QHeaderView* hView = qobject_cast<QHeaderView*>(this->sender());
    int selected = hView->logicalIndexAt(point);
    // Only makes sense to offer the pop-up "select scale" menu for physical quantities
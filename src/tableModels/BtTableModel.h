@@ -20,6 +20,7 @@
 #define TABLEMODELS_BTTABLEMODEL_H
 #pragma once
 
+#include <functional>
 #include <optional>
 
 #include <QAbstractTableModel>
@@ -28,10 +29,13 @@
 #include <QMap>
 #include <QMenu>
 #include <QPoint>
+#include <QSet>
 #include <QTableView>
+#include <QVector>
 
 #include "BtFieldType.h"
 #include "measurement/UnitSystem.h"
+#include "utils/MemoryAccounting.h"
 
 class Recipe;
 class NamedEntity;
@@ -102,22 +106,46 @@ public:
    }
 
    /**
-    * \brief Remove duplicates and non-displayable items from the supplied list
+    * \brief Remove duplicates and non-displayable items from the supplied list.  Items are duplicates if they are
+    *        already in the model or if they appear earlier in \c items.
+    *
+    *        We de-dupe via a hash set of the underlying objects rather than \c QList::contains() because, when
+    *        showing all the ingredients in a big database, the latter makes populating the model O(n²).
     */
    QList< std::shared_ptr<NE> > removeDuplicates(QList< std::shared_ptr<NE> > items, Recipe const * recipe = nullptr) {
       decltype(items) tmp;
+      tmp.reserve(items.size());
+
+      QSet<NE const *> seen;
+      seen.reserve(this->rows.size() + items.size());
+      for (auto const & row : this->rows) {
+         seen.insert(row.get());
+      }
 
       for (auto ii : items) {
          if (!recipe && (ii->deleted() || !ii->display())) {
                continue;
          }
-         if (!this->rows.contains(ii) ) {
+         if (!seen.contains(ii.get())) {
+            seen.insert(ii.get());
             tmp.append(ii);
          }
       }
       return tmp;
    }
 
+   /**
+    * \brief Disconnect all signals from the objects in the model to \c receiver and remove all rows.  Callers are
+    *        responsible for wrapping this in \c beginResetModel() / \c endResetModel() (or similar).
+    */
+   void disconnectAndClearRows(QObject const * receiver) {
+      for (auto const & row : this->rows) {
+         QObject::disconnect(row.get(), nullptr, receiver, nullptr);
+      }
+      this->rows.clear();
+      return;
+   }
+
 protected:
    virtual std::shared_ptr<NamedEntity> getRowAsNamedEntity(int ii) {
       return std::static_pointer_cast<NamedEntity>(this->getRow(ii));
@@ -164,6 +192,53 @@ public:
    //! \brief Reimplemented from QAbstractTableModel
    virtual int columnCount(QModelIndex const & parent = QModelIndex()) const;
 
+protected:
+   /**
+    * \brief Display strings for measured amounts are relatively expensive to generate: we have to look up the forced
+    *        unit system and scale for the column (which are stored in settings), convert the amount and then format
+    *        it.  And \c data() gets called for every visible cell every time the table is repainted.  So subclasses
+    *        should obtain such strings via this function, which calls \c formatter only if there isn't already a
+    *        string cached for the cell.
+    *
+    *        The cache is kept aligned with the rows of the model (via our own \c rowsInserted etc signals) and is
+    *        thrown away whenever any display setting changes (see \c Measurement::getDisplaySettingsGeneration).
+    *        Subclasses are responsible for calling \c invalidateCachedDisplayForProperty() when a row's underlying
+    *        object changes.
+    *
+    * \param row
+    * \param column
+    * \param formatter Generates the display string for the cell
+    */
+   QVariant cachedDisplayString(int row, int column, std::function<QString()> const & formatter) const;
+
+   /**
+    * \brief Invalidate the cached display string for one cell
+    */
+   void invalidateCachedDisplayCell(int row, int column);
+
+   /**
+    * \brief Invalidate cached display strings after a property of the object in \c row has changed.  If there is a
+    *        column for the property (ie whose \c ColumnInfo::attribute is the property name) only that cell is
+    *        invalidated.  Otherwise (eg for something like \c amountIsWeight that changes how other columns are
+    *        displayed), the whole row is.
+    */
+   void invalidateCachedDisplayForProperty(int row, char const * propertyName);
+
+   /**
+    * \brief Subclasses should call this before adding \c numRows rows to the end of the model in one go, and
+    *        \c endBulkInsertRows() afterwards.  If the model is currently empty (eg because we just started observing
+    *        a recipe or the database), we tell the view(s) about it with one model reset, otherwise with one ranged
+    *        insert.  Either way, the views only have to do their work once, rather than once per row.
+    *
+    *        It is a coding error to call this with \c numRows less than 1.
+    */
+   void beginBulkInsertRows(int numRows);
+
+   /**
+    * \brief See \c beginBulkInsertRows()
+    */
+   void endBulkInsertRows();
+
 private:
    QString     columnGetAttribute(int column) const;
    BtFieldType columnGetFieldType(int column) const;
@@ -173,12 +248,32 @@ public slots:
    //! \brief pops the context menu for changing units and scales
    void contextMenu(QPoint const & point);
 
+private slots:
+   //! \brief Keep \c displayCache aligned with the rows of the model
+   void displayCacheRowsInserted(QModelIndex const & parent, int first, int last);
+   //! \brief Keep \c displayCache aligned with the rows of the model
+   void displayCacheRowsRemoved(QModelIndex const & parent, int first, int last);
+   //! \brief Throw away \c displayCache when rows have been reset or reordered
+   void displayCacheClear();
+
 protected:
    QTableView* parentTableWidget;
    bool editable;
 private:
    QMap<int, ColumnInfo> columnIdToInfo;
 
+   //! \brief Cached display strings, indexed by row then column.  A null QString means nothing cached for that cell.
+   mutable QVector<QVector<QString> > displayCache;
+   //! \brief Value of \c Measurement::getDisplaySettingsGeneration() when \c displayCache was last cleared
+   mutable unsigned int displayCacheGeneration;
+
+   //! \brief Whether the current \c beginBulkInsertRows() call did \c beginResetModel() or \c beginInsertRows()
+   bool bulkInsertIsReset;
+
+   //! \brief Approximate number of rows and memory used by them.  See \c MemoryAccounting.
+   MemoryAccounting::Usage getMemoryUsage() const;
+   MemoryAccounting::Registration memoryRegistration;
+
 };
 
 class BtTableModelRecipeObserver : public BtTableModel {
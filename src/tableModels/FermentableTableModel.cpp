@@ -41,6 +41,7 @@
 #include <QWidget>
 
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "MainWindow.h"
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
@@ -86,14 +87,16 @@ FermentableTableModel::~FermentableTableModel() = default;
 
 void FermentableTableModel::observeRecipe(Recipe* rec) {
    if (this->recObs) {
-      qDebug() << Q_FUNC_INFO << "Unobserve Recipe #" << this->recObs->key() << "(" << this->recObs->name() << ")";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Unobserve Recipe #" << this->recObs->key() << "(" << this->recObs->name()
+         << ")";
       disconnect(this->recObs, nullptr, this, nullptr);
       this->removeAll();
    }
 
    this->recObs = rec;
    if (this->recObs) {
-      qDebug() << Q_FUNC_INFO << "Observe Recipe #" << this->recObs->key() << "(" << this->recObs->name() << ")";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Observe Recipe #" << this->recObs->key() << "(" << this->recObs->name()
+         << ")";
 
       connect(this->recObs, &NamedEntity::changed, this, &FermentableTableModel::changed);
       this->addFermentables(this->recObs->getAll<Fermentable>());
@@ -118,7 +121,7 @@ void FermentableTableModel::observeDatabase(bool val) {
 
 void FermentableTableModel::addFermentable(int fermId) {
    auto ferm = ObjectStoreWrapper::getById<Fermentable>(fermId);
-   qDebug() << Q_FUNC_INFO << ferm->name();
+   qCDebug(Logging::ui) << Q_FUNC_INFO << ferm->name();
 
    // Check to see if it's already in the list
    if (this->rows.contains(ferm)) {
@@ -134,7 +137,7 @@ void FermentableTableModel::addFermentable(int fermId) {
    if (this->recObs) {
       Recipe * recipeOfNewFermentable = ferm->getOwningRecipe();
       if (recipeOfNewFermentable && this->recObs->key() != recipeOfNewFermentable->key()) {
-         qDebug() <<
+         qCDebug(Logging::ui) <<
             Q_FUNC_INFO << "Ignoring signal about new Ferementable #" << ferm->key() << "as it belongs to Recipe #" <<
             recipeOfNewFermentable->key() << "and we are watching Recipe #" << this->recObs->key();
          return;
@@ -152,15 +155,15 @@ void FermentableTableModel::addFermentable(int fermId) {
 }
 
 void FermentableTableModel::addFermentables(QList<std::shared_ptr<Fermentable> > ferms) {
-   qDebug() << Q_FUNC_INFO << "Add up to " << ferms.size() << " fermentables to existing list of " << this->rows.size();
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Add up to " << ferms.size() << " fermentables to existing list of "
+      << this->rows.size();
 
    auto tmp = this->removeDuplicates(ferms, this->recObs);
 
-   qDebug() << Q_FUNC_INFO << QString("After de-duping, adding %1 fermentables").arg(tmp.size());
+   qCDebug(Logging::ui) << Q_FUNC_INFO << QString("After de-duping, adding %1 fermentables").arg(tmp.size());
 
-   int size = this->rows.size();
-   if (size+tmp.size()) {
-      beginInsertRows( QModelIndex(), size, size+tmp.size()-1 );
+   if (!tmp.isEmpty()) {
+      this->beginBulkInsertRows(tmp.size());
       this->rows.append(tmp);
 
       for (auto ferm : tmp) {
@@ -168,8 +171,9 @@ void FermentableTableModel::addFermentables(QList<std::shared_ptr<Fermentable> >
          totalFermMass_kg += ferm->amount_kg();
       }
 
-      endInsertRows();
+      this->endBulkInsertRows();
    }
+   return;
 }
 
 void FermentableTableModel::removeFermentable(int fermId, std::shared_ptr<QObject> object) {
@@ -195,14 +199,10 @@ bool FermentableTableModel::remove(std::shared_ptr<Fermentable> ferm) {
 }
 
 void FermentableTableModel::removeAll() {
-
-   int size = this->rows.size();
-   if (size > 0) {
-      beginRemoveRows(QModelIndex(), 0, size - 1);
-      while (!this->rows.empty()) {
-         disconnect(this->rows.takeLast().get(), nullptr, this, nullptr );
-      }
-      endRemoveRows();
+   if (!this->rows.isEmpty()) {
+      this->beginResetModel();
+      this->disconnectAndClearRows(this);
+      this->endResetModel();
    }
    // I think we need to zero this out
    this->totalFermMass_kg = 0;
@@ -227,6 +227,7 @@ void FermentableTableModel::changedInventory(int invKey, BtStringConst const & p
    if (propertyName == PropertyNames::Inventory::amount) {
       for (int ii = 0; ii < this->rows.size(); ++ii) {
          if (invKey == this->rows.at(ii)->inventoryId()) {
+            this->invalidateCachedDisplayCell(ii, FERMINVENTORYCOL);
             emit dataChanged(QAbstractItemModel::createIndex(ii, FERMINVENTORYCOL),
                              QAbstractItemModel::createIndex(ii, FERMINVENTORYCOL));
          }
@@ -236,7 +237,7 @@ void FermentableTableModel::changedInventory(int invKey, BtStringConst const & p
 }
 
 void FermentableTableModel::changed(QMetaProperty prop, QVariant /*val*/) {
-   qDebug() << Q_FUNC_INFO << prop.name();
+   qCDebug(Logging::ui) << Q_FUNC_INFO << prop.name();
 
    // Is sender one of our fermentables?
    Fermentable* fermSender = qobject_cast<Fermentable*>(sender());
@@ -248,6 +249,7 @@ void FermentableTableModel::changed(QMetaProperty prop, QVariant /*val*/) {
       }
 
       this->updateTotalGrains();
+      this->invalidateCachedDisplayForProperty(ii, prop.name());
       emit dataChanged(QAbstractItemModel::createIndex(ii, 0), QAbstractItemModel::createIndex(ii, FERMNUMCOLS - 1));
       if (displayPercentages && rowCount() > 0) {
          emit headerDataChanged(Qt::Vertical, 0, rowCount() - 1);
@@ -300,24 +302,22 @@ QVariant FermentableTableModel::data(QModelIndex const & index, int role) const
          break;
       case FERMINVENTORYCOL:
          if (role == Qt::DisplayRole) {
-            // So just query the columns
-            return QVariant(
-               Measurement::displayAmount(Measurement::Amount{row->inventory(), Measurement::Units::kilograms},
-                                          3,
-                                          this->getForcedSystemOfMeasurementForColumn(column),
-                                          this->getForcedRelativeScaleForColumn(column))
-            );
+            return this->cachedDisplayString(index.row(), column, [&]() {
+               return Measurement::displayAmount(Measurement::Amount{row->inventory(), Measurement::Units::kilograms},
+                                                 3,
+                                                 this->getForcedSystemOfMeasurementForColumn(column),
+                                                 this->getForcedRelativeScaleForColumn(column));
+            });
          }
          break;
       case FERMAMOUNTCOL:
          if (role == Qt::DisplayRole) {
-            // So just query the columns
-            return QVariant(
-               Measurement::displayAmount(Measurement::Amount{row->amount_kg(), Measurement::Units::kilograms},
-                                          3,
-                                          this->getForcedSystemOfMeasurementForColumn(column),
-                                          this->getForcedRelativeScaleForColumn(column))
-            );
+            return this->cachedDisplayString(index.row(), column, [&]() {
+               return Measurement::displayAmount(Measurement::Amount{row->amount_kg(), Measurement::Units::kilograms},
+                                                 3,
+                                                 this->getForcedSystemOfMeasurementForColumn(column),
+                                                 this->getForcedRelativeScaleForColumn(column));
+            });
          }
          break;
       case FERMISMASHEDCOL:
@@ -343,12 +343,12 @@ QVariant FermentableTableModel::data(QModelIndex const & index, int role) const
          break;
       case FERMCOLORCOL:
          if (role == Qt::DisplayRole) {
-            return QVariant(
-               Measurement::displayAmount(Measurement::Amount{row->color_srm(), Measurement::Units::srm},
-                                          0,
-                                          this->getForcedSystemOfMeasurementForColumn(column),
-                                          std::nullopt)
-            );
+            return this->cachedDisplayString(index.row(), column, [&]() {
+               return Measurement::displayAmount(Measurement::Amount{row->color_srm(), Measurement::Units::srm},
+                                                 0,
+                                                 this->getForcedSystemOfMeasurementForColumn(column),
+                                                 std::nullopt);
+            });
          }
          break;
       default :
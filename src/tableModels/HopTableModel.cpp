@@ -38,6 +38,7 @@
 
 #include "database/ObjectStoreWrapper.h"
 #include "Localization.h"
+#include "Logging.h"
 #include "MainWindow.h"
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
@@ -133,7 +134,7 @@ void HopTableModel::addHop(int hopId) {
    if (this->recObs) {
       Recipe * recipeOfNewHop = hopAdded->getOwningRecipe();
       if (recipeOfNewHop && this->recObs->key() != recipeOfNewHop->key()) {
-         qDebug() <<
+         qCDebug(Logging::ui) <<
             Q_FUNC_INFO << "Ignoring signal about new Hop #" << hopAdded->key() << "as it belongs to Recipe #" <<
             recipeOfNewHop->key() << "and we are watching Recipe #" << this->recObs->key();
          return;
@@ -149,27 +150,17 @@ void HopTableModel::addHop(int hopId) {
 }
 
 void HopTableModel::addHops(QList< std::shared_ptr<Hop> > hops) {
-   decltype(hops) tmp;
+   auto tmp = this->removeDuplicates(hops, this->recObs);
 
-   for (auto hop : hops) {
-      if (recObs == nullptr && (hop->deleted() || !hop->display())) {
-         continue;
-      }
-      if (!this->rows.contains(hop)) {
-         tmp.append(hop);
-      }
-   }
-
-   int size = this->rows.size();
-   if (size + tmp.size()) {
-      beginInsertRows(QModelIndex(), size, size + tmp.size() - 1);
+   if (!tmp.isEmpty()) {
+      this->beginBulkInsertRows(tmp.size());
       this->rows.append(tmp);
 
       for (auto hop : tmp) {
          connect(hop.get(), &NamedEntity::changed, this, &HopTableModel::changed);
       }
 
-      endInsertRows();
+      this->endBulkInsertRows();
    }
    return;
 }
@@ -199,19 +190,19 @@ void HopTableModel::setShowIBUs(bool var) {
 }
 
 void HopTableModel::removeAll() {
-   if (this->rows.size()) {
-      beginRemoveRows(QModelIndex(), 0, this->rows.size() - 1);
-      while (!this->rows.isEmpty()) {
-         disconnect(this->rows.takeLast().get(), nullptr, this, nullptr);
-      }
-      endRemoveRows();
+   if (!this->rows.isEmpty()) {
+      this->beginResetModel();
+      this->disconnectAndClearRows(this);
+      this->endResetModel();
    }
+   return;
 }
 
 void HopTableModel::changedInventory(int invKey, BtStringConst const & propertyName) {
    if (propertyName == PropertyNames::Inventory::amount) {
       for (int ii = 0; ii < this->rows.size(); ++ii) {
          if (invKey == this->rows.at(ii)->inventoryId()) {
+            this->invalidateCachedDisplayCell(ii, HOPINVENTORYCOL);
             emit dataChanged(QAbstractItemModel::createIndex(ii, HOPINVENTORYCOL),
                              QAbstractItemModel::createIndex(ii, HOPINVENTORYCOL));
          }
@@ -231,6 +222,7 @@ void HopTableModel::changed(QMetaProperty prop, QVariant /*val*/) {
          return;
       }
 
+      this->invalidateCachedDisplayForProperty(ii, prop.name());
       emit dataChanged(QAbstractItemModel::createIndex(ii, 0),
                        QAbstractItemModel::createIndex(ii, HOPNUMCOLS - 1));
       emit headerDataChanged(Qt::Vertical, ii, ii);
@@ -280,18 +272,22 @@ QVariant HopTableModel::data(const QModelIndex & index, int role) const {
          break;
       case HOPINVENTORYCOL:
          if (role == Qt::DisplayRole) {
-            return QVariant(Measurement::displayAmount(Measurement::Amount{row->inventory(), Measurement::Units::kilograms},
-                                                       3,
-                                                       this->getForcedSystemOfMeasurementForColumn(column),
-                                                       this->getForcedRelativeScaleForColumn(column)));
+            return this->cachedDisplayString(index.row(), column, [&]() {
+               return Measurement::displayAmount(Measurement::Amount{row->inventory(), Measurement::Units::kilograms},
+                                                 3,
+                                                 this->getForcedSystemOfMeasurementForColumn(column),
+                                                 this->getForcedRelativeScaleForColumn(column));
+            });
          }
          break;
       case HOPAMOUNTCOL:
          if (role == Qt::DisplayRole) {
-            return QVariant(Measurement::displayAmount(Measurement::Amount{row->amount_kg(), Measurement::Units::kilograms},
-                                                       3,
-                                                       this->getForcedSystemOfMeasurementForColumn(column),
-                                                       this->getForcedRelativeScaleForColumn(column)));
+            return this->cachedDisplayString(index.row(), column, [&]() {
+               return Measurement::displayAmount(Measurement::Amount{row->amount_kg(), Measurement::Units::kilograms},
+                                                 3,
+                                                 this->getForcedSystemOfMeasurementForColumn(column),
+                                                 this->getForcedRelativeScaleForColumn(column));
+            });
          }
          break;
       case HOPUSECOL:
@@ -304,10 +300,12 @@ QVariant HopTableModel::data(const QModelIndex & index, int role) const {
          break;
       case HOPTIMECOL:
          if (role == Qt::DisplayRole) {
-            return QVariant(Measurement::displayAmount(Measurement::Amount{row->time_min(), Measurement::Units::minutes},
-                                                       3,
-                                                       std::nullopt,
-                                                       this->getForcedRelativeScaleForColumn(column)));
+            return this->cachedDisplayString(index.row(), column, [&]() {
+               return Measurement::displayAmount(Measurement::Amount{row->time_min(), Measurement::Units::minutes},
+                                                 3,
+                                                 std::nullopt,
+                                                 this->getForcedRelativeScaleForColumn(column));
+            });
          }
          break;
       case HOPFORMCOL:
@@ -34,6 +34,7 @@
 #include <QWidget>
 
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "MainWindow.h"
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
@@ -78,7 +79,7 @@ bool MashStepTableModel::remove(std::shared_ptr<MashStep> mashStep) {
 
    int ii {this->rows.indexOf(mashStep)};
    if (ii >= 0) {
-      qDebug() << Q_FUNC_INFO << "Removing MashStep" << mashStep->name() << "(#" << mashStep->key() << ")";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Removing MashStep" << mashStep->name() << "(#" << mashStep->key() << ")";
       beginRemoveRows( QModelIndex(), ii, ii );
       disconnect(mashStep.get(), nullptr, this, nullptr);
       this->rows.removeAt(ii);
@@ -93,7 +94,7 @@ bool MashStepTableModel::remove(std::shared_ptr<MashStep> mashStep) {
 
 void MashStepTableModel::setMash(Mash * m) {
    if (this->mashObs && this->rows.size() > 0) {
-      qDebug() <<
+      qCDebug(Logging::ui) <<
          Q_FUNC_INFO << "Removing" << this->rows.size() << "MashStep rows for old Mash #" << this->mashObs->key();
       this->beginRemoveRows(QModelIndex(), 0, this->rows.size() - 1);
 
@@ -117,11 +118,11 @@ void MashStepTableModel::setMash(Mash * m) {
 
    this->mashObs = m;
    if (this->mashObs) {
-      qDebug() << Q_FUNC_INFO << "Now watching Mash #" << this->mashObs->key();
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Now watching Mash #" << this->mashObs->key();
 
       auto tmpSteps = this->mashObs->mashSteps();
       if (tmpSteps.size() > 0) {
-         qDebug() << Q_FUNC_INFO << "Inserting" << tmpSteps.size() << "MashStep rows";
+         qCDebug(Logging::ui) << Q_FUNC_INFO << "Inserting" << tmpSteps.size() << "MashStep rows";
          this->beginInsertRows(QModelIndex(), 0, tmpSteps.size() - 1);
          this->rows = tmpSteps;
          for (auto step : this->rows) {
@@ -148,7 +149,8 @@ void MashStepTableModel::reorderMashStep(std::shared_ptr<MashStep> step, int cur
    int destChild   = step->stepNumber();
    int doSomething = destChild - current - 1;
 
-   qDebug() << Q_FUNC_INFO << "Swapping" << destChild << "with" << current << ", so doSomething=" << doSomething;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Swapping" << destChild << "with" << current << ", so doSomething="
+      << doSomething;
 
    // Moving a step up or down generates two signals, one for each row
    // impacted. If we move row B above row A:
@@ -172,7 +174,7 @@ void MashStepTableModel::reorderMashStep(std::shared_ptr<MashStep> step, int cur
    }
 
    // We assert that we are swapping valid locations on the list as, to do otherwise implies a coding error
-   qDebug() <<
+   qCDebug(Logging::ui) <<
       Q_FUNC_INFO << "Swap" << current + doSomething << "with" << current << ", in list of " << this->rows.size();
    Q_ASSERT(current >= 0);
    Q_ASSERT(current + doSomething >= 0);
@@ -195,13 +197,13 @@ void MashStepTableModel::reorderMashStep(std::shared_ptr<MashStep> step, int cur
 
 void MashStepTableModel::mashChanged() {
    // A mash step was added, removed or change order.  Remove and re-add all steps.
-   qDebug() << Q_FUNC_INFO << "Re-reading mash steps for" << this->mashObs;
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Re-reading mash steps for" << this->mashObs;
    this->setMash(this->mashObs);
    return;
 }
 
 void MashStepTableModel::mashStepChanged(QMetaProperty prop, QVariant val) {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::ui) << Q_FUNC_INFO;
 
    MashStep* stepSenderRaw = qobject_cast<MashStep*>(sender());
    if (stepSenderRaw) {
@@ -27,6 +27,7 @@
 #include <QLineEdit>
 
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "MainWindow.h"
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
@@ -71,14 +72,14 @@ MiscTableModel::~MiscTableModel() = default;
 
 void MiscTableModel::observeRecipe(Recipe* rec) {
    if (this->recObs) {
-      qDebug() << Q_FUNC_INFO << "Unwatching Recipe" << this->recObs;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Unwatching Recipe" << this->recObs;
       disconnect(this->recObs, nullptr, this, nullptr);
       removeAll();
    }
 
    this->recObs = rec;
    if (this->recObs) {
-      qDebug() << Q_FUNC_INFO << "Watching Recipe" << this->recObs;
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Watching Recipe" << this->recObs;
       connect(this->recObs, &NamedEntity::changed, this, &MiscTableModel::changed);
       this->addMiscs(this->recObs->getAll<Misc>());
    }
@@ -115,7 +116,7 @@ void MiscTableModel::addMisc(int miscId) {
    if (this->recObs) {
       auto recipeOfNewMisc = misc->getOwningRecipe();
       if (recipeOfNewMisc && this->recObs->key() != recipeOfNewMisc->key()) {
-         qDebug() <<
+         qCDebug(Logging::ui) <<
             Q_FUNC_INFO << "Ignoring signal about new Misc #" << misc->key() << "as it belongs to Recipe #" <<
             recipeOfNewMisc->key() << "and we are watching Recipe #" << this->recObs->key();
          return;
@@ -134,17 +135,17 @@ void MiscTableModel::addMisc(int miscId) {
 void MiscTableModel::addMiscs(QList<std::shared_ptr<Misc> > miscs) {
    auto tmp = this->removeDuplicates(miscs, this->recObs);
 
-   int size = this->rows.size();
-   if (size+tmp.size()) {
-      beginInsertRows( QModelIndex(), size, size+tmp.size()-1 );
+   if (!tmp.isEmpty()) {
+      this->beginBulkInsertRows(tmp.size());
       this->rows.append(tmp);
 
       for (auto ii : tmp) {
          connect(ii.get(), &NamedEntity::changed, this, &MiscTableModel::changed);
       }
 
-      endInsertRows();
+      this->endBulkInsertRows();
    }
+   return;
 }
 
 // Returns true when misc is successfully found and removed.
@@ -168,17 +169,13 @@ bool MiscTableModel::remove(std::shared_ptr<Misc> misc) {
    return false;
 }
 
-void MiscTableModel::removeAll()
-{
-   if (this->rows.size())
-   {
-      beginRemoveRows( QModelIndex(), 0, this->rows.size()-1 );
-      while( !this->rows.isEmpty() )
-      {
-         disconnect( this->rows.takeLast().get(), nullptr, this, nullptr );
-      }
-      endRemoveRows();
+void MiscTableModel::removeAll() {
+   if (!this->rows.isEmpty()) {
+      this->beginResetModel();
+      this->disconnectAndClearRows(this);
+      this->endResetModel();
    }
+   return;
 }
 
 int MiscTableModel::rowCount(const QModelIndex& /*parent*/) const {
@@ -221,38 +218,40 @@ QVariant MiscTableModel::data(QModelIndex const & index, int role) const {
          return QVariant();
       case MISCTIMECOL:
          if (role == Qt::DisplayRole) {
-            return QVariant(Measurement::displayAmount(Measurement::Amount{row->time(), Measurement::Units::minutes},
-                                                       3,
-                                                       std::nullopt,
-                                                       this->getForcedRelativeScaleForColumn(column)));
+            return this->cachedDisplayString(index.row(), column, [&]() {
+               return Measurement::displayAmount(Measurement::Amount{row->time(), Measurement::Units::minutes},
+                                                 3,
+                                                 std::nullopt,
+                                                 this->getForcedRelativeScaleForColumn(column));
+            });
          }
          break;
       case MISCINVENTORYCOL:
          if (role == Qt::DisplayRole) {
-            return QVariant(
-               Measurement::displayAmount(Measurement::Amount{
-                                             row->inventory(),
-                                             row->amountIsWeight() ? Measurement::Units::kilograms :
-                                                                     Measurement::Units::liters
-                                          },
-                                          3,
-                                          this->getForcedSystemOfMeasurementForColumn(column),
-                                          std::nullopt)
-            );
+            return this->cachedDisplayString(index.row(), column, [&]() {
+               return Measurement::displayAmount(Measurement::Amount{
+                                                    row->inventory(),
+                                                    row->amountIsWeight() ? Measurement::Units::kilograms :
+                                                                            Measurement::Units::liters
+                                                 },
+                                                 3,
+                                                 this->getForcedSystemOfMeasurementForColumn(column),
+                                                 std::nullopt);
+            });
          }
          break;
       case MISCAMOUNTCOL:
          if (role == Qt::DisplayRole) {
-            return QVariant(
-               Measurement::displayAmount(Measurement::Amount{
-                                             row->amount(),
-                                             row->amountIsWeight() ? Measurement::Units::kilograms :
-                                                                     Measurement::Units::liters
-                                          },
-                                          3,
-                                          this->getForcedSystemOfMeasurementForColumn(column),
-                                          std::nullopt)
-            );
+            return this->cachedDisplayString(index.row(), column, [&]() {
+               return Measurement::displayAmount(Measurement::Amount{
+                                                    row->amount(),
+                                                    row->amountIsWeight() ? Measurement::Units::kilograms :
+                                                                            Measurement::Units::liters
+                                                 },
+                                                 3,
+                                                 this->getForcedSystemOfMeasurementForColumn(column),
+                                                 std::nullopt);
+            });
          }
          break;
       case MISCISWEIGHT:
@@ -394,6 +393,7 @@ void MiscTableModel::changedInventory(int invKey, BtStringConst const & property
    if (propertyName == PropertyNames::Inventory::amount) {
       for (int ii = 0; ii < this->rows.size(); ++ii) {
          if (invKey == this->rows.at(ii)->inventoryId()) {
+            this->invalidateCachedDisplayCell(ii, MISCINVENTORYCOL);
             emit dataChanged(QAbstractItemModel::createIndex(ii, MISCINVENTORYCOL),
                              QAbstractItemModel::createIndex(ii, MISCINVENTORYCOL));
          }
@@ -411,6 +411,7 @@ void MiscTableModel::changed(QMetaProperty prop, QVariant /*val*/) {
          return;
       }
 
+      this->invalidateCachedDisplayForProperty(i, prop.name());
       emit dataChanged( QAbstractItemModel::createIndex(i, 0),
                         QAbstractItemModel::createIndex(i, MISCNUMCOLS-1) );
       return;
@@ -126,16 +126,15 @@ void SaltTableModel::addSalt(std::shared_ptr<Salt> salt) {
 void SaltTableModel::addSalts(QList<std::shared_ptr<Salt> > salts) {
    auto tmp = this->removeDuplicates(salts);
 
-   int size = this->rows.size();
-   if (size+tmp.size()) {
-      beginInsertRows( QModelIndex(), size, size+tmp.size()-1 );
+   if (!tmp.isEmpty()) {
+      this->beginBulkInsertRows(tmp.size());
       this->rows.append(tmp);
-      endInsertRows();
 
       for (auto salt : tmp) {
          connect(salt.get(), &NamedEntity::changed, this, &SaltTableModel::changed);
       }
 
+      this->endBulkInsertRows();
    }
 
    if (parentTableWidget ) {
@@ -339,11 +338,12 @@ void SaltTableModel::removeSalts(QList<int>deadSalts) {
 }
 
 void SaltTableModel::removeAll() {
-   beginRemoveRows( QModelIndex(), 0, this->rows.size()-1 );
-   while (!this->rows.isEmpty() ) {
-      disconnect(this->rows.takeLast().get(), nullptr, this, nullptr );
+   if (!this->rows.isEmpty()) {
+      this->beginResetModel();
+      this->disconnectAndClearRows(this);
+      this->endResetModel();
    }
-   endRemoveRows();
+   return;
 }
 
 void SaltTableModel::changed(QMetaProperty prop, QVariant /*val*/)
@@ -355,10 +355,12 @@ void SaltTableModel::changed(QMetaProperty prop, QVariant /*val*/)
    if (saltSender ) {
       auto spSaltSender = ObjectStoreWrapper::getSharedFromRaw(saltSender);
       i = this->rows.indexOf(spSaltSender);
-      if (i >= 0 )
+      if (i >= 0 ) {
+         this->invalidateCachedDisplayForProperty(i, prop.name());
          emit dataChanged( QAbstractItemModel::createIndex(i, 0),
                            QAbstractItemModel::createIndex(i, SALTNUMCOLS-1));
          emit headerDataChanged( Qt::Vertical, i, i);
+      }
       return;
    }
 
@@ -403,8 +405,8 @@ QVariant SaltTableModel::data(QModelIndex const & index, int role) const {
          if (role != Qt::DisplayRole) {
             return QVariant();
          }
-         return QVariant(
-            Measurement::displayAmount(
+         return this->cachedDisplayString(index.row(), column, [&]() {
+            return Measurement::displayAmount(
                Measurement::Amount{
                   row->amount(),
                   row->amountIsWeight() ? Measurement::Units::kilograms : Measurement::Units::liters
@@ -412,8 +414,8 @@ QVariant SaltTableModel::data(QModelIndex const & index, int role) const {
                3,
                this->getForcedSystemOfMeasurementForColumn(column),
                std::nullopt
-            )
-         );
+            );
+         });
       case SALTADDTOCOL:
          if (role == Qt::DisplayRole) {
             return QVariant( addToName.at(static_cast<int>(row->addTo())));
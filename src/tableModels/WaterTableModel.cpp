@@ -34,6 +34,7 @@
 
 #include "database/ObjectStoreWrapper.h"
 #include "Localization.h"
+#include "Logging.h"
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
 #include "model/Recipe.h"
@@ -109,7 +110,7 @@ void WaterTableModel::addWater(int waterId) {
    if (this->recObs) {
       Recipe * recipeOfNewWater = water->getOwningRecipe();
       if (recipeOfNewWater && this->recObs->key() != recipeOfNewWater->key()) {
-         qDebug() <<
+         qCDebug(Logging::ui) <<
             Q_FUNC_INFO << "Ignoring signal about new Water #" << water->key() << "as it belongs to Recipe #" <<
             recipeOfNewWater->key() << "and we are watching Recipe #" << this->recObs->key();
          return;
@@ -130,16 +131,15 @@ void WaterTableModel::addWater(int waterId) {
 void WaterTableModel::addWaters(QList<std::shared_ptr<Water> > waters) {
    auto tmp = this->removeDuplicates(waters);
 
-   int size = rows.size();
-   if (size + tmp.size()) {
-      beginInsertRows(QModelIndex(), size, size + tmp.size() - 1);
-      rows.append(tmp);
+   if (!tmp.isEmpty()) {
+      this->beginBulkInsertRows(tmp.size());
+      this->rows.append(tmp);
 
       for (auto water : tmp) {
          connect(water.get(), &NamedEntity::changed, this, &WaterTableModel::changed);
       }
 
-      endInsertRows();
+      this->endBulkInsertRows();
    }
 
    if (parentTableWidget) {
@@ -166,11 +166,12 @@ void WaterTableModel::removeWater(int waterId, std::shared_ptr<QObject> object)
 }
 
 void WaterTableModel::removeAll() {
-   beginRemoveRows(QModelIndex(), 0, rows.size() - 1);
-   while (!rows.isEmpty()) {
-      disconnect(rows.takeLast().get(), nullptr, this, nullptr);
+   if (!this->rows.isEmpty()) {
+      this->beginResetModel();
+      this->disconnectAndClearRows(this);
+      this->endResetModel();
    }
-   endRemoveRows();
+   return;
 }
 
 void WaterTableModel::changed(QMetaProperty prop, QVariant val) {
@@ -36,6 +36,7 @@
 #include <QWidget>
 
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "MainWindow.h"
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
@@ -92,7 +93,7 @@ void YeastTableModel::addYeast(int yeastId) {
    if (this->recObs) {
       Recipe * recipeOfNewYeast = yeast->getOwningRecipe();
       if (recipeOfNewYeast && this->recObs->key() != recipeOfNewYeast->key()) {
-         qDebug() <<
+         qCDebug(Logging::ui) <<
             Q_FUNC_INFO << "Ignoring signal about new Yeast #" << yeast->key() << "as it belongs to Recipe #" <<
             recipeOfNewYeast->key() << "and we are watching Recipe #" << this->recObs->key();
          return;
@@ -145,16 +146,15 @@ void YeastTableModel::observeDatabase(bool val) {
 void YeastTableModel::addYeasts(QList<std::shared_ptr<Yeast> > yeasts) {
    auto tmp = this->removeDuplicates(yeasts, this->recObs);
 
-   int size = this->rows.size();
-   if (size + tmp.size()) {
-      beginInsertRows(QModelIndex(), size, size + tmp.size() - 1);
+   if (!tmp.isEmpty()) {
+      this->beginBulkInsertRows(tmp.size());
       this->rows.append(tmp);
 
       for (auto yeast : tmp) {
          connect(yeast.get(), &NamedEntity::changed, this, &YeastTableModel::changed);
       }
 
-      endInsertRows();
+      this->endBulkInsertRows();
    }
    return;
 }
@@ -179,13 +179,12 @@ void YeastTableModel::remove(std::shared_ptr<Yeast> yeast) {
 }
 
 void YeastTableModel::removeAll() {
-   if (this->rows.size()) {
-      beginRemoveRows(QModelIndex(), 0, this->rows.size() - 1);
-      while (!this->rows.isEmpty()) {
-         disconnect(this->rows.takeLast().get(), nullptr, this, nullptr);
-      }
-      endRemoveRows();
+   if (!this->rows.isEmpty()) {
+      this->beginResetModel();
+      this->disconnectAndClearRows(this);
+      this->endResetModel();
    }
+   return;
 }
 
 void YeastTableModel::changedInventory(int invKey, BtStringConst const & propertyName) {
@@ -210,6 +209,7 @@ void YeastTableModel::changed(QMetaProperty prop, QVariant /*val*/) {
          return;
       }
 
+      this->invalidateCachedDisplayForProperty(ii, prop.name());
       emit dataChanged(QAbstractItemModel::createIndex(ii, 0),
                        QAbstractItemModel::createIndex(ii, YEASTNUMCOLS - 1));
       return;
@@ -282,8 +282,8 @@ QVariant YeastTableModel::data(QModelIndex const & index, int role) const {
          break;
       case YEASTAMOUNTCOL:
          if (role == Qt::DisplayRole) {
-            return QVariant(
-               Measurement::displayAmount(
+            return this->cachedDisplayString(index.row(), column, [&]() {
+               return Measurement::displayAmount(
                   Measurement::Amount{
                      row->amount(),
                      row->amountIsWeight() ? Measurement::Units::kilograms : Measurement::Units::liters
@@ -291,8 +291,8 @@ QVariant YeastTableModel::data(QModelIndex const & index, int role) const {
                   3,
                   this->getForcedSystemOfMeasurementForColumn(column),
                   std::nullopt
-               )
-            );
+               );
+            });
          }
          break;
       default :
@@ -0,0 +1,792 @@
+/*
+ * unitTests/Benchmarks.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream> // For std::cout
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <xercesc/util/PlatformUtils.hpp>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QStringList>
+#include <QTableView>
+#include <QTextStream>
+#include <QVector>
+
+#include "brewtarget.h"
+#include "BtTreeModel.h"
+#include "config.h" // For VERSIONSTRING
+#include "database/BtSqlQuery.h"
+#include "database/Database.h"
+#include "database/ObjectStoreTyped.h"
+#include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
+#include "measurement/Measurement.h"
+#include "model/Equipment.h"
+#include "model/Fermentable.h"
+#include "model/Hop.h"
+#include "model/Misc.h"
+#include "model/Recipe.h"
+#include "model/Style.h"
+#include "model/Yeast.h"
+#include "PersistentSettings.h"
+#include "RecipeFormatter.h"
+#include "tableModels/FermentableTableModel.h"
+#include "utils/MemoryAccounting.h"
+#include "xml/BeerXml.h"
+
+namespace {
+   //
+   // How many times we run each operation.  These are fixed (rather than letting QtTest decide) so that results are
+   // comparable between runs and between commits.  If you change one, results for that benchmark from before the
+   // change are no longer directly comparable with those after.
+   //
+   int constexpr LOAD_ALL_ITERATIONS          = 10;
+   int constexpr IMPORT_DEFAULT_ITERATIONS    = 3;
+   int constexpr IMPORT_LARGE_ITERATIONS      = 1;
+   int constexpr RECALC_ALL_ITERATIONS        = 200;
+   int constexpr LOAD_TREE_MODEL_ITERATIONS   = 20;
+   int constexpr QSTRING_TO_SI_ITERATIONS     = 10000;
+   int constexpr RECIPE_HTML_ITERATIONS       = 50;
+   int constexpr SQLITE_UPDATE_ITERATIONS     = 500;
+   int constexpr TABLE_MODEL_ITERATIONS       = 20;
+
+   //! How many copies of the default data go in the "large" BeerXML file
+   int constexpr SYNTHETIC_FILE_COPIES = 5;
+
+   //
+   // Same again for the tests that use the synthetic DB (see comment in Benchmarks.h)
+   //
+   int constexpr COLD_LOAD_ITERATIONS         = 3;
+   int constexpr IMPORT_1K_RECIPES_ITERATIONS = 1;
+   int constexpr RECALC_ALL_10K_ITERATIONS    = 10000;
+   int constexpr BUILD_LARGE_TREE_ITERATIONS  = 3;
+
+   //! Names of the files made by brewtarget_generateTestData in BREWTARGET_PERF_FIXTURE_DIR
+   char const * const FIXTURE_DB_FILE      = "database.sqlite";
+   char const * const FIXTURE_BEERXML_FILE = "recipes.xml";
+
+   //! Number of recipes we expect in the synthetic DB
+   int constexpr FIXTURE_NUM_RECIPES = 1000;
+
+   //! Failure message for a benchmark that has to be timed on the synthetic DB as generated
+   char const * const FIXTURE_DB_MODIFIED =
+      "The synthetic DB has had recipes imported into it -- run this before import1kRecipes";
+
+   //! Below this p-value, we treat a difference from the baseline as real rather than noise
+   double constexpr SIGNIFICANCE_LEVEL = 0.01;
+
+   //! Size and number of runs of the calibration workload
+   int constexpr CALIBRATION_SIZE = 1 << 20;
+   int constexpr CALIBRATION_RUNS = 5;
+
+   //! Stops the compiler optimising away the calibration workload
+   volatile std::uint64_t calibrationSink = 0;
+
+   /**
+    * \brief Time a fixed, CPU- and memory-bound workload (sorting numbers and filling a hash of strings) that uses
+    *        the same sort of operations as the program.  Taking the fastest of several runs gives a figure that mostly
+    *        reflects the speed of the machine rather than whatever else happens to be running on it.
+    */
+   qint64 measureCalibrationNs() {
+      qint64 fastestNs = std::numeric_limits<qint64>::max();
+      for (int run = 0; run < CALIBRATION_RUNS; ++run) {
+         QElapsedTimer timer;
+         timer.start();
+         std::mt19937 engine{1};
+         std::vector<std::uint32_t> numbers(CALIBRATION_SIZE);
+         for (auto & number : numbers) {
+            number = engine();
+         }
+         std::sort(numbers.begin(), numbers.end());
+         QHash<QString, int> hash;
+         for (int ii = 0; ii < CALIBRATION_SIZE / 16; ++ii) {
+            hash.insert(QString::number(numbers[ii]), ii);
+         }
+         fastestNs = std::min(fastestNs, timer.nsecsElapsed());
+         calibrationSink = calibrationSink + hash.size() + numbers.front();
+      }
+      return fastestNs;
+   }
+
+   double median(QVector<double> values) {
+      if (values.isEmpty()) {
+         return 0.0;
+      }
+      std::sort(values.begin(), values.end());
+      int const middle = values.size() / 2;
+      return values.size() % 2 == 1 ? values.at(middle) : (values.at(middle - 1) + values.at(middle)) / 2.0;
+   }
+
+   /**
+    * \brief One-sided Mann-Whitney U test: the probability, if both sets of samples came from the same distribution,
+    *        of \c current being at least as much bigger than \c baseline as it is.
+    *
+    *        We only have a handful of samples, so we work out the exact distribution of U (by counting orderings)
+    *        rather than using the usual normal approximation.  Ties count as half, and U is then rounded down, which
+    *        errs on the side of not reporting a regression.
+    */
+   double mannWhitneyPValue(QVector<double> const & current, QVector<double> const & baseline) {
+      int const m = current.size();
+      int const n = baseline.size();
+      double u = 0.0;
+      for (double const currentSample : current) {
+         for (double const baselineSample : baseline) {
+            u += currentSample > baselineSample ? 1.0 : currentSample == baselineSample ? 0.5 : 0.0;
+         }
+      }
+      int const observedU = static_cast<int>(std::floor(u));
+
+      //
+      // ways[i][j][k] is the number of orderings of i current and j baseline samples with U = k.  Looking at the
+      // largest sample: if it's a current one, it beats all j baseline ones, otherwise it adds nothing to U.
+      //
+      std::vector<std::vector<std::vector<double>>> ways(
+         m + 1, std::vector<std::vector<double>>(n + 1, std::vector<double>(m * n + 1, 0.0))
+      );
+      for (int ii = 0; ii <= m; ++ii) {
+         for (int jj = 0; jj <= n; ++jj) {
+            if (ii == 0 || jj == 0) {
+               ways[ii][jj][0] = 1.0;
+               continue;
+            }
+            for (int kk = 0; kk <= ii * jj; ++kk) {
+               ways[ii][jj][kk] = (kk >= jj ? ways[ii - 1][jj][kk - jj] : 0.0) + ways[ii][jj - 1][kk];
+            }
+         }
+      }
+      double total = 0.0;
+      double atLeastObserved = 0.0;
+      for (int kk = 0; kk <= m * n; ++kk) {
+         total += ways[m][n][kk];
+         if (kk >= observedU) {
+            atLeastObserved += ways[m][n][kk];
+         }
+      }
+      return atLeastObserved / total;
+   }
+
+   //! \return The smallest p-value \c mannWhitneyPValue can give for these numbers of samples
+   double minimumPValue(int m, int n) {
+      // 1 / (m+n choose m)
+      double orderings = 1.0;
+      for (int ii = 1; ii <= m; ++ii) {
+         orderings = orderings * (n + ii) / ii;
+      }
+      return 1.0 / orderings;
+   }
+
+   /**
+    * \brief Reading all the objects of one type into a new store, which we then throw away.  (We can't use the
+    *        singleton store as it has already been loaded.)
+    *
+    * \return Number of objects read
+    */
+   template<class NE> int loadAllIntoDetachedStore() {
+      auto objectStore = ObjectStoreTyped<NE>::createDetachedInstance();
+      objectStore->loadAll();
+      return objectStore->getAll().size();
+   }
+
+   QHash<QString, std::function<int()>> const loadAllFunctions {
+      {"Equipment",   &loadAllIntoDetachedStore<Equipment>  },
+      {"Fermentable", &loadAllIntoDetachedStore<Fermentable>},
+      {"Hop",         &loadAllIntoDetachedStore<Hop>        },
+      {"Misc",        &loadAllIntoDetachedStore<Misc>       },
+      {"Recipe",      &loadAllIntoDetachedStore<Recipe>     },
+      {"Style",       &loadAllIntoDetachedStore<Style>      },
+      {"Yeast",       &loadAllIntoDetachedStore<Yeast>      }
+   };
+
+   /**
+    * \brief Make a BeerXML file with several copies of the default data, renamed so that none of the records is a
+    *        duplicate of one already in the DB.
+    *
+    *        The default data file is a series of top-level sections (\<HOPS\>, \<RECIPES\>, etc) each at the start of a
+    *        line, so we can just repeat the contents of each section.
+    */
+   bool writeSyntheticBeerXml(QString const & fileName) {
+      QFile defaultDataFile{Brewtarget::getResourceDir().filePath("DefaultData.xml")};
+      if (!defaultDataFile.open(QIODevice::ReadOnly)) {
+         qCritical() << Q_FUNC_INFO << "Could not read" << defaultDataFile.fileName();
+         return false;
+      }
+      // The default data file is ISO-8859-1, so we need to keep it that way
+      QString const defaultData = QString::fromLatin1(defaultDataFile.readAll());
+
+      QString output{"<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n"};
+      QRegularExpression const sectionRegExp{
+         "^<([A-Z]+)>$(.*?)^</\\1>$",
+         QRegularExpression::MultilineOption | QRegularExpression::DotMatchesEverythingOption
+      };
+      auto sections = sectionRegExp.globalMatch(defaultData);
+      while (sections.hasNext()) {
+         QRegularExpressionMatch const section = sections.next();
+         QString const sectionName = section.captured(1);
+         QString const sectionContents = section.captured(2);
+         output += QString{"<%1>"}.arg(sectionName);
+         for (int copy = 1; copy <= SYNTHETIC_FILE_COPIES; ++copy) {
+            output += QString{sectionContents}.replace("<NAME>", QString{"<NAME>Synthetic %1 "}.arg(copy));
+         }
+         output += QString{"</%1>\n"}.arg(sectionName);
+      }
+
+      QFile syntheticFile{fileName};
+      if (!syntheticFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+         qCritical() << Q_FUNC_INFO << "Could not write" << fileName;
+         return false;
+      }
+      syntheticFile.write(output.toLatin1());
+      return true;
+   }
+}
+
+QTEST_MAIN(Benchmarks)
+
+void Benchmarks::initTestCase() {
+   // Initialize Xerces XML tools
+   try {
+      xercesc::XMLPlatformUtils::Initialize();
+   } catch (xercesc::XMLException const &) {
+      QFAIL("Xerces XML Parser Initialisation Failed");
+   }
+
+   QVERIFY(this->userDataDir.isValid());
+
+   this->fixtureDir = QString::fromLocal8Bit(qgetenv("BREWTARGET_PERF_FIXTURE_DIR"));
+   if (!this->fixtureDir.isEmpty()) {
+      // Work on a copy of the synthetic DB, so the original is the same for every run
+      QVERIFY(QFile::copy(QDir{this->fixtureDir}.filePath(FIXTURE_DB_FILE),
+                          QDir{this->userDataDir.path()}.filePath(FIXTURE_DB_FILE)));
+   }
+   bool repeatsOk = false;
+   this->repeats = qgetenv("BREWTARGET_PERF_REPEATS").toInt(&repeatsOk);
+   if (!repeatsOk || this->repeats < 1) {
+      this->repeats = 1;
+   }
+   QString const baselineFileName = QString::fromLocal8Bit(qgetenv("BREWTARGET_PERF_BASELINE"));
+   if (!baselineFileName.isEmpty()) {
+      QFile baselineFile{baselineFileName};
+      QVERIFY2(baselineFile.open(QIODevice::ReadOnly), qPrintable("Could not read " + baselineFileName));
+      this->baseline = QJsonDocument::fromJson(baselineFile.readAll()).object();
+      bool thresholdOk = false;
+      this->regressionThreshold = qgetenv("BREWTARGET_PERF_THRESHOLD").toDouble(&thresholdOk);
+      if (!thresholdOk || this->regressionThreshold <= 0.0) {
+         this->regressionThreshold = 0.3;
+      }
+   }
+   this->calibrationNs = measureCalibrationNs();
+   std::cout << "Calibration workload: " << this->calibrationNs << " ns" << std::endl;
+
+   // Use separate settings from the real application and from the unit tests
+   QCoreApplication::setOrganizationDomain("brewtarget.com/benchmark");
+   QCoreApplication::setApplicationName("brewtarget-benchmark");
+   PersistentSettings::initialise(this->userDataDir.path());
+
+   Logging::initializeLogging();
+   // Debug logging would swamp what we are trying to measure
+   Logging::setLogLevel(Logging::LogLevel_WARNING);
+   Logging::setDirectory(this->userDataDir.path(), Logging::NewDirectoryIsTemporary);
+
+   Brewtarget::setInteractive(false);
+   QVERIFY(Brewtarget::initialize());
+   return;
+}
+
+void Benchmarks::cleanupTestCase() {
+   QString fileName = QString::fromLocal8Bit(qgetenv("BREWTARGET_BENCHMARK_RESULTS"));
+   if (fileName.isEmpty()) {
+      fileName = "benchmarkResults.json";
+   }
+   QJsonObject const root{
+      {"version",       VERSIONSTRING                                         },
+      {"qtVersion",     qVersion()                                            },
+      {"timestamp",     QDateTime::currentDateTimeUtc().toString(Qt::ISODate) },
+      {"calibrationNs", this->calibrationNs                                   },
+      {"benchmarks",    this->results                                         },
+      {"memory",        this->memoryResults                                   }
+   };
+   QFile resultsFile{fileName};
+   if (resultsFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      resultsFile.write(QJsonDocument{root}.toJson());
+      std::cout << "Benchmark results written to " << fileName.toStdString() << std::endl;
+   } else {
+      qWarning() << Q_FUNC_INFO << "Could not write benchmark results to" << fileName;
+   }
+
+   Brewtarget::cleanup();
+   Logging::terminateLogging();
+   QSettings().clear();
+   xercesc::XMLPlatformUtils::Terminate();
+   return;
+}
+
+void Benchmarks::runBenchmark(QString const & name,
+                              int iterations,
+                              bool warmUp,
+                              std::function<void()> const & operation) {
+   if (warmUp) {
+      operation();
+   }
+
+   QVector<double> samplesNsPerOp;
+   QJsonArray samplesAsJson;
+   QBENCHMARK_ONCE {
+      for (int repeat = 0; repeat < this->repeats; ++repeat) {
+         QElapsedTimer timer;
+         timer.start();
+         for (int ii = 0; ii < iterations; ++ii) {
+            operation();
+         }
+         double const sampleNsPerOp = static_cast<double>(timer.nsecsElapsed()) / iterations;
+         samplesNsPerOp.append(sampleNsPerOp);
+         samplesAsJson.append(sampleNsPerOp);
+      }
+   }
+
+   // Where we have repeated the timings, we report the median
+   double const nsPerOp = median(samplesNsPerOp);
+   qint64 const elapsedNs = static_cast<qint64>(nsPerOp * iterations);
+   double const opsPerSecond = nsPerOp > 0.0 ? 1.0e9 / nsPerOp : 0.0;
+   std::cout <<
+      name.toStdString() << ": " << iterations << " iterations, " << static_cast<qint64>(nsPerOp) << " ns/op, " <<
+      opsPerSecond << " ops/s" << std::endl;
+   this->results.insert(name, QJsonObject{
+      {"iterations",     iterations    },
+      {"totalNs",        elapsedNs     },
+      {"nsPerOp",        nsPerOp       },
+      {"opsPerSecond",   opsPerSecond  },
+      {"samplesNsPerOp", samplesAsJson }
+   });
+   this->checkAgainstBaseline(name, samplesNsPerOp);
+   return;
+}
+
+void Benchmarks::checkAgainstBaseline(QString const & name, QVector<double> const & samplesNsPerOp) {
+   if (this->baseline.isEmpty()) {
+      return;
+   }
+   double const baselineCalibrationNs = this->baseline.value("calibrationNs").toDouble();
+   QJsonArray const baselineSamplesAsJson =
+      this->baseline.value("benchmarks").toObject().value(name).toObject().value("samplesNsPerOp").toArray();
+   //
+   // If we've been given a baseline, it has to cover everything we're asked to check, otherwise the gate would pass
+   // without having compared anything.
+   //
+   QVERIFY2(
+      !baselineSamplesAsJson.isEmpty() && baselineCalibrationNs > 0.0 && this->calibrationNs > 0,
+      qPrintable(QString{"No baseline for %1 -- record one with the updatePerfBaseline build target"}.arg(name))
+   );
+
+   // Scale everything by the calibration timings, so that we are comparing like with like
+   QVector<double> baselineSamples;
+   for (auto const & sample : baselineSamplesAsJson) {
+      baselineSamples.append(sample.toDouble() / baselineCalibrationNs);
+   }
+   QVector<double> currentSamples;
+   for (double const sample : samplesNsPerOp) {
+      currentSamples.append(sample / static_cast<double>(this->calibrationNs));
+   }
+
+   double const baselineMedian = median(baselineSamples);
+   double const ratio = baselineMedian > 0.0 ? median(currentSamples) / baselineMedian : 1.0;
+   double const pValue = mannWhitneyPValue(currentSamples, baselineSamples);
+   //
+   // With very few samples (eg a baseline recorded without repeats) the test can never give a significant result, so
+   // we have to go on the medians alone.
+   //
+   bool const canBeSignificant = minimumPValue(currentSamples.size(), baselineSamples.size()) < SIGNIFICANCE_LEVEL;
+   bool const isSignificant = !canBeSignificant || pValue < SIGNIFICANCE_LEVEL;
+   std::cout <<
+      name.toStdString() << ": " << ratio << " x baseline (p = " << pValue << ", threshold " <<
+      1.0 + this->regressionThreshold << " x)" << std::endl;
+   QVERIFY2(
+      ratio <= 1.0 + this->regressionThreshold || !isSignificant,
+      qPrintable(
+         QString{"%1 has regressed: median %2 x baseline, p = %3"}.arg(name).arg(ratio, 0, 'f', 2).arg(pValue)
+      )
+   );
+   return;
+}
+
+Recipe * Benchmarks::findRecipeWithIngredients() const {
+   for (Recipe * recipe : ObjectStoreWrapper::getAllRaw<Recipe>()) {
+      if (!recipe->fermentables().isEmpty() && !recipe->hops().isEmpty()) {
+         return recipe;
+      }
+   }
+   return nullptr;
+}
+
+void Benchmarks::loadAll_data() {
+   QTest::addColumn<QString>("typeName");
+   // Sort so the order is the same every run
+   QStringList typeNames = loadAllFunctions.keys();
+   typeNames.sort();
+   for (auto const & typeName : typeNames) {
+      QTest::newRow(typeName.toUtf8().constData()) << typeName;
+   }
+   return;
+}
+
+void Benchmarks::loadAll() {
+   QFETCH(QString, typeName);
+   auto const & loadAllFunction = loadAllFunctions.value(typeName);
+   QVERIFY(loadAllFunction() > 0);
+   this->runBenchmark("loadAll/" + typeName, LOAD_ALL_ITERATIONS, false, [&loadAllFunction]() {
+      loadAllFunction();
+      return;
+   });
+   return;
+}
+
+void Benchmarks::importDefaultData() {
+   QString const fileName = Brewtarget::getResourceDir().filePath("DefaultData.xml");
+   this->runBenchmark("importDefaultData", IMPORT_DEFAULT_ITERATIONS, true, [&fileName]() {
+      QString userMessage;
+      QTextStream userMessageAsStream{&userMessage};
+      BeerXML::getInstance().importFromXML(fileName, userMessageAsStream);
+      return;
+   });
+   return;
+}
+
+void Benchmarks::importLargeSyntheticFile() {
+   QString const fileName = QDir{this->userDataDir.path()}.filePath("synthetic.xml");
+   QVERIFY(writeSyntheticBeerXml(fileName));
+   // No warm-up here, as, once the file has been imported, every record in it is a duplicate
+   bool succeeded = false;
+   this->runBenchmark("importLargeSyntheticFile", IMPORT_LARGE_ITERATIONS, false, [&fileName, &succeeded]() {
+      QString userMessage;
+      QTextStream userMessageAsStream{&userMessage};
+      succeeded = BeerXML::getInstance().importFromXML(fileName, userMessageAsStream);
+      return;
+   });
+   QVERIFY(succeeded);
+   return;
+}
+
+void Benchmarks::recalcAll() {
+   Recipe * recipe = this->findRecipeWithIngredients();
+   QVERIFY(recipe);
+   this->runBenchmark("recalcAll", RECALC_ALL_ITERATIONS, true, [recipe]() {
+      recipe->recalcAll();
+      return;
+   });
+   return;
+}
+
+void Benchmarks::loadTreeModel() {
+   this->runBenchmark("loadTreeModel", LOAD_TREE_MODEL_ITERATIONS, true, []() {
+      // Constructor calls loadTreeModel()
+      BtTreeModel treeModel{nullptr, BtTreeModel::RECIPEMASK};
+      return;
+   });
+   return;
+}
+
+void Benchmarks::qStringToSI() {
+   QVector<std::pair<QString, Measurement::PhysicalQuantity>> const inputs {
+      {"5.5 gal",  Measurement::PhysicalQuantity::Volume     },
+      {"20 L",     Measurement::PhysicalQuantity::Volume     },
+      {"1.5 kg",   Measurement::PhysicalQuantity::Mass       },
+      {"3 lb",     Measurement::PhysicalQuantity::Mass       },
+      {"28 g",     Measurement::PhysicalQuantity::Mass       },
+      {"152 F",    Measurement::PhysicalQuantity::Temperature},
+      {"67 C",     Measurement::PhysicalQuantity::Temperature},
+      {"60 min",   Measurement::PhysicalQuantity::Time       },
+      {"1.050 sg", Measurement::PhysicalQuantity::Density    },
+      {"12.5",     Measurement::PhysicalQuantity::Volume     }
+   };
+   // Each "operation" here is parsing one string
+   int index = 0;
+   this->runBenchmark("qStringToSI", QSTRING_TO_SI_ITERATIONS, true, [&inputs, &index]() {
+      auto const & input = inputs.at(index);
+      Measurement::qStringToSI(input.first, input.second);
+      index = (index + 1) % inputs.size();
+      return;
+   });
+   return;
+}
+
+void Benchmarks::recipeHtml() {
+   Recipe * recipe = this->findRecipeWithIngredients();
+   QVERIFY(recipe);
+   RecipeFormatter recipeFormatter;
+   recipeFormatter.setRecipe(recipe);
+   this->runBenchmark("recipeHtml", RECIPE_HTML_ITERATIONS, true, [&recipeFormatter]() {
+      recipeFormatter.getHtmlFormat();
+      return;
+   });
+   return;
+}
+
+void Benchmarks::tableModelPopulate_data() {
+   QTest::addColumn<bool>("bulk");
+   QTest::newRow("perRow") << false;
+   QTest::newRow("bulk")   << true;
+   return;
+}
+
+void Benchmarks::tableModelPopulate() {
+   QFETCH(bool, bulk);
+   QVERIFY2(!this->fixtureDbModified, FIXTURE_DB_MODIFIED);
+   QTableView tableView;
+   FermentableTableModel model(&tableView, false);
+
+   QList<std::shared_ptr<Fermentable> > fermentables;
+   for (auto fermentable : ObjectStoreWrapper::getAll<Fermentable>()) {
+      if (!fermentable->deleted() && fermentable->display()) {
+         fermentables.append(fermentable);
+      }
+   }
+   QVERIFY(!fermentables.isEmpty());
+
+   // Each operation is emptying the model and filling it again, so both variants do the same removeAll() work
+   this->runBenchmark(
+      QString{"tableModelPopulate/"} + (bulk ? "bulk" : "perRow"),
+      TABLE_MODEL_ITERATIONS,
+      true,
+      [&model, &fermentables, bulk]() {
+         model.removeAll();
+         if (bulk) {
+            model.addFermentables(fermentables);
+         } else {
+            for (auto const & fermentable : fermentables) {
+               model.addFermentable(fermentable->key());
+            }
+         }
+         return;
+      }
+   );
+   QCOMPARE(model.rowCount(), fermentables.size());
+   model.removeAll();
+   return;
+}
+
+void Benchmarks::sqliteUpdateLatency_data() {
+   QTest::addColumn<QString>("journalModeName");
+   QTest::newRow("wal")       << "wal";
+   QTest::newRow("exclusive") << "exclusive";
+   return;
+}
+
+void Benchmarks::sqliteUpdateLatency() {
+   QFETCH(QString, journalModeName);
+   Database::SqliteJournalMode const journalMode{
+      journalModeName == "wal" ? Database::SqliteJournalMode::Wal : Database::SqliteJournalMode::Exclusive
+   };
+   if (Database::instance().dbType() != Database::SQLITE) {
+      QSKIP("Needs an SQLite DB");
+   }
+
+   // Work on a copy of the DB, so that we can open it with whichever settings we're timing
+   QString const scratchFileName = QDir{this->userDataDir.path()}.filePath("updateLatency-" + journalModeName);
+   QVERIFY(Database::instance().backupToFile(scratchFileName));
+
+   QString const connectionName{"updateLatency"};
+   {
+      // This needs to be out of scope before we call QSqlDatabase::removeDatabase()
+      QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+      connection.setDatabaseName(scratchFileName);
+      QVERIFY2(connection.open(), qPrintable(connection.lastError().text()));
+      QVERIFY(Database::setSqliteConnectionOptions(connection, journalMode, true));
+
+      BtSqlQuery idQuery{connection};
+      QVERIFY(idQuery.exec("SELECT id FROM hop LIMIT 1;") && idQuery.next());
+      int const hopId = idQuery.value(0).toInt();
+      idQuery.finish();
+
+      // Each update is its own transaction, as when the user edits one field in the UI
+      BtSqlQuery updateQuery{connection};
+      updateQuery.prepare("UPDATE hop SET notes = :notes WHERE id = :id;");
+      int counter = 0;
+      bool succeeded = true;
+      this->runBenchmark(
+         "sqliteUpdateLatency/" + journalModeName,
+         SQLITE_UPDATE_ITERATIONS,
+         true,
+         [&updateQuery, hopId, &counter, &succeeded]() {
+            updateQuery.bindValue(":notes", QString::number(++counter));
+            updateQuery.bindValue(":id", hopId);
+            succeeded = updateQuery.exec() && succeeded;
+            return;
+         }
+      );
+      QVERIFY2(succeeded, qPrintable(updateQuery.lastError().text()));
+      updateQuery.finish();
+      connection.close();
+   }
+   QSqlDatabase::removeDatabase(connectionName);
+   return;
+}
+
+void Benchmarks::coldLoad() {
+   if (this->fixtureDir.isEmpty()) {
+      QSKIP("Needs BREWTARGET_PERF_FIXTURE_DIR");
+   }
+   QVERIFY2(!this->fixtureDbModified, FIXTURE_DB_MODIFIED);
+   this->runBenchmark("coldLoad", COLD_LOAD_ITERATIONS, false, []() {
+      for (auto const & loadAllFunction : loadAllFunctions) {
+         loadAllFunction();
+      }
+      return;
+   });
+   return;
+}
+
+void Benchmarks::import1kRecipes() {
+   if (this->fixtureDir.isEmpty()) {
+      QSKIP("Needs BREWTARGET_PERF_FIXTURE_DIR");
+   }
+   QFile fixtureFile{QDir{this->fixtureDir}.filePath(FIXTURE_BEERXML_FILE)};
+   QVERIFY2(fixtureFile.open(QIODevice::ReadOnly), qPrintable("Could not read " + fixtureFile.fileName()));
+   QByteArray const fixtureContents = fixtureFile.readAll();
+
+   //
+   // The fixture file has the same records as the fixture DB, so importing it as-is would only exercise duplicate
+   // detection.  Instead, every run (including the warm-up) gets its own copy with all the names changed, as in
+   // writeSyntheticBeerXml().  We write these out before we start timing.
+   //
+   QStringList fileNames;
+   int const numRuns = 1 + this->repeats * IMPORT_1K_RECIPES_ITERATIONS;
+   for (int run = 1; run <= numRuns; ++run) {
+      QString const fileName = QDir{this->userDataDir.path()}.filePath(QString{"import1kRecipes-%1.xml"}.arg(run));
+      QFile runFile{fileName};
+      QVERIFY2(runFile.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable("Could not write " + fileName));
+      runFile.write(QByteArray{fixtureContents}.replace("<NAME>", QString{"<NAME>Import %1 "}.arg(run).toLatin1()));
+      fileNames.append(fileName);
+   }
+
+   //
+   // Everything we import stays in the DB, so the other benchmarks on the synthetic DB would time something that
+   // depends on how many repeats we did.  Hence this has to be the last of them (as it is in the perfRegression test),
+   // and we make sure of it by having them fail if they run after us.
+   //
+   this->fixtureDbModified = true;
+   int const numRecipesBefore = ObjectStoreWrapper::getAllRaw<Recipe>().size();
+   int nextFile = 0;
+   bool succeeded = true;
+   this->runBenchmark("import1kRecipes", IMPORT_1K_RECIPES_ITERATIONS, true, [&fileNames, &nextFile, &succeeded]() {
+      QString userMessage;
+      QTextStream userMessageAsStream{&userMessage};
+      succeeded = BeerXML::getInstance().importFromXML(fileNames.at(nextFile++), userMessageAsStream) && succeeded;
+      return;
+   });
+   QVERIFY(succeeded);
+   QCOMPARE(nextFile, numRuns);
+   // Check we really did store new recipes rather than just finding duplicates
+   QVERIFY(ObjectStoreWrapper::getAllRaw<Recipe>().size() >= numRecipesBefore + numRuns * FIXTURE_NUM_RECIPES);
+   return;
+}
+
+void Benchmarks::recalcAll10k() {
+   if (this->fixtureDir.isEmpty()) {
+      QSKIP("Needs BREWTARGET_PERF_FIXTURE_DIR");
+   }
+   QVERIFY2(!this->fixtureDbModified, FIXTURE_DB_MODIFIED);
+   QList<Recipe *> const recipes = ObjectStoreWrapper::getAllRaw<Recipe>();
+   QVERIFY(recipes.size() >= FIXTURE_NUM_RECIPES);
+   int index = 0;
+   this->runBenchmark("recalcAll10k", RECALC_ALL_10K_ITERATIONS, true, [&recipes, &index]() {
+      recipes.at(index)->recalcAll();
+      index = (index + 1) % recipes.size();
+      return;
+   });
+   return;
+}
+
+void Benchmarks::buildLargeTree() {
+   if (this->fixtureDir.isEmpty()) {
+      QSKIP("Needs BREWTARGET_PERF_FIXTURE_DIR");
+   }
+   QVERIFY2(!this->fixtureDbModified, FIXTURE_DB_MODIFIED);
+   QVERIFY(ObjectStoreWrapper::getAllRaw<Recipe>().size() >= FIXTURE_NUM_RECIPES);
+   this->runBenchmark("buildLargeTree", BUILD_LARGE_TREE_ITERATIONS, true, []() {
+      // Constructor calls loadTreeModel()
+      BtTreeModel treeModel{nullptr, BtTreeModel::RECIPEMASK};
+      return;
+   });
+   return;
+}
+
+void Benchmarks::memoryUsage() {
+   //
+   // We only turn memory accounting on here, as it would otherwise add (a little) to the cost of loadAll.  Having the
+   // recipe and ingredient trees up means we see them as well as the object stores.
+   //
+   MemoryAccounting::setEnabled(true);
+   BtTreeModel recipeTreeModel{nullptr, BtTreeModel::RECIPEMASK};
+   BtTreeModel hopTreeModel{nullptr, BtTreeModel::HOPMASK};
+   QMap<QString, MemoryAccounting::Usage> const usage = MemoryAccounting::getUsage();
+   MemoryAccounting::setEnabled(false);
+   QVERIFY(!usage.isEmpty());
+
+   MemoryAccounting::Usage total;
+   for (auto ii = usage.constBegin(); ii != usage.constEnd(); ++ii) {
+      total += ii.value();
+      this->memoryResults.insert(ii.key(), QJsonObject{
+         {"numObjects",  ii.value().numObjects },
+         {"approxBytes", ii.value().approxBytes}
+      });
+      std::cout <<
+         "memory/" << ii.key().toStdString() << ": " << ii.value().numObjects << " objects, " <<
+         ii.value().approxBytes << " bytes" << std::endl;
+   }
+   this->memoryResults.insert("total", QJsonObject{
+      {"numObjects",  total.numObjects },
+      {"approxBytes", total.approxBytes}
+   });
+
+   QString const budgetFileName = QString::fromLocal8Bit(qgetenv("BREWTARGET_MEMORY_BUDGET"));
+   if (budgetFileName.isEmpty()) {
+      return;
+   }
+   QFile budgetFile{budgetFileName};
+   QVERIFY2(budgetFile.open(QIODevice::ReadOnly), qPrintable("Could not read " + budgetFileName));
+   QJsonObject const budgets = QJsonDocument::fromJson(budgetFile.readAll()).object();
+   QVERIFY2(!budgets.isEmpty(), qPrintable("No budgets in " + budgetFileName));
+   QStringList overBudget;
+   for (auto ii = budgets.constBegin(); ii != budgets.constEnd(); ++ii) {
+      qint64 const budget = static_cast<qint64>(ii.value().toDouble());
+      qint64 const used = ii.key() == "total" ? total.approxBytes : usage.value(ii.key()).approxBytes;
+      if (used > budget) {
+         overBudget.append(QString{"%1 uses %2 bytes (budget %3)"}.arg(ii.key()).arg(used).arg(budget));
+      }
+   }
+   QVERIFY2(overBudget.isEmpty(), qPrintable(overBudget.join("; ")));
+   return;
+}
@@ -0,0 +1,171 @@
+/*
+ * unitTests/Benchmarks.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UNITTESTS_BENCHMARKS_H
+#define UNITTESTS_BENCHMARKS_H
+#pragma once
+
+#include <functional>
+
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QTemporaryDir>
+#include <QVector>
+#include <QtTest/QtTest>
+
+class Recipe;
+
+/**
+ * \brief Timings of the main performance-sensitive paths in the program.  This is built as a separate executable from
+ *        the unit tests (and labelled "benchmark" in ctest) so that it can be run on its own:
+ *
+ *           ctest -L benchmark             # Run just the benchmarks
+ *           ctest -LE benchmark            # Run everything else
+ *
+ *        Each benchmark runs its operation a fixed number of times (after one untimed warm-up run, where that makes
+ *        sense), so results from different commits are comparable.  As well as the usual QtTest output, the results,
+ *        including operations per second, are written as JSON to the file named by the BREWTARGET_BENCHMARK_RESULTS
+ *        environment variable, or to benchmarkResults.json in the current directory if that is not set.
+ *
+ *        The last test, \c memoryUsage, records the approximate memory used by each subsystem (see
+ *        \c MemoryAccounting) in the same file.  If the BREWTARGET_MEMORY_BUDGET environment variable names a JSON
+ *        file mapping subsystem names (or "total") to a maximum number of bytes, eg
+ *
+ *           { "objectStore/recipe": 2000000, "treeModel/Recipe": 100000, "total": 20000000 }
+ *
+ *        then the test also fails if any of those subsystems is using more than its budget.
+ *
+ *        Performance regression gate
+ *        ---------------------------
+ *        The coldLoad, recalcAll10k, buildLargeTree and import1kRecipes tests need a large synthetic DB and matching
+ *        BeerXML file made by brewtarget_generateTestData.  They are skipped unless the BREWTARGET_PERF_FIXTURE_DIR
+ *        environment variable names the directory holding these.  The perfRegression test in ctest (ctest -L perf),
+ *        which is only registered in builds configured with -DBREWTARGET_PERF_GATE=ON, generates the fixtures and runs
+ *        these tests (plus tableModelPopulate, which works with any DB, so that the bulk and per-row table model paths
+ *        are tracked too) with the following environment variables:
+ *           BREWTARGET_PERF_REPEATS    How many times to repeat the timed part of each benchmark (default 1)
+ *           BREWTARGET_PERF_BASELINE   A results file from an earlier run to compare with
+ *           BREWTARGET_PERF_THRESHOLD  How much slower than the baseline (eg 0.3 for 30%) counts as a regression
+ *
+ *        So that one noisy run doesn't fail the build, a benchmark only fails if the median of its repeats is more
+ *        than the threshold slower than the baseline median AND a (one-sided Mann-Whitney U) test says the
+ *        difference is statistically significant.  Both sets of timings are first divided by the time taken by a
+ *        fixed calibration workload on the machine where they were recorded, so that a baseline recorded on one
+ *        machine is usable (within reason) on another.
+ *
+ *        A benchmark run by the perf gate with no entry in the baseline fails, so that the gate can't pass without
+ *        having compared anything.  To record a new baseline (src/unitTests/perfBaseline.json), build the
+ *        updatePerfBaseline target on the machine that runs the gate, which runs the same benchmarks against freshly
+ *        generated fixtures and writes the results (raw timings plus the calibration time they are normalised by) over
+ *        the checked-in file, then commit that.
+ */
+class Benchmarks : public QObject {
+   Q_OBJECT
+
+private slots:
+   void initTestCase();
+   void cleanupTestCase();
+
+   //! \brief Reading all objects of one type from the DB, via \c ObjectStore::loadAll
+   void loadAll_data();
+   void loadAll();
+
+   //! \brief BeerXML import of the default data.  As the DB already contains it, this measures reading, validation
+   //!        and duplicate detection rather than storing.
+   void importDefaultData();
+
+   //! \brief BeerXML import of a large file with records that are not yet in the DB
+   void importLargeSyntheticFile();
+
+   void recalcAll();
+
+   //! \brief Building the recipe tree (which calls \c BtTreeModel::loadTreeModel)
+   void loadTreeModel();
+
+   //! \brief Parsing of amounts typed in by the user, via \c Measurement::qStringToSI
+   void qStringToSI();
+
+   //! \brief HTML generation for printing / preview, via \c RecipeFormatter::getHtmlFormat
+   void recipeHtml();
+
+   //! \brief Filling a \c FermentableTableModel with all the fermentables, one row at a time (as when they arrive one
+   //!        by one from \c ObjectStore signals) and with the bulk \c FermentableTableModel::addFermentables
+   void tableModelPopulate_data();
+   void tableModelPopulate();
+
+   //! \brief Time to commit a one-column update (as when the user edits one field) in each
+   //!        \c Database::SqliteJournalMode, on a copy of the DB
+   void sqliteUpdateLatency_data();
+   void sqliteUpdateLatency();
+
+   //! \brief Reading all objects of all the main types from the synthetic DB
+   void coldLoad();
+
+   //! \brief 10,000 calls to \c Recipe::recalcAll, spread over the synthetic recipes
+   void recalcAll10k();
+
+   //! \brief Building the recipe tree for the synthetic DB
+   void buildLargeTree();
+
+   //! \brief BeerXML import of the 1000 synthetic recipes (and their ingredients).  The DB already contains the
+   //!        originals, so each run imports a copy with every name changed, meaning all the records are new and get
+   //!        stored (after being checked against everything already in the DB, which is where O(n²) lookups hurt).
+   //!        Because this adds to the DB, it must come after the other benchmarks that use the synthetic DB.
+   void import1kRecipes();
+
+   //! \brief Not a timing: records (and optionally checks) approximate memory use once everything is loaded
+   void memoryUsage();
+
+private:
+   /**
+    * \brief Time \c iterations runs of \c operation, report the result to QtTest and record it for the JSON output
+    *
+    * \param warmUp If \c true, run \c operation once, untimed, before the timed runs
+    */
+   void runBenchmark(QString const & name, int iterations, bool warmUp, std::function<void()> const & operation);
+
+   /**
+    * \brief If we have a baseline, fail if \c samplesNsPerOp for benchmark \c name are a significant regression on it
+    */
+   void checkAgainstBaseline(QString const & name, QVector<double> const & samplesNsPerOp);
+
+   //! \return A recipe from the default data with some ingredients, or \c nullptr if there isn't one
+   Recipe * findRecipeWithIngredients() const;
+
+   //! Where the DB (and any other files) for this run live.  Deleted when we finish.
+   QTemporaryDir userDataDir;
+
+   QJsonObject results;
+   QJsonObject memoryResults;
+
+   //! Directory containing the synthetic DB and BeerXML file, or empty if we don't have them
+   QString fixtureDir;
+   //! How many times we time each benchmark
+   int repeats = 1;
+   //! Results file we are comparing against, or empty if none
+   QJsonObject baseline;
+   //! Eg 0.3 means 30% slower than the baseline is a regression
+   double regressionThreshold = 0.0;
+   //! Time taken by the calibration workload on this machine
+   qint64 calibrationNs = 0;
+   //! Set once \c import1kRecipes has added to the synthetic DB, after which the other benchmarks on it are invalid
+   bool fixtureDbModified = false;
+};
+
+#endif
@@ -0,0 +1,476 @@
+/*
+ * unitTests/DatabaseStressTest.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "DatabaseStressTest.h"
+
+#include <atomic>
+#include <iostream> // For std::cout
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <xercesc/util/PlatformUtils.hpp>
+
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlRecord>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+
+#include "brewtarget.h"
+#include "database/BtSqlQuery.h"
+#include "database/Database.h"
+#include "database/DbTransaction.h"
+#include "Logging.h"
+#include "PersistentSettings.h"
+
+namespace {
+   //! How many DB operations each worker thread does in each test
+   int constexpr OPERATIONS_PER_THREAD = 500;
+
+   //! If no worker has completed an operation for this long, we assume they are deadlocked
+   qint64 constexpr DEADLOCK_TIMEOUT_MS = 60 * 1000;
+
+   //
+   // How long SQLite waits for a lock before failing with "database is locked".  The default in Qt is 5 seconds, which,
+   // if the DB is in Database::SqliteJournalMode::Exclusive mode (where the main connection holds an exclusive lock),
+   // would just make every write take 5 seconds to fail.  This needs to be well under DEADLOCK_TIMEOUT_MS.
+   //
+   int constexpr SQLITE_BUSY_TIMEOUT_MS = 250;
+
+   //! Once a worker has had this many lock errors, it stops trying to write and just does reads
+   int constexpr MAX_LOCK_ERRORS_PER_THREAD = 3;
+
+   //! If the hop table has fewer rows than this, we add some before starting
+   int constexpr MIN_SHARED_ROWS = 10;
+
+   //! Everything a worker inserts has a name starting with this, so we can tidy up afterwards
+   char const * const INSERTED_NAME_PREFIX = "Stress test";
+
+   //! Used to pick the type of operation; the numbers are percentages
+   int constexpr READ_PERCENT   = 60;
+   int constexpr UPDATE_PERCENT = 20;
+
+   /**
+    * \brief Returns \c true if the error means the DB (or a row in it) was locked by another connection, ie something
+    *        we would expect to happen sometimes when several connections are writing, as opposed to a bug.
+    */
+   bool isLockError(Database::DbType dbType, QSqlError const & error) {
+      QString const code = error.nativeErrorCode();
+      if (dbType == Database::PGSQL) {
+         // deadlock_detected, lock_not_available
+         return code == "40P01" || code == "55P03";
+      }
+      // SQLITE_BUSY, SQLITE_LOCKED
+      return code == "5" || code == "6";
+   }
+
+   /**
+    * \brief One worker thread.  It has no signals or slots, so no need for Q_OBJECT.
+    */
+   class StressWorker : public QThread {
+   public:
+      StressWorker(Database & database,
+                   int workerNumber,
+                   QVector<int> const & sharedIds,
+                   std::atomic<qint64> & progress) :
+         database{database},
+         workerNumber{workerNumber},
+         sharedIds{sharedIds},
+         progress{progress} {
+         return;
+      }
+
+      //! IDs of rows this worker inserted, and what it last wrote to their notes
+      QHash<int, QString> ownRows;
+      int numReads = 0;
+      int numUpdates = 0;
+      int numInserts = 0;
+      int numLockErrors = 0;
+      QStringList otherErrors;
+
+   protected:
+      virtual void run() override {
+         {
+            // This needs to be out of scope before we call closeConnectionForThisThread()
+            QSqlDatabase connection = this->database.sqlDatabase();
+            if (!connection.isOpen()) {
+               this->otherErrors.append(QString{"Could not open connection: %1"}.arg(connection.lastError().text()));
+               return;
+            }
+            if (this->database.dbType() == Database::SQLITE) {
+               BtSqlQuery pragma{connection};
+               pragma.exec(QString{"PRAGMA busy_timeout = %1"}.arg(SQLITE_BUSY_TIMEOUT_MS));
+            }
+
+            // Every column apart from the primary key, for copying one row into a new one
+            QStringList columns;
+            QSqlRecord const hopRecord = connection.record("hop");
+            for (int ii = 0; ii < hopRecord.count(); ++ii) {
+               if (hopRecord.fieldName(ii) != "id") {
+                  columns.append(hopRecord.fieldName(ii));
+               }
+            }
+
+            // Seeding by worker number means a given test does the same sequence of operations each time
+            std::mt19937 randomGenerator{static_cast<std::mt19937::result_type>(this->workerNumber)};
+            std::uniform_int_distribution<int> percentDistribution{0, 99};
+
+            for (int ii = 0; ii < OPERATIONS_PER_THREAD; ++ii) {
+               int const operation = percentDistribution(randomGenerator);
+               bool const canWrite = this->numLockErrors < MAX_LOCK_ERRORS_PER_THREAD;
+               if (operation < READ_PERCENT || !canWrite) {
+                  this->doRead(connection, this->randomId(randomGenerator));
+               } else if (operation < READ_PERCENT + UPDATE_PERCENT) {
+                  this->doUpdate(connection, ii, randomGenerator);
+               } else {
+                  this->doInsert(connection, ii, columns, randomGenerator);
+               }
+               this->progress.fetch_add(1, std::memory_order_relaxed);
+            }
+         }
+         this->database.closeConnectionForThisThread();
+         return;
+      }
+
+   private:
+      int randomId(std::mt19937 & randomGenerator) {
+         std::uniform_int_distribution<int> indexDistribution{0, this->sharedIds.size() - 1};
+         return this->sharedIds.at(indexDistribution(randomGenerator));
+      }
+
+      void recordError(QString const & what, QSqlError const & error) {
+         if (isLockError(this->database.dbType(), error)) {
+            ++this->numLockErrors;
+         } else {
+            this->otherErrors.append(QString{"%1: %2"}.arg(what).arg(error.text()));
+         }
+         return;
+      }
+
+      void doRead(QSqlDatabase & connection, int id) {
+         BtSqlQuery sqlQuery{connection};
+         sqlQuery.prepare("SELECT * FROM hop WHERE id = :id;");
+         sqlQuery.bindValue(":id", id);
+         if (!sqlQuery.exec()) {
+            this->recordError(QString{"Read hop #%1"}.arg(id), sqlQuery.lastError());
+            return;
+         }
+         sqlQuery.next();
+         ++this->numReads;
+         return;
+      }
+
+      /**
+       * \brief Half the time, update the notes on one of our own rows (if we have any), which we can check afterwards.
+       *        Otherwise, do a no-op update of a row that other threads are also updating, to make the threads contend
+       *        for the same rows.
+       */
+      void doUpdate(QSqlDatabase & connection, int operationNumber, std::mt19937 & randomGenerator) {
+         bool const updateOwnRow = !this->ownRows.isEmpty() && randomGenerator() % 2 == 0;
+         int id;
+         QString notes;
+         BtSqlQuery sqlQuery{connection};
+         if (updateOwnRow) {
+            id = this->ownRows.keys().at(static_cast<int>(randomGenerator() % this->ownRows.size()));
+            notes = QString{"Updated by worker %1 in operation %2"}.arg(this->workerNumber).arg(operationNumber);
+            sqlQuery.prepare("UPDATE hop SET notes = :notes WHERE id = :id;");
+            sqlQuery.bindValue(":notes", notes);
+         } else {
+            id = this->randomId(randomGenerator);
+            sqlQuery.prepare("UPDATE hop SET alpha = alpha WHERE id = :id;");
+         }
+         sqlQuery.bindValue(":id", id);
+
+         DbTransaction dbTransaction{this->database, connection};
+         if (!sqlQuery.exec()) {
+            this->recordError(QString{"Update hop #%1"}.arg(id), sqlQuery.lastError());
+            return;
+         }
+         if (!dbTransaction.commit()) {
+            this->recordError(QString{"Commit update of hop #%1"}.arg(id), connection.lastError());
+            return;
+         }
+         if (updateOwnRow) {
+            this->ownRows.insert(id, notes);
+         }
+         ++this->numUpdates;
+         return;
+      }
+
+      void doInsert(QSqlDatabase & connection,
+                    int operationNumber,
+                    QStringList const & columns,
+                    std::mt19937 & randomGenerator) {
+         int const templateId = this->randomId(randomGenerator);
+         QString const name =
+            QString{"%1 %2.%3"}.arg(INSERTED_NAME_PREFIX).arg(this->workerNumber).arg(operationNumber);
+         QString const notes = QString{"Inserted by worker %1"}.arg(this->workerNumber);
+
+         QStringList selectColumns;
+         for (auto const & column : columns) {
+            selectColumns.append(column == "name" ? ":name" : column == "notes" ? ":notes" : column);
+         }
+         BtSqlQuery sqlQuery{connection};
+         sqlQuery.prepare(
+            QString{"INSERT INTO hop (%1) SELECT %2 FROM hop WHERE id = :templateId;"}.arg(
+               columns.join(", ")
+            ).arg(
+               selectColumns.join(", ")
+            )
+         );
+         sqlQuery.bindValue(":name", name);
+         sqlQuery.bindValue(":notes", notes);
+         sqlQuery.bindValue(":templateId", templateId);
+         if (!sqlQuery.exec()) {
+            this->recordError(QString{"Insert copy of hop #%1"}.arg(templateId), sqlQuery.lastError());
+            return;
+         }
+         this->ownRows.insert(sqlQuery.lastInsertId().toInt(), notes);
+         ++this->numInserts;
+         return;
+      }
+
+      Database & database;
+      int const workerNumber;
+      QVector<int> const & sharedIds;
+      std::atomic<qint64> & progress;
+   };
+
+   /**
+    * \brief Returns IDs of the rows in the hop table, adding some rows first if there aren't enough (eg because this
+    *        is a new PostgreSQL DB).
+    */
+   QVector<int> getSharedIds(QSqlDatabase & connection) {
+      QVector<int> ids;
+      BtSqlQuery sqlQuery{connection};
+      if (sqlQuery.exec("SELECT id FROM hop;")) {
+         while (sqlQuery.next()) {
+            ids.append(sqlQuery.value(0).toInt());
+         }
+      }
+      while (ids.size() < MIN_SHARED_ROWS) {
+         BtSqlQuery insertQuery{connection};
+         insertQuery.prepare("INSERT INTO hop (name) VALUES (:name);");
+         insertQuery.bindValue(":name", QString{"%1 shared %2"}.arg(INSERTED_NAME_PREFIX).arg(ids.size()));
+         if (!insertQuery.exec()) {
+            qWarning() << Q_FUNC_INFO << "Could not add row to hop table:" << insertQuery.lastError().text();
+            break;
+         }
+         ids.append(insertQuery.lastInsertId().toInt());
+      }
+      return ids;
+   }
+}
+
+QTEST_MAIN(DatabaseStressTest)
+
+void DatabaseStressTest::initTestCase() {
+   // Initialize Xerces XML tools
+   try {
+      xercesc::XMLPlatformUtils::Initialize();
+   } catch (xercesc::XMLException const &) {
+      QFAIL("Xerces XML Parser Initialisation Failed");
+   }
+
+   QVERIFY(this->userDataDir.isValid());
+
+   // Use separate settings from the real application, the unit tests and the benchmarks
+   QCoreApplication::setOrganizationDomain("brewtarget.com/stress");
+   QCoreApplication::setApplicationName("brewtarget-stress");
+   PersistentSettings::initialise(this->userDataDir.path());
+
+   Logging::initializeLogging();
+   Logging::setLogLevel(Logging::LogLevel_WARNING);
+   Logging::setDirectory(this->userDataDir.path(), Logging::NewDirectoryIsTemporary);
+
+   Brewtarget::setInteractive(false);
+   QVERIFY(Brewtarget::initialize());
+   return;
+}
+
+void DatabaseStressTest::cleanupTestCase() {
+   if (!qgetenv("BREWTARGET_STRESS_PGSQL_HOST").isEmpty()) {
+      Database::instance(Database::PGSQL).unload();
+   }
+   Brewtarget::cleanup();
+   Logging::terminateLogging();
+   QSettings().clear();
+   xercesc::XMLPlatformUtils::Terminate();
+   return;
+}
+
+void DatabaseStressTest::addThreadCountRows() {
+   QTest::addColumn<int>("numThreads");
+   for (int numThreads : {1, 2, 4, 8}) {
+      QTest::newRow(QString{"%1 threads"}.arg(numThreads).toUtf8().constData()) << numThreads;
+   }
+   return;
+}
+
+void DatabaseStressTest::runStressTest(Database & database, QString const & dbName) {
+   QFETCH(int, numThreads);
+
+   QSqlDatabase mainConnection = database.sqlDatabase();
+   QVector<int> const sharedIds = getSharedIds(mainConnection);
+   QVERIFY(sharedIds.size() >= MIN_SHARED_ROWS);
+
+   std::atomic<qint64> progress{0};
+   std::vector<std::unique_ptr<StressWorker>> workers;
+   for (int ii = 0; ii < numThreads; ++ii) {
+      workers.push_back(std::make_unique<StressWorker>(database, ii, sharedIds, progress));
+   }
+
+   QElapsedTimer timer;
+   timer.start();
+   for (auto & worker : workers) {
+      worker->start();
+   }
+
+   qint64 lastProgress = -1;
+   QElapsedTimer sinceLastProgress;
+   sinceLastProgress.start();
+   for (auto & worker : workers) {
+      while (!worker->wait(100)) {
+         qint64 const currentProgress = progress.load(std::memory_order_relaxed);
+         if (currentProgress != lastProgress) {
+            lastProgress = currentProgress;
+            sinceLastProgress.restart();
+         } else if (sinceLastProgress.elapsed() > DEADLOCK_TIMEOUT_MS) {
+            //
+            // There's no safe way to stop threads that are stuck inside DB calls, and we can't clean up while they are
+            // still running, so bail out of the whole run.
+            //
+            qFatal(
+               "%s: no progress from %d worker threads for %lld ms -- probable deadlock",
+               Q_FUNC_INFO,
+               numThreads,
+               DEADLOCK_TIMEOUT_MS
+            );
+         }
+      }
+   }
+   qint64 const elapsedNs = timer.nsecsElapsed();
+
+   int numReads = 0;
+   int numUpdates = 0;
+   int numInserts = 0;
+   int numLockErrors = 0;
+   QStringList otherErrors;
+   for (auto const & worker : workers) {
+      numReads      += worker->numReads;
+      numUpdates    += worker->numUpdates;
+      numInserts    += worker->numInserts;
+      numLockErrors += worker->numLockErrors;
+      otherErrors   += worker->otherErrors;
+   }
+
+   int const numOperations = numReads + numUpdates + numInserts;
+   double const opsPerSecond = elapsedNs > 0 ? numOperations * 1.0e9 / static_cast<double>(elapsedNs) : 0.0;
+   std::cout <<
+      dbName.toStdString() << ", " << numThreads << " thread(s): " << numOperations << " operations (" <<
+      numReads << " reads, " << numUpdates << " updates, " << numInserts << " inserts) in " <<
+      elapsedNs / 1000000 << " ms, " << opsPerSecond << " ops/s total, " << opsPerSecond / numThreads <<
+      " ops/s per thread, " << numLockErrors << " lock errors" << std::endl;
+
+   //
+   // Check that everything each worker wrote is what's now in the DB.  (No two workers write to the same row's name or
+   // notes, so there's no ambiguity about what the last write was.)
+   //
+   int numMismatches = 0;
+   for (auto const & worker : workers) {
+      for (auto ownRow = worker->ownRows.cbegin(); ownRow != worker->ownRows.cend(); ++ownRow) {
+         BtSqlQuery sqlQuery{mainConnection};
+         sqlQuery.prepare("SELECT notes FROM hop WHERE id = :id;");
+         sqlQuery.bindValue(":id", ownRow.key());
+         if (!sqlQuery.exec() || !sqlQuery.next() || sqlQuery.value(0).toString() != ownRow.value()) {
+            qWarning() << Q_FUNC_INFO << "Hop #" << ownRow.key() << "does not have notes" << ownRow.value();
+            ++numMismatches;
+         }
+      }
+   }
+
+   // Tidy up before any of the checks can end the test
+   BtSqlQuery deleteQuery{mainConnection};
+   deleteQuery.prepare("DELETE FROM hop WHERE name LIKE :prefix;");
+   deleteQuery.bindValue(":prefix", QString{"%1 %"}.arg(INSERTED_NAME_PREFIX));
+   deleteQuery.exec();
+
+   QVERIFY2(otherErrors.isEmpty(), otherErrors.join("\n").toUtf8().constData());
+   QCOMPARE(numMismatches, 0);
+
+   if (database.dbType() == Database::SQLITE) {
+      BtSqlQuery pragma{mainConnection};
+      if (pragma.exec("PRAGMA locking_mode;") && pragma.next() &&
+          pragma.value(0).toString().compare("exclusive", Qt::CaseInsensitive) == 0) {
+         QEXPECT_FAIL(
+            "",
+            "The main connection uses locking_mode = EXCLUSIVE, so no other connection can write to the DB",
+            Continue
+         );
+      }
+   }
+   QCOMPARE(numLockErrors, 0);
+   return;
+}
+
+void DatabaseStressTest::sqlite_data() {
+   this->addThreadCountRows();
+   return;
+}
+
+void DatabaseStressTest::sqlite() {
+   this->runStressTest(Database::instance(Database::SQLITE), "SQLite");
+   return;
+}
+
+void DatabaseStressTest::postgresql_data() {
+   this->addThreadCountRows();
+   return;
+}
+
+void DatabaseStressTest::postgresql() {
+   QString const host = QString::fromLocal8Bit(qgetenv("BREWTARGET_STRESS_PGSQL_HOST"));
+   if (host.isEmpty()) {
+      QSKIP("Set BREWTARGET_STRESS_PGSQL_HOST etc to run against PostgreSQL");
+   }
+   auto envOrDefault = [](char const * name, QString const & defaultValue) {
+      QString const value = QString::fromLocal8Bit(qgetenv(name));
+      return value.isEmpty() ? defaultValue : value;
+   };
+   // These are only read the first time we ask for the PostgreSQL Database object, but it's harmless to set them again
+   PersistentSettings::insert(PersistentSettings::Names::dbHostname, host);
+   PersistentSettings::insert(PersistentSettings::Names::dbPortnum,
+                              envOrDefault("BREWTARGET_STRESS_PGSQL_PORT", "5432").toInt());
+   PersistentSettings::insert(PersistentSettings::Names::dbName,
+                              envOrDefault("BREWTARGET_STRESS_PGSQL_NAME", "brewtarget"));
+   PersistentSettings::insert(PersistentSettings::Names::dbSchema,
+                              envOrDefault("BREWTARGET_STRESS_PGSQL_SCHEMA", "public"));
+   PersistentSettings::insert(PersistentSettings::Names::dbUsername,
+                              envOrDefault("BREWTARGET_STRESS_PGSQL_USER", "brewtarget"));
+   PersistentSettings::insert(PersistentSettings::Names::dbPassword,
+                              envOrDefault("BREWTARGET_STRESS_PGSQL_PASSWORD", ""));
+
+   Database & database = Database::instance(Database::PGSQL);
+   QVERIFY(database.loadSuccessful());
+   this->runStressTest(database, "PostgreSQL");
+   return;
+}
@@ -0,0 +1,71 @@
+/*
+ * unitTests/DatabaseStressTest.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UNITTESTS_DATABASESTRESSTEST_H
+#define UNITTESTS_DATABASESTRESSTEST_H
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class Database;
+
+/**
+ * \brief Hammers the per-thread DB connections that \c Database::sqlDatabase() hands out, to check that several
+ *        threads can use the DB at once.  Each test runs 1, 2, 4 and 8 worker threads, each doing a mix of reads,
+ *        single-column updates (the SQL that \c ObjectStore::updateProperty does) and inserts, and reports the
+ *        throughput for each number of threads.  A test fails if:
+ *          - the workers stop making progress (ie there is probably a deadlock);
+ *          - a DB call fails because the DB is locked or busy;
+ *          - any other DB call fails;
+ *          - the rows a worker wrote are not what it wrote.
+ *
+ *        The workers talk to the DB directly through their connections rather than via \c ObjectStore, as the object
+ *        stores are (by design) only used from the main thread.
+ *
+ *        This is built as a separate executable from the unit tests and labelled "stress" in ctest.  It is most useful
+ *        when built with -DSANITIZE_THREAD=ON, so that ThreadSanitizer can report data races.
+ *
+ *        SQLite tests run against a temporary copy of the default DB.  PostgreSQL tests are skipped unless the
+ *        BREWTARGET_STRESS_PGSQL_HOST environment variable is set, in which case BREWTARGET_STRESS_PGSQL_PORT, _NAME,
+ *        _SCHEMA, _USER and _PASSWORD are also read.  The PostgreSQL DB should be a throwaway one, as the test will
+ *        create the Brewtarget schema in it if it is empty.
+ */
+class DatabaseStressTest : public QObject {
+   Q_OBJECT
+
+private slots:
+   void initTestCase();
+   void cleanupTestCase();
+
+   void sqlite_data();
+   void sqlite();
+
+   void postgresql_data();
+   void postgresql();
+
+private:
+   void addThreadCountRows();
+   void runStressTest(Database & database, QString const & dbName);
+
+   //! Where the SQLite DB (and any other files) for this run live.  Deleted when we finish.
+   QTemporaryDir userDataDir;
+};
+
+#endif
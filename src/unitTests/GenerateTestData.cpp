@@ -0,0 +1,460 @@
+/*
+ * unitTests/GenerateTestData.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file GenerateTestData.cpp
+ *
+ * \brief Stand-alone tool to make a large, but valid, database (and optionally a matching BeerXML file) for testing
+ *        how the program behaves at scale -- eg start-up time, building the tree views, BeerXML import.  Everything
+ *        is created through the normal \c ObjectStore code, so the result is exactly what the program itself would
+ *        have written.
+ *
+ *        The output is a user data directory that can be used with the main program's --user-dir option, eg:
+ *
+ *           bin/brewtarget_generateTestData --output-dir /tmp/bt100x --recipes 20000 --ingredients 2000
+ *           brewtarget --user-dir /tmp/bt100x
+ *
+ *        For the same seed and options, the generated data (other than the creation timestamps) is always the same.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#include <xercesc/util/PlatformUtils.hpp>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDate>
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QSqlDatabase>
+#include <QStringList>
+
+#include "brewtarget.h"
+#include "config.h"
+#include "database/Database.h"
+#include "database/DbTransaction.h"
+#include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
+#include "model/BrewNote.h"
+#include "model/Equipment.h"
+#include "model/Fermentable.h"
+#include "model/Hop.h"
+#include "model/Mash.h"
+#include "model/MashStep.h"
+#include "model/Misc.h"
+#include "model/Recipe.h"
+#include "model/Style.h"
+#include "model/Yeast.h"
+#include "PersistentSettings.h"
+#include "xml/BeerXml.h"
+
+namespace {
+
+   /**
+    * \brief Random numbers that are the same for a given seed on every platform.  (The standard library engines are
+    *        fully specified, but the distributions, eg \c std::uniform_int_distribution, are not, which is why we do
+    *        our own scaling here.)
+    */
+   class SeededRandom {
+   public:
+      SeededRandom(std::uint32_t seed) : engine{seed} {
+         return;
+      }
+
+      //! \return A number in the range [minimum, maximum]
+      int intInRange(int minimum, int maximum) {
+         if (maximum <= minimum) {
+            return minimum;
+         }
+         std::uint64_t const range = static_cast<std::uint64_t>(maximum - minimum) + 1;
+         return minimum + static_cast<int>(this->engine() % range);
+      }
+
+      //! \return A number in the range [minimum, maximum)
+      double doubleInRange(double minimum, double maximum) {
+         double const fraction = static_cast<double>(this->engine()) / (static_cast<double>(std::mt19937::max()) + 1.0);
+         return minimum + fraction * (maximum - minimum);
+      }
+
+      template<class T> T * pick(QList<T *> const & list) {
+         return list.isEmpty() ? nullptr : list.at(this->intInRange(0, list.size() - 1));
+      }
+
+   private:
+      std::mt19937 engine;
+   };
+
+   /**
+    * \brief What to generate, as set on the command line
+    */
+   struct Parameters {
+      std::uint32_t seed;
+      //! Number of "current" recipes -- ie not counting previous versions
+      int numRecipes;
+      //! Number of each type of ingredient (hop, fermentable, misc, yeast)
+      int numIngredients;
+      int maxIngredientsPerRecipe;
+      int maxBrewNotesPerRecipe;
+      //! Maximum number of previous versions of each recipe
+      int maxAncestryDepth;
+      int folderDepth;
+      int foldersPerLevel;
+   };
+
+   //! \return All the folder paths in a tree \c depth levels deep, with \c perLevel sub-folders in each folder
+   QStringList makeFolderPaths(int depth, int perLevel) {
+      // Things not in any folder are at the top level of the tree
+      QStringList allPaths{""};
+      QStringList currentLevel{"/Synthetic"};
+      for (int level = 1; level <= depth; ++level) {
+         allPaths.append(currentLevel);
+         QStringList nextLevel;
+         for (auto const & path : currentLevel) {
+            for (int ii = 1; ii <= perLevel; ++ii) {
+               nextLevel.append(QString{"%1/Level %2 Folder %3"}.arg(path).arg(level).arg(ii));
+            }
+         }
+         currentLevel = nextLevel;
+      }
+      return allPaths;
+   }
+
+   /**
+    * \brief Ingredients that recipes can then use.  Each is created with whatever properties are specific to it set to
+    *        plausible values, then inserted in the DB.
+    */
+   template<class NE> QList<NE *> makeIngredients(Parameters const & parameters,
+                                                 QStringList const & folders,
+                                                 SeededRandom & random,
+                                                 std::function<void(NE &)> const & setProperties) {
+      QList<NE *> ingredients;
+      for (int ii = 1; ii <= parameters.numIngredients; ++ii) {
+         auto ingredient = std::make_shared<NE>(
+            QString{"Synthetic %1 %2"}.arg(NE::staticMetaObject.className()).arg(ii)
+         );
+         ingredient->setFolder(folders.at(random.intInRange(0, folders.size() - 1)));
+         setProperties(*ingredient);
+         ObjectStoreWrapper::insert(ingredient);
+         ingredients.append(ingredient.get());
+      }
+      qInfo() << "Created" << ingredients.size() << NE::staticMetaObject.className() << "records";
+      return ingredients;
+   }
+
+   template<class NE> void addRandomIngredient(Recipe & recipe,
+                                               QList<NE *> const & ingredients,
+                                               SeededRandom & random) {
+      if (!ingredients.isEmpty()) {
+         // Recipe::add makes the "instance of use of" copy of the ingredient for us
+         recipe.add<NE>(ObjectStoreWrapper::getSharedFromRaw(random.pick(ingredients)));
+      }
+      return;
+   }
+
+   std::shared_ptr<Mash> makeMash(QString const & name, SeededRandom & random) {
+      auto mash = std::make_shared<Mash>(name);
+      ObjectStoreWrapper::insert(mash);
+
+      auto saccharification = std::make_shared<MashStep>("Saccharification");
+      saccharification->setType(MashStep::Infusion);
+      saccharification->setInfuseAmount_l(random.doubleInRange(12.0, 25.0));
+      saccharification->setStepTemp_c(random.doubleInRange(62.0, 70.0));
+      saccharification->setStepTime_min(random.intInRange(45, 90));
+      ObjectStoreWrapper::insert(saccharification);
+      mash->addMashStep(saccharification);
+
+      auto mashOut = std::make_shared<MashStep>("Mash Out");
+      mashOut->setType(MashStep::Temperature);
+      mashOut->setStepTemp_c(76.0);
+      mashOut->setStepTime_min(10);
+      ObjectStoreWrapper::insert(mashOut);
+      mash->addMashStep(mashOut);
+
+      return mash;
+   }
+
+   /**
+    * \brief Create one recipe, with its ingredients, mash, brew notes and previous versions
+    *
+    * \return The current version of the recipe
+    */
+   Recipe * makeRecipe(int number,
+                       Parameters const & parameters,
+                       QStringList const & folders,
+                       SeededRandom & random,
+                       QList<Hop *> const & hops,
+                       QList<Fermentable *> const & fermentables,
+                       QList<Misc *> const & miscs,
+                       QList<Yeast *> const & yeasts,
+                       QList<Style *> const & styles,
+                       QList<Equipment *> const & equipments) {
+      // Doing each recipe in one transaction makes this a lot faster (on SQLite at least) than having a transaction
+      // for each individual insert and update.
+      Database & database = Database::instance();
+      QSqlDatabase connection = database.sqlDatabase();
+      DbTransaction dbTransaction{database, connection};
+
+      auto recipe = std::make_shared<Recipe>(QString{"Synthetic Recipe %1"}.arg(number));
+      recipe->setFolder(folders.at(random.intInRange(0, folders.size() - 1)));
+      recipe->setBatchSize_l(random.doubleInRange(10.0, 40.0));
+      recipe->setBoilSize_l(recipe->batchSize_l() * 1.2);
+      recipe->setBoilTime_min(random.intInRange(6, 18) * 5);
+      recipe->setEfficiency_pct(random.doubleInRange(65.0, 80.0));
+      ObjectStoreWrapper::insert(recipe);
+
+      recipe->setStyle(random.pick(styles));
+      recipe->setEquipment(random.pick(equipments));
+      recipe->setMash(makeMash(QString{"Synthetic Mash %1"}.arg(number), random));
+
+      // Always at least one fermentable, one hop and one yeast, so that the recipe calculations have something to do
+      int const numIngredients = random.intInRange(3, std::max(3, parameters.maxIngredientsPerRecipe));
+      for (int ii = 0; ii < numIngredients; ++ii) {
+         switch (ii < 3 ? ii : random.intInRange(0, 3)) {
+            case 0:  addRandomIngredient(*recipe, fermentables, random); break;
+            case 1:  addRandomIngredient(*recipe, hops,         random); break;
+            case 2:  addRandomIngredient(*recipe, yeasts,       random); break;
+            default: addRandomIngredient(*recipe, miscs,        random); break;
+         }
+      }
+
+      //
+      // Previous versions are made the same way as automatic versioning does it: copy the recipe, then make the copy
+      // the ancestor of the original.  Brew notes go on the oldest versions first, as they would if the recipe had
+      // been brewed and then tweaked over time.
+      //
+      QDate brewDate = QDate{2015, 1, 1}.addDays(random.intInRange(0, 365));
+      int const ancestryDepth = random.intInRange(0, parameters.maxAncestryDepth);
+      for (int generation = 0; generation <= ancestryDepth; ++generation) {
+         int const numBrewNotes = random.intInRange(0, parameters.maxBrewNotesPerRecipe);
+         for (int ii = 0; ii < numBrewNotes; ++ii) {
+            auto brewNote = std::make_shared<BrewNote>(*recipe);
+            brewNote->populateNote(recipe.get());
+            brewNote->setBrewDate(brewDate);
+            brewNote->setFermentDate(brewDate.addDays(random.intInRange(7, 21)));
+            ObjectStoreWrapper::insert(brewNote);
+            brewDate = brewDate.addDays(random.intInRange(14, 120));
+         }
+
+         if (generation < ancestryDepth) {
+            auto previousVersion = std::make_shared<Recipe>(*recipe);
+            ObjectStoreWrapper::insert(previousVersion);
+            recipe->setAncestor(*previousVersion);
+         }
+      }
+
+      dbTransaction.commit();
+      return recipe.get();
+   }
+
+   /**
+    * \brief Write what we generated to a BeerXML file, eg for testing import
+    */
+   bool writeBeerXml(QString const & fileName,
+                     QList<Hop *> & hops,
+                     QList<Fermentable *> & fermentables,
+                     QList<Yeast *> & yeasts,
+                     QList<Misc *> & miscs,
+                     QList<Recipe *> & recipes) {
+      QFile outFile{fileName};
+      if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+         qCritical() << Q_FUNC_INFO << "Could not open" << fileName << "for writing:" << outFile.errorString();
+         return false;
+      }
+      BeerXML & bxml = BeerXML::getInstance();
+      bxml.createXmlFile(outFile);
+      // Same order as in the BeerXML 1.0 spec -- see MainWindow::exportSelected()
+      bxml.toXml(hops,         outFile);
+      bxml.toXml(fermentables, outFile);
+      bxml.toXml(yeasts,       outFile);
+      bxml.toXml(miscs,        outFile);
+      bxml.toXml(recipes,      outFile);
+      outFile.close();
+      return true;
+   }
+}
+
+int main(int argc, char **argv) {
+   QCoreApplication app(argc, argv);
+   // Keep our settings well away from those of a real installation
+   app.setOrganizationDomain("brewtarget.com/generateTestData");
+   app.setApplicationName("brewtarget-generateTestData");
+   app.setApplicationVersion(VERSIONSTRING);
+
+   QCommandLineParser parser;
+   parser.setApplicationDescription(
+      "Generates a reproducible synthetic Brewtarget database (and optionally BeerXML file) for scale testing"
+   );
+   QCommandLineOption const outputDirOption(
+      "output-dir", "Create the database in <directory>, which must not already contain one", "directory"
+   );
+   parser.addOption(outputDirOption);
+   QCommandLineOption const beerXmlOption("beerxml", "Also write everything generated to BeerXML <file>", "file");
+   parser.addOption(beerXmlOption);
+   QCommandLineOption const seedOption("seed", "Random number seed", "number", "1");
+   parser.addOption(seedOption);
+   QCommandLineOption const recipesOption("recipes", "Number of recipes", "number", "1000");
+   parser.addOption(recipesOption);
+   QCommandLineOption const ingredientsOption(
+      "ingredients", "Number of each type of ingredient (hop, fermentable, misc, yeast)", "number", "200"
+   );
+   parser.addOption(ingredientsOption);
+   QCommandLineOption const ingredientsPerRecipeOption(
+      "ingredients-per-recipe", "Maximum number of ingredients in each recipe", "number", "12"
+   );
+   parser.addOption(ingredientsPerRecipeOption);
+   QCommandLineOption const brewNotesOption(
+      "brew-notes", "Maximum number of brew notes on each version of a recipe", "number", "2"
+   );
+   parser.addOption(brewNotesOption);
+   QCommandLineOption const ancestryDepthOption(
+      "ancestry-depth", "Maximum number of previous versions of each recipe", "number", "2"
+   );
+   parser.addOption(ancestryDepthOption);
+   QCommandLineOption const folderDepthOption("folder-depth", "How deeply folders are nested", "number", "3");
+   parser.addOption(folderDepthOption);
+   QCommandLineOption const foldersPerLevelOption(
+      "folders-per-level", "Number of sub-folders in each folder", "number", "3"
+   );
+   parser.addOption(foldersPerLevelOption);
+   parser.addHelpOption();
+   parser.addVersionOption();
+   parser.process(app);
+
+   if (!parser.isSet(outputDirOption)) {
+      std::cerr << "Must specify --" << outputDirOption.names().first().toStdString() << std::endl;
+      return EXIT_FAILURE;
+   }
+   QDir const outputDir{parser.value(outputDirOption)};
+   if (outputDir.exists("database.sqlite")) {
+      // Adding to an existing DB would make the result depend on what was already there
+      std::cerr << "There is already a database in " << outputDir.absolutePath().toStdString() << std::endl;
+      return EXIT_FAILURE;
+   }
+   if (!outputDir.mkpath(".")) {
+      std::cerr << "Could not create " << outputDir.absolutePath().toStdString() << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   Parameters const parameters{
+      parser.value(seedOption).toUInt(),
+      parser.value(recipesOption).toInt(),
+      parser.value(ingredientsOption).toInt(),
+      parser.value(ingredientsPerRecipeOption).toInt(),
+      parser.value(brewNotesOption).toInt(),
+      parser.value(ancestryDepthOption).toInt(),
+      parser.value(folderDepthOption).toInt(),
+      parser.value(foldersPerLevelOption).toInt()
+   };
+
+   PersistentSettings::initialise(outputDir.absolutePath());
+   Logging::initializeLogging();
+   // Otherwise we'd log every insert
+   Logging::setLogLevel(Logging::LogLevel_WARNING);
+
+   try {
+      xercesc::XMLPlatformUtils::Initialize();
+   } catch (xercesc::XMLException const & xercesInitException) {
+      qCritical() << Q_FUNC_INFO << "Xerces XML Parser Initialisation Failed: " << xercesInitException.getMessage();
+      return EXIT_FAILURE;
+   }
+
+   // Starting up normally creates a new DB from the default data, which gives us styles and equipment to use
+   Brewtarget::setInteractive(false);
+   if (!Brewtarget::initialize()) {
+      std::cerr << "Could not create database in " << outputDir.absolutePath().toStdString() << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   // We make previous versions of recipes ourselves, so we don't want automatic versioning making extra ones
+   RecipeHelper::SuspendRecipeVersioning suspendRecipeVersioning;
+
+   SeededRandom random{parameters.seed};
+   QStringList const folders = makeFolderPaths(parameters.folderDepth, parameters.foldersPerLevel);
+
+   QList<Hop *> hops = makeIngredients<Hop>(
+      parameters, folders, random, [&random](Hop & hop) {
+         hop.setAlpha_pct(random.doubleInRange(2.0, 18.0));
+         hop.setBeta_pct(random.doubleInRange(2.0, 10.0));
+         hop.setForm(static_cast<Hop::Form>(random.intInRange(Hop::Leaf, Hop::Plug)));
+         hop.setType(static_cast<Hop::Type>(random.intInRange(Hop::Bittering, Hop::Both)));
+         hop.setUse(Hop::Boil);
+         hop.setTime_min(random.intInRange(0, 12) * 5);
+         hop.setAmount_kg(random.doubleInRange(0.005, 0.1));
+      }
+   );
+   QList<Fermentable *> fermentables = makeIngredients<Fermentable>(
+      parameters, folders, random, [&random](Fermentable & fermentable) {
+         fermentable.setType(static_cast<Fermentable::Type>(random.intInRange(Fermentable::Grain,
+                                                                              Fermentable::Adjunct)));
+         fermentable.setYield_pct(random.doubleInRange(60.0, 82.0));
+         fermentable.setColor_srm(random.doubleInRange(1.5, 500.0));
+         fermentable.setAmount_kg(random.doubleInRange(0.1, 6.0));
+      }
+   );
+   QList<Misc *> miscs = makeIngredients<Misc>(
+      parameters, folders, random, [&random](Misc & misc) {
+         misc.setType(static_cast<Misc::Type>(random.intInRange(Misc::Spice, Misc::Other)));
+         misc.setUse(static_cast<Misc::Use>(random.intInRange(Misc::Boil, Misc::Bottling)));
+         misc.setTime(random.intInRange(0, 60));
+         misc.setAmount(random.doubleInRange(0.001, 0.05));
+      }
+   );
+   QList<Yeast *> yeasts = makeIngredients<Yeast>(
+      parameters, folders, random, [&random](Yeast & yeast) {
+         yeast.setType(static_cast<Yeast::Type>(random.intInRange(Yeast::Ale, Yeast::Champagne)));
+         yeast.setForm(static_cast<Yeast::Form>(random.intInRange(Yeast::Liquid, Yeast::Culture)));
+         yeast.setAttenuation_pct(random.doubleInRange(65.0, 85.0));
+         yeast.setAmount(random.doubleInRange(0.01, 0.2));
+      }
+   );
+
+   QList<Style *> const styles = ObjectStoreWrapper::getAllRaw<Style>();
+   QList<Equipment *> const equipments = ObjectStoreWrapper::getAllRaw<Equipment>();
+
+   QList<Recipe *> recipes;
+   for (int ii = 1; ii <= parameters.numRecipes; ++ii) {
+      recipes.append(
+         makeRecipe(ii, parameters, folders, random, hops, fermentables, miscs, yeasts, styles, equipments)
+      );
+      if (ii % 1000 == 0) {
+         qInfo() << "Created" << ii << "of" << parameters.numRecipes << "recipes";
+      }
+   }
+
+   int returnValue = EXIT_SUCCESS;
+   if (parser.isSet(beerXmlOption) &&
+       !writeBeerXml(parser.value(beerXmlOption), hops, fermentables, yeasts, miscs, recipes)) {
+      returnValue = EXIT_FAILURE;
+   }
+
+   std::cout <<
+      "Created " << recipes.size() << " recipes (plus previous versions) and " << hops.size() + fermentables.size() +
+      miscs.size() + yeasts.size() << " ingredients in " << outputDir.absolutePath().toStdString() << std::endl;
+
+   Database::instance().unload();
+   Logging::terminateLogging();
+   xercesc::XMLPlatformUtils::Terminate();
+   return returnValue;
+}
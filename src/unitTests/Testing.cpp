@@ -20,16 +20,32 @@
  */
 #include "Testing.h"
 
+#include <algorithm>
 #include <exception>
 #include <iostream> // For std::cout
+#include <limits>
 #include <math.h>
 #include <memory>
 
 #include <xercesc/util/PlatformUtils.hpp>
 
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QString>
+#include <QStringList>
+#include <QTableView>
+#include <QTemporaryDir>
+#include <QThread>
 #include <QtTest/QtTest>
 #if QT_VERSION < QT_VERSION_CHECK(5,10,0)
 #include <QtGlobal> // For qrand() -- which is superseded by QRandomGenerator in later versions of Qt
@@ -37,7 +53,19 @@
 #include <QRandomGenerator>
 #endif
 
+#include "database/Database.h"
+#include "database/DatabaseBackup.h"
+#include "database/DatabaseCompaction.h"
+#include "database/DatabaseMigration.h"
+#include "database/DatabaseSchemaHelper.h"
+#include "database/DatabaseWorkerPool.h"
+#include "database/DbTransaction.h"
+#include "database/DefaultDataManifest.h"
+#include "database/FullTextSearch.h"
+#include "database/ObjectStoreSnapshot.h"
+#include "database/ObjectStoreTyped.h"
 #include "database/ObjectStoreWrapper.h"
+#include "brewtarget.h"
 #include "Logging.h"
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
@@ -45,10 +73,18 @@
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
 #include "model/Hop.h"
+#include "model/Instruction.h"
 #include "model/Mash.h"
 #include "model/MashStep.h"
+#include "model/Misc.h"
 #include "model/Recipe.h"
+#include "model/Style.h"
+#include "model/Water.h"
+#include "model/Yeast.h"
 #include "PersistentSettings.h"
+#include "tableModels/FermentableTableModel.h"
+#include "utils/Metrics.h"
+#include "utils/Tracing.h"
 
 namespace {
 
@@ -84,6 +120,15 @@ namespace {
       return randSTR;
    }
 
+   //! \brief Records a span on its own thread, for testing \c Tracing
+   class SpanRecordingThread : public QThread {
+   protected:
+      virtual void run() override {
+         TRACE_SPAN("test", "Worker");
+         return;
+      }
+   };
+
 }
 
 //
@@ -412,6 +457,9 @@ void Testing::testLogRotation() {
    // Put logging back to normal
    Logging::setLoggingToStderr(true);
 
+   // Make sure everything we logged has actually been written out before we look at the files
+   Logging::flush();
+
    QFileInfoList fileList = Logging::getLogFileList();
    //There is always a "logFileCount" number of old files + 1 current file
    QCOMPARE(fileList.size(), Logging::logFileCount + 1);
@@ -425,6 +473,659 @@ void Testing::testLogRotation() {
    return;
 }
 
+void Testing::testLoggingCategoryLevels() {
+   auto savedLevels = []() {
+      return PersistentSettings::value(PersistentSettings::Names::LoggingCategoryLevels, "").toString();
+   };
+
+   // Levels set just for this run (as with --log-categories) are used...
+   QVERIFY(Logging::setCategoryLogLevels("db=DEBUG"));
+   QVERIFY(Logging::getCategoryLogLevel("db") == Logging::LogLevel_DEBUG);
+   QVERIFY(Logging::db().isDebugEnabled());
+
+   // ...but not saved, even when another category's level is
+   Logging::setCategoryLogLevel("xml", Logging::LogLevel_WARNING);
+   QVERIFY(savedLevels().contains("xml=WARNING"));
+   QVERIFY(!savedLevels().contains("db="));
+   QVERIFY(Logging::getCategoryLogLevel("db") == Logging::LogLevel_DEBUG);
+
+   // Setting the level explicitly replaces the one for this run
+   Logging::setCategoryLogLevel("db", std::nullopt);
+   QVERIFY(!Logging::getCategoryLogLevel("db"));
+
+   Logging::setCategoryLogLevel("xml", std::nullopt);
+   QVERIFY(!savedLevels().contains("xml="));
+   return;
+}
+
+void Testing::testFullTextSearch() {
+   auto recipe = std::make_shared<Recipe>(QString("Full-text search test"));
+   recipe->setNotes("Mash stuck badly; next time use rice hulls");
+   ObjectStoreWrapper::insert(recipe);
+   int const recipeId = recipe->key();
+
+   auto isFound = [recipeId](QString const & queryText) {
+      for (auto const & match : FullTextSearch::search(Database::instance(), queryText)) {
+         if (match.tableName == "recipe" && match.objectId == recipeId) {
+            return true;
+         }
+      }
+      return false;
+   };
+
+   if (FullTextSearch::isWordBased(Database::instance())) {
+      // Words can be in any order, and the last one is a prefix
+      QVERIFY(isFound("hulls stuck"));
+   } else {
+      // Without FTS5, the LIKE fallback only finds the text as it was typed
+      QVERIFY(isFound("stuck badly"));
+      QVERIFY(!isFound("hulls stuck"));
+   }
+   QVERIFY(isFound("rice hul"));
+   QVERIFY(!isFound("whirlpool"));
+
+   // Changing the notes should change what we find
+   recipe->setNotes("Whirlpool for 20 minutes");
+   QVERIFY(isFound("whirlpool"));
+   QVERIFY(!isFound("hulls"));
+
+   ObjectStoreWrapper::hardDelete(*recipe);
+   QVERIFY(!isFound("whirlpool"));
+   return;
+}
+
+void Testing::testDatabaseBackup() {
+   auto recipe = std::make_shared<Recipe>(QString("Database backup test"));
+   ObjectStoreWrapper::insert(recipe);
+
+   QTemporaryDir backupDir;
+   QVERIFY(backupDir.isValid());
+
+   // Returns true if the named recipe is in the SQLite DB in fileName
+   auto containsRecipe = [](QString const & fileName, QString const & recipeName) {
+      bool found = false;
+      {
+         QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", "testDatabaseBackup");
+         connection.setDatabaseName(fileName);
+         if (connection.open()) {
+            QSqlQuery query{connection};
+            query.prepare("SELECT id FROM recipe WHERE name = :name;");
+            query.bindValue(":name", recipeName);
+            found = query.exec() && query.next();
+            query.finish();
+            connection.close();
+         }
+      }
+      QSqlDatabase::removeDatabase("testDatabaseBackup");
+      return found;
+   };
+
+   QString const plainFileName = QDir{backupDir.path()}.filePath("backup.sqlite");
+   QVERIFY(Database::instance().backupToFile(plainFileName));
+   QVERIFY(!DatabaseBackup::isCompressed(plainFileName));
+   QVERIFY(containsRecipe(plainFileName, recipe->name()));
+
+   QString const compressedFileName = QDir{backupDir.path()}.filePath("backup.qz");
+   {
+      DatabaseBackup backup{Database::instance(), compressedFileName, true};
+      backup.start();
+      backup.wait();
+      QVERIFY2(backup.succeeded(), qPrintable(backup.errorMessage()));
+   }
+   QVERIFY(DatabaseBackup::isCompressed(compressedFileName));
+   QString const uncompressedFileName = QDir{backupDir.path()}.filePath("uncompressed.sqlite");
+   QVERIFY(DatabaseBackup::decompress(compressedFileName, uncompressedFileName));
+   QVERIFY(containsRecipe(uncompressedFileName, recipe->name()));
+
+   ObjectStoreWrapper::hardDelete(*recipe);
+   return;
+}
+
+void Testing::testDefaultDataManifest() {
+   QString const dataFileName = Brewtarget::getResourceDir().filePath("DefaultData.xml");
+   QFile dataFile{dataFileName};
+   QVERIFY(dataFile.open(QIODevice::ReadOnly));
+   QByteArray const dataFileContents = dataFile.readAll();
+
+   DefaultDataManifest const builtManifest = DefaultDataManifest::build(dataFileContents);
+   QVERIFY(!builtManifest.records().isEmpty());
+
+   // If this fails, copy the manifest it writes over data/DefaultData.manifest
+   std::optional<DefaultDataManifest> const shippedManifest =
+      DefaultDataManifest::read(DefaultDataManifest::manifestFileName(dataFileName));
+   QVERIFY(shippedManifest);
+   if (!(*shippedManifest == builtManifest)) {
+      QString const regeneratedFileName = QDir::temp().filePath("DefaultData.manifest");
+      builtManifest.write(regeneratedFileName);
+      QFAIL(qPrintable(QString{"Shipped manifest is out of date.  Correct one is in %1"}.arg(regeneratedFileName)));
+   }
+
+   // Pick one record from each section and check we get a valid document with just those
+   QVector<DefaultDataManifest::Record> someRecords;
+   for (auto const & record : builtManifest.records()) {
+      if (someRecords.isEmpty() || someRecords.last().sectionName != record.sectionName) {
+         someRecords.append(record);
+      }
+   }
+   QByteArray const extracted = DefaultDataManifest::extract(dataFileContents, someRecords);
+   QVERIFY(extracted.startsWith("<?xml version="));
+   DefaultDataManifest const extractedManifest = DefaultDataManifest::build(extracted);
+   QCOMPARE(extractedManifest.records().size(), someRecords.size());
+   for (int ii = 0; ii < someRecords.size(); ++ii) {
+      QCOMPARE(extractedManifest.records().at(ii).hash, someRecords.at(ii).hash);
+   }
+
+   // Records that don't match the file should be refused
+   QVector<DefaultDataManifest::Record> badRecords{someRecords.first()};
+   ++badRecords.first().offset;
+   QVERIFY(DefaultDataManifest::extract(dataFileContents, badRecords).isEmpty());
+   return;
+}
+
+void Testing::testObjectStoreSnapshot() {
+   auto hop = std::make_shared<Hop>(QString("Snapshot test hop"));
+   hop->setAlpha_pct(12.5);
+   ObjectStoreWrapper::insert(hop);
+   int const hopId = hop->key();
+
+   auto findHop = [hopId](ObjectStoreSnapshot const & snapshot) {
+      auto matches = snapshot.findAllMatching(
+         [hopId](ObjectStoreSnapshot::Record const & record) {
+            return record.get<int>(PropertyNames::NamedEntity::key) == hopId;
+         }
+      );
+      return matches.size() == 1 ? matches.first().get<QString>(PropertyNames::NamedEntity::name) : QString{};
+   };
+
+   ObjectStoreSnapshot const before = ObjectStoreSnapshot::capture<Hop>();
+   QCOMPARE(before.records().size(), ObjectStoreWrapper::getAll<Hop>().size());
+   QCOMPARE(findHop(before), QString("Snapshot test hop"));
+
+   // Nothing has changed, so we should get the same snapshot back without it being copied
+   ObjectStoreSnapshot const again = ObjectStoreSnapshot::capture<Hop>();
+   QCOMPARE(again.generation(), before.generation());
+   QVERIFY(&again.records() == &before.records());
+
+   // Changing the hop changes what's in a new snapshot, but not what's in the old one
+   hop->setName("Renamed snapshot test hop");
+   ObjectStoreSnapshot const after = ObjectStoreSnapshot::capture<Hop>();
+   QVERIFY(after.generation() > before.generation());
+   QCOMPARE(findHop(after), QString("Renamed snapshot test hop"));
+   QCOMPARE(findHop(before), QString("Snapshot test hop"));
+
+   ObjectStoreWrapper::hardDelete(*hop);
+   QCOMPARE(findHop(ObjectStoreSnapshot::capture<Hop>()), QString{});
+   QCOMPARE(findHop(after), QString("Renamed snapshot test hop"));
+
+   // A snapshot that no-one is holding any more isn't kept around in case it's wanted again
+   Metrics::Counter & numReused = Metrics::counter("db.snapshot.reused");
+   qint64 const numReusedBefore = numReused.get();
+   ObjectStoreSnapshot::capture<Hop>();
+   ObjectStoreSnapshot::capture<Hop>();
+   QCOMPARE(numReused.get(), numReusedBefore);
+   return;
+}
+
+void Testing::testDatabaseMigration() {
+   QTemporaryDir targetDir;
+   QVERIFY(targetDir.isValid());
+
+   QVector<ObjectStore::TableDefinition const *> const tables = GetAllTableDefinitions();
+
+   // Returns the number of rows in a table and a hash of their contents, computed independently of DatabaseMigration
+   auto readTable = [](QSqlDatabase & connection, ObjectStore::TableDefinition const & table) {
+      QStringList columnNames;
+      QStringList columnNumbers;
+      for (auto const & field : table.tableFields) {
+         columnNames.append(*field.columnName);
+         columnNumbers.append(QString::number(columnNames.size()));
+      }
+      QSqlQuery query{connection};
+      query.exec(QString{"SELECT %1 FROM %2 ORDER BY %3;"}.arg(columnNames.join(", "),
+                                                               *table.tableName,
+                                                               columnNumbers.join(", ")));
+      qint64 numRows = 0;
+      QCryptographicHash hash{QCryptographicHash::Sha1};
+      while (query.next()) {
+         for (int ii = 0; ii < columnNames.size(); ++ii) {
+            hash.addData(query.value(ii).isNull() ? QByteArray{"\x01"} : query.value(ii).toString().toUtf8());
+            hash.addData("\x1f", 1);
+         }
+         ++numRows;
+      }
+      return qMakePair(numRows, hash.result());
+   };
+
+   for (bool const copyOnCallingThread : {false, true}) {
+      QString const targetFileName =
+         QDir{targetDir.path()}.filePath(QString{"migrated-%1.sqlite"}.arg(copyOnCallingThread ? "single" : "workers"));
+      {
+         QSqlDatabase target = QSqlDatabase::addDatabase("QSQLITE", "testDatabaseMigration");
+         target.setDatabaseName(targetFileName);
+         QVERIFY(target.open());
+         // Source and target are both SQLite, so the same Database object does for both, as in Database::createBlank()
+         Database & database = Database::instance();
+         QVERIFY(DatabaseSchemaHelper::create(database, target));
+         {
+            DatabaseMigration migration{database, database, target, tables};
+            migration.setCopyOnCallingThread(copyOnCallingThread);
+            QVERIFY2(migration.run(), qPrintable(migration.errorMessage()));
+         }
+
+         QSqlDatabase source = database.sqlDatabase();
+         for (auto const table : tables) {
+            auto const sourceContents = readTable(source, *table);
+            auto const targetContents = readTable(target, *table);
+            QVERIFY2(sourceContents.first == targetContents.first, qPrintable(*table->tableName));
+            QVERIFY2(sourceContents.second == targetContents.second, qPrintable(*table->tableName));
+         }
+
+         // We copied the primary keys, so a new row must get a key after all the copied ones
+         QSqlQuery maxIdQuery{source};
+         QVERIFY(maxIdQuery.exec("SELECT MAX(id) FROM hop;") && maxIdQuery.next());
+         int const maxSourceId = maxIdQuery.value(0).toInt();
+         QSqlQuery insertQuery{target};
+         QVERIFY(insertQuery.exec("INSERT INTO hop (name) VALUES ('Migration test hop');"));
+         QVERIFY(insertQuery.lastInsertId().toInt() > maxSourceId);
+
+         maxIdQuery.finish();
+         insertQuery.finish();
+         target.close();
+      }
+      QSqlDatabase::removeDatabase("testDatabaseMigration");
+   }
+   return;
+}
+
+void Testing::testJunctionTableQueryPlans() {
+   if (Database::instance().dbType() != Database::SQLITE) {
+      QSKIP("Query plan checks are written for SQLite");
+   }
+
+   // Returns the steps SQLite would take to run the query
+   auto queryPlan = [](QString const & queryString) {
+      QStringList details;
+      QSqlQuery query{Database::instance().sqlDatabase()};
+      if (query.exec("EXPLAIN QUERY PLAN " + queryString)) {
+         while (query.next()) {
+            details.append(query.value("detail").toString());
+         }
+      }
+      return details;
+   };
+
+   QVector<ObjectStore const *> const objectStores{
+      &ObjectStoreTyped<Equipment>::getInstance(),
+      &ObjectStoreTyped<Fermentable>::getInstance(),
+      &ObjectStoreTyped<Hop>::getInstance(),
+      &ObjectStoreTyped<Misc>::getInstance(),
+      &ObjectStoreTyped<Recipe>::getInstance(),
+      &ObjectStoreTyped<Style>::getInstance(),
+      &ObjectStoreTyped<Water>::getInstance(),
+      &ObjectStoreTyped<Yeast>::getInstance()
+   };
+   for (auto const * objectStore : objectStores) {
+      // The first table is the primary one; the rest are junction tables (see ObjectStore::JunctionTableDefinition
+      // for the order of the columns)
+      auto const tableDefinitions = objectStore->getTableDefinitions();
+      for (auto const * junctionTable : tableDefinitions.mid(1)) {
+         QString const tableName   = *junctionTable->tableName;
+         QString const thisColumn  = *junctionTable->tableFields[1].columnName;
+         QString const otherColumn = *junctionTable->tableFields[2].columnName;
+         QString const orderColumn =
+            junctionTable->tableFields.size() > 3 ? *junctionTable->tableFields[3].columnName : otherColumn;
+
+         // Reading the whole table in ObjectStore::loadAll() should read an index in order, not sort the table
+         QStringList plan = queryPlan(
+            QString("SELECT %1, %2 FROM %3 ORDER BY %1, %4").arg(thisColumn, otherColumn, tableName, orderColumn)
+         );
+         QVERIFY2(!plan.isEmpty(), qPrintable(tableName));
+         for (auto const & detail : plan) {
+            QVERIFY2(!detail.contains("TEMP B-TREE"), qPrintable(tableName + ": " + detail));
+            QVERIFY2(!detail.startsWith("SCAN") || detail.contains("INDEX"), qPrintable(tableName + ": " + detail));
+         }
+
+         // Finding the rows for one object (to replace or delete them), or the rows that refer to another object
+         // (to check foreign keys when it is deleted), should search an index
+         for (auto const & column : {thisColumn, otherColumn}) {
+            plan = queryPlan(QString("SELECT id FROM %1 WHERE %2 = 1").arg(tableName, column));
+            QVERIFY2(plan.size() == 1 && plan.first().startsWith("SEARCH"),
+                     qPrintable(tableName + "." + column + ": " + plan.join("; ")));
+         }
+      }
+   }
+   return;
+}
+
+void Testing::testJunctionTableSync() {
+   auto recipe = std::make_shared<Recipe>(QString("Junction table sync test"));
+   ObjectStoreWrapper::insert(recipe);
+   QVector<std::shared_ptr<Instruction> > instructions;
+   for (int ii = 1; ii <= 4; ++ii) {
+      auto instruction = std::make_shared<Instruction>(QString("Step %1").arg(ii));
+      ObjectStoreWrapper::insert(instruction);
+      instructions.append(instruction);
+   }
+   for (int ii = 0; ii < 3; ++ii) {
+      recipe->insertInstruction(*instructions[ii], ii + 1);
+   }
+
+   // Maps instruction ID to (row ID, instruction number) for the recipe's rows in the junction table
+   auto readRows = [&recipe]() {
+      QHash<int, QPair<int, int> > rows;
+      QSqlQuery query{Database::instance().sqlDatabase()};
+      query.prepare(
+         "SELECT id, instruction_id, instruction_number FROM instruction_in_recipe WHERE recipe_id = :recipeId"
+      );
+      query.bindValue(":recipeId", recipe->key());
+      if (query.exec()) {
+         while (query.next()) {
+            rows.insert(query.value(1).toInt(), qMakePair(query.value(0).toInt(), query.value(2).toInt()));
+         }
+      }
+      return rows;
+   };
+   auto const before = readRows();
+   QCOMPARE(before.size(), 3);
+
+   // Swapping two instructions should renumber their rows, not replace them, and leave the other row alone
+   recipe->swapInstructions(instructions[0].get(), instructions[2].get());
+   auto const afterSwap = readRows();
+   QCOMPARE(afterSwap.size(), 3);
+   QCOMPARE(afterSwap.value(instructions[0]->key()), qMakePair(before.value(instructions[0]->key()).first, 3));
+   QCOMPARE(afterSwap.value(instructions[1]->key()), before.value(instructions[1]->key()));
+   QCOMPARE(afterSwap.value(instructions[2]->key()), qMakePair(before.value(instructions[2]->key()).first, 1));
+
+   // Adding one to the end should add one row and leave the others alone
+   recipe->insertInstruction(*instructions[3], 4);
+   auto const afterInsert = readRows();
+   QCOMPARE(afterInsert.size(), 4);
+   for (int ii = 0; ii < 3; ++ii) {
+      QCOMPARE(afterInsert.value(instructions[ii]->key()), afterSwap.value(instructions[ii]->key()));
+   }
+   QCOMPARE(afterInsert.value(instructions[3]->key()).second, 4);
+
+   ObjectStoreWrapper::hardDelete(*recipe);
+   return;
+}
+
+void Testing::testSoftDeleteCompaction() {
+   auto recipe = std::make_shared<Recipe>(QString("Compaction test"));
+   ObjectStoreWrapper::insert(recipe);
+   auto unusedHop = std::make_shared<Hop>(QString("Compaction test unused hop"));
+   ObjectStoreWrapper::insert(unusedHop);
+   int const unusedHopId = unusedHop->key();
+   auto usedHop = std::make_shared<Hop>(QString("Compaction test used hop"));
+   ObjectStoreWrapper::insert(usedHop);
+   // The recipe gets its own copy of the hop, whose parent is usedHop
+   auto hopInRecipe = recipe->add<Hop>(usedHop);
+
+   ObjectStoreWrapper::softDelete(*unusedHop);
+   ObjectStoreWrapper::softDelete(*usedHop);
+   ObjectStoreWrapper::softDelete(*hopInRecipe);
+
+   {
+      // This is what Database::automaticCompaction() does, unless SQLite is in exclusive mode.  The deletes are handed
+      // to this thread via the event loop, which QTRY_VERIFY keeps running while it waits.
+      DatabaseCompaction compaction{Database::instance()};
+      compaction.start();
+      QTRY_VERIFY_WITH_TIMEOUT(compaction.isFinished(), 60000);
+      DatabaseCompaction::Report const report = compaction.report();
+      QVERIFY2(report.errorMessage.isEmpty(), qPrintable(report.errorMessage));
+      QVERIFY(report.finished);
+      QVERIFY(report.bytesAfter > 0);
+      QVERIFY(report.numPurgedByTable.value("hop") >= 1);
+   }
+   auto const & hopStore = ObjectStoreTyped<Hop>::getInstance();
+   QVERIFY(!hopStore.contains(unusedHopId));
+   QVERIFY2(hopStore.contains(usedHop->key()), "Parent of a hop in a recipe should be kept");
+   QVERIFY2(hopStore.contains(hopInRecipe->key()), "Hop in a recipe should be kept");
+
+   {
+      // This is what happens in exclusive mode.  Everything unused has already been purged.
+      DatabaseCompaction compaction{Database::instance()};
+      QVERIFY(compaction.runHere());
+      DatabaseCompaction::Report const report = compaction.report();
+      QVERIFY(report.finished);
+      QVERIFY(report.numPurgedByTable.isEmpty());
+      QVERIFY(hopStore.contains(usedHop->key()));
+   }
+
+   ObjectStoreWrapper::hardDelete(*recipe);
+   return;
+}
+
+void Testing::testDatabaseWorkerPool() {
+   int constexpr numKeys = 5;
+   int constexpr numTasksPerKey = 20;
+   QMutex mutex;
+   QHash<QString, QVector<int> > runOrderByKey;
+   int numCallbacks = 0;
+   bool callbacksOnMainThread = true;
+   {
+      DatabaseWorkerPool workerPool{Database::instance(), 3};
+      for (int taskNumber = 0; taskNumber < numTasksPerKey; ++taskNumber) {
+         for (int keyNumber = 0; keyNumber < numKeys; ++keyNumber) {
+            QString const key = QString{"key%1"}.arg(keyNumber);
+            workerPool.enqueue(
+               key,
+               [&, key, taskNumber](QSqlDatabase & connection) {
+                  QSqlQuery query{connection};
+                  bool const succeeded = query.exec("SELECT 1;") && query.next();
+                  QMutexLocker locker(&mutex);
+                  runOrderByKey[key].append(taskNumber);
+                  return succeeded;
+               },
+               [&](bool const succeeded) {
+                  callbacksOnMainThread = callbacksOnMainThread && QThread::currentThread() == this->thread();
+                  if (succeeded) {
+                     ++numCallbacks;
+                  }
+               }
+            );
+         }
+      }
+      workerPool.waitForAll();
+      {
+         QMutexLocker locker(&mutex);
+         QCOMPARE(runOrderByKey.size(), numKeys);
+         for (auto const & runOrder : runOrderByKey) {
+            QCOMPARE(runOrder.size(), numTasksPerKey);
+            QVERIFY(std::is_sorted(runOrder.cbegin(), runOrder.cend()));
+         }
+      }
+      // Callbacks come via the event loop
+      QTRY_COMPARE(numCallbacks, numKeys * numTasksPerKey);
+   }
+   QVERIFY(callbacksOnMainThread);
+   return;
+}
+
+void Testing::testQueuedPropertyWrites() {
+   Database & database = Database::instance();
+   // The pool is normally only used with PostgreSQL, but works the same way with SQLite in WAL mode
+   QVERIFY(database.setNumWorkerConnections(2));
+   QVERIFY(database.workerPool());
+
+   auto recipe = std::make_shared<Recipe>(QString("Queued writes test"));
+   ObjectStoreWrapper::insert(recipe);
+   auto hop = std::make_shared<Hop>(QString("Queued writes test hop"));
+   ObjectStoreWrapper::insert(hop);
+
+   // Reads a column straight from the DB, rather than from the object store
+   auto readColumn = [](QSqlDatabase & connection, QString const & tableName, QString const & columnName, int id) {
+      QSqlQuery query{connection};
+      query.prepare(QString{"SELECT %1 FROM %2 WHERE id = :id;"}.arg(columnName, tableName));
+      query.bindValue(":id", id);
+      return query.exec() && query.next() ? query.value(0).toString() : QString{};
+   };
+
+   // Writes to any one object are done in order, so the last one made is the one we should see
+   Metrics::Counter & numQueued = Metrics::counter("db.updateProperty.queued");
+   qint64 const numQueuedBefore = numQueued.get();
+   int constexpr numWrites = 20;
+   for (int ii = 1; ii <= numWrites; ++ii) {
+      recipe->setNotes(QString{"Queued recipe notes %1"}.arg(ii));
+      hop->setNotes(QString{"Queued hop notes %1"}.arg(ii));
+   }
+   QCOMPARE(numQueued.get() - numQueuedBefore, 2 * numWrites);
+   database.workerPool()->waitForAll();
+   {
+      QSqlDatabase connection = database.sqlDatabase();
+      QCOMPARE(readColumn(connection, "recipe", "notes", recipe->key()),
+               QString{"Queued recipe notes %1"}.arg(numWrites));
+      QCOMPARE(readColumn(connection, "hop", "notes", hop->key()), QString{"Queued hop notes %1"}.arg(numWrites));
+   }
+
+   // A write queued before a transaction starts is done before it starts.  One made inside the transaction is done
+   // there and then, as part of it.
+   recipe->setNotes("Queued before transaction");
+   {
+      QSqlDatabase connection = database.sqlDatabase();
+      DbTransaction dbTransaction{database, connection};
+      QCOMPARE(readColumn(connection, "recipe", "notes", recipe->key()), QString{"Queued before transaction"});
+      qint64 const numQueuedBeforeWrite = numQueued.get();
+      recipe->setNotes("Written in transaction");
+      QCOMPARE(numQueued.get(), numQueuedBeforeWrite);
+      QCOMPARE(readColumn(connection, "recipe", "notes", recipe->key()), QString{"Written in transaction"});
+      QVERIFY(dbTransaction.commit());
+   }
+   QVERIFY(database.setNumWorkerConnections(0));
+   {
+      QSqlDatabase connection = database.sqlDatabase();
+      QCOMPARE(readColumn(connection, "recipe", "notes", recipe->key()), QString{"Written in transaction"});
+   }
+
+   ObjectStoreWrapper::hardDelete(*hop);
+   ObjectStoreWrapper::hardDelete(*recipe);
+   return;
+}
+
+void Testing::testTableModelBulkPopulate() {
+   QTableView tableView;
+   FermentableTableModel model(&tableView, false);
+
+   QList<std::shared_ptr<Fermentable> > fermentables;
+   for (auto fermentable : ObjectStoreWrapper::getAll<Fermentable>()) {
+      if (!fermentable->deleted() && fermentable->display()) {
+         fermentables.append(fermentable);
+      }
+   }
+   QVERIFY(!fermentables.isEmpty());
+
+   // The per-row path is what we get when objects are added one at a time from the ObjectStore's signals
+   for (auto fermentable : fermentables) {
+      model.addFermentable(fermentable->key());
+   }
+   QCOMPARE(model.rowCount(), fermentables.size());
+
+   model.removeAll();
+   QCOMPARE(model.rowCount(), 0);
+
+   // Duplicates within the list, as well as things already in the model, should be skipped by the bulk path
+   model.addFermentables(fermentables + fermentables);
+   QCOMPARE(model.rowCount(), fermentables.size());
+   model.addFermentables(fermentables);
+   QCOMPARE(model.rowCount(), fermentables.size());
+
+   model.removeAll();
+   return;
+}
+
+void Testing::testTracing() {
+   QTemporaryDir tempDir;
+   QVERIFY(tempDir.isValid());
+   QString const traceFileName = tempDir.filePath("trace.json");
+
+   Tracing::clear();
+
+   // Nothing should be recorded while tracing is off
+   Tracing::setEnabled(false);
+   {
+      TRACE_SPAN("test", "Disabled");
+   }
+
+   Tracing::setEnabled(true);
+   {
+      TRACE_SPAN("test", "Outer");
+      {
+         TRACE_SPAN("test", "Inner");
+      }
+   }
+   // Spans on other threads should be kept even after the thread has finished
+   SpanRecordingThread thread;
+   thread.start();
+   thread.wait();
+   Tracing::setEnabled(false);
+
+   QVERIFY(Tracing::writeChromeTrace(traceFileName));
+
+   QFile traceFile{traceFileName};
+   QVERIFY(traceFile.open(QIODevice::ReadOnly));
+   QJsonParseError parseError;
+   QJsonDocument const traceDocument = QJsonDocument::fromJson(traceFile.readAll(), &parseError);
+   QCOMPARE(parseError.error, QJsonParseError::NoError);
+
+   QHash<QString, QJsonObject> spans;
+   for (auto const & eventValue : traceDocument.object().value("traceEvents").toArray()) {
+      QJsonObject const event = eventValue.toObject();
+      if (event.value("ph").toString() == "X") {
+         spans.insert(event.value("name").toString(), event);
+      }
+   }
+   QVERIFY(!spans.contains("Disabled"));
+   QVERIFY(spans.contains("Outer"));
+   QVERIFY(spans.contains("Inner"));
+   QVERIFY(spans.contains("Worker"));
+
+   // Inner span should be inside the outer one on the same thread, and the worker should be on a different thread
+   QJsonObject const & outer = spans["Outer"];
+   QJsonObject const & inner = spans["Inner"];
+   QCOMPARE(inner.value("tid").toInt(), outer.value("tid").toInt());
+   QVERIFY(inner.value("ts").toDouble() >= outer.value("ts").toDouble());
+   QVERIFY(inner.value("ts").toDouble() + inner.value("dur").toDouble() <=
+           outer.value("ts").toDouble() + outer.value("dur").toDouble());
+   QVERIFY(spans["Worker"].value("tid").toInt() != outer.value("tid").toInt());
+
+   Tracing::clear();
+   return;
+}
+
+void Testing::testMetrics() {
+   // Same name should always give the same counter
+   Metrics::Counter & counter = Metrics::counter("test.counter");
+   QCOMPARE(&Metrics::counter("test.counter"), &counter);
+   counter.reset();
+   counter.add();
+   counter.add(41);
+   QCOMPARE(Metrics::getCounterValues().value("test.counter"), qint64{42});
+
+   // Every value should land in a bucket whose upper bound is no more than 12.5% above it
+   for (qint64 value : {qint64{0}, qint64{1}, qint64{15}, qint64{16}, qint64{17}, qint64{1000}, qint64{123456789},
+                        std::numeric_limits<qint64>::max()}) {
+      int const index = Metrics::Histogram::bucketIndex(value);
+      QVERIFY(index >= 0 && index < Metrics::Histogram::numBuckets);
+      qint64 const upperBound = Metrics::Histogram::bucketUpperBound(index);
+      QVERIFY(upperBound >= value);
+      QVERIFY(static_cast<double>(upperBound - value) <= 0.125 * static_cast<double>(value));
+      QVERIFY(index == 0 || Metrics::Histogram::bucketUpperBound(index - 1) < value);
+   }
+
+   Metrics::Histogram & histogram = Metrics::histogram("test.histogram");
+   histogram.reset();
+   for (qint64 value = 1; value <= 1000; ++value) {
+      histogram.record(value);
+   }
+   Metrics::HistogramSummary const summary = histogram.getSummary();
+   QCOMPARE(summary.count, qint64{1000});
+   QCOMPARE(summary.max, qint64{1000});
+   QVERIFY(fuzzyComp(summary.mean, 500.5, 0.001));
+   QVERIFY(fuzzyComp(summary.p50, 500, 500 * 0.125));
+   QVERIFY(fuzzyComp(summary.p90, 900, 900 * 0.125));
+   QVERIFY(fuzzyComp(summary.p99, 990, 990 * 0.125));
+   return;
+}
+
 void Testing::cleanupTestCase()
 {
    Brewtarget::cleanup();
@@ -73,6 +73,49 @@ private slots:
 
    //! \brief Verify Log rotation is working
    void testLogRotation();
+
+   //! \brief Verify per-category logging levels set just for this run are used but not saved
+   void testLoggingCategoryLevels();
+
+   //! \brief Verify the full-text search index follows inserts and updates of recipe notes
+   void testFullTextSearch();
+
+   //! \brief Verify a backup taken while the DB is open has the latest changes, and compressed backups round-trip
+   void testDatabaseBackup();
+
+   //! \brief Verify the shipped default data manifest is up-to-date, and that we can extract records using it
+   void testDefaultDataManifest();
+
+   //! \brief Verify snapshots don't change when the objects do, and are reused when nothing has changed
+   void testObjectStoreSnapshot();
+
+   //! \brief Verify a migration to a new DB copies every row, both with worker threads and on the calling thread
+   void testDatabaseMigration();
+
+   //! \brief Verify the DB uses indexes, rather than scanning whole tables, for the junction table queries we run most
+   void testJunctionTableQueryPlans();
+
+   //! \brief Verify small changes to a list of IDs only touch the junction table rows that need to change
+   void testJunctionTableSync();
+
+   //! \brief Verify compaction purges soft-deleted objects that aren't used, and keeps those that are
+   void testSoftDeleteCompaction();
+
+   //! \brief Verify the DB worker pool keeps work for the same key in order, and runs callbacks on the main thread
+   void testDatabaseWorkerPool();
+
+   //! \brief Verify property writes queued on the worker pool end up in the DB, in order, and ones made inside a
+   //!        transaction are part of it
+   void testQueuedPropertyWrites();
+
+   //! \brief Verify bulk population of table models de-dupes properly.  (Benchmarks::tableModelPopulate times it.)
+   void testTableModelBulkPopulate();
+
+   //! \brief Verify spans are recorded, nested and written out as valid Chrome trace JSON
+   void testTracing();
+
+   //! \brief Verify metrics histogram bucketing and percentiles are within their stated accuracy
+   void testMetrics();
 };
 
 #endif
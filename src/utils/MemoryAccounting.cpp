@@ -0,0 +1,176 @@
+/*
+ * utils/MemoryAccounting.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "utils/MemoryAccounting.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <QByteArray>
+#include <QMetaObject>
+#include <QMetaProperty>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QVector>
+
+namespace {
+   //
+   // These are rough figures for 64-bit builds.  They don't need to be exact (see comment in header file), just in the
+   // right ballpark so that, eg, lots of small objects don't look free.
+   //
+   // QObjectPrivate (which every QObject allocates) is a bit over 100 bytes in Qt 5, before any signal connections
+   qint64 const qObjectPrivateSize = 120;
+   // The control block for a std::shared_ptr that was not created with std::make_shared: vtable pointer, use count,
+   // weak count and pointer to the object
+   qint64 const sharedPtrControlBlockSize = 3 * sizeof(void *);
+   // Header in front of the characters of a QString (or bytes of a QByteArray or elements of a QVector)
+   qint64 const arrayHeaderSize = sizeof(QArrayData);
+
+   //
+   // Registrations can be created during static initialisation (eg by the ObjectStore singletons), so the registry
+   // has to be a function-local static rather than a file-scope one.  (The same goes for its mutex.)
+   //
+   struct Registry {
+      QMutex mutex;
+      std::map<int, MemoryAccounting::Reporter> reporters;
+      int nextId = 0;
+   };
+   Registry & registry() {
+      static Registry theRegistry;
+      return theRegistry;
+   }
+
+   template<typename T> qint64 approxHeapSizeOfVector(QVector<T> const & vector) {
+      return vector.capacity() == 0 ? 0 : arrayHeaderSize + vector.capacity() * static_cast<qint64>(sizeof(T));
+   }
+}
+
+std::atomic<bool> MemoryAccounting::enabledFlag{false};
+
+qint64 const MemoryAccounting::containerNodeOverhead = 3 * sizeof(void *);
+
+void MemoryAccounting::setEnabled(bool enabled) {
+   enabledFlag.store(enabled, std::memory_order_relaxed);
+   return;
+}
+
+MemoryAccounting::Registration::Registration(MemoryAccounting::Reporter reporter) : id{[&reporter]() {
+   Registry & reg = registry();
+   QMutexLocker locker(&reg.mutex);
+   int const newId = reg.nextId++;
+   reg.reporters.emplace(newId, std::move(reporter));
+   return newId;
+}()} {
+   return;
+}
+
+MemoryAccounting::Registration::~Registration() {
+   Registry & reg = registry();
+   QMutexLocker locker(&reg.mutex);
+   reg.reporters.erase(this->id);
+   return;
+}
+
+QMap<QString, MemoryAccounting::Usage> MemoryAccounting::getUsage() {
+   QMap<QString, Usage> usage;
+   if (!isEnabled()) {
+      return usage;
+   }
+
+   // Take a copy so that we are not holding the lock while the reporters run
+   std::vector<Reporter> reporters;
+   {
+      Registry & reg = registry();
+      QMutexLocker locker(&reg.mutex);
+      reporters.reserve(reg.reporters.size());
+      for (auto const & entry : reg.reporters) {
+         reporters.push_back(entry.second);
+      }
+   }
+   for (auto const & reporter : reporters) {
+      reporter(usage);
+   }
+   return usage;
+}
+
+qint64 MemoryAccounting::approxHeapSizeOf(QString const & string) {
+   // Null and empty strings, and those made with QStringLiteral, share static data and have no capacity
+   if (string.capacity() == 0) {
+      return 0;
+   }
+   return arrayHeaderSize + (string.capacity() + 1) * static_cast<qint64>(sizeof(QChar));
+}
+
+qint64 MemoryAccounting::approxHeapSizeOf(QVariant const & variant) {
+   int const type = variant.userType();
+   if (type == QMetaType::QString) {
+      return approxHeapSizeOf(variant.toString());
+   }
+   if (type == QMetaType::QByteArray) {
+      QByteArray const byteArray = variant.toByteArray();
+      return byteArray.capacity() == 0 ? 0 : arrayHeaderSize + byteArray.capacity() + 1;
+   }
+   if (type == QMetaType::QStringList) {
+      QStringList const stringList = variant.toStringList();
+      qint64 bytes = stringList.isEmpty() ? 0 : arrayHeaderSize + stringList.size() * containerNodeOverhead;
+      for (auto const & string : stringList) {
+         bytes += approxHeapSizeOf(string);
+      }
+      return bytes;
+   }
+   if (type == qMetaTypeId<QVector<int>>()) {
+      return approxHeapSizeOfVector(variant.value<QVector<int>>());
+   }
+   if (type == qMetaTypeId<QVector<double>>()) {
+      return approxHeapSizeOfVector(variant.value<QVector<double>>());
+   }
+   // Otherwise, assume QVariant stores anything bigger than two pointers on the heap, and that it owns no further heap
+   // memory itself
+   int const size = QMetaType::sizeOf(type);
+   return size > static_cast<int>(2 * sizeof(void *)) ? size : 0;
+}
+
+qint64 MemoryAccounting::approxHeapSizeOf(QHash<QString, QVariant> const & hash) {
+   // Each node holds a next pointer and the hash value as well as the key and the value.  There is also about one
+   // bucket pointer per node.
+   qint64 bytes = hash.size() * (containerNodeOverhead + sizeof(QString) + sizeof(QVariant));
+   for (auto ii = hash.cbegin(); ii != hash.cend(); ++ii) {
+      bytes += approxHeapSizeOf(ii.key()) + approxHeapSizeOf(ii.value());
+   }
+   return bytes;
+}
+
+qint64 MemoryAccounting::approxSizeOfSharedObject(QObject const & object, std::size_t sizeOfClass) {
+   qint64 bytes = static_cast<qint64>(sizeOfClass) + qObjectPrivateSize + sharedPtrControlBlockSize;
+
+   //
+   // Only look at stored, writable properties, ie the ones that hold data (and, in practice, the ones that get written
+   // to the DB).  Others, such as Recipe::IBUs, are calculated on the fly, which could be slow, and don't use memory
+   // when not being read.  We skip QObject's own objectName, which is not used for model objects.
+   //
+   QMetaObject const * metaObject = object.metaObject();
+   for (int ii = QObject::staticMetaObject.propertyCount(); ii < metaObject->propertyCount(); ++ii) {
+      QMetaProperty const property = metaObject->property(ii);
+      if (property.isStored() && property.isWritable()) {
+         bytes += approxHeapSizeOf(property.read(&object));
+      }
+   }
+   return bytes;
+}
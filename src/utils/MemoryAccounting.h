@@ -0,0 +1,134 @@
+/*
+ * utils/MemoryAccounting.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UTILS_MEMORYACCOUNTING_H
+#define UTILS_MEMORYACCOUNTING_H
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QtGlobal>
+#include <QVariant>
+
+/**
+ * \brief Approximate count of live objects and the memory they use, broken down by subsystem (each \c ObjectStore,
+ *        tree model and table model), so that we can see where memory goes on big databases.
+ *
+ *        Nothing is counted as objects are created and destroyed.  Instead, each subsystem registers a function that
+ *        measures its current usage (see \c Registration), and these are only called when someone asks for the
+ *        figures (via \c getUsage()).  The measuring functions walk every object they own, so this is off unless
+ *        turned on with the --memory-accounting command-line option (or \c setEnabled()).  When it is on, the figures
+ *        are shown in Help > Diagnostics, and the benchmarks record them and can check them against a budget (see
+ *        unitTests/Benchmarks.cpp).
+ *
+ *        Sizes are estimates: we know \c sizeof each class, and can see how much heap each string and list property
+ *        is using, but we have to guess at the overheads inside Qt (\c QObject private data, container nodes, etc)
+ *        and \c std::shared_ptr.  They are meant for comparing one subsystem with another, and one build with
+ *        another, rather than for matching what the OS reports.
+ *
+ *        Subsystems are identified by names of the form "objectStore/hop", "treeModel/Recipe",
+ *        "tableModel/HopTableModel".  Where there are several instances with the same name (eg several hop table
+ *        models), their usage is added together.
+ */
+namespace MemoryAccounting {
+
+   struct Usage {
+      qint64 numObjects = 0;
+      qint64 approxBytes = 0;
+
+      Usage & operator+=(Usage const & other) {
+         this->numObjects  += other.numObjects;
+         this->approxBytes += other.approxBytes;
+         return *this;
+      }
+   };
+
+   //! \brief Don't use this directly.  Call \c isEnabled() instead.
+   extern std::atomic<bool> enabledFlag;
+
+   /**
+    * \return \c true if memory accounting is turned on
+    */
+   inline bool isEnabled() {
+      return enabledFlag.load(std::memory_order_relaxed);
+   }
+
+   void setEnabled(bool enabled);
+
+   /**
+    * \brief A function that adds the current usage of one subsystem to the supplied map, eg:
+    *           usage["objectStore/hop"] += this->getMemoryUsage();
+    */
+   using Reporter = std::function<void(QMap<QString, Usage> &)>;
+
+   /**
+    * \brief RAII object that registers a \c Reporter for as long as it exists.  Typically a member of the object whose
+    *        usage is being reported.  Reporters are only ever called from the main thread.
+    */
+   class Registration {
+   public:
+      Registration(Reporter reporter);
+      ~Registration();
+
+   private:
+      int const id;
+
+      // RAII class shouldn't be getting copied or moved
+      Registration(Registration const &) = delete;
+      Registration & operator=(Registration const &) = delete;
+      Registration(Registration &&) = delete;
+      Registration & operator=(Registration &&) = delete;
+   };
+
+   /**
+    * \return Current usage of each registered subsystem, in name order, or an empty map if memory accounting is not
+    *         enabled.  Must be called from the main thread.
+    */
+   QMap<QString, Usage> getUsage();
+
+   //! \return Approximate heap memory used by a string, not counting the \c QString itself
+   qint64 approxHeapSizeOf(QString const & string);
+
+   //! \return Approximate heap memory used by a \c QVariant's value, not counting the \c QVariant itself
+   qint64 approxHeapSizeOf(QVariant const & variant);
+
+   //! \return Approximate heap memory used by a hash of named values (eg a \c NamedParameterBundle)
+   qint64 approxHeapSizeOf(QHash<QString, QVariant> const & hash);
+
+   /**
+    * \brief Approximate memory used by an object held by \c std::shared_ptr, as \c ObjectStore holds them: the object
+    *        itself, its \c QObject private data, the \c shared_ptr control block, and the heap used by its stored
+    *        properties (name, notes, lists of IDs, etc).
+    *
+    * \param sizeOfClass \c sizeof the object's most derived class
+    */
+   qint64 approxSizeOfSharedObject(QObject const & object, std::size_t sizeOfClass);
+
+   /**
+    * \brief Estimated overhead per entry in a \c QHash or \c QList, over and above the stored value
+    */
+   extern qint64 const containerNodeOverhead;
+}
+
+#endif
@@ -0,0 +1,236 @@
+/*
+ * utils/Metrics.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "utils/Metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtAlgorithms> // For qCountLeadingZeroBits
+
+#include "utils/Tracing.h"
+
+namespace {
+   //
+   // Metrics are never deleted, so references handed out by Metrics::counter() and Metrics::histogram() stay valid.
+   // We use std::map (rather than QMap) because it can hold non-copyable values.
+   //
+   QMutex registryMutex;
+   std::map<QString, std::unique_ptr<Metrics::Counter>> counters;
+   std::map<QString, std::unique_ptr<Metrics::Histogram>> histograms;
+}
+
+Metrics::Counter::Counter() : value{0} {
+   return;
+}
+
+qint64 Metrics::Counter::get() const {
+   return this->value.load(std::memory_order_relaxed);
+}
+
+void Metrics::Counter::reset() {
+   this->value.store(0, std::memory_order_relaxed);
+   return;
+}
+
+Metrics::Histogram::Histogram() : buckets{}, count{0}, sum{0}, max{0} {
+   this->reset();
+   return;
+}
+
+int Metrics::Histogram::bucketIndex(qint64 value) {
+   if (value < 2 * subBucketCount) {
+      // Small values get a bucket each
+      return static_cast<int>(std::max<qint64>(value, 0));
+   }
+   // Position of the highest set bit, counting from 0
+   int const highestBit = 63 - qCountLeadingZeroBits(static_cast<quint64>(value));
+   int const shift = highestBit - subBucketBits;
+   // (value >> shift) is in [subBucketCount, 2 * subBucketCount)
+   return (shift + 1) * subBucketCount + static_cast<int>((value >> shift) - subBucketCount);
+}
+
+qint64 Metrics::Histogram::bucketUpperBound(int index) {
+   if (index < 2 * subBucketCount) {
+      return index;
+   }
+   int const shift = index / subBucketCount - 1;
+   qint64 const subBucket = index % subBucketCount;
+   // Can't just shift and subtract 1 for the very last bucket as it would overflow
+   qint64 const lowerBound = (subBucketCount + subBucket) << shift;
+   return lowerBound + ((qint64{1} << shift) - 1);
+}
+
+void Metrics::Histogram::record(qint64 value) {
+   if (value < 0) {
+      value = 0;
+   }
+   this->buckets[static_cast<size_t>(bucketIndex(value))].fetch_add(1, std::memory_order_relaxed);
+   this->count.fetch_add(1, std::memory_order_relaxed);
+   this->sum.fetch_add(value, std::memory_order_relaxed);
+   qint64 currentMax = this->max.load(std::memory_order_relaxed);
+   while (value > currentMax &&
+          !this->max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {
+      // compare_exchange_weak updated currentMax for us, so just try again
+   }
+   return;
+}
+
+qint64 Metrics::Histogram::getPercentile(double percentile) const {
+   qint64 const total = this->count.load(std::memory_order_relaxed);
+   if (total == 0) {
+      return 0;
+   }
+   qint64 const target = std::max<qint64>(1, static_cast<qint64>(std::ceil(total * percentile / 100.0)));
+   qint64 seen = 0;
+   for (int ii = 0; ii < numBuckets; ++ii) {
+      seen += this->buckets[static_cast<size_t>(ii)].load(std::memory_order_relaxed);
+      if (seen >= target) {
+         // No point reporting a value bigger than anything we actually saw
+         return std::min(bucketUpperBound(ii), this->max.load(std::memory_order_relaxed));
+      }
+   }
+   return this->max.load(std::memory_order_relaxed);
+}
+
+Metrics::HistogramSummary Metrics::Histogram::getSummary() const {
+   qint64 const numValues = this->count.load(std::memory_order_relaxed);
+   qint64 const total = this->sum.load(std::memory_order_relaxed);
+   return HistogramSummary{
+      numValues,
+      total,
+      this->max.load(std::memory_order_relaxed),
+      numValues > 0 ? static_cast<double>(total) / static_cast<double>(numValues) : 0.0,
+      this->getPercentile(50.0),
+      this->getPercentile(90.0),
+      this->getPercentile(99.0)
+   };
+}
+
+void Metrics::Histogram::reset() {
+   for (auto & bucket : this->buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+   }
+   this->count.store(0, std::memory_order_relaxed);
+   this->sum.store(0, std::memory_order_relaxed);
+   this->max.store(0, std::memory_order_relaxed);
+   return;
+}
+
+Metrics::Counter & Metrics::counter(QString const & name) {
+   QMutexLocker locker(&registryMutex);
+   auto & counter = counters[name];
+   if (!counter) {
+      counter = std::make_unique<Metrics::Counter>();
+   }
+   return *counter;
+}
+
+Metrics::Histogram & Metrics::histogram(QString const & name) {
+   QMutexLocker locker(&registryMutex);
+   auto & histogram = histograms[name];
+   if (!histogram) {
+      histogram = std::make_unique<Metrics::Histogram>();
+   }
+   return *histogram;
+}
+
+Metrics::ScopedLatency::ScopedLatency(Histogram & histogram) : histogram{histogram}, startNs{Tracing::now()} {
+   return;
+}
+
+Metrics::ScopedLatency::~ScopedLatency() {
+   this->histogram.record(Tracing::now() - this->startNs);
+   return;
+}
+
+QMap<QString, qint64> Metrics::getCounterValues() {
+   QMap<QString, qint64> values;
+   QMutexLocker locker(&registryMutex);
+   for (auto const & [name, counter] : counters) {
+      values.insert(name, counter->get());
+   }
+   return values;
+}
+
+QMap<QString, Metrics::HistogramSummary> Metrics::getHistogramSummaries() {
+   QMap<QString, Metrics::HistogramSummary> summaries;
+   QMutexLocker locker(&registryMutex);
+   for (auto const & [name, histogram] : histograms) {
+      summaries.insert(name, histogram->getSummary());
+   }
+   return summaries;
+}
+
+void Metrics::resetAll() {
+   QMutexLocker locker(&registryMutex);
+   for (auto & nameAndCounter : counters) {
+      nameAndCounter.second->reset();
+   }
+   for (auto & nameAndHistogram : histograms) {
+      nameAndHistogram.second->reset();
+   }
+   return;
+}
+
+bool Metrics::writeJson(QString const & fileName) {
+   QJsonObject countersJson;
+   QMap<QString, qint64> const counterValues = getCounterValues();
+   for (auto ii = counterValues.constBegin(); ii != counterValues.constEnd(); ++ii) {
+      countersJson.insert(ii.key(), ii.value());
+   }
+
+   QJsonObject histogramsJson;
+   QMap<QString, HistogramSummary> const histogramSummaries = getHistogramSummaries();
+   for (auto ii = histogramSummaries.constBegin(); ii != histogramSummaries.constEnd(); ++ii) {
+      HistogramSummary const & summary = ii.value();
+      histogramsJson.insert(ii.key(), QJsonObject{
+         {"count", summary.count},
+         {"sum",   summary.sum  },
+         {"max",   summary.max  },
+         {"mean",  summary.mean },
+         {"p50",   summary.p50  },
+         {"p90",   summary.p90  },
+         {"p99",   summary.p99  }
+      });
+   }
+
+   QFile file{fileName};
+   if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      qWarning() << Q_FUNC_INFO << "Could not open" << fileName << "for writing:" << file.errorString();
+      return false;
+   }
+   QJsonObject const root{{"counters", countersJson}, {"histograms", histogramsJson}};
+   file.write(QJsonDocument{root}.toJson());
+   file.close();
+   if (file.error() != QFileDevice::NoError) {
+      qWarning() << Q_FUNC_INFO << "Error writing" << fileName << ":" << file.errorString();
+      return false;
+   }
+   qInfo() << Q_FUNC_INFO << "Wrote" << counterValues.size() << "counters and" << histogramSummaries.size() <<
+      "histograms to" << fileName;
+   return true;
+}
@@ -0,0 +1,164 @@
+/*
+ * utils/Metrics.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UTILS_METRICS_H
+#define UTILS_METRICS_H
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include <QMap>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * \brief Always-on, cheap, counts and timings of what the program is doing (DB writes, recipe recalculations, XML
+ *        records read, etc).  Unlike \c Tracing, which records every span for later inspection, metrics are just
+ *        running totals, so they can be left on all the time and compared between builds or between users' machines.
+ *
+ *        Metrics are identified by dotted names, eg "db.transactions.committed", and created on first use.  Looking a
+ *        metric up by name takes a lock, so, where a metric is updated often, keep a reference to it, eg:
+ *
+ *           static Metrics::Counter & numCommits = Metrics::counter("db.transactions.committed");
+ *           numCommits.add();
+ *
+ *        The values can be seen in Help > Diagnostics, or written to a file on exit with the --dump-metrics option.
+ */
+namespace Metrics {
+
+   /**
+    * \brief A count of something that has happened.  Thread-safe and lock-free.
+    */
+   class Counter {
+   public:
+      Counter();
+
+      void add(qint64 amount = 1) {
+         this->value.fetch_add(amount, std::memory_order_relaxed);
+         return;
+      }
+
+      qint64 get() const;
+
+      void reset();
+
+   private:
+      std::atomic<qint64> value;
+   };
+
+   /**
+    * \brief Summary of the values recorded in a \c Histogram.  Percentiles are accurate to within 12.5%.
+    */
+   struct HistogramSummary {
+      qint64 count;
+      qint64 sum;
+      qint64 max;
+      double mean;
+      qint64 p50;
+      qint64 p90;
+      qint64 p99;
+   };
+
+   /**
+    * \brief Distribution of a set of non-negative values, typically latencies in nanoseconds.  Thread-safe and
+    *        lock-free.
+    *
+    *        As in HdrHistogram, buckets are log-linear: each power of two is split into 8 equal sub-buckets.  This
+    *        covers the whole range of qint64 in a fixed (4KB) amount of memory, and recording a value is a few
+    *        arithmetic operations and an atomic increment.
+    */
+   class Histogram {
+   public:
+      //! 2^subBucketBits sub-buckets per power of two
+      static int constexpr subBucketBits = 3;
+      static int constexpr subBucketCount = 1 << subBucketBits;
+      static int constexpr numBuckets = (64 - subBucketBits) * subBucketCount;
+
+      Histogram();
+
+      void record(qint64 value);
+
+      /**
+       * \return The value below which \c percentile % of recorded values fall, or 0 if nothing has been recorded
+       */
+      qint64 getPercentile(double percentile) const;
+
+      HistogramSummary getSummary() const;
+
+      void reset();
+
+      //! \return Index of the bucket in which \c value is counted.  Exposed for testing.
+      static int bucketIndex(qint64 value);
+      //! \return The largest value counted in bucket \c index.  Exposed for testing.
+      static qint64 bucketUpperBound(int index);
+
+   private:
+      std::array<std::atomic<qint64>, numBuckets> buckets;
+      std::atomic<qint64> count;
+      std::atomic<qint64> sum;
+      std::atomic<qint64> max;
+   };
+
+   /**
+    * \brief Get the counter with the given name, creating it if necessary.  The returned reference remains valid for
+    *        the lifetime of the program.
+    */
+   Counter & counter(QString const & name);
+
+   /**
+    * \brief Get the histogram with the given name, creating it if necessary.  The returned reference remains valid
+    *        for the lifetime of the program.
+    */
+   Histogram & histogram(QString const & name);
+
+   /**
+    * \brief Records, in the supplied histogram, the time in nanoseconds from construction to destruction of this
+    *        object.
+    */
+   class ScopedLatency {
+   public:
+      ScopedLatency(Histogram & histogram);
+      ~ScopedLatency();
+
+   private:
+      ScopedLatency(ScopedLatency const &) = delete;
+      ScopedLatency & operator=(ScopedLatency const &) = delete;
+
+      Histogram & histogram;
+      qint64 const startNs;
+   };
+
+   //! \return Current value of every counter, in name order
+   QMap<QString, qint64> getCounterValues();
+
+   //! \return Summary of every histogram, in name order
+   QMap<QString, HistogramSummary> getHistogramSummaries();
+
+   //! \brief Set all counters and histograms back to zero
+   void resetAll();
+
+   /**
+    * \brief Write all counters and histograms to a JSON file, eg for comparing one build with another
+    *
+    * \return \c true if the file was written successfully, \c false otherwise (in which case the reason is logged)
+    */
+   bool writeJson(QString const & fileName);
+}
+
+#endif
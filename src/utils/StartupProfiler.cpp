@@ -0,0 +1,153 @@
+/*
+ * utils/StartupProfiler.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "utils/StartupProfiler.h"
+
+#include <atomic>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+namespace {
+   //
+   // If something that is instrumented as a start-up phase gets called a lot (eg ObjectStore::loadAll in the
+   // benchmarks, where markInteractive() is never called), we don't want the list of phases to grow without limit.
+   //
+   int const maxPhases = 1000;
+
+   struct PhaseRecord {
+      QString name;
+      int     depth;
+      qint64  startNs;
+      qint64  durationNs;
+   };
+
+   //
+   // Static initialisation happens before main() is called, so this is as close as we can easily get to the time the
+   // process started.
+   //
+   QElapsedTimer const sinceProcessStart = []() {
+      QElapsedTimer timer;
+      timer.start();
+      return timer;
+   }();
+
+   std::atomic<bool> interactive{false};
+   std::atomic<qint64> nsToInteractive{-1};
+
+   QMutex phasesMutex;
+   QVector<PhaseRecord> phases;
+
+   // How deeply nested the phase currently being recorded on this thread is
+   thread_local int currentDepth = 0;
+
+   int startPhase(QString const & name) {
+      if (interactive.load(std::memory_order_relaxed)) {
+         return -1;
+      }
+      qint64 const startNs = sinceProcessStart.nsecsElapsed();
+      QMutexLocker locker(&phasesMutex);
+      if (phases.size() >= maxPhases) {
+         return -1;
+      }
+      phases.append(PhaseRecord{name, currentDepth, startNs, -1});
+      ++currentDepth;
+      return phases.size() - 1;
+   }
+
+   double nsToMs(qint64 ns) {
+      return static_cast<double>(ns) / 1000000.0;
+   }
+}
+
+StartupProfiler::Phase::Phase(char const * const name) : index{startPhase(name)} {
+   return;
+}
+
+StartupProfiler::Phase::Phase(char const * const name, QString const & detail) :
+   index{interactive.load(std::memory_order_relaxed) ? -1 : startPhase(QString{"%1 %2"}.arg(name).arg(detail))} {
+   return;
+}
+
+StartupProfiler::Phase::~Phase() {
+   if (this->index < 0) {
+      return;
+   }
+   qint64 const endNs = sinceProcessStart.nsecsElapsed();
+   QMutexLocker locker(&phasesMutex);
+   phases[this->index].durationNs = endNs - phases[this->index].startNs;
+   --currentDepth;
+   return;
+}
+
+void StartupProfiler::markInteractive() {
+   if (interactive.exchange(true)) {
+      // Already called
+      return;
+   }
+   nsToInteractive.store(sinceProcessStart.nsecsElapsed());
+   for (QString const & line : getReport().split('\n')) {
+      if (!line.isEmpty()) {
+         qInfo().noquote() << line;
+      }
+   }
+   return;
+}
+
+bool StartupProfiler::isInteractive() {
+   return interactive.load(std::memory_order_relaxed);
+}
+
+qint64 StartupProfiler::getMillisecondsToInteractive() {
+   qint64 const ns = nsToInteractive.load();
+   return ns < 0 ? -1 : ns / 1000000;
+}
+
+QString StartupProfiler::getReport() {
+   QString report;
+   QTextStream reportAsStream{&report};
+   reportAsStream << "Start-up phases (start and duration in milliseconds since the process started):\n";
+   {
+      QMutexLocker locker(&phasesMutex);
+      for (auto const & phase : phases) {
+         reportAsStream <<
+            QString{"%1 %2  %3%4\n"}.arg(
+               nsToMs(phase.startNs), 9, 'f', 1
+            ).arg(
+               // A phase that is still running (or was on another thread when we stopped recording) has no duration
+               phase.durationNs < 0 ? QString{"?"} : QString::number(nsToMs(phase.durationNs), 'f', 1), 9
+            ).arg(
+               QString(phase.depth * 3, QChar(' '))
+            ).arg(
+               phase.name
+            );
+      }
+   }
+   qint64 const ns = nsToInteractive.load();
+   if (ns < 0) {
+      reportAsStream << "Start-up not yet complete\n";
+   } else {
+      reportAsStream << QString{"Main window interactive after %1 ms\n"}.arg(nsToMs(ns), 0, 'f', 1);
+   }
+   return report;
+}
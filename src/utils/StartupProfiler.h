@@ -0,0 +1,85 @@
+/*
+ * utils/StartupProfiler.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UTILS_STARTUPPROFILER_H
+#define UTILS_STARTUPPROFILER_H
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * \brief Records how long each phase of program start-up takes, from the start of the process until the main window
+ *        is ready to use.  Unlike \c Tracing, this is always on, as it only records a few dozen entries per run.
+ *
+ *        Put a \c StartupProfiler::Phase at the start of a block that is part of (or might be part of) start-up, eg:
+ *
+ *           void ObjectStore::loadAll(Database * database) {
+ *              StartupProfiler::Phase startupPhase{"Load DB table", *this->pimpl->primaryTable.tableName};
+ *              ...
+ *
+ *        Phases can nest, and are shown indented in the report.  Once \c markInteractive() has been called, start-up
+ *        is over, the report is logged at INFO level, and further phases are ignored (so code that also runs later does
+ *        not keep adding to the report).
+ */
+namespace StartupProfiler {
+
+   /**
+    * \brief RAII object that records the wall time from its construction to its destruction as one start-up phase
+    */
+   class Phase {
+   public:
+      Phase(char const * const name);
+      //! \param detail Appended to \c name in the report -- eg the name of the DB table being loaded
+      Phase(char const * const name, QString const & detail);
+      ~Phase();
+
+   private:
+      //! Index of our entry in the list of phases, or -1 if we are not recording
+      int index;
+
+      // RAII class shouldn't be getting copied or moved
+      Phase(Phase const &) = delete;
+      Phase & operator=(Phase const &) = delete;
+      Phase(Phase &&) = delete;
+      Phase & operator=(Phase &&) = delete;
+   };
+
+   /**
+    * \brief Call once the main window is shown and the event loop is running.  Logs the start-up report.
+    */
+   void markInteractive();
+
+   /**
+    * \return \c true if \c markInteractive() has been called
+    */
+   bool isInteractive();
+
+   /**
+    * \return Milliseconds from process start to \c markInteractive(), or -1 if it has not been called yet
+    */
+   qint64 getMillisecondsToInteractive();
+
+   /**
+    * \return Human-readable table of all the phases recorded, with their start times and durations
+    */
+   QString getReport();
+
+}
+
+#endif
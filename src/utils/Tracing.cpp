@@ -0,0 +1,235 @@
+/*
+ * utils/Tracing.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "utils/Tracing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+int const Tracing::maxSpansPerThread = 1000000;
+
+std::atomic<bool> Tracing::enabledFlag{false};
+
+namespace {
+   struct Span {
+      char const * category;
+      char const * name;
+      qint64 startNs;
+      qint64 durationNs;
+   };
+
+   /**
+    * \brief The spans recorded on one thread.  The mutex is only ever contended while the spans are being written
+    *        out or cleared, so locking it when recording a span is cheap.
+    */
+   struct ThreadBuffer {
+      int threadId;
+      QString threadName;
+      QMutex mutex;
+      std::vector<Span> spans;
+      qint64 numDroppedSpans = 0;
+   };
+
+   //
+   // Every thread that has ever recorded a span has its buffer in threadBuffers.  We hold the buffers by shared_ptr so
+   // that spans recorded on a thread that has since finished (eg a BeerXML loader thread) are not lost.
+   //
+   QMutex threadBuffersMutex;
+   std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+   int nextThreadId = 1;
+
+   thread_local std::shared_ptr<ThreadBuffer> currentThreadBuffer;
+
+   ThreadBuffer & getCurrentThreadBuffer() {
+      if (!currentThreadBuffer) {
+         auto threadBuffer = std::make_shared<ThreadBuffer>();
+         QThread const * thread = QThread::currentThread();
+         QCoreApplication const * app = QCoreApplication::instance();
+         if (app && thread == app->thread()) {
+            threadBuffer->threadName = "Main";
+         } else if (!thread->objectName().isEmpty()) {
+            threadBuffer->threadName = thread->objectName();
+         } else {
+            threadBuffer->threadName = thread->metaObject()->className();
+         }
+
+         QMutexLocker locker(&threadBuffersMutex);
+         threadBuffer->threadId = nextThreadId++;
+         threadBuffers.push_back(threadBuffer);
+         currentThreadBuffer = threadBuffer;
+      }
+      return *currentThreadBuffer;
+   }
+
+   QByteArray toJsonString(QString const & input) {
+      QByteArray output{"\""};
+      for (QChar const character : input) {
+         if (character == '"' || character == '\\') {
+            output.append('\\').append(character.toLatin1());
+         } else if (character.unicode() < 0x20) {
+            output.append(QString{"\\u%1"}.arg(character.unicode(), 4, 16, QChar{'0'}).toLatin1());
+         } else {
+            output.append(QString{character}.toUtf8());
+         }
+      }
+      output.append('"');
+      return output;
+   }
+
+   //! Chrome trace timestamps and durations are in microseconds, but can have a fractional part
+   QByteArray toMicroseconds(qint64 nanoseconds) {
+      return QByteArray::number(static_cast<double>(nanoseconds) / 1000.0, 'f', 3);
+   }
+}
+
+void Tracing::setEnabled(bool enabled) {
+   enabledFlag.store(enabled, std::memory_order_relaxed);
+   return;
+}
+
+void Tracing::clear() {
+   QMutexLocker locker(&threadBuffersMutex);
+   for (auto & threadBuffer : threadBuffers) {
+      QMutexLocker bufferLocker(&threadBuffer->mutex);
+      threadBuffer->spans.clear();
+      threadBuffer->numDroppedSpans = 0;
+   }
+   return;
+}
+
+qint64 Tracing::getNumDroppedSpans() {
+   qint64 numDroppedSpans = 0;
+   QMutexLocker locker(&threadBuffersMutex);
+   for (auto & threadBuffer : threadBuffers) {
+      QMutexLocker bufferLocker(&threadBuffer->mutex);
+      numDroppedSpans += threadBuffer->numDroppedSpans;
+   }
+   return numDroppedSpans;
+}
+
+qint64 Tracing::now() {
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()
+   ).count();
+}
+
+void Tracing::recordSpan(char const * category, char const * name, qint64 startNs, qint64 endNs) {
+   ThreadBuffer & threadBuffer = getCurrentThreadBuffer();
+   QMutexLocker locker(&threadBuffer.mutex);
+   if (threadBuffer.spans.size() >= static_cast<size_t>(maxSpansPerThread)) {
+      ++threadBuffer.numDroppedSpans;
+      return;
+   }
+   threadBuffer.spans.push_back(Span{category, name, startNs, endNs - startNs});
+   return;
+}
+
+bool Tracing::writeChromeTrace(QString const & fileName) {
+   //
+   // Take a copy of everything recorded so far, so we don't hold up threads that are still recording while we write
+   // the file.
+   //
+   struct ThreadSpans {
+      int threadId;
+      QString threadName;
+      std::vector<Span> spans;
+   };
+   std::vector<ThreadSpans> allThreadSpans;
+   qint64 numDroppedSpans = 0;
+   {
+      QMutexLocker locker(&threadBuffersMutex);
+      for (auto & threadBuffer : threadBuffers) {
+         QMutexLocker bufferLocker(&threadBuffer->mutex);
+         allThreadSpans.push_back(ThreadSpans{threadBuffer->threadId, threadBuffer->threadName, threadBuffer->spans});
+         numDroppedSpans += threadBuffer->numDroppedSpans;
+      }
+   }
+
+   // Timestamps are easier to read in the viewer if they start from (about) zero
+   qint64 firstStartNs = std::numeric_limits<qint64>::max();
+   for (auto const & threadSpans : allThreadSpans) {
+      for (auto const & span : threadSpans.spans) {
+         firstStartNs = std::min(firstStartNs, span.startNs);
+      }
+   }
+
+   QFile file{fileName};
+   if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      qWarning() << Q_FUNC_INFO << "Could not open" << fileName << "for writing:" << file.errorString();
+      return false;
+   }
+
+   QByteArray const processId = QByteArray::number(QCoreApplication::applicationPid());
+   QByteArray output{"{\"traceEvents\":[\n"};
+   bool firstEvent = true;
+   auto startEvent = [&output, &firstEvent]() {
+      if (!firstEvent) {
+         output.append(",\n");
+      }
+      firstEvent = false;
+      return;
+   };
+   for (auto const & threadSpans : allThreadSpans) {
+      QByteArray const threadId = QByteArray::number(threadSpans.threadId);
+      // Metadata event so the viewer shows a name for the thread rather than just a number
+      startEvent();
+      output.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":").append(processId)
+            .append(",\"tid\":").append(threadId)
+            .append(",\"args\":{\"name\":").append(toJsonString(threadSpans.threadName)).append("}}");
+      for (auto const & span : threadSpans.spans) {
+         startEvent();
+         output.append("{\"name\":").append(toJsonString(QString::fromUtf8(span.name)))
+               .append(",\"cat\":").append(toJsonString(QString::fromUtf8(span.category)))
+               .append(",\"ph\":\"X\",\"pid\":").append(processId)
+               .append(",\"tid\":").append(threadId)
+               .append(",\"ts\":").append(toMicroseconds(span.startNs - firstStartNs))
+               .append(",\"dur\":").append(toMicroseconds(span.durationNs))
+               .append('}');
+         // Write in chunks so we don't need the whole file in memory
+         if (output.size() > 1024 * 1024) {
+            file.write(output);
+            output.clear();
+         }
+      }
+   }
+   output.append("\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedSpans\":")
+         .append(QByteArray::number(numDroppedSpans)).append("}}\n");
+   file.write(output);
+   file.close();
+
+   if (file.error() != QFileDevice::NoError) {
+      qWarning() << Q_FUNC_INFO << "Error writing" << fileName << ":" << file.errorString();
+      return false;
+   }
+
+   qInfo() << Q_FUNC_INFO << "Wrote trace of" << allThreadSpans.size() << "thread(s) to" << fileName;
+   if (numDroppedSpans > 0) {
+      qWarning() << Q_FUNC_INFO << numDroppedSpans << "spans were not recorded because buffers were full";
+   }
+   return true;
+}
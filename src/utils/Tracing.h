@@ -0,0 +1,137 @@
+/*
+ * utils/Tracing.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UTILS_TRACING_H
+#define UTILS_TRACING_H
+#pragma once
+
+#include <atomic>
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * \brief Lightweight instrumentation to show where time goes when the program is running.
+ *
+ *        Put a \c TRACE_SPAN at the start of a block (typically a function) you want to measure, eg:
+ *
+ *           void ObjectStore::loadAll(Database * database) {
+ *              TRACE_SPAN("db", "ObjectStore::loadAll");
+ *              ...
+ *
+ *        When tracing is enabled, each span records its start time and duration (to the nearest nanosecond) in a
+ *        buffer belonging to the current thread, so recording does not need to wait on other threads.  When tracing
+ *        is disabled (the default), a span costs one relaxed atomic read and a branch.
+ *
+ *        The recorded spans can be written out in the Trace Event JSON format understood by chrome://tracing and
+ *        https://ui.perfetto.dev, which show them as a timeline per thread, with nested spans stacked.
+ *
+ *        Tracing is turned on by the --trace command-line option.
+ */
+namespace Tracing {
+   /**
+    * \brief Maximum number of spans we keep per thread.  Once a thread's buffer is full, further spans on that thread
+    *        are counted (see \c getNumDroppedSpans()) but not stored, so that leaving tracing on does not use up all
+    *        the memory.
+    */
+   extern int const maxSpansPerThread;
+
+   //! \brief Don't use this directly.  Call \c isEnabled() instead.
+   extern std::atomic<bool> enabledFlag;
+
+   /**
+    * \return \c true if spans are currently being recorded
+    */
+   inline bool isEnabled() {
+      return enabledFlag.load(std::memory_order_relaxed);
+   }
+
+   /**
+    * \brief Start or stop recording spans.  Spans already recorded are kept until \c clear() is called.
+    */
+   void setEnabled(bool enabled);
+
+   /**
+    * \brief Discard all recorded spans.  Should not be called while spans are being recorded on other threads.
+    */
+   void clear();
+
+   /**
+    * \return Number of spans, across all threads, that were not recorded because a thread's buffer was full
+    */
+   qint64 getNumDroppedSpans();
+
+   /**
+    * \brief Write all the spans recorded so far, on all threads, to a JSON file that can be loaded into
+    *        chrome://tracing or https://ui.perfetto.dev
+    *
+    * \return \c true if the file was written successfully, \c false otherwise (in which case the reason is logged)
+    */
+   bool writeChromeTrace(QString const & fileName);
+
+   //! \brief Nanoseconds since an arbitrary fixed point, from a monotonic clock.  Used for span timings.
+   qint64 now();
+
+   //! \brief Called when a span ends.  Don't call this directly -- use \c TRACE_SPAN.
+   void recordSpan(char const * category, char const * name, qint64 startNs, qint64 endNs);
+
+   /**
+    * \brief Records the time from its construction to its destruction as a span.  Normally created via
+    *        \c TRACE_SPAN.
+    *
+    *        NB: \c category and \c name are stored as pointers, so they must be string literals (or otherwise live
+    *        for the rest of the program).
+    */
+   class ScopedSpan {
+   public:
+      ScopedSpan(char const * category, char const * name) :
+         category{category},
+         name{isEnabled() ? name : nullptr},
+         startNs{this->name ? now() : 0} {
+         return;
+      }
+
+      ~ScopedSpan() {
+         if (this->name) {
+            recordSpan(this->category, this->name, this->startNs, now());
+         }
+         return;
+      }
+
+   private:
+      ScopedSpan(ScopedSpan const &) = delete;
+      ScopedSpan & operator=(ScopedSpan const &) = delete;
+
+      char const * const category;
+      //! Null if tracing was not enabled when the span was created
+      char const * const name;
+      qint64 const startNs;
+   };
+}
+
+// Two levels of macro are needed to get __LINE__ expanded before it is pasted onto the variable name
+#define TRACE_SPAN_VARIABLE_NAME_INNER(line) tracingScopedSpan##line
+#define TRACE_SPAN_VARIABLE_NAME(line) TRACE_SPAN_VARIABLE_NAME_INNER(line)
+
+/**
+ * \brief Record the time from here to the end of the current block as a span called \c name in category
+ *        \c category.  Both parameters must be string literals.
+ */
+#define TRACE_SPAN(category, name) Tracing::ScopedSpan const TRACE_SPAN_VARIABLE_NAME(__LINE__){category, name}
+
+#endif
@@ -23,6 +23,7 @@
 #include <QApplication>
 #include <QDebug>
 
+#include "Logging.h"
 #include "measurement/Measurement.h"
 #include "measurement/SystemOfMeasurement.h"
 #include "measurement/Unit.h"
@@ -90,10 +91,10 @@ std::optional<T> UnitAndScalePopUpMenu::dataFromQAction(QAction const & action)
    Q_ASSERT(data.type() == QVariant::Int);
    int raw = data.toInt();
    if (raw < 0) {
-      qDebug() << Q_FUNC_INFO << "Raw" << raw << "= null";
+      qCDebug(Logging::ui) << Q_FUNC_INFO << "Raw" << raw << "= null";
       return std::nullopt;
    }
-   qDebug() << Q_FUNC_INFO << "Raw" << raw << "=" << static_cast<T>(raw);
+   qCDebug(Logging::ui) << Q_FUNC_INFO << "Raw" << raw << "=" << static_cast<T>(raw);
    return static_cast<T>(raw);
 }
 //
@@ -22,6 +22,7 @@
 #include <stdexcept>
 
 #include <QApplication>
+#include <QBuffer>
 #include <QDebug>
 #include <QDomNodeList>
 #include <QFile>
@@ -31,6 +32,7 @@
 #include <QTextStream>
 
 #include "config.h" // For VERSIONSTRING
+#include "Logging.h"
 #include "model/BrewNote.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
@@ -596,11 +598,15 @@ public:
     * \param fileName Fully-qualified name of the file to validate
     * \param userMessage Any message that we want the top-level caller to display to the user (either about an error
     *                    or, in the event of success, summarising what was read in) should be appended to this string.
+    * \param recordLoadedHandler If null, everything is stored in the DB as it is read in.  Otherwise, see
+    *                            \c XmlCoding::validateAndLoad().
     *
     * \return true if file validated OK (including if there were "errors" that we can safely ignore)
     *         false if there was a problem that means it's not worth trying to read in the data from the file
     */
-   bool validateAndLoad(QString const & fileName, QTextStream & userMessage) {
+   bool validateAndLoad(QString const & fileName,
+                        QTextStream & userMessage,
+                        XmlRecord::ChildRecordLoadedHandler const * recordLoadedHandler = nullptr) {
 
       QFile inputFile;
       inputFile.setFileName(fileName);
@@ -610,6 +616,19 @@ public:
          return false;
       }
 
+      return this->validateAndLoad(inputFile, fileName, userMessage, recordLoadedHandler);
+   }
+
+   /**
+    * \brief As above, but reading from an already-open device (eg a \c QBuffer for a document we have in memory)
+    *
+    * \param fileName Name of the file the document came from, for use in error messages
+    */
+   bool validateAndLoad(QIODevice & inputFile,
+                        QString const & fileName,
+                        QTextStream & userMessage,
+                        XmlRecord::ChildRecordLoadedHandler const * recordLoadedHandler = nullptr) {
+
       //
       // Rather than just read the XML file into memory, we actually make a small on-the-fly modification to it to
       // place all the top-level content inside a <BEER_XML>...</BEER_XML> field.  This massively simplifies the XSD
@@ -651,7 +670,7 @@ public:
       //
       QByteArray documentData = inputFile.readLine();
       QString firstLine{documentData};
-      qDebug() << Q_FUNC_INFO << "First line of " << inputFile.fileName() << " was " << firstLine;
+      qCDebug(Logging::xml) << Q_FUNC_INFO << "First line of " << fileName << " was " << firstLine;
       if (!firstLine.startsWith(QString("<?xml version="))) {
          //
          // For the moment, we're being strict and bailing out here.  An alternative approach would be to accept files
@@ -666,11 +685,12 @@ public:
       documentData += "<BEER_XML>\n";
       documentData += inputFile.readAll();
       documentData += "\n</BEER_XML>";
-      qDebug() << Q_FUNC_INFO << "Input file " << inputFile.fileName() << ": " << documentData.length() << " bytes";
+      qCDebug(Logging::xml) << Q_FUNC_INFO << "Input file " << fileName << ": " << documentData.length()
+         << " bytes";
 
       // It is sometimes helpful to uncomment the next line for debugging, but usually leave it commented out as can
       // put a _lot_ of data in the logs in DEBUG mode.
-      // qDebug().noquote() << Q_FUNC_INFO << "Full content of " << inputFile.fileName() << " is:\n" << QString(documentData);
+      // qDebug().noquote() << Q_FUNC_INFO << "Full content of " << fileName << " is:\n" << QString(documentData);
 
       //
       // Some errors we explicitly want to ignore.  In particular, the BeerXML 1.0 standard says:
@@ -703,6 +723,13 @@ public:
       };
       BtDomErrorHandler domErrorHandler(&errorPatternsToIgnore, 1, 1);
 
+      if (recordLoadedHandler) {
+         return this->BeerXml1Coding.validateAndLoad(documentData,
+                                                     fileName,
+                                                     domErrorHandler,
+                                                     userMessage,
+                                                     *recordLoadedHandler);
+      }
       return this->BeerXml1Coding.validateLoadAndStoreInDb(documentData, fileName, domErrorHandler, userMessage);
 
    }
@@ -805,3 +832,24 @@ bool BeerXML::importFromXML(QString const & filename, QTextStream & userMessage)
    QApplication::restoreOverrideCursor();
    return result;
 }
+
+bool BeerXML::importFromXML(QByteArray const & documentData,
+                            QString const & documentName,
+                            QTextStream & userMessage) {
+   // See above for why we suspend versioning and show the busy cursor
+   RecipeHelper::SuspendRecipeVersioning suspendRecipeVersioning;
+   QApplication::setOverrideCursor(Qt::WaitCursor);
+   QApplication::processEvents();
+   QBuffer inputBuffer;
+   inputBuffer.setData(documentData);
+   inputBuffer.open(QIODevice::ReadOnly);
+   bool result = this->pimpl->validateAndLoad(inputBuffer, documentName, userMessage);
+   QApplication::restoreOverrideCursor();
+   return result;
+}
+
+bool BeerXML::loadFromXML(QString const & filename,
+                          QTextStream & userMessage,
+                          std::function<bool(std::shared_ptr<XmlRecord>)> const & recordLoadedHandler) {
+   return this->pimpl->validateAndLoad(filename, userMessage, &recordLoadedHandler);
+}
@@ -20,12 +20,16 @@
 #ifndef XML_BEERXML_H
 #define XML_BEERXML_H
 
+#include <functional>
 #include <memory> // For PImpl
 
+#include <QByteArray>
 #include <QFile>
 #include <QString>
 #include <QTextStream>
 
+class XmlRecord;
+
 /*!
  * \class BeerXML
  *
@@ -62,6 +66,27 @@ public:
     */
    bool importFromXML(QString const & filename, QTextStream & userMessage);
 
+   /*! Import ingredients, recipes, etc from a BeerXML document we already have in memory.
+    * \param documentData The whole document, starting with the XML declaration
+    * \param documentName What to call the document in log messages (eg the file it was made from)
+    * \param userMessage As above
+    * \return true if succeeded, false otherwise
+    */
+   bool importFromXML(QByteArray const & documentData, QString const & documentName, QTextStream & userMessage);
+
+   /*! Validate and load a BeerXML document without storing anything in the DB.  Instead each top-level record (hop,
+    *  recipe, etc) is passed to \c recordLoadedHandler as soon as it has been loaded, and it is the handler's job to
+    *  store it (via \c XmlRecord::normaliseAndStoreInDb).  This does not touch the DB, so it can be run on a worker
+    *  thread.  See \c BeerXmlImport.
+    * \param filename
+    * \param userMessage Where to write any (brief!) message about why the load failed
+    * \param recordLoadedHandler Returns \c false to abandon the load
+    * \return true if succeeded, false otherwise
+    */
+   bool loadFromXML(QString const & filename,
+                    QTextStream & userMessage,
+                    std::function<bool(std::shared_ptr<XmlRecord>)> const & recordLoadedHandler);
+
 private:
    // Private implementation details - see https://herbsutter.com/gotw/_100/
    class impl;
@@ -0,0 +1,413 @@
+/*
+ * xml/BeerXmlImport.cpp is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "xml/BeerXmlImport.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+
+#include "database/Database.h"
+#include "database/DbTransaction.h"
+#include "Logging.h"
+#include "model/Recipe.h"
+#include "xml/BeerXml.h"
+#include "xml/XmlRecord.h"
+#include "xml/XmlRecordCount.h"
+
+int const BeerXmlImport::BATCH_SIZE = 25;
+
+// This private implementation class holds all private non-virtual members of BeerXmlImport
+class BeerXmlImport::impl {
+public:
+
+   /**
+    * \brief A worker thread that reads, validates and loads files.  It never touches the DB.  Each worker thread keeps
+    *        taking the next file that no other thread has started on until there are none left.
+    */
+   class LoaderThread : public QThread {
+   public:
+      LoaderThread(BeerXmlImport::impl & owner) : QThread{}, owner{owner} {
+         return;
+      }
+
+      virtual ~LoaderThread() = default;
+
+   protected:
+      virtual void run() {
+         for (int fileIndex = this->owner.nextFileIndex++;
+              fileIndex < this->owner.fileNames.size() && !this->owner.cancelRequested;
+              fileIndex = this->owner.nextFileIndex++) {
+            this->owner.loadFile(fileIndex);
+         }
+         {
+            QMutexLocker locker{&this->owner.mutex};
+            ++this->owner.numLoaderThreadsFinished;
+         }
+         this->owner.wakeGuiThread();
+         return;
+      }
+
+   private:
+      BeerXmlImport::impl & owner;
+   };
+
+   impl(BeerXmlImport & self, QStringList const & fileNames) :
+      self{self},
+      fileNames{fileNames},
+      guiThread{self.thread()},
+      loaderThreads{},
+      cancelRequested{false},
+      storeScheduled{false},
+      nextFileIndex{0},
+      numRecordsLoaded{0},
+      mutex{},
+      pendingRecords{},
+      numLoaderThreadsFinished{0},
+      fileLoadSucceeded(fileNames.size(), false),
+      fileLoadMessages(fileNames.size()),
+      started{false},
+      running{false},
+      isStoring{false},
+      storeFailed{false},
+      numRecordsProcessed{0},
+      stats{},
+      storeMessage{},
+      storeMessageAsStream{&storeMessage} {
+      return;
+   }
+
+   ~impl() {
+      // If we're being destroyed mid-import, we need the worker threads to stop before we go away
+      this->cancelRequested = true;
+      for (auto & loaderThread : this->loaderThreads) {
+         loaderThread->wait();
+      }
+      return;
+   }
+
+   /**
+    * \brief Called on a worker thread to read, validate and load one file
+    */
+   void loadFile(int const fileIndex) {
+      QString const & fileName = this->fileNames.at(fileIndex);
+      qCDebug(Logging::xml) << Q_FUNC_INFO << "Loading" << fileName << "on" << QThread::currentThread();
+      int numRecordsLoadedFromFile = 0;
+      QString loadMessage;
+      QTextStream loadMessageAsStream{&loadMessage};
+      bool const succeeded = BeerXML::getInstance().loadFromXML(
+         fileName,
+         loadMessageAsStream,
+         [this, &numRecordsLoadedFromFile](std::shared_ptr<XmlRecord> xmlRecord) {
+            if (this->cancelRequested) {
+               return false;
+            }
+            // The GUI thread is going to do the storing, so it needs to own the objects we created
+            xmlRecord->moveNamedEntitiesToThread(this->guiThread);
+            {
+               QMutexLocker locker{&this->mutex};
+               this->pendingRecords.enqueue(xmlRecord);
+            }
+            ++numRecordsLoadedFromFile;
+            ++this->numRecordsLoaded;
+            this->wakeGuiThread();
+            return true;
+         }
+      );
+      qCDebug(Logging::xml) <<
+         Q_FUNC_INFO << "Loading" << fileName << (succeeded ? "succeeded" : "failed") << "after" <<
+         numRecordsLoadedFromFile << "records";
+      {
+         QMutexLocker locker{&this->mutex};
+         this->fileLoadSucceeded[fileIndex] = succeeded;
+         this->fileLoadMessages[fileIndex] = loadMessage;
+      }
+      return;
+   }
+
+   /**
+    * \return \c true if all the worker threads have finished.  Caller must hold \c mutex.
+    */
+   bool loadFinished() const {
+      return this->numLoaderThreadsFinished == static_cast<int>(this->loaderThreads.size());
+   }
+
+   /**
+    * \brief Ask (from any thread) for storePendingRecords() to be called on the GUI thread.  We make sure there is
+    *        only ever one such call waiting in the event queue.
+    */
+   void wakeGuiThread() {
+      if (!this->storeScheduled.exchange(true)) {
+         QMetaObject::invokeMethod(&this->self, "storePendingRecords", Qt::QueuedConnection);
+      }
+      return;
+   }
+
+   /**
+    * \brief Store one batch of records in a single DB transaction.  If we are cancelled part way through, or something
+    *        goes wrong, then everything done in this batch is undone.
+    */
+   void storeBatch(QVector<std::shared_ptr<XmlRecord> > const & batch) {
+      //
+      // As in BeerXML::importFromXML, we don't want automatic versioning while we're reading in Recipes.  We only
+      // suspend it while we're storing a batch though, as the user can carry on doing other things in between.
+      //
+      RecipeHelper::SuspendRecipeVersioning suspendRecipeVersioning;
+
+      Database & database = Database::instance();
+      QSqlDatabase connection = database.sqlDatabase();
+      DbTransaction dbTransaction{database, connection};
+
+      XmlRecordCount batchStats;
+      QVector<std::shared_ptr<XmlRecord> > processedRecords;
+      for (auto xmlRecord : batch) {
+         if (this->cancelRequested) {
+            break;
+         }
+         if (XmlRecord::ProcessingResult::Failed ==
+             xmlRecord->normaliseAndStoreInDb(nullptr, this->storeMessageAsStream, batchStats)) {
+            this->storeFailed = true;
+            break;
+         }
+         processedRecords.append(xmlRecord);
+         ++this->numRecordsProcessed;
+         // Anything connected to this signal might process events, in which case cancel() might get called
+         emit this->self.progress(this->numRecordsProcessed, this->numRecordsLoaded);
+      }
+
+      if (!this->cancelRequested && !this->storeFailed) {
+         if (dbTransaction.commit()) {
+            this->stats.add(batchStats);
+            return;
+         }
+         this->storeFailed = true;
+         this->storeMessageAsStream << BeerXmlImport::tr("Error saving to database.  See logs for more details");
+      }
+
+      //
+      // Rolling back the transaction (which happens when dbTransaction goes out of scope) takes care of the DB, but
+      // the object stores also need to forget everything we stored in this batch.
+      //
+      qCInfo(Logging::xml) <<
+         Q_FUNC_INFO << "Rolling back" << processedRecords.size() << "records from" << this->fileNames <<
+         (this->storeFailed ? "after error" : "on cancellation");
+      for (auto ii = processedRecords.rbegin(); ii != processedRecords.rend(); ++ii) {
+         (*ii)->undoStoreInDb();
+      }
+      this->numRecordsProcessed -= processedRecords.size();
+      // Make sure the worker threads stop too
+      this->cancelRequested = true;
+      return;
+   }
+
+   /**
+    * \brief Called once, on the GUI thread, when both loading and storing are done
+    */
+   void finish() {
+      this->running = false;
+      // The worker threads have already told us they're finished, so this won't block for more than an instant
+      for (auto & loaderThread : this->loaderThreads) {
+         loaderThread->wait();
+      }
+
+      QString userMessage;
+      QTextStream userMessageAsStream{&userMessage};
+      bool succeeded = false;
+      if (this->storeFailed) {
+         userMessageAsStream << this->storeMessage;
+      } else if (this->cancelRequested) {
+         userMessageAsStream << BeerXmlImport::tr("Import cancelled.");
+         // Tell the user about anything that was stored before we were cancelled
+         QString summary;
+         QTextStream summaryAsStream{&summary};
+         if (this->stats.writeToUserMessage(summaryAsStream)) {
+            userMessageAsStream << "\n\n" << summary;
+         }
+      } else {
+         //
+         // One bad file doesn't stop us storing what we read from the others, so the user needs to hear about both.
+         // (The worker threads are all done, so we don't need the mutex to look at what they wrote.)
+         //
+         bool allLoadsSucceeded = true;
+         for (int fileIndex = 0; fileIndex < this->fileNames.size(); ++fileIndex) {
+            if (!this->fileLoadSucceeded.at(fileIndex)) {
+               allLoadsSucceeded = false;
+               if (this->fileNames.size() > 1) {
+                  QString const fileName = QFileInfo(this->fileNames.at(fileIndex)).fileName();
+                  userMessageAsStream << BeerXmlImport::tr("Error reading \"%1\": ").arg(fileName);
+               }
+               userMessageAsStream << this->fileLoadMessages.at(fileIndex) << "\n\n";
+            }
+         }
+         succeeded = this->stats.writeToUserMessage(userMessageAsStream) && allLoadsSucceeded;
+      }
+
+      qCInfo(Logging::xml) <<
+         Q_FUNC_INFO << "Import of" << this->fileNames.size() << "file(s)" << (succeeded ? "succeeded" : "failed");
+      emit this->self.finished(succeeded, userMessage);
+      return;
+   }
+
+   BeerXmlImport & self;
+   QStringList const fileNames;
+   QThread * const guiThread;
+   std::vector<std::unique_ptr<LoaderThread> > loaderThreads;
+
+   // Shared between threads
+   std::atomic<bool> cancelRequested;
+   std::atomic<bool> storeScheduled;
+   std::atomic<int> nextFileIndex;
+   std::atomic<int> numRecordsLoaded;
+
+   // Shared between threads and protected by mutex
+   QMutex mutex;
+   QQueue<std::shared_ptr<XmlRecord> > pendingRecords;
+   int numLoaderThreadsFinished;
+   QVector<bool> fileLoadSucceeded;
+   QVector<QString> fileLoadMessages;
+
+   // Only accessed on the GUI thread
+   bool started;
+   bool running;
+   bool isStoring;
+   bool storeFailed;
+   int numRecordsProcessed;
+   XmlRecordCount stats;
+   QString storeMessage;
+   QTextStream storeMessageAsStream;
+};
+
+BeerXmlImport::BeerXmlImport(QString const & fileName, QObject * parent) :
+   BeerXmlImport{QStringList{fileName}, parent} {
+   return;
+}
+
+BeerXmlImport::BeerXmlImport(QStringList const & fileNames, QObject * parent) :
+   QObject{parent},
+   pimpl{std::make_unique<impl>(*this, fileNames)} {
+   return;
+}
+
+// See https://herbsutter.com/gotw/_100/ for why we need to explicitly define the destructor here (and not in the
+// header file)
+BeerXmlImport::~BeerXmlImport() = default;
+
+QStringList BeerXmlImport::getFileNames() const {
+   return this->pimpl->fileNames;
+}
+
+void BeerXmlImport::start() {
+   if (this->pimpl->started) {
+      // It's a coding error to try to start an import twice
+      qWarning() << Q_FUNC_INFO << "Import of" << this->pimpl->fileNames << "already started";
+      return;
+   }
+
+   //
+   // There's no point having more worker threads than files, nor (since reading in files is CPU-bound) than cores.
+   // Note that QThread::idealThreadCount() can return -1 if it can't work out the number of cores.
+   //
+   int const numLoaderThreads = std::min(std::max(QThread::idealThreadCount(), 1), this->pimpl->fileNames.size());
+   qCInfo(Logging::xml) <<
+      Q_FUNC_INFO << "Starting import of" << this->pimpl->fileNames.size() << "file(s) on" << numLoaderThreads <<
+      "thread(s)";
+   this->pimpl->started = true;
+   this->pimpl->running = true;
+   for (int ii = 0; ii < numLoaderThreads; ++ii) {
+      this->pimpl->loaderThreads.push_back(std::make_unique<impl::LoaderThread>(*this->pimpl));
+   }
+   for (auto & loaderThread : this->pimpl->loaderThreads) {
+      loaderThread->start();
+   }
+   if (this->pimpl->loaderThreads.empty()) {
+      // Nothing to read, but we still need to emit finished
+      this->pimpl->wakeGuiThread();
+   }
+   return;
+}
+
+void BeerXmlImport::cancel() {
+   if (this->pimpl->running) {
+      qCInfo(Logging::xml) << Q_FUNC_INFO << "Cancelling import of" << this->pimpl->fileNames;
+      this->pimpl->cancelRequested = true;
+      // Make sure we get round to noticing, even if there's nothing waiting to be stored
+      this->pimpl->wakeGuiThread();
+   }
+   return;
+}
+
+bool BeerXmlImport::isRunning() const {
+   return this->pimpl->running;
+}
+
+void BeerXmlImport::storePendingRecords() {
+   this->pimpl->storeScheduled = false;
+   if (!this->pimpl->running || this->pimpl->isStoring) {
+      //
+      // Either we already finished or we have been called re-entrantly (eg because something connected to our progress
+      // signal called QCoreApplication::processEvents(), as QProgressDialog does when it is modal).  In the latter case,
+      // the outer call will pick up any new records when it's done.
+      //
+      return;
+   }
+
+   QVector<std::shared_ptr<XmlRecord> > batch;
+   {
+      QMutexLocker locker{&this->pimpl->mutex};
+      while (!this->pimpl->pendingRecords.isEmpty() && batch.size() < BATCH_SIZE) {
+         batch.append(this->pimpl->pendingRecords.dequeue());
+      }
+   }
+
+   if (!batch.isEmpty() && !this->pimpl->cancelRequested) {
+      this->pimpl->isStoring = true;
+      this->pimpl->storeBatch(batch);
+      this->pimpl->isStoring = false;
+   }
+
+   bool loadFinished;
+   bool morePending;
+   {
+      QMutexLocker locker{&this->pimpl->mutex};
+      if (this->pimpl->cancelRequested) {
+         // Anything loaded but not yet stored just gets thrown away
+         this->pimpl->pendingRecords.clear();
+      }
+      loadFinished = this->pimpl->loadFinished();
+      morePending = !this->pimpl->pendingRecords.isEmpty();
+   }
+
+   if (loadFinished && !morePending) {
+      this->pimpl->finish();
+   } else if (morePending) {
+      // Go back to the event loop before doing the next batch, so that the UI stays responsive
+      this->pimpl->wakeGuiThread();
+   }
+   // Otherwise the worker threads will wake us when there is more to do
+   return;
+}
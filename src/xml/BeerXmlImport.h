@@ -0,0 +1,117 @@
+/*
+ * xml/BeerXmlImport.h is part of Brewtarget, and is copyright the following
+ * authors 2022:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef XML_BEERXMLIMPORT_H
+#define XML_BEERXMLIMPORT_H
+#pragma once
+
+#include <memory> // For PImpl
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+/*!
+ * \class BeerXmlImport
+ *
+ * \brief Imports one or more BeerXML files without blocking the GUI.  (\c BeerXML::importFromXML does the whole job
+ *        in one go on the calling thread, which is fine for small files and for the command line, but freezes the
+ *        application for large imports.)
+ *
+ *        Reading, validating and parsing the files is done on worker threads -- one per core, up to the number of
+ *        files, with each thread taking the next unread file when it finishes one.  As each top-level record (hop,
+ *        recipe, etc) is loaded, it is put on a queue.  The GUI thread takes records off the queue and stores them in
+ *        the DB, \c BATCH_SIZE records per DB transaction, returning to the event loop between batches so that the UI
+ *        stays responsive.  (The DB has to be written from the GUI thread because that is where the object stores,
+ *        and everything that is watching them, live.)  So only the final storing step is serialised, and importing
+ *        a directory full of files is not limited to one core.
+ *
+ *        Cancellation is cooperative: \c cancel() asks the worker threads to stop loading at the next record and the
+ *        GUI thread to stop storing.  Anything stored in the batch that was in progress is rolled back.  Batches that
+ *        were already committed are kept (and included in the summary).
+ *
+ *        Usage is:
+ *           - construct
+ *           - connect to \c progress and \c finished signals
+ *           - call \c start()
+ *           - (optionally) call \c cancel()
+ *           - wait for \c finished, which is always emitted exactly once
+ */
+class BeerXmlImport : public QObject {
+   Q_OBJECT
+
+public:
+   //! \brief Number of records we store in each DB transaction
+   static int const BATCH_SIZE;
+
+   BeerXmlImport(QString const & fileName, QObject * parent = nullptr);
+   BeerXmlImport(QStringList const & fileNames, QObject * parent = nullptr);
+   virtual ~BeerXmlImport();
+
+   QStringList getFileNames() const;
+
+   /**
+    * \brief Start the import.  Returns immediately.
+    */
+   void start();
+
+   /**
+    * \brief Ask the import to stop as soon as possible.  Does nothing if the import has already finished.
+    *        (NB: The validation and parsing of a file by Xerces can't be interrupted, so, if we are still doing that,
+    *        \c finished will only be emitted once it is complete.)
+    */
+   void cancel();
+
+   /**
+    * \return \c true if \c start() has been called and \c finished has not yet been emitted
+    */
+   bool isRunning() const;
+
+signals:
+   /**
+    * \brief Emitted after each top-level record has been stored (or skipped as a duplicate)
+    *
+    * \param numRecordsProcessed How many top-level records have been stored or skipped so far
+    * \param numRecordsLoaded How many top-level records have been read in from the file(s) so far.  Until the worker
+    *                         threads have finished reading all the files, this will keep going up.
+    */
+   void progress(int numRecordsProcessed, int numRecordsLoaded);
+
+   /**
+    * \brief Emitted exactly once when the import is complete, has failed, or has been cancelled
+    *
+    * \param succeeded \c false if the import failed or was cancelled
+    * \param userMessage The same sort of message as \c BeerXML::importFromXML gives: why each file that could not be
+    *                    read failed, and/or an \c XmlRecordCount summary of what was read in from all the files
+    */
+   void finished(bool succeeded, QString const & userMessage);
+
+private slots:
+   /**
+    * \brief Called (on the GUI thread) whenever there are records waiting to be stored or a worker thread has
+    *        finished.
+    */
+   void storePendingRecords();
+
+private:
+   // Private implementation details - see https://herbsutter.com/gotw/_100/
+   class impl;
+   std::unique_ptr<impl> pimpl;
+};
+
+#endif
@@ -25,6 +25,7 @@
 #include <xercesc/dom/DOMLocator.hpp>
 #include <xercesc/dom/DOMError.hpp>
 
+#include "Logging.h"
 #include "xml/XQString.h"
 
 // This private implementation class holds all private non-virtual members of BtDomErrorHandler
@@ -96,7 +97,7 @@ QString BtDomErrorHandler::getlastError() {
 unsigned int BtDomErrorHandler::correctErrorLine(unsigned int lineNumberOfError) {
    if (this->pimpl->numberOfLinesInserted > 0 &&
          lineNumberOfError > (this->pimpl->lineAfterWhichInserted + this->pimpl->numberOfLinesInserted)) {
-      qDebug() <<
+      qCDebug(Logging::xml) <<
          Q_FUNC_INFO << "Removing " << this->pimpl->numberOfLinesInserted << " from raw line number of error ("<<
          lineNumberOfError << ")";
       return lineNumberOfError - this->pimpl->numberOfLinesInserted;
@@ -44,6 +44,9 @@
 #include <xalanc/XercesParserLiaison/XercesDOMSupport.hpp>
 #include <xalanc/XPath/XPathEvaluator.hpp>
 
+#include "Logging.h"
+#include "utils/StartupProfiler.h"
+#include "utils/Tracing.h"
 #include "xml/BtDomDocumentOwner.h"
 #include "xml/XercesHelpers.h"
 #include "xml/XmlRecordCount.h"
@@ -96,6 +99,19 @@
 // using a huge number of different function calls.
 //
 
+namespace {
+   //
+   // Xerces objects created by DOMImplementationLS::createLSParser() have to be given back via release() rather than
+   // deleted.  This lets us hold one in a std::unique_ptr.
+   //
+   struct DomLsParserReleaser {
+      void operator()(xercesc::DOMLSParser * parser) const {
+         parser->release();
+         return;
+      }
+   };
+   typedef std::unique_ptr<xercesc::DOMLSParser, DomLsParserReleaser> DomLsParserPtr;
+}
 
 //
 // Private implementation class for XmlCoding
@@ -106,13 +122,19 @@ public:
    /**
     * Constructor
     */
-   impl(QString const schemaResource) /* : grammarPool(xercesc::XMLPlatformUtils::fgMemoryManager)*/ {
+   impl(QString const schemaResource) :
+      grammarPool{new xercesc::XMLGrammarPoolImpl(xercesc::XMLPlatformUtils::fgMemoryManager)},
+      domImplementation{nullptr} {
       this->loadSchema(schemaResource);
       return;
    }
 
    /**
     * Destructor
+    *
+    * NB: We deliberately do not delete grammarPool here.  XmlCoding objects live in singletons that are only destroyed
+    *     after main() has returned, by which point the Xerces library has been terminated and it is no longer safe to
+    *     give memory back to it.
     */
    ~impl() = default;
 
@@ -127,6 +149,7 @@ public:
     *                       for file permissions or file not found etc.
     */
    void loadSchema(QString const & schemaResource) {
+      StartupProfiler::Phase startupPhase{"Load XML schema", schemaResource};
       //
       // See https://stackoverflow.com/questions/52275608/xerces-c-validate-xml-with-hardcoded-xsd and
       // http://www.codesynthesis.com/~boris/blog/2010/03/15/validating-external-schemas-xerces-cxx/ (plus linked
@@ -156,6 +179,83 @@ public:
       XQString const features("LS");
       this->domImplementation = xercesc::DOMImplementationRegistry::getDOMImplementation(features.getXercesString());
 
+      // NB: The error handler needs to outlive the parser that points to it, so we declare it first
+      BtDomErrorHandler domErrorHandler;
+      DomLsParserPtr parser = this->createParser();
+      xercesc::DOMConfiguration * config = parser->getDomConfig();
+      config->setParameter(xercesc::XMLUni::fgDOMErrorHandler, &domErrorHandler);
+
+      QFile schemaFile(schemaResource);
+      if (!schemaFile.open(QIODevice::ReadOnly)) {
+         // This should pretty much never happen, as we're loading from a QResource compiled into the binary rather
+         // than reading from the file system at run-time.
+         qCritical() <<
+            Q_FUNC_INFO << "Could not open schema file resource " << schemaFile.fileName() << " for reading";
+         throw std::runtime_error("Could not open schema file resource");
+      }
+
+      QByteArray schemaData = schemaFile.readAll();
+      qCDebug(Logging::xml) <<
+         Q_FUNC_INFO << "Schema file " << schemaFile.fileName() << ": " << schemaData.length() << " bytes";
+
+      // Don't want qDebug to escape newlines, as there will be lots in the list of parameter settings, hence
+      // ".noquote()" here.
+      qCDebug(Logging::xml).noquote() <<
+         Q_FUNC_INFO << "Settings for reading schema file " << schemaFile.fileName() << ": " <<
+         XercesHelpers::getParameterSettings(*config);
+
+      // The third parameter is just a name for the object.  It's not used by Xerces, but does show up in error
+      // messages (as the URI of the error location), so we use the file name as something vaguely helpful to show
+      // there.
+      QByteArray schemaFileNameAsCString = schemaFile.fileName().toLocal8Bit();
+      xercesc::MemBufInputSource schemaAsInputSource{reinterpret_cast<const XMLByte *>(schemaData.constData()),
+                                                     static_cast<XMLSize_t>(schemaData.length()),
+                                                     schemaFileNameAsCString};
+
+      xercesc::Wrapper4InputSource schemaAsDOMLSInput{&schemaAsInputSource, false};
+
+      // Load the schema and cache its grammar (third parameter = true does the latter)
+      // The returned preparsed schema grammar object (SchemaGrammar or DTDGrammar) is owned by the grammar pool
+      // (because the parser has one) and should not be deleted by the user.
+      // Strictly, we should try/catch this for SAXException, XMLException. DOMException.  However, we are not
+      // expecting any of these because we are parsing our own XSD file that is compiled into the program binary.
+      xercesc::Grammar * grammar = parser->loadGrammar(&schemaAsDOMLSInput,
+                                                       xercesc::Grammar::SchemaGrammarType,
+                                                       true);
+      if (!grammar) {
+         // As above, this shouldn't happen "in production" as it's our own schema file, so we should make it parseable
+         qCritical() << Q_FUNC_INFO << "Unable to parse schema " << schemaFile.fileName();
+         throw std::runtime_error("Unable to parse schema -- see log file for more details");
+      }
+
+      if (domErrorHandler.failed()) {
+         qCritical() << Q_FUNC_INFO << "Error parsing schema " << schemaFile.fileName();
+         throw std::runtime_error("Error parsing schema -- see log file for more details");
+      }
+
+      xercesc::Grammar * rootGrammar = parser->getRootGrammar();
+
+      qCDebug(Logging::xml) <<
+         Q_FUNC_INFO << "Schema " << schemaFile.fileName() << " loaded OK.  Grammar:" << grammar << ", root grammar:" <<
+         rootGrammar;
+
+      //
+      // Now that the pool contains everything we need, lock it.  This means no parser can add anything to it (which
+      // they shouldn't anyway, given the settings in createDocumentParser()), and, importantly, it is what makes it
+      // safe for parsers on different threads to use the pool at the same time, as Xerces then switches to a
+      // thread-safe string pool internally.
+      //
+      this->grammarPool->lockPool();
+
+      // The parser we used to load the schema gets released when we return, but the grammar it loaded stays in the pool
+      return;
+   }
+
+   /**
+    * \brief Create a new parser, using our shared grammar pool, with all the settings we want for validating against
+    *        our schema(s).
+    */
+   DomLsParserPtr createParser() const {
       //
       // According to https://xerces.apache.org/xerces-c/program-dom-3.html, DOMLSParser is a new interface introduced by
       // the W3C DOM Level 3.0 Load and Save Specification.  DOMLSParser provides the "Load" interface for parsing XML
@@ -171,11 +271,15 @@ public:
       // other schema language).   Since we completely control the schemas we're using, there seems little benefit in
       // trying to specify such restrictions here.
       //
-      this->parser =
-         domImplementation->createLSParser(xercesc::DOMImplementationLS::MODE_SYNCHRONOUS,
-                                           nullptr  /*,
-                                           xercesc::XMLPlatformUtils::fgMemoryManager, .:TBD:. Shall we reenable the grammar pool stuff?
-                                           &this->grammarPool*/);
+      // The last parameter is the grammar pool, which is where the parser looks for (and, when loading the schema,
+      // puts) compiled grammars.  All our parsers share the one pool, so the XSD only gets parsed once.
+      //
+      DomLsParserPtr parser{
+         this->domImplementation->createLSParser(xercesc::DOMImplementationLS::MODE_SYNCHRONOUS,
+                                                 nullptr,
+                                                 xercesc::XMLPlatformUtils::fgMemoryManager,
+                                                 this->grammarPool)
+      };
 
       //
       // See https://xerces.apache.org/xerces-c/program-dom-3.html for full details of these config options
@@ -202,7 +306,7 @@ public:
       // anything but will cause a subsequent error of "implementation does not support the requested type of object or
       // operation" when you, say, try to parse a document.
       //
-      xercesc::DOMConfiguration * config = this->parser->getDomConfig();
+      xercesc::DOMConfiguration * config = parser->getDomConfig();
 
       // "comments" - false = Discard Comment nodes in document
       config->setParameter(xercesc::XMLUni::fgDOMComments, false);
@@ -255,62 +359,20 @@ public:
       // Xerces functionality from Xalan.
       config->setParameter(xercesc::XMLUni::fgXercesDOMHasPSVIInfo, true);
 
-      BtDomErrorHandler domErrorHandler;
-      config->setParameter(xercesc::XMLUni::fgDOMErrorHandler, &domErrorHandler);
-
-      QFile schemaFile(schemaResource);
-      if (!schemaFile.open(QIODevice::ReadOnly)) {
-         // This should pretty much never happen, as we're loading from a QResource compiled into the binary rather
-         // than reading from the file system at run-time.
-         qCritical() <<
-            Q_FUNC_INFO << "Could not open schema file resource " << schemaFile.fileName() << " for reading";
-         throw std::runtime_error("Could not open schema file resource");
-      }
-
-      QByteArray schemaData = schemaFile.readAll();
-      qDebug() <<
-         Q_FUNC_INFO << "Schema file " << schemaFile.fileName() << ": " << schemaData.length() << " bytes";
-
-      // Don't want qDebug to escape newlines, as there will be lots in the list of parameter settings, hence
-      // ".noquote()" here.
-      qDebug().noquote() <<
-         Q_FUNC_INFO << "Settings for reading schema file " << schemaFile.fileName() << ": " <<
-         XercesHelpers::getParameterSettings(*config);
-
-      // The third parameter is just a name for the object.  It's not used by Xerces, but does show up in error
-      // messages (as the URI of the error location), so we use the file name as something vaguely helpful to show
-      // there.
-      QByteArray schemaFileNameAsCString = schemaFile.fileName().toLocal8Bit();
-      xercesc::MemBufInputSource schemaAsInputSource{reinterpret_cast<const XMLByte *>(schemaData.constData()),
-                                                     static_cast<XMLSize_t>(schemaData.length()),
-                                                     schemaFileNameAsCString};
-
-      xercesc::Wrapper4InputSource schemaAsDOMLSInput{&schemaAsInputSource, false};
-
-      // Load the schema and cache its grammar (third parameter = true does the latter)
-      // The returned preparsed schema grammar object (SchemaGrammar or DTDGrammar) is owned by the parser and should
-      // not be deleted by the user.
-      // Strictly, we should try/catch this for SAXException, XMLException. DOMException.  However, we are not
-      // expecting any of these because we are parsing our own XSD file that is compiled into the program binary.
-      xercesc::Grammar * grammar = this->parser->loadGrammar(&schemaAsDOMLSInput,
-                                                             xercesc::Grammar::SchemaGrammarType,
-                                                             true);
-      if (!grammar) {
-         // As above, this shouldn't happen "in production" as it's our own schema file, so we should make it parseable
-         qCritical() << Q_FUNC_INFO << "Unable to parse schema " << schemaFile.fileName();
-         throw std::runtime_error("Unable to parse schema -- see log file for more details");
-      }
-
-      if (domErrorHandler.failed()) {
-         qCritical() << Q_FUNC_INFO << "Error parsing schema " << schemaFile.fileName();
-         throw std::runtime_error("Error parsing schema -- see log file for more details");
-      }
-
-      xercesc::Grammar * rootGrammar = this->parser->getRootGrammar();
+      return parser;
+   }
 
-      qDebug() <<
-         Q_FUNC_INFO << "Schema " << schemaFile.fileName() << " loaded OK.  Grammar:" << grammar << ", root grammar:" <<
-         rootGrammar;
+   /**
+    * \brief Create a new parser for reading in an XML document against the schema we already loaded into the grammar
+    *        pool.
+    *
+    *        Xerces parsers are not thread-safe, but creating one is cheap (as long as it doesn't have to parse a
+    *        schema), so each document gets its own parser, which means several documents can be parsed on different
+    *        threads at the same time.
+    */
+   DomLsParserPtr createDocumentParser() const {
+      DomLsParserPtr parser = this->createParser();
+      xercesc::DOMConfiguration * config = parser->getDomConfig();
 
       // "http://apache.org/xml/features/validation/use-cachedGrammarInParse"
       // true = Use cached grammar if it exists in the pool
@@ -326,11 +388,11 @@ public:
       //        call xercesc::DOMDocument::release() to release the associated memory. The parser will not release it.
       //        The ownership is transferred from the parser to the caller.
       //
-      // The reason for setting this to true is that we reuse the parser, so we don't want to wait until its destructor
-      // is called for all the DOMDocument objects to be released.
+      // The reason for setting this to true is that BtDomDocumentOwner takes care of releasing the document, and we
+      // want that to be independent of when the parser that created it is released.
       config->setParameter(xercesc::XMLUni::fgXercesUserAdoptsDOMDocument, true);
 
-      return;
+      return parser;
    }
 
    /**
@@ -346,6 +408,8 @@ public:
     *                        parsing it.  See comments in the BeerXML-specific files for more details.)
     * \param userMessage Any message that we want the top-level caller to display to the user (either about an error
     *                    or, in the event of success, summarising what was read in) should be appended to this string.
+    * \param recordLoadedHandler If not null, top-level records are passed to this as they are loaded, instead of
+    *                            being stored in the DB.  See \c XmlCoding::validateAndLoad().
     *
     * \return true if file validated OK (including if there were "errors" that we can safely ignore)
     *         false if there was a problem that means it's not worth trying to read in the data from the file
@@ -354,22 +418,22 @@ public:
                                  QByteArray const & documentData,
                                  QString const & fileName,
                                  BtDomErrorHandler & domErrorHandler,
-                                 QTextStream & userMessage) {
+                                 QTextStream & userMessage,
+                                 XmlRecord::ChildRecordLoadedHandler const * recordLoadedHandler = nullptr) {
       // See https://www.codesynthesis.com/pipermail/xsd-users/2010-April/002805.html for list of all exceptions Xerces
       // can throw.
       try {
-         // Probably not 100% necessary to lock the pool against modifications, as we're not planning any after start-up, but...
-         //this->grammarPool.lockPool();
-
-         /// TBD probably need to lock other things here ///
-
-
-         xercesc::DOMConfiguration * config = this->parser->getDomConfig();
+         //
+         // Each document gets its own parser (see comment on createDocumentParser()), so there's nothing here we need to
+         // lock if imports are happening on more than one thread.
+         //
+         DomLsParserPtr parser = this->createDocumentParser();
+         xercesc::DOMConfiguration * config = parser->getDomConfig();
          config->setParameter(xercesc::XMLUni::fgDOMErrorHandler, &domErrorHandler);
 
          // Don't want qDebug to escape newlines, as there will be lots in the list of parameter settings, hence
          // ".noquote()" here.
-         qDebug().noquote() <<
+         qCDebug(Logging::xml).noquote() <<
             Q_FUNC_INFO << "Settings for reading input " << fileName << ": " << XercesHelpers::getParameterSettings(*config);
 
          QByteArray fileNameAsCString = fileName.toLocal8Bit();
@@ -385,11 +449,12 @@ public:
 
          // The BtDomDocumentOwner object will, in its destructor, handle telling Xerces to release resources related
          // to the document
-         // std::shared_ptr<BtDomDocumentOwner> domDocumentOwner{new BtDomDocumentOwner{this->parser->parse(&documentAsDOMLSInput)}}
-         BtDomDocumentOwner domDocumentOwner{this->parser->parse(&documentAsDOMLSInput)};
+         // std::shared_ptr<BtDomDocumentOwner> domDocumentOwner{new BtDomDocumentOwner{parser->parse(&documentAsDOMLSInput)}}
+         BtDomDocumentOwner domDocumentOwner{parser->parse(&documentAsDOMLSInput)};
 
          bool parsedOk = !domErrorHandler.failed();
-         qDebug() << Q_FUNC_INFO << "Parse of input file " << fileName << (parsedOk ? "succeeded" : "FAILED");
+         qCDebug(Logging::xml) << Q_FUNC_INFO << "Parse of input file " << fileName
+            << (parsedOk ? "succeeded" : "FAILED");
 
          if (!parsedOk) {
             userMessage << domErrorHandler.getlastError();
@@ -407,7 +472,7 @@ public:
          }
 
          // If we got this far, the validation has succeeded, and we can now proceed to loading
-         return this->loadValidated(xmlCoding, domDocumentOwner.getDomDocument(), userMessage);
+         return this->loadValidated(xmlCoding, domDocumentOwner.getDomDocument(), userMessage, recordLoadedHandler);
 
       } catch(const std::exception& se) {
          qCritical() << Q_FUNC_INFO << "Caught std::exception: " << se.what();
@@ -445,11 +510,15 @@ public:
     *                    returns).
     * \param userMessage Any message that we want the top-level caller to display to the user (either about an error
     *                    or, in the event of success, summarising what was read in) should be appended to this.
+    * \param recordLoadedHandler See \c validateLoadAndStoreInDb()
     *
     * \return true if file validated OK (including if there were "errors" that we can safely ignore)
     *         false if there was a problem that means it's not worth trying to read in the data from the file
     */
-   bool loadValidated(XmlCoding const * xmlCoding, xercesc::DOMDocument * domDocument, QTextStream & userMessage) {
+   bool loadValidated(XmlCoding const * xmlCoding,
+                      xercesc::DOMDocument * domDocument,
+                      QTextStream & userMessage,
+                      XmlRecord::ChildRecordLoadedHandler const * recordLoadedHandler) {
 
       //
       // Some of the initial things we're doing here are just as easy to do in Xerces, but it's easiest to start
@@ -481,7 +550,7 @@ public:
          return false;
       }
 
-      return this->loadNormaliseAndStoreInDb(xmlCoding, domSupport, rootNode, userMessage);
+      return this->loadNormaliseAndStoreInDb(xmlCoding, domSupport, rootNode, userMessage, recordLoadedHandler);
    }
 
 
@@ -492,15 +561,17 @@ public:
     * \param rootNode root node of document
     * \param userMessage Any message that we want the top-level caller to display to the user (either about an error
     *                    or, in the event of success, summarising what was read in) should be appended to this.
+    * \param recordLoadedHandler See \c validateLoadAndStoreInDb()
     * \return
     */
    bool loadNormaliseAndStoreInDb(XmlCoding const * xmlCoding,
                                   xalanc::DOMSupport & domSupport,
                                   xalanc::XalanNode * rootNode,
-                                  QTextStream & userMessage) const {
+                                  QTextStream & userMessage,
+                                  XmlRecord::ChildRecordLoadedHandler const * recordLoadedHandler) const {
 
       XQString rootNodeName{rootNode->getNodeName()};
-      qDebug() << Q_FUNC_INFO << "Processing root node: " << rootNodeName;
+      qCDebug(Logging::xml) << Q_FUNC_INFO << "Processing root node: " << rootNodeName;
 
       // It's usually a coding error if we don't understand how to process the root node, because it should have been
       // validated by the XSD.  (In the case of BeerXML, the root node is a manufactured one that we inserted, which is all
@@ -515,6 +586,12 @@ public:
 
       std::shared_ptr<XmlRecord> rootRecord = xmlCoding->getNewXmlRecord(rootNodeName);
 
+      if (recordLoadedHandler) {
+         // Storing the records, and keeping stats about it, is the handler's job
+         rootRecord->setChildRecordLoadedHandler(*recordLoadedHandler);
+         return rootRecord->load(domSupport, rootNode, userMessage);
+      }
+
       XmlRecordCount stats;
 
       if (!rootRecord->load(domSupport, rootNode, userMessage)) {
@@ -538,14 +615,15 @@ private:
    // Xerces.  However, since Xerces 3.0.0 release, it is now part of the public API -- see
    // https://xerces.apache.org/xerces-c/migrate-archive-3.html#NewAPI300
    //
-   // NB: For the moment, this is commented out as I think we don't need it.  If we want to play around with it more
-   //     then we need to be careful about ensuring it is destructed before the Xerces & Xalan libraries are terminated
-   //     in main().
+   // We parse our schema into this once, in the constructor, and then lock it, after which it is read-only and can be
+   // shared by the parsers for all the documents we read in, including on different threads.
    //
-   // xercesc::XMLGrammarPoolImpl grammarPool;
+   // NB: Because of the way the Xerces & Xalan libraries are terminated in main(), this is a raw pointer that we never
+   //     delete.  See comment on the destructor.
+   //
+   xercesc::XMLGrammarPoolImpl * grammarPool;
 
    xercesc::DOMImplementation * domImplementation;
-   xercesc::DOMLSParser * parser;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -556,7 +634,7 @@ XmlCoding::XmlCoding(QString const name,
    name{name},
    entityNameToXmlRecordDefinition{entityNameToXmlRecordDefinition},
    pimpl{ new impl{schemaResource} } {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::xml) << Q_FUNC_INFO;
    return;
 }
 
@@ -583,5 +661,19 @@ bool XmlCoding::validateLoadAndStoreInDb(QByteArray const & documentData,
                                          QString const & fileName,
                                          BtDomErrorHandler & domErrorHandler,
                                          QTextStream & userMessage) const {
+   TRACE_SPAN("xml", "XmlCoding::validateLoadAndStoreInDb");
    return this->pimpl->validateLoadAndStoreInDb(this, documentData, fileName, domErrorHandler, userMessage);
 }
+
+bool XmlCoding::validateAndLoad(QByteArray const & documentData,
+                                QString const & fileName,
+                                BtDomErrorHandler & domErrorHandler,
+                                QTextStream & userMessage,
+                                XmlRecord::ChildRecordLoadedHandler const & recordLoadedHandler) const {
+   return this->pimpl->validateLoadAndStoreInDb(this,
+                                                documentData,
+                                                fileName,
+                                                domErrorHandler,
+                                                userMessage,
+                                                &recordLoadedHandler);
+}
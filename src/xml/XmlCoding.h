@@ -230,6 +230,26 @@ public:
                                  BtDomErrorHandler & domErrorHandler,
                                  QTextStream & userMessage) const;
 
+   /**
+    * \brief Validate XML file against schema and load its contents into objects, but, instead of storing them in the
+    *        DB, pass each top-level record to \c recordLoadedHandler as soon as it has been loaded.  Since this does
+    *        not touch the DB, it can be called on a worker thread.
+    *
+    * \param documentData See \c validateLoadAndStoreInDb()
+    * \param fileName See \c validateLoadAndStoreInDb()
+    * \param domErrorHandler See \c validateLoadAndStoreInDb()
+    * \param userMessage Any message about errors that we want the top-level caller to display to the user
+    * \param recordLoadedHandler Called, on the calling thread, for each top-level record loaded.  If it returns
+    *                            \c false, we stop loading (and return \c false).
+    *
+    * \return true if file validated OK and all records were loaded and accepted by \c recordLoadedHandler
+    */
+   bool validateAndLoad(QByteArray const & documentData,
+                        QString const & fileName,
+                        BtDomErrorHandler & domErrorHandler,
+                        QTextStream & userMessage,
+                        XmlRecord::ChildRecordLoadedHandler const & recordLoadedHandler) const;
+
 private:
    QString name;
    QHash<QString, XmlRecordDefinition> const entityNameToXmlRecordDefinition;
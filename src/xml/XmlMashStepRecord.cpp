@@ -17,6 +17,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "xml/XmlMashStepRecord.h"
+#include "Logging.h"
 #include "model/Mash.h"
 
 XmlRecord::ProcessingResult XmlMashStepRecord::normaliseAndStoreInDb(std::shared_ptr<NamedEntity> containingEntity,
@@ -73,7 +74,7 @@ XmlRecord::ProcessingResult XmlMashStepRecord::normaliseAndStoreInDb(std::shared
 }
 
 void XmlMashStepRecord::setContainingEntity(std::shared_ptr<NamedEntity> containingEntity) {
-   qDebug() <<
+   qCDebug(Logging::xml) <<
       Q_FUNC_INFO << "Setting" << containingEntity->metaObject()->className() << "ID" << containingEntity->key() <<
       "on" << this->namedEntity->metaObject()->className() << "#" << this->namedEntity->key();
 
@@ -92,7 +93,7 @@ void XmlMashStepRecord::setContainingEntity(std::shared_ptr<NamedEntity> contain
 }
 
 int XmlMashStepRecord::storeNamedEntityInDb() {
-   qDebug() <<
+   qCDebug(Logging::xml) <<
       Q_FUNC_INFO << "Skipping store in DB as already done and MashStep has ID" << this->namedEntity->key() <<
       "and step number" << std::static_pointer_cast<MashStep>(this->namedEntity)->stepNumber();
    return this->namedEntity->key();
@@ -21,6 +21,7 @@
 #include <cstring>
 #include <functional>
 
+#include "Logging.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
 #include "model/Hop.h"
@@ -84,7 +85,7 @@ void XmlRecipeRecord::addChildren() {
    //
    for (auto ii : this->childRecords) {
       if (ii.xmlRecord->namedEntityClassName == childClassName) {
-         qDebug() << Q_FUNC_INFO << "Adding " << childClassName << " to Recipe";
+         qCDebug(Logging::xml) << Q_FUNC_INFO << "Adding " << childClassName << " to Recipe";
 
          // It would be a (pretty unexpected) coding error if the NamedEntity subclass object isn't of the class it's
          // supposed to be.
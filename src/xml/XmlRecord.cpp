@@ -27,6 +27,7 @@
 #include <xalanc/XPath/XPathEvaluator.hpp>
 #include <xalanc/XalanDOM/XalanNamedNodeMap.hpp>
 
+#include "Logging.h"
 #include "xml/XmlCoding.h"
 
 //
@@ -75,7 +76,9 @@ XmlRecord::XmlRecord(QString const & recordName,
    namedParameterBundle{NamedParameterBundle::NotStrict},
    namedEntity{nullptr},
    includeInStats{true},
-   childRecords{} {
+   childRecords{},
+   childRecordLoadedHandler{},
+   storedInDb{false} {
    return;
 }
 
@@ -95,7 +98,7 @@ std::shared_ptr<NamedEntity> XmlRecord::getNamedEntity() const {
 bool XmlRecord::load(xalanc::DOMSupport & domSupport,
                      xalanc::XalanNode * rootNodeOfRecord,
                      QTextStream & userMessage) {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::xml) << Q_FUNC_INFO;
 
    xalanc::XPathEvaluator xPathEvaluator;
    //
@@ -129,7 +132,7 @@ bool XmlRecord::load(xalanc::DOMSupport & domSupport,
                                     rootNodeOfRecord,
                                     fieldDefinition->xPath.getXalanString());
       auto numChildNodes = nodesForCurrentXPath.getLength();
-      qDebug() << Q_FUNC_INFO << "Found" << numChildNodes << "node(s) for " << fieldDefinition->xPath;
+      qCDebug(Logging::xml) << Q_FUNC_INFO << "Found" << numChildNodes << "node(s) for " << fieldDefinition->xPath;
       if (XmlRecord::FieldType::RecordSimple == fieldDefinition->fieldType ||
           XmlRecord::FieldType::RecordComplex == fieldDefinition->fieldType) {
          //
@@ -158,12 +161,12 @@ bool XmlRecord::load(xalanc::DOMSupport & domSupport,
          XQString fieldName{fieldContainerNode->getNodeName()};
          xalanc::XalanNodeList const * fieldContents = fieldContainerNode->getChildNodes();
          int numChildrenOfContainerNode = fieldContents->getLength();
-         qDebug() <<
+         qCDebug(Logging::xml) <<
             Q_FUNC_INFO << "Node " << fieldDefinition->xPath << "(" << fieldName << ":" <<
             XALAN_NODE_TYPES[fieldContainerNode->getNodeType()] << ") has " <<
             numChildrenOfContainerNode << " children";
          if (0 == numChildrenOfContainerNode) {
-            qDebug() << Q_FUNC_INFO << "Empty!";
+            qCDebug(Logging::xml) << Q_FUNC_INFO << "Empty!";
          } else {
             {
                //
@@ -178,7 +181,7 @@ bool XmlRecord::load(xalanc::DOMSupport & domSupport,
                }
                xalanc::XalanNode * valueNode = fieldContents->item(0);
                XQString value(valueNode->getNodeValue());
-               qDebug() << Q_FUNC_INFO << "Value " << value;
+               qCDebug(Logging::xml) << Q_FUNC_INFO << "Value " << value;
 
                bool parsedValueOk = false;
                QVariant parsedValue;
@@ -246,7 +249,7 @@ bool XmlRecord::load(xalanc::DOMSupport & domSupport,
                         // For the moment, we assume that, if a "-" didn't get filtered out by XSD then it's allowed
                         // and should be interpreted as NULL, which therefore means we store 0.0.
                         //
-                        qInfo() <<
+                        qCInfo(Logging::xml) <<
                            Q_FUNC_INFO << "Treating " << this->namedEntityClassName << " node " << fieldDefinition->xPath << "=" <<
                            value << " as 0.0";
                         parsedValue.setValue(0.0);
@@ -357,7 +360,7 @@ bool XmlRecord::load(xalanc::DOMSupport & domSupport,
                      // out), we can't carry on to normal processing below.  So jump straight to processing the next
                      // node in the loop (via continue).
                      //
-                     qDebug() <<
+                     qCDebug(Logging::xml) <<
                         Q_FUNC_INFO << "Skipping " << this->namedEntityClassName << " node " <<
                         fieldDefinition->xPath << "=" << value << "(" << fieldDefinition->propertyName <<
                         ") as not useful";
@@ -416,6 +419,35 @@ bool XmlRecord::load(xalanc::DOMSupport & domSupport,
    return true;
 }
 
+void XmlRecord::setChildRecordLoadedHandler(XmlRecord::ChildRecordLoadedHandler handler) {
+   this->childRecordLoadedHandler = handler;
+   return;
+}
+
+void XmlRecord::moveNamedEntitiesToThread(QThread * thread) {
+   if (this->namedEntity) {
+      this->namedEntity->moveToThread(thread);
+   }
+   for (auto & childRecord : this->childRecords) {
+      childRecord.xmlRecord->moveNamedEntitiesToThread(thread);
+   }
+   return;
+}
+
+void XmlRecord::undoStoreInDb() {
+   // Children first, in reverse order, so that we undo things in the opposite order to how they were done
+   for (auto ii = this->childRecords.rbegin(); ii != this->childRecords.rend(); ++ii) {
+      ii->xmlRecord->undoStoreInDb();
+   }
+   if (this->storedInDb) {
+      qCDebug(Logging::xml) << Q_FUNC_INFO << "Deleting stored" << this->namedEntityClassName << "#"
+         << this->namedEntity->key();
+      this->deleteNamedEntityFromDb();
+      this->storedInDb = false;
+   }
+   return;
+}
+
 void XmlRecord::constructNamedEntity() {
    // Base class does not have a NamedEntity or a container, so nothing to do
    // Stictly, it's a coding error if this function is called, as caller should first check whether there is a
@@ -438,7 +470,7 @@ XmlRecord::ProcessingResult XmlRecord::normaliseAndStoreInDb(std::shared_ptr<Nam
                                                              QTextStream & userMessage,
                                                              XmlRecordCount & stats) {
    if (nullptr != this->namedEntity) {
-      qDebug() <<
+      qCDebug(Logging::xml) <<
          Q_FUNC_INFO << "Normalise and store " << this->namedEntityClassName << "(" <<
          this->namedEntity->metaObject()->className() << "):" << this->namedEntity->name();
 
@@ -452,7 +484,7 @@ XmlRecord::ProcessingResult XmlRecord::normaliseAndStoreInDb(std::shared_ptr<Nam
       // determine whether they are duplicates.  This is why we check again, after storing in the DB, below.
       //
       if (this->isDuplicate()) {
-         qDebug() <<
+         qCDebug(Logging::xml) <<
             Q_FUNC_INFO << "(Early found) duplicate" << this->namedEntityClassName <<
             (this->includeInStats ? " will" : " won't") << " be included in stats";
          if (this->includeInStats) {
@@ -475,6 +507,7 @@ XmlRecord::ProcessingResult XmlRecord::normaliseAndStoreInDb(std::shared_ptr<Nam
          "in database.  See logs for more details";
          return XmlRecord::ProcessingResult::Failed;
       }
+      this->storedInDb = true;
    }
 
    XmlRecord::ProcessingResult processingResult;
@@ -508,7 +541,7 @@ XmlRecord::ProcessingResult XmlRecord::normaliseAndStoreInDb(std::shared_ptr<Nam
       // We potentially do stats for everything except failure
       //
       if (XmlRecord::ProcessingResult::FoundDuplicate == processingResult) {
-         qDebug() <<
+         qCDebug(Logging::xml) <<
             Q_FUNC_INFO << "(Late found) duplicate" << this->namedEntityClassName <<
             (this->includeInStats ? " will" : " won't") << " be included in stats";
          if (this->includeInStats) {
@@ -532,10 +565,11 @@ XmlRecord::ProcessingResult XmlRecord::normaliseAndStoreInDb(std::shared_ptr<Nam
          // and 2 MashSteps before hitting an error on the 3rd MashStep, then deleting the Mash from the DB will also
          // result in those 2 stored MashSteps getting deleted from the DB.)
          //
-         qDebug() <<
+         qCDebug(Logging::xml) <<
             Q_FUNC_INFO << "Deleting stored" << this->namedEntityClassName << "as" <<
             (XmlRecord::ProcessingResult::FoundDuplicate == processingResult ? "duplicate" : "failed to read all child records");
          this->deleteNamedEntityFromDb();
+         this->storedInDb = false;
       }
    }
 
@@ -559,7 +593,7 @@ bool XmlRecord::normaliseAndStoreChildRecordsInDb(QTextStream & userMessage,
    // iterators, so going backwards would be a bit clunky.)
    //
    for (auto ii = this->childRecords.begin(); ii != this->childRecords.end(); ++ii) {
-      qDebug() <<
+      qCDebug(Logging::xml) <<
          Q_FUNC_INFO << "Storing" << ii->xmlRecord->namedEntityClassName << "child of" << this->namedEntityClassName;
       if (XmlRecord::ProcessingResult::Failed ==
          ii->xmlRecord->normaliseAndStoreInDb(this->namedEntity, userMessage, stats)) {
@@ -592,7 +626,7 @@ bool XmlRecord::normaliseAndStoreChildRecordsInDb(QTextStream & userMessage,
          // It's a coding error if we can't create a valid QVariant from a pointer to class we are trying to "set"
          Q_ASSERT(QVariant::fromValue(ii->xmlRecord->namedEntity.get()).isValid());
 
-         qDebug() <<
+         qCDebug(Logging::xml) <<
             Q_FUNC_INFO << "Setting" << propertyName << "property (type = " <<
             this->namedEntity->metaObject()->property(
                this->namedEntity->metaObject()->indexOfProperty(propertyName)
@@ -643,16 +677,25 @@ bool XmlRecord::loadChildRecords(xalanc::DOMSupport & domSupport,
       Q_ASSERT(this->xmlCoding.isKnownXmlRecordType(childRecordName));
 
       std::shared_ptr<XmlRecord> xmlRecord = this->xmlCoding.getNewXmlRecord(childRecordName);
-      this->childRecords.append(XmlRecord::ChildRecord{fieldDefinition, xmlRecord});
       //
       // The return value of xalanc::XalanNode::getIndex() doesn't have an instantly obvious direct meaning, but AFAICT
       // higher values are for nodes that were later in the input file, so useful to log.
       //
-      qDebug() <<
+      qCDebug(Logging::xml) <<
          Q_FUNC_INFO << "Loading child record" << childRecordName << "with index" << childRecordNode->getIndex();
       if (!xmlRecord->load(domSupport, childRecordNode, userMessage)) {
          return false;
       }
+
+      if (this->childRecordLoadedHandler) {
+         // The handler is now responsible for the child record, so we don't keep it ourselves
+         if (!this->childRecordLoadedHandler(xmlRecord)) {
+            qCDebug(Logging::xml) << Q_FUNC_INFO << "Loading abandoned after" << childRecordName << "record";
+            return false;
+         }
+      } else {
+         this->childRecords.append(XmlRecord::ChildRecord{fieldDefinition, xmlRecord});
+      }
    }
 
    return true;
@@ -708,7 +751,7 @@ void XmlRecord::toXml(NamedEntity const & namedEntityToExport,
                       char const * const indentString) const {
    // Callers are not allowed to supply null indent string
    Q_ASSERT(nullptr != indentString);
-   qDebug() <<
+   qCDebug(Logging::xml) <<
       Q_FUNC_INFO << "Exporting XML for" << namedEntityToExport.metaObject()->className() << "#" << namedEntityToExport.key();
    writeIndents(out, indentLevel, indentString);
    out << "<" << this->recordName << ">\n";
@@ -748,8 +791,8 @@ void XmlRecord::toXml(NamedEntity const & namedEntityToExport,
             writeIndents(out, indentLevel + 1 + ii, indentString);
             out << "<" << xPathElements.at(ii) << ">\n";
          }
-         qDebug() << Q_FUNC_INFO << xPathElements;
-         qDebug() << Q_FUNC_INFO << xPathElements.last();
+         qCDebug(Logging::xml) << Q_FUNC_INFO << xPathElements;
+         qCDebug(Logging::xml) << Q_FUNC_INFO << xPathElements.last();
          std::shared_ptr<XmlRecord> subRecord = this->xmlCoding.getNewXmlRecord(xPathElements.last());
 
          if (XmlRecord::FieldType::RecordSimple == fieldDefinition.fieldType) {
@@ -890,7 +933,7 @@ void XmlRecord::writeNone(XmlRecord const & subRecord,
    // XML coding.  Eg, we allow a recipe to exist without a style, equipment or mash, but, in BeerXML, only the latter
    // two of these three are optional.  For the moment we just log what's going on.
    //
-   qInfo() <<
+   qCInfo(Logging::xml) <<
       Q_FUNC_INFO << "Skipping" << subRecord.getRecordName() << "tag while exporting" <<
       this->getRecordName() << "XML record for" << namedEntityToExport.metaObject()->className() <<
       "as no data to write";
@@ -20,6 +20,7 @@
 #define XML_XMLRECORD_H
 #pragma once
 
+#include <functional>
 #include <memory>
 
 #include <QTextStream>
@@ -35,6 +36,7 @@
 #include "xml/XmlRecordCount.h"
 #include "xml/XQString.h"
 
+class QThread;
 class XmlCoding;
 
 
@@ -89,6 +91,11 @@ public:
 
    typedef QVector<FieldDefinition> FieldDefinitions;
 
+   /**
+    * \brief See \c setChildRecordLoadedHandler().  The handler returns \c false if loading should be abandoned.
+    */
+   typedef std::function<bool(std::shared_ptr<XmlRecord>)> ChildRecordLoadedHandler;
+
    /**
     * \brief Constructor
     * \param recordName The name of the outer tag around this type of record, eg "RECIPE" for a "<RECIPE>...</RECIPE>"
@@ -145,6 +152,30 @@ public:
              xalanc::XalanNode * rootNodeOfRecord,
              QTextStream & userMessage);
 
+   /**
+    * \brief Normally, child records are kept inside this record after they are loaded, and stored in the DB as part of
+    *        \c normaliseAndStoreInDb().  If a handler is set here, then each child record is instead passed to it as
+    *        soon as it (and everything inside it) has been loaded, and it becomes the handler's responsibility to
+    *        store it.  This is used on the root record to allow us to start storing the contents of a big document
+    *        before we have finished loading all of it.  (See \c BeerXmlImport.)
+    */
+   void setChildRecordLoadedHandler(ChildRecordLoadedHandler handler);
+
+   /**
+    * \brief \c NamedEntity objects are \c QObjects, so they belong to the thread that created them.  If a record is
+    *        loaded on one thread and stored on another, then the caller needs to use this function (on the loading
+    *        thread) to move the \c NamedEntity objects of this record and all its children to the storing thread.
+    */
+   void moveNamedEntitiesToThread(QThread * thread);
+
+   /**
+    * \brief Undo a successful \c normaliseAndStoreInDb() by deleting from the DB (and the object stores) every object
+    *        that this record and its child records stored.  Objects that were found to be duplicates of ones we
+    *        already had are, of course, left alone.  This is needed where the caller is going to roll back the DB
+    *        transaction in which the record was stored, as rolling back does not touch the in-memory object stores.
+    */
+   void undoStoreInDb();
+
    /**
     * \brief Once the record (including all its sub-records) is loaded into memory, we this function does any final
     *        validation and data correction before then storing the object(s) in the database.  Most validation should
@@ -312,6 +343,12 @@ protected:
       std::shared_ptr<XmlRecord> xmlRecord;
    };
    QVector<ChildRecord> childRecords;
+
+private:
+   ChildRecordLoadedHandler childRecordLoadedHandler;
+
+   // Whether this->namedEntity is one that we ourselves stored in the DB (see undoStoreInDb())
+   bool storedInDb;
 };
 
 #endif
@@ -18,6 +18,8 @@
  */
 #include "xml/XmlRecordCount.h"
 
+#include "utils/Metrics.h"
+
 XmlRecordCount::XmlRecordCount() : skips{}, oks{} {
    return;
 }
@@ -27,6 +29,7 @@ void XmlRecordCount::skipped(QString recordName) {
    // If QMap holds an item with key recordName then insert() will just replace its existing value
    this->skips.insert(recordName,
                       this->skips.contains(recordName) ? (this->skips.value(recordName) + 1) : 1);
+   Metrics::counter("xml.records.skipped." + recordName).add();
    return;
 }
 
@@ -35,6 +38,17 @@ void XmlRecordCount::processedOk(QString recordName) {
    // function
    this->oks.insert(recordName,
                     this->oks.contains(recordName) ? (this->oks.value(recordName) + 1) : 1);
+   Metrics::counter("xml.records.processed." + recordName).add();
+   return;
+}
+
+void XmlRecordCount::add(XmlRecordCount const & other) {
+   for (auto ii = other.skips.constBegin(); ii != other.skips.constEnd(); ++ii) {
+      this->skips.insert(ii.key(), this->skips.value(ii.key(), 0) + ii.value());
+   }
+   for (auto ii = other.oks.constBegin(); ii != other.oks.constEnd(); ++ii) {
+      this->oks.insert(ii.key(), this->oks.value(ii.key(), 0) + ii.value());
+   }
    return;
 }
 
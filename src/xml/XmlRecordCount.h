@@ -55,6 +55,12 @@ public:
     */
    void processedOk(QString recordName);
 
+   /**
+    * \brief Add the tallies from another \c XmlRecordCount to this one.  Useful where records are processed in
+    *        batches, some of which might end up being rolled back.
+    */
+   void add(XmlRecordCount const & other);
+
    /**
     * \brief Construct a user-readable string summarising how many records of each type were skipped and/or successfully
     *        processed.